@@ -299,6 +299,10 @@ double   ByteArray::readDouble() {
 
 std::string ByteArray::readStringF16() {
     uint16_t len = readFuint16();
+    // 长度前缀来自外部数据，先和剩余数据比较，避免按伪造的长度分配内存
+    if(len > getReadSize()) {
+        throw std::out_of_range("not enough len");
+    }
     std::string buff;
     buff.resize(len);
     read(&buff[0], len);
@@ -307,6 +311,9 @@ std::string ByteArray::readStringF16() {
 
 std::string ByteArray::readStringF32() {
     uint32_t len = readFuint32();
+    if(len > getReadSize()) {
+        throw std::out_of_range("not enough len");
+    }
     std::string buff;
     buff.resize(len);
     read(&buff[0], len);
@@ -315,6 +322,9 @@ std::string ByteArray::readStringF32() {
 
 std::string ByteArray::readStringF64() {
     uint64_t len = readFuint64();
+    if(len > getReadSize()) {
+        throw std::out_of_range("not enough len");
+    }
     std::string buff;
     buff.resize(len);
     read(&buff[0], len);
@@ -323,6 +333,9 @@ std::string ByteArray::readStringF64() {
 
 std::string ByteArray::readStringVint() {
     uint64_t len = readUint64();
+    if(len > getReadSize()) {
+        throw std::out_of_range("not enough len");
+    }
     std::string buff;
     buff.resize(len);
     read(&buff[0], len);
@@ -381,6 +394,9 @@ void ByteArray::read(void* buf, size_t size) {
     if(size > getReadSize()) {
         throw std::out_of_range("not enough len");
     }
+    if(size == 0) {
+        return;
+    }
 
     size_t npos = m_position % m_baseSize;
     size_t ncap = m_cur->size - npos;
@@ -410,6 +426,9 @@ void ByteArray::read(void* buf, size_t size, size_t position) const {
     if(size > (m_size - position)) {
         throw std::out_of_range("not enough len");
     }
+    if(size == 0) {
+        return;
+    }
 
     size_t npos = position % m_baseSize;
     size_t ncap = m_cur->size - npos;
@@ -0,0 +1,187 @@
+/**
+ * @file circuit_breaker.cc
+ * @brief 熔断器实现
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "circuit_breaker.h"
+#include <algorithm>
+#include <sstream>
+#include "config.h"
+#include "log.h"
+#include "util.h"
+
+namespace sylar {
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_NAME("system");
+
+static sylar::ConfigVar<uint32_t>::ptr g_consecutive_errors =
+    sylar::Config::Lookup("circuit_breaker.consecutive_errors", (uint32_t)5,
+            "consecutive failures to eject an upstream, 0 disables ejection");
+
+static sylar::ConfigVar<uint64_t>::ptr g_slow_request =
+    sylar::Config::Lookup("circuit_breaker.slow_request_ms", (uint64_t)0,
+            "requests slower than this count as failures, 0 disables");
+
+static sylar::ConfigVar<uint64_t>::ptr g_base_ejection =
+    sylar::Config::Lookup("circuit_breaker.base_ejection_ms", (uint64_t)30000,
+            "base ejection time in ms, multiplied by consecutive ejections");
+
+static sylar::ConfigVar<uint64_t>::ptr g_max_ejection =
+    sylar::Config::Lookup("circuit_breaker.max_ejection_ms", (uint64_t)300000,
+            "max ejection time in ms");
+
+static sylar::ConfigVar<uint32_t>::ptr g_max_requests =
+    sylar::Config::Lookup("circuit_breaker.max_requests", (uint32_t)0,
+            "max concurrent requests to one upstream, 0 means unlimited");
+
+static sylar::ConfigVar<uint32_t>::ptr g_half_open_requests =
+    sylar::Config::Lookup("circuit_breaker.half_open_requests", (uint32_t)1,
+            "probe requests allowed when ejection expires");
+
+CircuitBreaker::CircuitBreaker(const std::string& name)
+    :m_name(name)
+    ,m_consecutiveErrors(g_consecutive_errors->getValue())
+    ,m_slowRequest(g_slow_request->getValue())
+    ,m_baseEjection(g_base_ejection->getValue())
+    ,m_maxEjection(std::max(g_max_ejection->getValue(), g_base_ejection->getValue()))
+    ,m_maxRequests(g_max_requests->getValue())
+    ,m_halfOpenRequests(std::max(g_half_open_requests->getValue(), (uint32_t)1)) {
+    auto mgr = sylar::MetricsMgr::GetInstance();
+    MetricsRegistry::Labels labels = {{"name", name}};
+    m_stateGauge = mgr->gauge("sylar_circuit_breaker_state"
+                    , "0 closed, 1 open, 2 half open", labels);
+    m_ejectionsTotal = mgr->counter("sylar_circuit_breaker_ejections_total"
+                    , "upstream ejections", labels);
+    m_rejected = mgr->counter("sylar_circuit_breaker_rejected_total"
+                    , "requests rejected by circuit breaker", labels);
+    m_stateGauge->set(CLOSED);
+}
+
+bool CircuitBreaker::allow() {
+    return allow(GetCurrentMS());
+}
+
+bool CircuitBreaker::allow(uint64_t now_ms) {
+    Spinlock::Lock lock(m_mutex);
+    if(m_maxRequests && m_inflight >= m_maxRequests) {
+        lock.unlock();
+        m_rejected->inc();
+        return false;
+    }
+    if(m_state == OPEN && now_ms >= m_openUntil) {
+        setState(HALF_OPEN);
+        m_probes = 0;
+    }
+    if(m_state == OPEN
+            || (m_state == HALF_OPEN && m_probes >= m_halfOpenRequests)) {
+        lock.unlock();
+        m_rejected->inc();
+        return false;
+    }
+    if(m_state == HALF_OPEN) {
+        ++m_probes;
+    }
+    ++m_inflight;
+    return true;
+}
+
+void CircuitBreaker::record(bool success, uint64_t latency_us) {
+    record(success, latency_us, GetCurrentMS());
+}
+
+void CircuitBreaker::record(bool success, uint64_t latency_us, uint64_t now_ms) {
+    if(success && m_slowRequest && latency_us > m_slowRequest * 1000) {
+        success = false;
+    }
+    Spinlock::Lock lock(m_mutex);
+    if(m_inflight) {
+        --m_inflight;
+    }
+    if(success) {
+        m_errors = 0;
+        if(m_state == HALF_OPEN) {
+            setState(CLOSED);
+            m_closedAt = now_ms;
+        }
+        return;
+    }
+    if(m_state == HALF_OPEN) {
+        eject(now_ms);
+    } else if(m_state == CLOSED && m_consecutiveErrors
+            && ++m_errors >= m_consecutiveErrors) {
+        eject(now_ms);
+    }
+}
+
+void CircuitBreaker::cancel() {
+    Spinlock::Lock lock(m_mutex);
+    if(m_inflight) {
+        --m_inflight;
+    }
+    if(m_state == HALF_OPEN && m_probes) {
+        --m_probes;
+    }
+}
+
+void CircuitBreaker::eject(uint64_t now_ms) {
+    // 恢复后稳定了一个最大熔断时长，重新从基础时长开始
+    if(m_state == CLOSED && now_ms > m_closedAt + m_maxEjection) {
+        m_ejections = 0;
+    }
+    ++m_ejections;
+    uint64_t duration = std::min(m_baseEjection * m_ejections, m_maxEjection);
+    m_openUntil = now_ms + duration;
+    m_errors = 0;
+    setState(OPEN);
+    m_ejectionsTotal->inc();
+    SYLAR_LOG_WARN(g_logger) << "circuit breaker " << m_name << " ejected for "
+        << duration << "ms, ejections=" << m_ejections;
+}
+
+void CircuitBreaker::setState(State state) {
+    m_state = state;
+    m_stateGauge->set(state);
+}
+
+bool CircuitBreaker::isAvailable(uint64_t now_ms) {
+    Spinlock::Lock lock(m_mutex);
+    return m_state != OPEN || now_ms >= m_openUntil;
+}
+
+CircuitBreaker::State CircuitBreaker::getState() {
+    Spinlock::Lock lock(m_mutex);
+    return m_state;
+}
+
+uint32_t CircuitBreaker::getInflight() {
+    Spinlock::Lock lock(m_mutex);
+    return m_inflight;
+}
+
+const char* CircuitBreaker::StateToString(State state) {
+    switch(state) {
+        case CLOSED:
+            return "closed";
+        case OPEN:
+            return "open";
+        case HALF_OPEN:
+            return "half_open";
+    }
+    return "unknown";
+}
+
+std::string CircuitBreaker::toString() {
+    std::stringstream ss;
+    Spinlock::Lock lock(m_mutex);
+    ss << "[CircuitBreaker name=" << m_name
+       << " state=" << StateToString(m_state)
+       << " inflight=" << m_inflight
+       << " errors=" << m_errors
+       << " ejections=" << m_ejections
+       << " open_until=" << m_openUntil
+       << " rejected=" << getRejected() << "]";
+    return ss.str();
+}
+
+}
@@ -0,0 +1,169 @@
+/**
+ * @file circuit_breaker.h
+ * @brief 上游熔断和异常摘除
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#ifndef __SYLAR_CIRCUIT_BREAKER_H__
+#define __SYLAR_CIRCUIT_BREAKER_H__
+
+#include <memory>
+#include <string>
+#include "metrics.h"
+#include "mutex.h"
+#include "noncopyable.h"
+
+namespace sylar {
+
+/**
+ * @brief 单个上游的熔断器
+ * @details 两种保护：
+ *          1. 并发上限(circuit_breaker.max_requests)：发往上游的请求数达到上限时新请求立即失败，
+ *             上游变慢时调用方不会在recvResponse上越积越多，占满协程；
+ *          2. 异常摘除：连续circuit_breaker.consecutive_errors次失败(连接/发送失败、超时、5xx响应，
+ *             或耗时超过circuit_breaker.slow_request_ms)后熔断，熔断期间请求立即失败。
+ *             熔断时长为base_ejection_ms乘以连续熔断次数，不超过max_ejection_ms；
+ *             到期后进入半开状态，放行half_open_requests个探测请求，成功则恢复，失败则再次熔断。
+ *          状态、熔断次数和拒绝数以name标签导出到MetricsMgr
+ */
+class CircuitBreaker : Noncopyable {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<CircuitBreaker> ptr;
+
+    /**
+     * @brief 熔断器状态
+     */
+    enum State {
+        /// 正常
+        CLOSED = 0,
+        /// 熔断中
+        OPEN = 1,
+        /// 半开，放行探测请求
+        HALF_OPEN = 2
+    };
+
+    /**
+     * @brief 构造函数
+     * @param[in] name 名称，一般为上游的host:port，用作指标的name标签
+     */
+    CircuitBreaker(const std::string& name);
+
+    /**
+     * @brief 请求是否可以发往上游
+     * @details 返回true时占用一个并发名额，请求结束后必须调用record归还
+     */
+    bool allow();
+
+    /**
+     * @brief 以指定的当前时间判断
+     * @param[in] now_ms 当前时间(毫秒)
+     */
+    bool allow(uint64_t now_ms);
+
+    /**
+     * @brief 记录allow()放行的请求的结果
+     * @param[in] success 请求是否成功
+     * @param[in] latency_us 请求耗时(微秒)
+     */
+    void record(bool success, uint64_t latency_us);
+
+    /**
+     * @brief 以指定的当前时间记录
+     * @param[in] now_ms 当前时间(毫秒)
+     */
+    void record(bool success, uint64_t latency_us, uint64_t now_ms);
+
+    /**
+     * @brief 归还allow()占用的名额，不记录结果
+     * @details 请求被调用方主动放弃(如对冲请求落败)时使用，不代表上游的好坏
+     */
+    void cancel();
+
+    /**
+     * @brief 当前是否可能放行请求
+     * @details 不改变状态也不占用名额，熔断已到期的上游视为可用，供负载均衡挑选上游时使用
+     * @param[in] now_ms 当前时间(毫秒)
+     */
+    bool isAvailable(uint64_t now_ms);
+
+    /**
+     * @brief 返回当前状态
+     */
+    State getState();
+
+    /**
+     * @brief 返回发往上游的请求数
+     */
+    uint32_t getInflight();
+
+    /**
+     * @brief 返回累计熔断次数
+     */
+    uint64_t getEjections() const { return m_ejectionsTotal->get();}
+
+    /**
+     * @brief 返回累计拒绝的请求数
+     */
+    uint64_t getRejected() const { return m_rejected->get();}
+
+    /**
+     * @brief 返回名称
+     */
+    const std::string& getName() const { return m_name;}
+
+    static const char* StateToString(State state);
+
+    std::string toString();
+private:
+    /**
+     * @brief 熔断，调用方持有锁
+     */
+    void eject(uint64_t now_ms);
+
+    /**
+     * @brief 切换状态，调用方持有锁
+     */
+    void setState(State state);
+private:
+    /// 名称
+    std::string m_name;
+    /// 熔断的连续失败次数
+    uint32_t m_consecutiveErrors;
+    /// 慢请求耗时(毫秒)，0表示不按耗时判断
+    uint64_t m_slowRequest;
+    /// 基础熔断时长(毫秒)
+    uint64_t m_baseEjection;
+    /// 最大熔断时长(毫秒)
+    uint64_t m_maxEjection;
+    /// 并发上限，0表示不限制
+    uint32_t m_maxRequests;
+    /// 半开状态放行的探测请求数
+    uint32_t m_halfOpenRequests;
+    /// 保护以下状态
+    Spinlock m_mutex;
+    /// 当前状态
+    State m_state = CLOSED;
+    /// 发往上游的请求数
+    uint32_t m_inflight = 0;
+    /// 当前连续失败次数
+    uint32_t m_errors = 0;
+    /// 连续熔断次数，决定熔断时长
+    uint32_t m_ejections = 0;
+    /// 熔断结束时间(毫秒)
+    uint64_t m_openUntil = 0;
+    /// 最近一次恢复的时间(毫秒)
+    uint64_t m_closedAt = 0;
+    /// 半开状态已放行的探测请求数
+    uint32_t m_probes = 0;
+    /// 状态
+    Gauge::ptr m_stateGauge;
+    /// 累计熔断次数
+    Counter::ptr m_ejectionsTotal;
+    /// 累计拒绝数
+    Counter::ptr m_rejected;
+};
+
+}
+
+#endif
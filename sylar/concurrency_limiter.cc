@@ -0,0 +1,157 @@
+/**
+ * @file concurrency_limiter.cc
+ * @brief 自适应并发限制器实现
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "concurrency_limiter.h"
+#include <math.h>
+#include <algorithm>
+#include <sstream>
+#include "config.h"
+#include "util.h"
+
+namespace sylar {
+
+static sylar::ConfigVar<uint32_t>::ptr g_initial_limit =
+    sylar::Config::Lookup("concurrency_limiter.initial_limit", (uint32_t)20,
+            "concurrency limiter initial limit");
+
+static sylar::ConfigVar<uint32_t>::ptr g_min_limit =
+    sylar::Config::Lookup("concurrency_limiter.min_limit", (uint32_t)4,
+            "concurrency limiter min limit");
+
+static sylar::ConfigVar<uint32_t>::ptr g_max_limit =
+    sylar::Config::Lookup("concurrency_limiter.max_limit", (uint32_t)1000,
+            "concurrency limiter max limit");
+
+static sylar::ConfigVar<uint64_t>::ptr g_window =
+    sylar::Config::Lookup("concurrency_limiter.window", (uint64_t)100,
+            "concurrency limiter sample window in ms");
+
+static sylar::ConfigVar<uint32_t>::ptr g_min_samples =
+    sylar::Config::Lookup("concurrency_limiter.min_samples", (uint32_t)10,
+            "concurrency limiter min samples per window");
+
+static sylar::ConfigVar<uint32_t>::ptr g_long_window =
+    sylar::Config::Lookup("concurrency_limiter.long_window", (uint32_t)600,
+            "concurrency limiter baseline latency averaging windows");
+
+static sylar::ConfigVar<double>::ptr g_tolerance =
+    sylar::Config::Lookup("concurrency_limiter.tolerance", 1.5,
+            "concurrency limiter tolerated latency over baseline");
+
+static sylar::ConfigVar<double>::ptr g_smoothing =
+    sylar::Config::Lookup("concurrency_limiter.smoothing", 0.2,
+            "concurrency limiter limit smoothing factor");
+
+ConcurrencyLimiter::ConcurrencyLimiter(const std::string& name, uint32_t initial_limit
+                                       ,uint32_t min_limit, uint32_t max_limit)
+    :m_name(name)
+    ,m_minLimit(min_limit ? min_limit : g_min_limit->getValue())
+    ,m_maxLimit(max_limit ? max_limit : g_max_limit->getValue()) {
+    m_minLimit = std::max(m_minLimit, (uint32_t)1);
+    m_maxLimit = std::max(m_maxLimit, m_minLimit);
+    if(initial_limit == 0) {
+        initial_limit = g_initial_limit->getValue();
+    }
+    initial_limit = std::min(std::max(initial_limit, m_minLimit), m_maxLimit);
+    m_limit = initial_limit;
+    m_estimate = initial_limit;
+    m_window = g_window->getValue();
+    m_minSamples = g_min_samples->getValue();
+    m_longWindow = std::max(g_long_window->getValue(), (uint32_t)1);
+    m_tolerance = g_tolerance->getValue();
+    m_smoothing = g_smoothing->getValue();
+
+    auto mgr = sylar::MetricsMgr::GetInstance();
+    MetricsRegistry::Labels labels = {{"name", name}};
+    m_limitGauge = mgr->gauge("sylar_concurrency_limit", "adaptive concurrency limit", labels);
+    m_inflightGauge = mgr->gauge("sylar_concurrency_inflight", "requests in flight", labels);
+    m_rejected = mgr->counter("sylar_concurrency_rejected_total"
+                    , "requests rejected by concurrency limit", labels);
+    m_limitGauge->set(initial_limit);
+}
+
+bool ConcurrencyLimiter::acquire() {
+    uint32_t cur = m_inflight.load(std::memory_order_relaxed);
+    do {
+        if(cur >= m_limit.load(std::memory_order_relaxed)) {
+            m_rejected->inc();
+            return false;
+        }
+    } while(!m_inflight.compare_exchange_weak(cur, cur + 1, std::memory_order_relaxed));
+    ++cur;
+    uint32_t max = m_windowMaxInflight.load(std::memory_order_relaxed);
+    while(cur > max && !m_windowMaxInflight.compare_exchange_weak(max, cur
+                , std::memory_order_relaxed));
+    m_inflightGauge->set(cur);
+    return true;
+}
+
+void ConcurrencyLimiter::release(uint64_t latency_us, bool sample) {
+    release(latency_us, sample, GetCurrentMS());
+}
+
+void ConcurrencyLimiter::release(uint64_t latency_us, bool sample, uint64_t now_ms) {
+    m_inflightGauge->set(m_inflight.fetch_sub(1, std::memory_order_relaxed) - 1);
+    if(!sample) {
+        return;
+    }
+    Spinlock::Lock lock(m_mutex);
+    if(!m_windowStart) {
+        m_windowStart = now_ms;
+    }
+    m_windowSum += latency_us;
+    ++m_windowCount;
+    if(now_ms < m_windowStart + m_window || m_windowCount < m_minSamples) {
+        return;
+    }
+    double short_rtt = (double)m_windowSum / m_windowCount;
+    uint32_t max_inflight = m_windowMaxInflight.exchange(
+                m_inflight.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    m_windowStart = now_ms;
+    m_windowSum = 0;
+    m_windowCount = 0;
+    update(short_rtt, max_inflight);
+}
+
+void ConcurrencyLimiter::update(double short_rtt, uint32_t max_inflight) {
+    m_shortRtt = std::max(short_rtt, 1.0);
+    if(m_longRtt <= 0) {
+        m_longRtt = m_shortRtt;
+    } else {
+        m_longRtt += (m_shortRtt - m_longRtt) / m_longWindow;
+        // 耗时回落后基线跟得太慢，加快衰减，避免上限长时间不收缩
+        if(m_longRtt > m_shortRtt * 2) {
+            m_longRtt *= 0.95;
+        }
+    }
+    // 上限没有被用到时不调整
+    if(max_inflight * 2 < m_estimate) {
+        return;
+    }
+    double gradient = m_tolerance * m_longRtt / m_shortRtt;
+    gradient = std::min(std::max(gradient, 0.5), 1.0);
+    double target = m_estimate * gradient + sqrt(m_estimate);
+    m_estimate = m_estimate * (1 - m_smoothing) + target * m_smoothing;
+    m_estimate = std::min(std::max(m_estimate, (double)m_minLimit), (double)m_maxLimit);
+    m_limit.store((uint32_t)m_estimate, std::memory_order_relaxed);
+    m_limitGauge->set((uint32_t)m_estimate);
+}
+
+std::string ConcurrencyLimiter::toString() {
+    std::stringstream ss;
+    Spinlock::Lock lock(m_mutex);
+    ss << "[ConcurrencyLimiter name=" << m_name
+       << " limit=" << getLimit()
+       << " inflight=" << getInflight()
+       << " min=" << m_minLimit
+       << " max=" << m_maxLimit
+       << " long_rtt_us=" << m_longRtt
+       << " short_rtt_us=" << m_shortRtt
+       << " rejected=" << getRejected() << "]";
+    return ss.str();
+}
+
+}
@@ -0,0 +1,137 @@
+/**
+ * @file concurrency_limiter.h
+ * @brief 按请求耗时自适应调整的并发限制
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#ifndef __SYLAR_CONCURRENCY_LIMITER_H__
+#define __SYLAR_CONCURRENCY_LIMITER_H__
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include "metrics.h"
+#include "mutex.h"
+#include "noncopyable.h"
+
+namespace sylar {
+
+/**
+ * @brief 自适应并发限制器(梯度算法)
+ * @details 固定的并发上限在后端变慢时偏大、变快时偏小。这里按窗口(concurrency_limiter.window)
+ *          统计请求耗时的平均值作为短期耗时，再对短期耗时做长周期的指数平均作为基线：
+ *          gradient = clamp(tolerance * 基线 / 短期耗时, 0.5, 1)，
+ *          新上限 = 上限 * gradient + sqrt(上限)，再按smoothing平滑并限制在[min_limit, max_limit]。
+ *          耗时没有超过基线的tolerance倍时上限按sqrt(上限)缓慢增长，排队使耗时上升时上限随之收缩，
+ *          超出上限的请求立即拒绝，而不是堆在调度器的任务队列里拉高所有请求的耗时。
+ *          窗口内的最大并发不到上限一半时说明上限没有被用到，不再增长。
+ *          上限、并发数和拒绝数以name标签导出到MetricsMgr
+ */
+class ConcurrencyLimiter : Noncopyable {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<ConcurrencyLimiter> ptr;
+
+    /**
+     * @brief 构造函数
+     * @param[in] name 名称，用作指标的name标签
+     * @param[in] initial_limit 初始上限，0表示取concurrency_limiter.initial_limit配置
+     * @param[in] min_limit 最小上限，0表示取concurrency_limiter.min_limit配置
+     * @param[in] max_limit 最大上限，0表示取concurrency_limiter.max_limit配置
+     */
+    ConcurrencyLimiter(const std::string& name, uint32_t initial_limit = 0
+                       ,uint32_t min_limit = 0, uint32_t max_limit = 0);
+
+    /**
+     * @brief 占用一个并发名额
+     * @return 并发数已达上限时返回false，请求应当被拒绝
+     */
+    bool acquire();
+
+    /**
+     * @brief 归还acquire()成功占用的名额
+     * @param[in] latency_us 请求耗时(微秒)
+     * @param[in] sample 是否把耗时计入统计，请求没有真正处理(如读请求体失败)时为false
+     */
+    void release(uint64_t latency_us, bool sample = true);
+
+    /**
+     * @brief 以指定的当前时间归还名额
+     * @param[in] now_ms 当前时间(毫秒)，需要单调不减
+     */
+    void release(uint64_t latency_us, bool sample, uint64_t now_ms);
+
+    /**
+     * @brief 返回当前上限
+     */
+    uint32_t getLimit() const { return m_limit.load(std::memory_order_relaxed);}
+
+    /**
+     * @brief 返回当前并发数
+     */
+    uint32_t getInflight() const { return m_inflight.load(std::memory_order_relaxed);}
+
+    /**
+     * @brief 返回被拒绝的请求数
+     */
+    uint64_t getRejected() const { return m_rejected->get();}
+
+    /**
+     * @brief 返回名称
+     */
+    const std::string& getName() const { return m_name;}
+
+    std::string toString();
+private:
+    /**
+     * @brief 窗口结束时按耗时调整上限
+     */
+    void update(double short_rtt, uint32_t max_inflight);
+private:
+    /// 名称
+    std::string m_name;
+    /// 最小上限
+    uint32_t m_minLimit;
+    /// 最大上限
+    uint32_t m_maxLimit;
+    /// 窗口长度(毫秒)
+    uint64_t m_window;
+    /// 每个窗口的最少样本数
+    uint32_t m_minSamples;
+    /// 基线平均的窗口数
+    uint32_t m_longWindow;
+    /// 容忍的耗时倍数
+    double m_tolerance;
+    /// 上限平滑系数
+    double m_smoothing;
+    /// 当前上限
+    std::atomic<uint32_t> m_limit;
+    /// 当前并发数
+    std::atomic<uint32_t> m_inflight = {0};
+    /// 保护以下窗口统计和估计值
+    Spinlock m_mutex;
+    /// 未取整的上限估计值
+    double m_estimate;
+    /// 耗时基线(微秒)
+    double m_longRtt = 0;
+    /// 最近一个窗口的平均耗时(微秒)
+    double m_shortRtt = 0;
+    /// 当前窗口的开始时间(毫秒)
+    uint64_t m_windowStart = 0;
+    /// 当前窗口的耗时之和
+    uint64_t m_windowSum = 0;
+    /// 当前窗口的样本数
+    uint32_t m_windowCount = 0;
+    /// 当前窗口内的最大并发数
+    std::atomic<uint32_t> m_windowMaxInflight = {0};
+    /// 上限
+    Gauge::ptr m_limitGauge;
+    /// 并发数
+    Gauge::ptr m_inflightGauge;
+    /// 被拒绝的请求数
+    Counter::ptr m_rejected;
+};
+
+}
+
+#endif
@@ -6,10 +6,14 @@
  */
 
 #include <atomic>
+#include <vector>
 #include "fiber.h"
 #include "config.h"
+#include "flight_recorder.h"
 #include "log.h"
 #include "macro.h"
+#include "metrics.h"
+#include "probe.h"
 #include "scheduler.h"
 
 namespace sylar {
@@ -21,6 +25,9 @@ static std::atomic<uint64_t> s_fiber_id{0};
 /// 全局静态变量，用于统计当前的协程数
 static std::atomic<uint64_t> s_fiber_count{0};
 
+static Gauge::ptr g_fiber_gauge = MetricsMgr::GetInstance()->gauge("sylar_fibers"
+        , "live fibers", MetricsRegistry::Labels(), []() { return (double)s_fiber_count; });
+
 /// 线程局部变量，当前线程正在运行的协程
 static thread_local Fiber *t_fiber = nullptr;
 /// 线程局部变量，当前线程的主协程，切换到这个协程，就相当于切换到了主线程中运行，智能指针形式
@@ -30,6 +37,23 @@ static thread_local Fiber::ptr t_thread_fiber = nullptr;
 static ConfigVar<uint32_t>::ptr g_fiber_stack_size =
     Config::Lookup<uint32_t>("fiber.stack_size", 128 * 1024, "fiber stack size");
 
+//每个线程缓存的空闲协程栈数
+static ConfigVar<uint32_t>::ptr g_fiber_stack_cache =
+    Config::Lookup<uint32_t>("fiber.stack_cache", 16, "free fiber stacks cached per thread");
+
+static uint32_t s_stack_cache = 16;
+
+struct _StackCacheIniter {
+    _StackCacheIniter() {
+        s_stack_cache = g_fiber_stack_cache->getValue();
+        g_fiber_stack_cache->addListener([](const uint32_t& old_value, const uint32_t& new_value) {
+            s_stack_cache = new_value;
+        });
+    }
+};
+
+static _StackCacheIniter s_stack_cache_initer;
+
 /**
  * @brief malloc栈内存分配器
  */
@@ -39,7 +63,62 @@ public:
     static void Dealloc(void *vp, size_t size) { return free(vp); }
 };
 
-using StackAllocator = MallocStackAllocator;
+/**
+ * @brief 带线程缓存的栈内存分配器
+ * @details 短命的协程(如停放的长连接收到数据后才创建的协程)频繁创建销毁，
+ *          默认128K的栈超过了malloc的mmap阈值，每次都是一对mmap/munmap，
+ *          这里把释放的栈留在线程缓存里给下一个协程用，只缓存同一大小的栈
+ */
+class CachedStackAllocator {
+public:
+    static void *Alloc(size_t size) {
+        if (t_cacheDestroyed) {
+            return MallocStackAllocator::Alloc(size);
+        }
+        StackCache& cache = t_cache;
+        if (size == cache.size && !cache.stacks.empty()) {
+            void *vp = cache.stacks.back();
+            cache.stacks.pop_back();
+            return vp;
+        }
+        return MallocStackAllocator::Alloc(size);
+    }
+
+    static void Dealloc(void *vp, size_t size) {
+        // 线程局部变量先于静态变量析构，之后释放的栈(如静态对象持有的协程)直接还给系统
+        if (t_cacheDestroyed) {
+            return MallocStackAllocator::Dealloc(vp, size);
+        }
+        StackCache& cache = t_cache;
+        if (cache.stacks.empty()) {
+            cache.size = size;
+        }
+        if (size == cache.size && cache.stacks.size() < s_stack_cache) {
+            cache.stacks.push_back(vp);
+            return;
+        }
+        MallocStackAllocator::Dealloc(vp, size);
+    }
+private:
+    struct StackCache {
+        ~StackCache() {
+            t_cacheDestroyed = true;
+            for (auto i : stacks) {
+                MallocStackAllocator::Dealloc(i, size);
+            }
+        }
+        size_t size = 0;
+        std::vector<void *> stacks;
+    };
+    static thread_local StackCache t_cache;
+    /// 本线程的缓存是否已经析构，平凡类型没有析构顺序问题
+    static thread_local bool t_cacheDestroyed;
+};
+
+thread_local CachedStackAllocator::StackCache CachedStackAllocator::t_cache;
+thread_local bool CachedStackAllocator::t_cacheDestroyed = false;
+
+using StackAllocator = CachedStackAllocator;
 
 uint64_t Fiber::GetFiberId() {
     if (t_fiber) {
@@ -48,6 +127,10 @@ uint64_t Fiber::GetFiberId() {
     return 0;
 }
 
+uint64_t Fiber::TotalFibers() {
+    return s_fiber_count;
+}
+
 Fiber::Fiber() {
     SetThis(this);
     m_state = RUNNING;
@@ -101,6 +184,7 @@ Fiber::Fiber(std::function<void()> cb, size_t stacksize, bool run_in_scheduler)
 
     makecontext(&m_ctx, &Fiber::MainFunc, 0);
 
+    SYLAR_PROBE2(fiber_create, m_id, m_stacksize);
     SYLAR_LOG_DEBUG(g_logger) << "Fiber::Fiber() id = " << m_id;
 }
 
@@ -133,7 +217,8 @@ Fiber::~Fiber() {
 void Fiber::reset(std::function<void()> cb) {
     SYLAR_ASSERT(m_stack);
     SYLAR_ASSERT(m_state == TERM);
-    m_cb = cb;
+    m_cb   = cb;
+    m_span = nullptr;
     if (getcontext(&m_ctx)) {
         SYLAR_ASSERT2(false, "getcontext");
     }
@@ -148,6 +233,8 @@ void Fiber::reset(std::function<void()> cb) {
 
 void Fiber::resume() {
     SYLAR_ASSERT(m_state != TERM && m_state != RUNNING);
+    SYLAR_PROBE1(fiber_resume, m_id);
+    FlightRecorder::Record(FlightRecorder::FIBER_RESUME, 0, m_id);
     SetThis(this);
     m_state = RUNNING;
 
@@ -161,14 +248,22 @@ void Fiber::resume() {
             SYLAR_ASSERT2(false, "swapcontext");
         }
     }
+
+    // yield之后回到这里，上下文已经保存，此时才能被其他线程resume
+    if (m_state == RUNNING) {
+        m_state = READY;
+    }
 }
 
 void Fiber::yield() {
     /// 协程运行完之后会自动yield一次，用于回到主协程，此时状态已为结束状态
     SYLAR_ASSERT(m_state == RUNNING || m_state == TERM);
     SetThis(t_thread_fiber.get());
+    // 状态保持RUNNING，直到swapcontext保存完上下文回到resume中才改为READY。
+    // 其他线程可能在yield之前就唤醒了该协程，调度器会跳过RUNNING状态的协程
     if (m_state != TERM) {
-        m_state = READY;
+        SYLAR_PROBE1(fiber_yield, m_id);
+        FlightRecorder::Record(FlightRecorder::FIBER_YIELD, 0, m_id);
     }
 
     // 如果协程参与调度器调度，那么应该和调度器的主协程进行swap，而不是线程主协程
@@ -193,6 +288,8 @@ void Fiber::MainFunc() {
     cur->m_cb();
     cur->m_cb    = nullptr;
     cur->m_state = TERM;
+    SYLAR_PROBE1(fiber_term, cur->m_id);
+    FlightRecorder::Record(FlightRecorder::FIBER_TERM, 0, cur->m_id);
 
     auto raw_ptr = cur.get(); // 手动让t_fiber的引用计数减1
     cur.reset();
@@ -16,6 +16,8 @@
 
 namespace sylar {
 
+class Span;
+
 /**
  * @brief 协程类
  */
@@ -88,6 +90,16 @@ public:
      */
     State getState() const { return m_state; }
 
+    /**
+     * @brief 获取协程当前的活动span
+     */
+    Span *getSpan() const { return m_span; }
+
+    /**
+     * @brief 设置协程当前的活动span
+     */
+    void setSpan(Span *span) { m_span = span; }
+
 public:
     /**
      * @brief 设置当前正在运行的协程，即设置线程局部变量t_fiber的值
@@ -133,6 +145,8 @@ private:
     std::function<void()> m_cb;
     /// 本协程是否参与调度器调度
     bool m_runInScheduler;
+    /// 协程当前的活动span，链路追踪上下文跟随协程而不是线程
+    Span *m_span = nullptr;
 };
 
 } // namespace sylar
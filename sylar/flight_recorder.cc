@@ -0,0 +1,363 @@
+/**
+ * @file flight_recorder.cc
+ * @brief 飞行记录器实现
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "flight_recorder.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "config.h"
+#include "fiber.h"
+#include "hook.h"
+#include "log.h"
+#include "macro.h"
+#include "thread.h"
+#include "util.h"
+
+namespace sylar {
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_NAME("system");
+
+static sylar::ConfigVar<bool>::ptr g_flight_enable =
+    sylar::Config::Lookup("flight_recorder.enable", true, "record scheduler/io/timer events in memory");
+
+static sylar::ConfigVar<uint32_t>::ptr g_flight_size =
+    sylar::Config::Lookup("flight_recorder.size", (uint32_t)4096, "events kept per thread");
+
+static sylar::ConfigVar<int>::ptr g_flight_signal =
+    sylar::Config::Lookup("flight_recorder.signal", 0, "signal that dumps the flight recorder, 0 for none");
+
+static sylar::ConfigVar<std::string>::ptr g_flight_dump_path =
+    sylar::Config::Lookup("flight_recorder.dump_path", std::string(""), "flight recorder dump file, empty for stderr");
+
+static sylar::ConfigVar<bool>::ptr g_flight_dump_on_assert =
+    sylar::Config::Lookup("flight_recorder.dump_on_assert", true, "dump the flight recorder when SYLAR_ASSERT fails");
+
+/**
+ * @brief 一个事件，32字节
+ */
+struct FlightEvent {
+    /// 时间戳(tick)
+    uint64_t ts;
+    /// 记录时的协程id
+    uint64_t fiber;
+    /// 参数
+    uint64_t arg;
+    /// 参数
+    int32_t value;
+    /// 事件类型
+    uint16_t type;
+    uint16_t pad;
+};
+
+/**
+ * @brief 一个线程的缓冲，分配后不释放，线程退出后留给新线程复用
+ */
+struct FlightRing {
+    FlightRing(size_t capacity) {
+        size = 1;
+        while(size < capacity) {
+            size <<= 1;
+        }
+        events = new FlightEvent[size];
+        memset(events, 0, sizeof(FlightEvent) * size);
+    }
+    /// 所属线程id，0表示空闲
+    std::atomic<int> tid = {0};
+    /// 最后一个使用者的线程id
+    int lastTid = 0;
+    /// 最后一个使用者的线程名称
+    char name[32] = {0};
+    /// 容量，2的幂
+    size_t size;
+    /// 已写入的事件数，只有所属线程修改
+    std::atomic<uint64_t> pos = {0};
+    /// 事件数组
+    FlightEvent* events;
+};
+
+/// 最多登记的缓冲数
+static const size_t s_max_rings = 256;
+static std::atomic<FlightRing*> s_rings[s_max_rings];
+static std::atomic<size_t> s_ring_count = {0};
+
+static std::atomic<bool> s_enabled = {true};
+static std::atomic<bool> s_dump_on_assert = {true};
+/// 导出路径，信号处理函数里不能访问std::string
+static char s_dump_path[256] = {0};
+
+/// 校准时间戳用的基准点
+static uint64_t s_base_ticks = 0;
+static uint64_t s_base_ns = 0;
+
+static uint64_t MonotonicNS() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static inline uint64_t Ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return MonotonicNS();
+#endif
+}
+
+/**
+ * @brief 线程退出时释放缓冲，事件保留到被复用
+ */
+struct FlightRingHolder {
+    ~FlightRingHolder() {
+        if(ring) {
+            ring->tid = 0;
+        }
+    }
+    FlightRing* ring = nullptr;
+    /// 缓冲已分配完，本线程不再记录
+    bool full = false;
+};
+
+static thread_local FlightRingHolder t_ring;
+
+static FlightRing* AcquireRing() {
+    int tid = GetThreadId();
+    size_t size = g_flight_size->getValue();
+    FlightRing* ring = nullptr;
+    size_t count = std::min(s_ring_count.load(), s_max_rings);
+    for(size_t i = 0; i < count; ++i) {
+        FlightRing* r = s_rings[i].load();
+        int expect = 0;
+        if(r && r->size >= size && r->tid.compare_exchange_strong(expect, tid)) {
+            ring = r;
+            ring->pos = 0;
+            break;
+        }
+    }
+    if(!ring) {
+        size_t idx = s_ring_count++;
+        if(idx >= s_max_rings) {
+            return nullptr;
+        }
+        ring = new FlightRing(size);
+        ring->tid = tid;
+        s_rings[idx] = ring;
+    }
+    ring->lastTid = tid;
+    strncpy(ring->name, Thread::GetName().c_str(), sizeof(ring->name) - 1);
+    return ring;
+}
+
+void FlightRecorder::Record(Type type, int32_t value, uint64_t arg) {
+    if(!s_enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    FlightRing* ring = t_ring.ring;
+    if(SYLAR_UNLIKELY(!ring)) {
+        if(t_ring.full) {
+            return;
+        }
+        ring = t_ring.ring = AcquireRing();
+        if(!ring) {
+            t_ring.full = true;
+            return;
+        }
+    }
+    uint64_t pos = ring->pos.load(std::memory_order_relaxed);
+    FlightEvent& e = ring->events[pos & (ring->size - 1)];
+    e.ts = Ticks();
+    e.fiber = Fiber::GetFiberId();
+    e.arg = arg;
+    e.value = value;
+    e.type = type;
+    ring->pos.store(pos + 1, std::memory_order_release);
+}
+
+const char* FlightRecorder::TypeToString(uint16_t type) {
+    static const char* s_names[] = {"unknown", "fiber_resume", "fiber_yield", "fiber_term"
+        , "sched_enqueue", "sched_dequeue", "io_add", "io_del", "io_trigger"
+        , "idle_wait", "idle_wake", "timer_fire", "http_start", "http_end"};
+    return type < TYPE_COUNT ? s_names[type] : s_names[0];
+}
+
+void FlightRecorder::DumpImpl(Writer writer, void* ctx, size_t last) {
+    char buf[256];
+    uint64_t now_ticks = Ticks();
+    uint64_t now_ns = MonotonicNS();
+    double ns_per_tick = 1;
+    if(now_ticks > s_base_ticks && now_ns > s_base_ns) {
+        ns_per_tick = (double)(now_ns - s_base_ns) / (now_ticks - s_base_ticks);
+    }
+    // 时间是相对导出时刻的微秒数
+    int n = snprintf(buf, sizeof(buf), "=== flight recorder pid=%d (time in us before dump) ===\n", getpid());
+    writer(ctx, buf, n);
+
+    size_t count = std::min(s_ring_count.load(), s_max_rings);
+    for(size_t i = 0; i < count; ++i) {
+        FlightRing* ring = s_rings[i].load();
+        if(!ring) {
+            continue;
+        }
+        uint64_t end = ring->pos.load(std::memory_order_acquire);
+        if(!end) {
+            continue;
+        }
+        uint64_t begin = end > ring->size ? end - ring->size : 0;
+        if(last && end - begin > last) {
+            begin = end - last;
+        }
+        n = snprintf(buf, sizeof(buf), "--- thread %d %s%s events=%llu ---\n"
+                , ring->lastTid, ring->name, ring->tid ? "" : " (exited)"
+                , (unsigned long long)(end - begin));
+        writer(ctx, buf, n);
+
+        // 所属线程可能还在写，分段复制后检查这一段是否已被覆盖
+        static const size_t s_chunk = 32;
+        FlightEvent chunk[s_chunk];
+        for(uint64_t p = begin; p < end; p += s_chunk) {
+            size_t len = std::min((uint64_t)s_chunk, end - p);
+            for(size_t j = 0; j < len; ++j) {
+                chunk[j] = ring->events[(p + j) & (ring->size - 1)];
+            }
+            uint64_t cur = ring->pos.load(std::memory_order_acquire);
+            uint64_t valid = cur > ring->size ? cur - ring->size : 0;
+            for(size_t j = 0; j < len; ++j) {
+                if(p + j < valid) {
+                    continue;
+                }
+                const FlightEvent& e = chunk[j];
+                double ago = now_ticks > e.ts ? (now_ticks - e.ts) * ns_per_tick / 1000 : 0;
+                n = snprintf(buf, sizeof(buf), "%14.3f fiber=%-6llu %-14s value=%d arg=%llu\n"
+                        , -ago, (unsigned long long)e.fiber, TypeToString(e.type)
+                        , e.value, (unsigned long long)e.arg);
+                writer(ctx, buf, n);
+            }
+        }
+    }
+}
+
+static void StringWriter(void* ctx, const char* buf, size_t len) {
+    ((std::string*)ctx)->append(buf, len);
+}
+
+static void FdWriter(void* ctx, const char* buf, size_t len) {
+    // 不走hook，信号处理函数里不能碰FdManager的锁
+    int fd = *(int*)ctx;
+    while(len > 0) {
+        ssize_t rt = write_f(fd, buf, len);
+        if(rt <= 0) {
+            if(rt < 0 && errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        buf += rt;
+        len -= rt;
+    }
+}
+
+std::string FlightRecorder::Dump(size_t last) {
+    std::string str;
+    DumpImpl(&StringWriter, &str, last);
+    return str;
+}
+
+void FlightRecorder::DumpToFd(int fd, size_t last) {
+    DumpImpl(&FdWriter, &fd, last);
+}
+
+void FlightRecorder::DumpToFile() {
+    if(!s_dump_path[0]) {
+        DumpToFd(STDERR_FILENO);
+        return;
+    }
+    int fd = open(s_dump_path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if(fd < 0) {
+        DumpToFd(STDERR_FILENO);
+        return;
+    }
+    DumpToFd(fd);
+    close_f(fd);
+}
+
+void FlightRecorder::OnAssert() {
+    static std::atomic<bool> s_dumped = {false};
+    // 只导出一次，导出过程中再次断言失败时不重入
+    if(!s_dump_on_assert || s_dumped.exchange(true)) {
+        return;
+    }
+    DumpToFile();
+}
+
+static void OnDumpSignal(int sig) {
+    int err = errno;
+    FlightRecorder::DumpToFile();
+    errno = err;
+}
+
+static void SetDumpSignal(int old_sig, int new_sig) {
+    if(old_sig > 0) {
+        signal(old_sig, SIG_DFL);
+    }
+    if(new_sig > 0) {
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = &OnDumpSignal;
+        sa.sa_flags = SA_RESTART;
+        sigemptyset(&sa.sa_mask);
+        if(sigaction(new_sig, &sa, nullptr)) {
+            SYLAR_LOG_ERROR(g_logger) << "flight recorder sigaction(" << new_sig
+                << ") fail errno=" << errno << " errstr=" << strerror(errno);
+        }
+    }
+}
+
+static void SetDumpPath(const std::string& path) {
+    // 先清空再写入，信号处理函数最多读到一个空路径
+    s_dump_path[0] = '\0';
+    if(path.size() < sizeof(s_dump_path)) {
+        memcpy(s_dump_path + 1, path.c_str() + 1, path.size());
+        s_dump_path[0] = path.empty() ? '\0' : path[0];
+    } else {
+        SYLAR_LOG_ERROR(g_logger) << "flight recorder dump path too long: " << path;
+    }
+}
+
+struct FlightRecorderIniter {
+    FlightRecorderIniter() {
+        s_base_ticks = Ticks();
+        s_base_ns = MonotonicNS();
+        s_enabled = g_flight_enable->getValue();
+        s_dump_on_assert = g_flight_dump_on_assert->getValue();
+        SetDumpPath(g_flight_dump_path->getValue());
+        SetDumpSignal(0, g_flight_signal->getValue());
+
+        g_flight_enable->addListener([](const bool& old_value, const bool& new_value) {
+            s_enabled = new_value;
+        });
+        g_flight_dump_on_assert->addListener([](const bool& old_value, const bool& new_value) {
+            s_dump_on_assert = new_value;
+        });
+        g_flight_dump_path->addListener([](const std::string& old_value, const std::string& new_value) {
+            SetDumpPath(new_value);
+        });
+        g_flight_signal->addListener([](const int& old_value, const int& new_value) {
+            SetDumpSignal(old_value, new_value);
+        });
+    }
+};
+
+static FlightRecorderIniter __flight_recorder_init;
+
+}
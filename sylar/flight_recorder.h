@@ -0,0 +1,103 @@
+/**
+ * @file flight_recorder.h
+ * @brief 飞行记录器，在内存里保留每个线程最近的调度、IO和定时器事件
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#ifndef __SYLAR_FLIGHT_RECORDER_H__
+#define __SYLAR_FLIGHT_RECORDER_H__
+
+#include <stdint.h>
+#include <string>
+
+namespace sylar {
+
+/**
+ * @brief 飞行记录器
+ * @details 每个线程一个定长的环形缓冲，写满后覆盖最旧的事件。记录一次事件只有一次时间戳读取(x86上是rdtsc)
+ *          和32字节的写入，不加锁，可以在生产环境常开。
+ *          出问题之后通过 /_/flight 管理接口、配置的信号(flight_recorder.signal)或断言失败时导出，
+ *          看到出问题前每个线程最后做了什么，不需要事先打开调试日志。
+ *          线程退出后缓冲保留到被新线程复用，退出前的事件仍可导出
+ */
+class FlightRecorder {
+public:
+    /**
+     * @brief 事件类型，value和arg的含义见各类型说明
+     */
+    enum Type {
+        /// 切入协程，arg为协程id
+        FIBER_RESUME = 1,
+        /// 协程让出执行权，arg为协程id
+        FIBER_YIELD,
+        /// 协程函数执行完，arg为协程id
+        FIBER_TERM,
+        /// 任务入队，value为入队前的队列长度，arg为任务序号
+        SCHED_ENQUEUE,
+        /// 调度线程取出任务，arg为任务序号
+        SCHED_DEQUEUE,
+        /// 注册IO事件，value为fd，arg为事件(1读 4写)
+        IO_ADD,
+        /// 删除IO事件，value为fd，arg为事件
+        IO_DEL,
+        /// IO事件就绪或被取消，value为fd，arg为事件
+        IO_TRIGGER,
+        /// 进入epoll_wait，value为超时时间(毫秒)
+        IDLE_WAIT,
+        /// epoll_wait返回，value为就绪事件数
+        IDLE_WAKE,
+        /// 定时器到期，value为晚了多少毫秒，arg为定时器周期(毫秒)
+        TIMER_FIRE,
+        /// 收到HTTP请求头，value为fd
+        HTTP_START,
+        /// HTTP响应发送完，value为fd，arg为状态码
+        HTTP_END,
+        /// 类型数量
+        TYPE_COUNT
+    };
+
+    /**
+     * @brief 输出回调，导出时逐段调用，不能分配内存
+     */
+    typedef void (*Writer)(void* ctx, const char* buf, size_t len);
+
+    /**
+     * @brief 在当前线程的缓冲里记录一个事件，同时记录当前协程id
+     */
+    static void Record(Type type, int32_t value, uint64_t arg);
+
+    /**
+     * @brief 导出所有线程的事件，每个线程按时间先后
+     * @param[in] last 每个线程最多输出最近的多少个事件，0表示全部
+     */
+    static std::string Dump(size_t last = 0);
+
+    /**
+     * @brief 导出到文件描述符，不分配内存，可以在信号处理函数里调用
+     */
+    static void DumpToFd(int fd, size_t last = 0);
+
+    /**
+     * @brief 按配置flight_recorder.dump_path导出，为空时写到标准错误
+     */
+    static void DumpToFile();
+
+    /**
+     * @brief 断言失败时调用，按配置flight_recorder.dump_on_assert决定是否导出
+     */
+    static void OnAssert();
+
+    /**
+     * @brief 返回事件类型名称
+     */
+    static const char* TypeToString(uint16_t type);
+private:
+    /**
+     * @brief 导出实现
+     */
+    static void DumpImpl(Writer writer, void* ctx, size_t last);
+};
+
+}
+
+#endif
@@ -0,0 +1,142 @@
+/**
+ * @file hdr_histogram.cc
+ * @brief HDR风格直方图实现
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "hdr_histogram.h"
+#include <math.h>
+#include <algorithm>
+#include <sstream>
+
+namespace sylar {
+
+static std::atomic<size_t> s_next_stripe = {0};
+
+size_t HdrHistogram::BucketIndex(uint64_t v, uint32_t precision) {
+    if(v < (1ull << precision)) {
+        return v;
+    }
+    uint32_t msb = 63 - __builtin_clzll(v);
+    uint32_t shift = msb - precision + 1;
+    return ((size_t)shift << (precision - 1)) + (v >> shift);
+}
+
+uint64_t HdrHistogram::BucketLow(size_t idx, uint32_t precision) {
+    if(idx < (1ull << precision)) {
+        return idx;
+    }
+    size_t shift = (idx >> (precision - 1)) - 1;
+    uint64_t m = idx - (shift << (precision - 1));
+    return m << shift;
+}
+
+uint64_t HdrHistogram::BucketHigh(size_t idx, uint32_t precision) {
+    if(idx < (1ull << precision)) {
+        return idx;
+    }
+    size_t shift = (idx >> (precision - 1)) - 1;
+    uint64_t m = idx - (shift << (precision - 1));
+    return ((m + 1) << shift) - 1;
+}
+
+HdrHistogram::HdrHistogram(uint64_t max_value, uint32_t precision, size_t stripes)
+    :m_maxValue(std::max(max_value, (uint64_t)1))
+    ,m_precision(std::min(std::max(precision, 2u), 16u))
+    ,m_stripeCount(stripes ? stripes : 8) {
+    m_buckets = BucketIndex(m_maxValue, m_precision) + 1;
+    m_stripes.reset(new Stripe[m_stripeCount]);
+}
+
+HdrHistogram::~HdrHistogram() {
+    for(size_t i = 0; i < m_stripeCount; ++i) {
+        delete[] m_stripes[i].counts.load();
+    }
+}
+
+HdrHistogram::Stripe& HdrHistogram::getStripe() {
+    static thread_local size_t t_stripe = s_next_stripe++;
+    Stripe& s = m_stripes[t_stripe % m_stripeCount];
+    if(!s.counts.load(std::memory_order_acquire)) {
+        std::atomic<uint64_t>* counts = new std::atomic<uint64_t>[m_buckets];
+        for(size_t i = 0; i < m_buckets; ++i) {
+            counts[i] = 0;
+        }
+        std::atomic<uint64_t>* expect = nullptr;
+        if(!s.counts.compare_exchange_strong(expect, counts)) {
+            delete[] counts;
+        }
+    }
+    return s;
+}
+
+void HdrHistogram::record(uint64_t v, uint64_t count) {
+    Stripe& s = getStripe();
+    size_t idx = BucketIndex(std::min(v, m_maxValue), m_precision);
+    s.counts.load(std::memory_order_relaxed)[idx].fetch_add(count, std::memory_order_relaxed);
+    s.count.fetch_add(count, std::memory_order_relaxed);
+    s.sum.fetch_add(v * count, std::memory_order_relaxed);
+    // 最值稳定之后基本不会进入CAS
+    uint64_t cur = s.max.load(std::memory_order_relaxed);
+    while(v > cur && !s.max.compare_exchange_weak(cur, v, std::memory_order_relaxed));
+    cur = s.min.load(std::memory_order_relaxed);
+    while(v < cur && !s.min.compare_exchange_weak(cur, v, std::memory_order_relaxed));
+}
+
+HdrSnapshot HdrHistogram::snapshot() const {
+    HdrSnapshot snap;
+    snap.m_precision = m_precision;
+    snap.m_counts.resize(m_buckets, 0);
+    snap.m_min = UINT64_MAX;
+    for(size_t i = 0; i < m_stripeCount; ++i) {
+        const Stripe& s = m_stripes[i];
+        std::atomic<uint64_t>* counts = s.counts.load(std::memory_order_acquire);
+        if(!counts) {
+            continue;
+        }
+        // 计数从桶里重新累加，保证和各桶之和一致
+        for(size_t j = 0; j < m_buckets; ++j) {
+            uint64_t c = counts[j].load(std::memory_order_relaxed);
+            snap.m_counts[j] += c;
+            snap.m_count += c;
+        }
+        snap.m_sum += s.sum.load(std::memory_order_relaxed);
+        snap.m_min = std::min(snap.m_min, s.min.load(std::memory_order_relaxed));
+        snap.m_max = std::max(snap.m_max, s.max.load(std::memory_order_relaxed));
+    }
+    return snap;
+}
+
+uint64_t HdrSnapshot::percentile(double q) const {
+    if(!m_count) {
+        return 0;
+    }
+    if(q <= 0) {
+        return getMin();
+    }
+    uint64_t target = (uint64_t)ceil(std::min(q, 100.0) / 100 * m_count);
+    target = std::max(target, (uint64_t)1);
+    uint64_t total = 0;
+    for(size_t i = 0; i < m_counts.size(); ++i) {
+        total += m_counts[i];
+        if(total >= target) {
+            return std::min(HdrHistogram::BucketHigh(i, m_precision), m_max);
+        }
+    }
+    return m_max;
+}
+
+std::string HdrSnapshot::toString() const {
+    std::stringstream ss;
+    ss << "count=" << m_count
+       << " mean=" << getMean()
+       << " min=" << getMin()
+       << " p50=" << percentile(50)
+       << " p90=" << percentile(90)
+       << " p99=" << percentile(99)
+       << " p999=" << percentile(99.9)
+       << " max=" << m_max;
+    return ss.str();
+}
+
+}
@@ -0,0 +1,175 @@
+/**
+ * @file hdr_histogram.h
+ * @brief HDR风格的直方图，按线程分段记录，读取时合并
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#ifndef __SYLAR_HDR_HISTOGRAM_H__
+#define __SYLAR_HDR_HISTOGRAM_H__
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sylar {
+
+/**
+ * @brief 直方图某一时刻的合并结果
+ */
+class HdrSnapshot {
+friend class HdrHistogram;
+public:
+    /**
+     * @brief 记录次数
+     */
+    uint64_t getCount() const { return m_count;}
+
+    /**
+     * @brief 记录值之和
+     */
+    uint64_t getSum() const { return m_sum;}
+
+    /**
+     * @brief 最小值，没有记录时为0
+     */
+    uint64_t getMin() const { return m_count ? m_min : 0;}
+
+    /**
+     * @brief 最大值
+     */
+    uint64_t getMax() const { return m_max;}
+
+    /**
+     * @brief 平均值
+     */
+    double getMean() const { return m_count ? (double)m_sum / m_count : 0;}
+
+    /**
+     * @brief 百分位数
+     * @param[in] q 百分位，[0, 100]，如99.9
+     * @return 落在该百分位的桶的上界(不超过最大值)，误差不超过桶宽
+     */
+    uint64_t percentile(double q) const;
+
+    /**
+     * @brief 各桶的计数
+     */
+    const std::vector<uint64_t>& getCounts() const { return m_counts;}
+
+    /**
+     * @brief 输出 count/mean/min/p50/p90/p99/p999/max
+     */
+    std::string toString() const;
+private:
+    /// 精度位数
+    uint32_t m_precision = 0;
+    /// 各桶的计数
+    std::vector<uint64_t> m_counts;
+    /// 记录次数
+    uint64_t m_count = 0;
+    /// 记录值之和
+    uint64_t m_sum = 0;
+    /// 最小值
+    uint64_t m_min = 0;
+    /// 最大值
+    uint64_t m_max = 0;
+};
+
+/**
+ * @brief HDR风格的直方图
+ * @details 值按对数-线性分桶：小于2^precision的值每个值一个桶，更大的值在每个2的幂区间内再等分
+ *          2^(precision-1)个桶，相对误差不超过 1/2^(precision-1)。
+ *          每个线程按槽位写入自己的分段，只有一次无竞争的原子加；读取时把各分段合并成HdrSnapshot。
+ *          分段在第一次写入时才分配
+ */
+class HdrHistogram {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<HdrHistogram> ptr;
+
+    /**
+     * @brief 构造函数
+     * @param[in] max_value 可区分的最大值，更大的值计入最后一个桶，最大值仍如实记录
+     * @param[in] precision 精度位数，[2, 16]，默认5位即相对误差约6%
+     * @param[in] stripes 分段数，0表示默认8段
+     */
+    HdrHistogram(uint64_t max_value = 1ull << 36, uint32_t precision = 5, size_t stripes = 0);
+
+    ~HdrHistogram();
+
+    /**
+     * @brief 记录一个值
+     * @param[in] count 次数
+     */
+    void record(uint64_t v, uint64_t count = 1);
+
+    /**
+     * @brief 合并各分段，返回快照
+     */
+    HdrSnapshot snapshot() const;
+
+    /**
+     * @brief 返回桶数
+     */
+    size_t getBucketCount() const { return m_buckets;}
+
+    /**
+     * @brief 返回精度位数
+     */
+    uint32_t getPrecision() const { return m_precision;}
+
+    /**
+     * @brief 返回值所在的桶
+     */
+    static size_t BucketIndex(uint64_t v, uint32_t precision);
+
+    /**
+     * @brief 返回桶的下界
+     */
+    static uint64_t BucketLow(size_t idx, uint32_t precision);
+
+    /**
+     * @brief 返回桶的上界(包含)
+     */
+    static uint64_t BucketHigh(size_t idx, uint32_t precision);
+private:
+    /**
+     * @brief 一个分段
+     */
+    struct Stripe {
+        /// 各桶计数，第一次写入时分配
+        std::atomic<std::atomic<uint64_t>*> counts = {nullptr};
+        /// 记录次数
+        std::atomic<uint64_t> count = {0};
+        /// 记录值之和
+        std::atomic<uint64_t> sum = {0};
+        /// 最小值
+        std::atomic<uint64_t> min = {UINT64_MAX};
+        /// 最大值
+        std::atomic<uint64_t> max = {0};
+        /// 避免不同分段共享缓存行
+        char pad[24];
+    };
+
+    /**
+     * @brief 返回当前线程使用的分段，第一次写入时分配桶
+     */
+    Stripe& getStripe();
+private:
+    /// 可区分的最大值
+    uint64_t m_maxValue;
+    /// 精度位数
+    uint32_t m_precision;
+    /// 桶数
+    size_t m_buckets;
+    /// 分段数
+    size_t m_stripeCount;
+    /// 各分段
+    std::unique_ptr<Stripe[]> m_stripes;
+};
+
+}
+
+#endif
@@ -5,6 +5,7 @@
  * @date 2021-09-24
  */
 #include "http.h"
+#include "multipart.h"
 #include "sylar/util.h"
 
 namespace sylar {
@@ -237,6 +238,26 @@ void HttpRequest::initBodyParam() {
         return;
     }
     std::string content_type = getHeader("content-type");
+    std::string boundary = MultipartParser::GetBoundary(content_type);
+    if (!boundary.empty()) {
+        // 只取普通字段，上传的文件需要流式servlet用MultipartParser自行处理
+        MultipartParser parser(boundary);
+        std::string* value = nullptr;
+        parser.setOnPartBegin([this, &value](const MultipartParser::Part& part) {
+            value = part.isFile() || part.name.empty() ? nullptr
+                        : &(m_params[part.name] = "");
+            return true;
+        });
+        parser.setOnPartData([&value](const char* data, size_t len) {
+            if (value) {
+                value->append(data, len);
+            }
+            return true;
+        });
+        parser.execute(m_body.c_str(), m_body.size());
+        m_parserParamFlag |= 0x2;
+        return;
+    }
     if (strcasestr(content_type.c_str(), "application/x-www-form-urlencoded") == nullptr) {
         m_parserParamFlag |= 0x2;
         return;
@@ -273,7 +294,8 @@ HttpResponse::HttpResponse(uint8_t version, bool close)
     : m_status(HttpStatus::OK)
     , m_version(version)
     , m_close(close)
-    , m_websocket(false) {
+    , m_websocket(false)
+    , m_streamBody(false) {
 }
 
 std::string HttpResponse::getHeader(const std::string &key, const std::string &def) const {
@@ -347,6 +369,16 @@ std::ostream &HttpResponse::dump(std::ostream &os) const {
         os << "content-length: " << m_body.size() << "\r\n\r\n"
            << m_body;
     } else {
+        // 空消息体也要写明长度，否则客户端只能读到连接关闭才认为响应结束。
+        // HTTP/1.0的close响应本来就以关闭连接结束消息体，调用方可能随后自己写出
+        uint32_t status = (uint32_t)m_status;
+        bool close_delimited = m_close && m_version < 0x11;
+        if (!m_websocket && !m_streamBody && !close_delimited
+                && status >= 200 && status != 204 && status != 304
+                && !m_headers.count("content-length")
+                && !m_headers.count("transfer-encoding")) {
+            os << "content-length: 0\r\n";
+        }
         os << "\r\n";
     }
     return os;
@@ -223,6 +223,11 @@ public:
      */
     void setBody(const std::string& v) { m_body = v;}
 
+    /**
+     * @brief 设置请求消息体，接管v的内存，如JsonWriter写好的字符串
+     */
+    void setBody(std::string&& v) { m_body = std::move(v);}
+
     /**
      * @brief 追加HTTP请求的消息体
      * @param[in] v 追加内容
@@ -455,7 +460,8 @@ public:
     void initQueryParam();
 
     /**
-     * @brief 当content-type是application/x-www-form-urlencoded时，提取消息体中的表单参数
+     * @brief 当content-type是application/x-www-form-urlencoded或multipart/form-data时，提取消息体中的表单参数
+     * @details multipart中上传的文件不作为参数
      */
     void initBodyParam();
 
@@ -562,6 +568,11 @@ public:
      */
     void setBody(const std::string& v) { m_body = v;}
 
+    /**
+     * @brief 设置响应消息体，接管v的内存，如JsonWriter写好的字符串
+     */
+    void setBody(std::string&& v) { m_body = std::move(v);}
+
     /**
      * @brief 追加HTTP请求的消息体
      * @param[in] v 追加内容
@@ -600,6 +611,18 @@ public:
      */
     void setWebsocket(bool v) { m_websocket = v;}
 
+    /**
+     * @brief 消息体是否由调用方在响应头之后自行写出
+     */
+    bool isStreamBody() const { return m_streamBody;}
+
+    /**
+     * @brief 设置消息体由调用方在响应头之后自行写出(或是HEAD响应)
+     * @details 没有Content-Length和Transfer-Encoding时dump不再补content-length: 0，
+     *          如以关闭连接结束的消息体、照搬上游头部的HEAD响应
+     */
+    void setStreamBody(bool v) { m_streamBody = v;}
+
     /**
      * @brief 获取响应头部参数
      * @param[in] key 关键字
@@ -685,6 +708,8 @@ private:
     bool m_close;
     /// 是否为websocket
     bool m_websocket;
+    /// 消息体是否由调用方自行写出
+    bool m_streamBody;
     /// 响应消息体
     std::string m_body;
     /// 响应原因
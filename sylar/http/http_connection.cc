@@ -6,14 +6,44 @@
  */
 
 #include "http_connection.h"
+#include <sys/socket.h>
+#include <algorithm>
 #include "http_parser.h"
+#include "../config.h"
 #include "../log.h"
+#include "../trace.h"
 
 namespace sylar {
 namespace http {
 
 static sylar::Logger::ptr g_logger = SYLAR_LOG_NAME("system");
 
+static sylar::ConfigVar<uint64_t>::ptr g_hedge_delay =
+    sylar::Config::Lookup("http.client.hedge_delay_ms", (uint64_t)0
+            , "delay before a hedged request is sent, 0 means the tracked latency percentile");
+
+static sylar::ConfigVar<double>::ptr g_hedge_percentile =
+    sylar::Config::Lookup("http.client.hedge_percentile", 95.0
+            , "upstream latency percentile used as hedge delay");
+
+static sylar::ConfigVar<double>::ptr g_hedge_budget =
+    sylar::Config::Lookup("http.client.hedge_budget", 0.05
+            , "max ratio of hedged and retried requests to all hedgeable requests");
+
+/// 按耗时分位数对冲时至少需要的样本数
+static const uint64_t s_hedge_min_samples = 20;
+/// 对冲延迟的重新计算间隔(毫秒)
+static const uint64_t s_hedge_delay_refresh = 1000;
+/// 最多积累的对冲额度(次)
+static const int64_t s_hedge_max_credits = 10;
+
+/**
+ * @brief 客户端span的状态：收到响应时为状态码，否则为负的HttpResult错误码
+ */
+static int32_t TraceStatus(HttpResult::ptr result) {
+    return result->response ? (int32_t)result->response->getStatus() : -result->result;
+}
+
 std::string HttpResult::toString() const {
     std::stringstream ss;
     ss << "[HttpResult result=" << result
@@ -24,7 +54,8 @@ std::string HttpResult::toString() const {
 }
 
 HttpConnection::HttpConnection(Socket::ptr sock, bool owner)
-    :SocketStream(sock, owner) {
+    :SocketStream(sock, owner)
+    ,m_reader(this) {
 }
 
 HttpConnection::~HttpConnection() {
@@ -32,109 +63,28 @@ HttpConnection::~HttpConnection() {
 }
 
 HttpResponse::ptr HttpConnection::recvResponse() {
-    HttpResponseParser::ptr parser(new HttpResponseParser);
-    uint64_t buff_size = HttpRequestParser::GetHttpRequestBufferSize();
-    std::shared_ptr<char> buffer(
-            new char[buff_size + 1], [](char* ptr){
-                delete[] ptr;
-            });
-    char* data = buffer.get();
-    int offset = 0;
-    do {
-        int len = read(data + offset, buff_size - offset);
-        if(len <= 0) {
-            close();
-            return nullptr;
-        }
-        len += offset;
-        data[len] = '\0';
-        size_t nparse = parser->execute(data, len);
-        if(parser->hasError()) {
-            close();
-            return nullptr;
-        }
-        offset = len - nparse;
-        if(offset == (int)buff_size) {
-            close();
-            return nullptr;
-        }
-        if(parser->isFinished()) {
-            break;
-        }
-    } while(true);
-    // auto& client_parser = parser->getParser();
-    // if(client_parser.chunked) {
-    //     std::string body;
-    //     int len = offset;
-    //     do {
-    //         do {
-    //             int rt = read(data + len, buff_size - len);
-    //             if(rt <= 0) {
-    //                 close();
-    //                 return nullptr;
-    //             }
-    //             len += rt;
-    //             data[len] = '\0';
-    //             size_t nparse = parser->execute(data, len, true);
-    //             if(parser->hasError()) {
-    //                 close();
-    //                 return nullptr;
-    //             }
-    //             len -= nparse;
-    //             if(len == (int)buff_size) {
-    //                 close();
-    //                 return nullptr;
-    //             }
-    //         } while(!parser->isFinished());
-    //         len -= 2;
-            
-    //         SYLAR_LOG_INFO(g_logger) << "content_len=" << client_parser.content_len;
-    //         if(client_parser.content_len <= len) {
-    //             body.append(data, client_parser.content_len);
-    //             memmove(data, data + client_parser.content_len
-    //                     , len - client_parser.content_len);
-    //             len -= client_parser.content_len;
-    //         } else {
-    //             body.append(data, len);
-    //             int left = client_parser.content_len - len;
-    //             while(left > 0) {
-    //                 int rt = read(data, left > (int)buff_size ? (int)buff_size : left);
-    //                 if(rt <= 0) {
-    //                     close();
-    //                     return nullptr;
-    //                 }
-    //                 body.append(data, rt);
-    //                 left -= rt;
-    //             }
-    //             len = 0;
-    //         }
-    //     } while(!client_parser.chunks_done);
-    //     parser->getData()->setBody(body);
-    // } else {
-    //     int64_t length = parser->getContentLength();
-    //     if(length > 0) {
-    //         std::string body;
-    //         body.resize(length);
-
-    //         int len = 0;
-    //         if(length >= offset) {
-    //             memcpy(&body[0], data, offset);
-    //             len = offset;
-    //         } else {
-    //             memcpy(&body[0], data, length);
-    //             len = length;
-    //         }
-    //         length -= offset;
-    //         if(length > 0) {
-    //             if(readFixSize(&body[len], length) <= 0) {
-    //                 close();
-    //                 return nullptr;
-    //             }
-    //         }
-    //         parser->getData()->setBody(body);
-    //     }
-    // }
-    return parser->getData();
+    HttpResponse::ptr rsp = recvResponseHeader();
+    if(!rsp) {
+        return nullptr;
+    }
+    std::string body;
+    if(!m_reader.recvBody(body, HttpResponseParser::GetHttpResponseMaxBodySize())) {
+        close();
+        return nullptr;
+    }
+    if(!body.empty()) {
+        rsp->setBody(body);
+    }
+    return rsp;
+}
+
+HttpResponse::ptr HttpConnection::recvResponseHeader() {
+    HttpResponse::ptr rsp = m_reader.recvHeader(HttpResponseParser::GetHttpResponseBufferSize());
+    if(!rsp) {
+        close();
+        return nullptr;
+    }
+    return rsp;
 }
 
 int HttpConnection::sendRequest(HttpRequest::ptr rsp) {
@@ -230,23 +180,43 @@ HttpResult::ptr HttpConnection::DoRequest(HttpMethod method
 HttpResult::ptr HttpConnection::DoRequest(HttpRequest::ptr req
                             , Uri::ptr uri
                             , uint64_t timeout_ms) {
+    Span span(std::string(HttpMethodToString(req->getMethod())) + " "
+                + uri->getHost() + req->getPath(), Span::CLIENT);
+    req->setHeader("traceparent", span.getContext().toTraceparent());
+    auto result = DoRequestImpl(req, uri, timeout_ms);
+    span.setStatus(TraceStatus(result));
+    return result;
+}
+
+HttpResult::ptr HttpConnection::DoRequestImpl(HttpRequest::ptr req
+                            , Uri::ptr uri
+                            , uint64_t timeout_ms) {
     Address::ptr addr = uri->createAddress();
     if(!addr) {
         return std::make_shared<HttpResult>((int)HttpResult::Error::INVALID_HOST
                 , nullptr, "invalid host: " + uri->getHost());
     }
-    Socket::ptr sock = Socket::CreateTCP(addr);
+    bool is_ssl = uri->getScheme() == "https";
+    Socket::ptr sock;
+    if(is_ssl) {
+        SSLSocket::ptr ssl_sock = SSLSocket::CreateTCP(addr);
+        ssl_sock->setHostName(uri->getHost());
+        sock = ssl_sock;
+    } else {
+        sock = Socket::CreateTCP(addr);
+    }
     if(!sock) {
         return std::make_shared<HttpResult>((int)HttpResult::Error::CREATE_SOCKET_ERROR
                 , nullptr, "create socket fail: " + addr->toString()
                         + " errno=" + std::to_string(errno)
                         + " errstr=" + std::string(strerror(errno)));
     }
+    // TLS握手也受超时时间约束
+    sock->setRecvTimeout(timeout_ms);
     if(!sock->connect(addr)) {
         return std::make_shared<HttpResult>((int)HttpResult::Error::CONNECT_FAIL
                 , nullptr, "connect fail: " + addr->toString());
     }
-    sock->setRecvTimeout(timeout_ms);
     HttpConnection::ptr conn = std::make_shared<HttpConnection>(sock);
     int rt = conn->sendRequest(req);
     if(rt == 0) {
@@ -273,13 +243,42 @@ HttpConnectionPool::HttpConnectionPool(const std::string& host
                                         ,uint32_t port
                                         ,uint32_t max_size
                                         ,uint32_t max_alive_time
-                                        ,uint32_t max_request)
+                                        ,uint32_t max_request
+                                        ,bool is_https)
     :m_host(host)
     ,m_vhost(vhost)
-    ,m_port(port)
+    ,m_port(port ? port : (is_https ? 443 : 80))
     ,m_maxSize(max_size)
     ,m_maxAliveTime(max_alive_time)
-    ,m_maxRequest(max_request) {
+    ,m_maxRequest(max_request)
+    ,m_isHttps(is_https)
+    ,m_hedgeDelayConf(g_hedge_delay->getValue())
+    ,m_hedgePercentile(g_hedge_percentile->getValue())
+    ,m_hedgeBudget(g_hedge_budget->getValue()) {
+    std::string name = m_host + ":" + std::to_string(m_port);
+    m_stats = std::make_shared<SocketStatsGroup>("upstream", name);
+    m_breaker = std::make_shared<CircuitBreaker>(name);
+    auto mgr = sylar::MetricsMgr::GetInstance();
+    MetricsRegistry::Labels labels = {{"name", name}};
+    m_hedges = mgr->counter("sylar_http_client_hedges_total"
+                    , "hedged and retried requests sent", labels);
+    m_hedgeWins = mgr->counter("sylar_http_client_hedge_wins_total"
+                    , "hedged requests that answered first", labels);
+}
+
+HttpConnectionPool::ptr HttpConnectionPool::Create(const std::string& uri
+                                                   ,const std::string& vhost
+                                                   ,uint32_t max_size
+                                                   ,uint32_t max_alive_time
+                                                   ,uint32_t max_request) {
+    Uri::ptr turi = Uri::Create(uri);
+    if(!turi) {
+        SYLAR_LOG_ERROR(g_logger) << "invalid uri=" << uri;
+        return nullptr;
+    }
+    return std::make_shared<HttpConnectionPool>(turi->getHost()
+            , vhost, turi->getPort(), max_size, max_alive_time, max_request
+            , turi->getScheme() == "https");
 }
 
 HttpConnection::ptr HttpConnectionPool::getConnection() {
@@ -314,7 +313,14 @@ HttpConnection::ptr HttpConnectionPool::getConnection() {
             return nullptr;
         }
         addr->setPort(m_port);
-        Socket::ptr sock = Socket::CreateTCP(addr);
+        Socket::ptr sock;
+        if(m_isHttps) {
+            SSLSocket::ptr ssl_sock = SSLSocket::CreateTCP(addr);
+            ssl_sock->setHostName(m_vhost.empty() ? m_host : m_vhost);
+            sock = ssl_sock;
+        } else {
+            sock = Socket::CreateTCP(addr);
+        }
         if(!sock) {
             SYLAR_LOG_ERROR(g_logger) << "create sock fail: " << *addr;
             return nullptr;
@@ -324,6 +330,7 @@ HttpConnection::ptr HttpConnectionPool::getConnection() {
             return nullptr;
         }
 
+        m_stats->add(sock);
         ptr = new HttpConnection(sock);
         ++m_total;
     }
@@ -332,9 +339,26 @@ HttpConnection::ptr HttpConnectionPool::getConnection() {
 
 }
 
+void HttpConnectionPool::close() {
+    std::list<HttpConnection*> conns;
+    {
+        MutexType::Lock lock(m_mutex);
+        m_closed = true;
+        conns.swap(m_conns);
+    }
+    for(auto i : conns) {
+        delete i;
+    }
+    m_total -= conns.size();
+}
+
 void HttpConnectionPool::ReleasePtr(HttpConnection* ptr, HttpConnectionPool* pool) {
     ++ptr->m_request;
+    pool->m_stats->tick(sylar::GetCurrentMS());
+    // 响应没有读完或者多读到了数据的连接无法复用
     if(!ptr->isConnected()
+            || !ptr->m_reader.isBodyFinished()
+            || ptr->m_reader.hasBuffered()
             || ((ptr->m_createTime + pool->m_maxAliveTime) >= sylar::GetCurrentMS())
             || (ptr->m_request >= pool->m_maxRequest)) {
         delete ptr;
@@ -342,6 +366,12 @@ void HttpConnectionPool::ReleasePtr(HttpConnection* ptr, HttpConnectionPool* poo
         return;
     }
     MutexType::Lock lock(pool->m_mutex);
+    if(pool->m_closed) {
+        lock.unlock();
+        delete ptr;
+        --pool->m_total;
+        return;
+    }
     pool->m_conns.push_back(ptr);
 }
 
@@ -385,9 +415,8 @@ HttpResult::ptr HttpConnectionPool::doPost(Uri::ptr uri
     return doPost(ss.str(), timeout_ms, headers, body);
 }
 
-HttpResult::ptr HttpConnectionPool::doRequest(HttpMethod method
+HttpRequest::ptr HttpConnectionPool::makeRequest(HttpMethod method
                                     , const std::string& url
-                                    , uint64_t timeout_ms
                                     , const std::map<std::string, std::string>& headers
                                     , const std::string& body) {
     HttpRequest::ptr req = std::make_shared<HttpRequest>();
@@ -417,7 +446,15 @@ HttpResult::ptr HttpConnectionPool::doRequest(HttpMethod method
         }
     }
     req->setBody(body);
-    return doRequest(req, timeout_ms);
+    return req;
+}
+
+HttpResult::ptr HttpConnectionPool::doRequest(HttpMethod method
+                                    , const std::string& url
+                                    , uint64_t timeout_ms
+                                    , const std::map<std::string, std::string>& headers
+                                    , const std::string& body) {
+    return doRequest(makeRequest(method, url, headers, body), timeout_ms);
 }
 
 HttpResult::ptr HttpConnectionPool::doRequest(HttpMethod method
@@ -436,11 +473,40 @@ HttpResult::ptr HttpConnectionPool::doRequest(HttpMethod method
 
 HttpResult::ptr HttpConnectionPool::doRequest(HttpRequest::ptr req
                                         , uint64_t timeout_ms) {
+    Span span(std::string(HttpMethodToString(req->getMethod())) + " "
+                + m_host + req->getPath(), Span::CLIENT);
+    req->setHeader("traceparent", span.getContext().toTraceparent());
+    HttpResult::ptr result;
+    if(!m_breaker->allow()) {
+        result = std::make_shared<HttpResult>((int)HttpResult::Error::CIRCUIT_OPEN
+                , nullptr, "circuit open host:" + m_host + " port:" + std::to_string(m_port));
+    } else {
+        uint64_t start = sylar::GetCurrentUS();
+        result = doRequestImpl(req, timeout_ms);
+        uint64_t used = sylar::GetCurrentUS() - start;
+        // 5xx说明上游自身出了问题，和连接失败、超时一样计为失败
+        m_breaker->record(result->result == 0
+                    && (int)result->response->getStatus() < 500, used);
+        if(result->result == 0) {
+            m_latency.record(used);
+        }
+    }
+    span.setStatus(TraceStatus(result));
+    return result;
+}
+
+HttpResult::ptr HttpConnectionPool::doRequestImpl(HttpRequest::ptr req
+                                        , uint64_t timeout_ms
+                                        , const std::function<bool(HttpConnection::ptr)>& on_conn) {
     auto conn = getConnection();
     if(!conn) {
         return std::make_shared<HttpResult>((int)HttpResult::Error::POOL_GET_CONNECTION
                 , nullptr, "pool host:" + m_host + " port:" + std::to_string(m_port));
     }
+    if(on_conn && !on_conn(conn)) {
+        return std::make_shared<HttpResult>((int)HttpResult::Error::CANCELLED
+                , nullptr, "cancelled host:" + m_host + " port:" + std::to_string(m_port));
+    }
     auto sock = conn->getSocket();
     if(!sock) {
         return std::make_shared<HttpResult>((int)HttpResult::Error::POOL_INVALID_CONNECTION
@@ -463,8 +529,198 @@ HttpResult::ptr HttpConnectionPool::doRequest(HttpRequest::ptr req
                     , nullptr, "recv response timeout: " + sock->getRemoteAddress()->toString()
                     + " timeout_ms:" + std::to_string(timeout_ms));
     }
+    // 任意一方声明了connection: close，对端已经或即将关闭连接，不能放回池里
+    if(req->isClose() || strcasecmp(rsp->getHeader("connection").c_str(), "close") == 0) {
+        conn->close();
+    }
     return std::make_shared<HttpResult>((int)HttpResult::Error::OK, rsp, "ok");
 }
 
+HttpResult::ptr HttpConnectionPool::doHedgedGet(const std::string& url
+                                    , uint64_t timeout_ms
+                                    , const std::map<std::string, std::string>& headers) {
+    return doHedgedRequest(makeRequest(HttpMethod::GET, url, headers, ""), timeout_ms);
+}
+
+uint64_t HttpConnectionPool::getHedgeDelay() {
+    if(m_hedgeDelayConf) {
+        return m_hedgeDelayConf;
+    }
+    uint64_t now = sylar::GetCurrentMS();
+    uint64_t last = m_hedgeDelayTime.load(std::memory_order_relaxed);
+    if(now >= last + s_hedge_delay_refresh
+            && m_hedgeDelayTime.compare_exchange_strong(last, now)) {
+        HdrSnapshot snap = m_latency.snapshot();
+        uint64_t delay = 0;
+        if(snap.getCount() >= s_hedge_min_samples) {
+            delay = std::max(snap.percentile(m_hedgePercentile) / 1000, (uint64_t)1);
+        }
+        m_hedgeDelay.store(delay, std::memory_order_relaxed);
+    }
+    return m_hedgeDelay.load(std::memory_order_relaxed);
+}
+
+bool HttpConnectionPool::takeHedgeBudget() {
+    int64_t credits = m_hedgeCredits.load(std::memory_order_relaxed);
+    do {
+        if(credits < 1000) {
+            return false;
+        }
+    } while(!m_hedgeCredits.compare_exchange_weak(credits, credits - 1000));
+    return true;
+}
+
+HttpResult::ptr HttpConnectionPool::doHedgedRequest(HttpRequest::ptr req, uint64_t timeout_ms) {
+    IOManager* iom = IOManager::GetThis();
+    if(!iom || (req->getMethod() != HttpMethod::GET && req->getMethod() != HttpMethod::HEAD)) {
+        return doRequest(req, timeout_ms);
+    }
+    // 每个可对冲的请求积累一部分额度
+    int64_t credits = m_hedgeCredits.load(std::memory_order_relaxed);
+    int64_t add = (int64_t)(m_hedgeBudget * 1000);
+    while(credits < s_hedge_max_credits * 1000
+            && !m_hedgeCredits.compare_exchange_weak(credits
+                , std::min(credits + add, s_hedge_max_credits * 1000)));
+    uint64_t delay = getHedgeDelay();
+    if(!delay || delay >= timeout_ms) {
+        return doRequest(req, timeout_ms);
+    }
+
+    Span span(std::string(HttpMethodToString(req->getMethod())) + " "
+                + m_host + req->getPath(), Span::CLIENT);
+    HedgeContext::ptr ctx(new HedgeContext);
+    ctx->fiber = Fiber::GetThis();
+    ctx->iom = iom;
+    ctx->parent = span.getContext();
+    ctx->deadline = sylar::GetCurrentMS() + timeout_ms;
+    ctx->running = 1;
+    auto self = shared_from_this();
+    iom->schedule(std::bind(&HttpConnectionPool::hedgeAttempt, self, ctx
+                , std::make_shared<HttpRequest>(*req), timeout_ms, false));
+    Timer::ptr timer = iom->addTimer(delay, std::bind(&HttpConnectionPool::startHedge, self, ctx
+                , std::make_shared<HttpRequest>(*req)));
+    Fiber::GetThis()->yield();
+    timer->cancel();
+    MutexType::Lock lock(ctx->mutex);
+    ctx->fiber.reset();
+    HttpResult::ptr result = ctx->result;
+    lock.unlock();
+    span.setStatus(TraceStatus(result));
+    return result;
+}
+
+void HttpConnectionPool::startHedge(HedgeContext::ptr ctx, HttpRequest::ptr req) {
+    MutexType::Lock lock(ctx->mutex);
+    if(ctx->done || !ctx->hedgePending) {
+        return;
+    }
+    ctx->hedgePending = false;
+    // 对冲和重试请求的超时扣除已经等待的时间，整个调用不超过timeout_ms
+    uint64_t now = sylar::GetCurrentMS();
+    uint64_t timeout_ms = ctx->deadline > now ? ctx->deadline - now : 0;
+    if(!timeout_ms || !takeHedgeBudget()) {
+        if(ctx->running == 0) {
+            // 主请求已经失败，没有时间或额度重试，以它的结果结束
+            ctx->done = true;
+            lock.unlock();
+            ctx->iom->schedule(ctx->fiber);
+        }
+        return;
+    }
+    ++ctx->running;
+    lock.unlock();
+    m_hedges->inc();
+    ctx->iom->schedule(std::bind(&HttpConnectionPool::hedgeAttempt, shared_from_this()
+                , ctx, req, timeout_ms, true));
+}
+
+void HttpConnectionPool::hedgeAttempt(HedgeContext::ptr ctx, HttpRequest::ptr req
+                                      , uint64_t timeout_ms, bool hedge) {
+    Span span(std::string(HttpMethodToString(req->getMethod())) + " "
+                + m_host + req->getPath(), ctx->parent, Span::CLIENT);
+    req->setHeader("traceparent", span.getContext().toTraceparent());
+    HttpConnection::ptr conn;
+    HttpResult::ptr result;
+    uint64_t used = 0;
+    bool admitted = m_breaker->allow();
+    if(!admitted) {
+        result = std::make_shared<HttpResult>((int)HttpResult::Error::CIRCUIT_OPEN
+                , nullptr, "circuit open host:" + m_host + " port:" + std::to_string(m_port));
+    } else {
+        uint64_t start = sylar::GetCurrentUS();
+        result = doRequestImpl(req, timeout_ms, [ctx, &conn](HttpConnection::ptr c) {
+            MutexType::Lock lock(ctx->mutex);
+            if(ctx->done) {
+                return false;
+            }
+            conn = c;
+            ctx->conns.push_back(c);
+            return true;
+        });
+        used = sylar::GetCurrentUS() - start;
+    }
+    span.setStatus(TraceStatus(result));
+
+    MutexType::Lock lock(ctx->mutex);
+    // 胜出的请求已经取走了落败请求的连接
+    auto it = std::find(ctx->conns.begin(), ctx->conns.end(), conn);
+    if(it != ctx->conns.end()) {
+        ctx->conns.erase(it);
+    }
+    --ctx->running;
+    bool cancelled = ctx->done;
+    bool win = !cancelled && result->result == 0;
+    bool retry = false;
+    bool wake = false;
+    if(!cancelled) {
+        if(win || !ctx->result) {
+            ctx->result = result;
+        }
+        if(win || (ctx->running == 0 && !ctx->hedgePending)) {
+            ctx->done = true;
+            wake = true;
+            // 必须在锁内处理，否则落败的请求可能先看到done并关闭连接，
+            // fd被别的连接复用后这里会shutdown到无关的socket
+            for(auto& i : ctx->conns) {
+                // shutdown之后读写立即返回，cancelEvent唤醒正在等待的协程，不必等到超时
+                int fd = i->getSocket()->getSocket();
+                ::shutdown(fd, SHUT_RDWR);
+                ctx->iom->cancelEvent(fd, IOManager::READ);
+                ctx->iom->cancelEvent(fd, IOManager::WRITE);
+            }
+            ctx->conns.clear();
+        } else {
+            // 失败了但还有请求在执行，或者对冲请求还没发出(此时立即发出，相当于重试)
+            retry = ctx->running == 0;
+        }
+    }
+    lock.unlock();
+
+    if(admitted) {
+        if(cancelled) {
+            m_breaker->cancel();
+        } else {
+            m_breaker->record(result->result == 0
+                    && (int)result->response->getStatus() < 500, used);
+        }
+    }
+    if(!cancelled && result->result == 0) {
+        m_latency.record(used);
+    }
+    if(cancelled && conn) {
+        // 连接可能已经被胜出的请求shutdown，不能放回池里
+        conn->close();
+    }
+    conn.reset();
+    if(win && hedge) {
+        m_hedgeWins->inc();
+    }
+    if(retry) {
+        startHedge(ctx, std::make_shared<HttpRequest>(*req));
+    } else if(wake) {
+        ctx->iom->schedule(ctx->fiber);
+    }
+}
+
 }
 }
@@ -12,7 +12,13 @@
 
 #include "../streams/socket_stream.h"
 #include "http.h"
+#include "http_reader.h"
 #include "../uri.h"
+#include "../socket_stats.h"
+#include "../circuit_breaker.h"
+#include "../hdr_histogram.h"
+#include "../iomanager.h"
+#include "../trace.h"
 #include "../thread.h"
 
 #include <list>
@@ -50,6 +56,10 @@ struct HttpResult {
         POOL_GET_CONNECTION = 8,
         /// 无效的连接
         POOL_INVALID_CONNECTION = 9,
+        /// 上游被熔断或并发已达上限
+        CIRCUIT_OPEN = 10,
+        /// 对冲请求中落败被取消
+        CANCELLED = 11,
     };
 
     /**
@@ -195,6 +205,34 @@ public:
      */
     HttpResponse::ptr recvResponse();
 
+    /**
+     * @brief 只接收HTTP响应头，消息体之后用readBody()流式读取
+     * @note HEAD请求的响应没有消息体，不能再读消息体，连接也不能再复用
+     */
+    HttpResponse::ptr recvResponseHeader();
+
+    /**
+     * @brief 流式读取一段响应消息体
+     * @param[out] out 读到的数据，已去掉chunked编码
+     * @return >0 读到的字节数，=0 消息体结束，<0 出错
+     */
+    int readBody(std::string& out) { return m_reader.readBody(out);}
+
+    /**
+     * @brief 响应消息体是否已经读完
+     */
+    bool isBodyFinished() const { return m_reader.isBodyFinished();}
+
+    /**
+     * @brief 返回socket上尚未读取的响应消息体字节数，参考HttpReader::getBodyLeft
+     */
+    uint64_t getBodyLeft() const { return m_reader.getBodyLeft();}
+
+    /**
+     * @brief 调用方已经直接从socket搬走了getBodyLeft()字节
+     */
+    void setBodyConsumed() { m_reader.setBodyConsumed();}
+
     /**
      * @brief 发送HTTP请求
      * @param[in] req HTTP请求结构
@@ -202,13 +240,26 @@ public:
     int sendRequest(HttpRequest::ptr req);
 
 private:
+    /**
+     * @brief 不带链路追踪的DoRequest实现
+     */
+    static HttpResult::ptr DoRequestImpl(HttpRequest::ptr req
+                            , Uri::ptr uri
+                            , uint64_t timeout_ms);
+private:
+    /// 响应读取器
+    HttpReader<HttpResponseParser> m_reader;
     /// 创建时间
     uint64_t m_createTime = 0;
     /// 该连接已使用的次数，只在使用连接池的情况下有用
     uint64_t m_request = 0;
 };
 
-class HttpConnectionPool {
+/**
+ * @brief HTTP连接池
+ * @note 对冲请求的落败请求在调用返回后仍会运行一段时间，连接池需要由shared_ptr管理
+ */
+class HttpConnectionPool : public std::enable_shared_from_this<HttpConnectionPool> {
 public:
     typedef std::shared_ptr<HttpConnectionPool> ptr;
     typedef Mutex MutexType;
@@ -221,13 +272,26 @@ public:
      * @param[in] max_size 暂未使用
      * @param[in] max_alive_time 单个连接的最大存活时间
      * @param[in] max_request 单个连接可复用的最大次数
+     * @param[in] is_https 是否使用TLS连接
      */
     HttpConnectionPool(const std::string& host
                        ,const std::string& vhost
                        ,uint32_t port
                        ,uint32_t max_size
                        ,uint32_t max_alive_time
-                       ,uint32_t max_request);
+                       ,uint32_t max_request
+                       ,bool is_https = false);
+
+    /**
+     * @brief 根据uri创建连接池，https时使用TLS连接
+     * @param[in] uri 形如 https://host:port 的地址，未指定端口时使用协议的默认端口
+     * @return uri非法时返回nullptr
+     */
+    static HttpConnectionPool::ptr Create(const std::string& uri
+                                          ,const std::string& vhost
+                                          ,uint32_t max_size
+                                          ,uint32_t max_alive_time
+                                          ,uint32_t max_request);
 
     /**
      * @brief 从请求池中获取一个连接
@@ -236,6 +300,13 @@ public:
      */
     HttpConnection::ptr getConnection();
 
+    /**
+     * @brief 关闭连接池
+     * @details 释放所有空闲连接，之后归还的连接直接关闭，不再放回池中。
+     *          空闲长连接会让上游一直等待下一个请求，停止服务时需要先关闭
+     */
+    void close();
+
 
     /**
      * @brief 发送HTTP的GET请求
@@ -327,7 +398,107 @@ public:
      */
     HttpResult::ptr doRequest(HttpRequest::ptr req
                             , uint64_t timeout_ms);
+
+    /**
+     * @brief 发送带对冲的GET请求，参考doHedgedRequest
+     * @param[in] url 请求的url
+     * @param[in] timeout_ms 超时时间(毫秒)
+     * @param[in] headers HTTP请求头部参数
+     */
+    HttpResult::ptr doHedgedGet(const std::string& url
+                          , uint64_t timeout_ms
+                          , const std::map<std::string, std::string>& headers = {});
+
+    /**
+     * @brief 发送带对冲的请求
+     * @details 请求发出hedge_delay后仍没有响应时，在另一个连接上再发一份，先到的响应胜出，
+     *          落败的请求shutdown连接并通过cancelEvent立即唤醒，不再等待。
+     *          延迟取http.client.hedge_delay_ms，为0时取该上游最近成功请求耗时的
+     *          http.client.hedge_percentile分位数，样本不足时不对冲。
+     *          对冲额度按http.client.hedge_budget的比例随请求积累，额度用完时不再对冲，
+     *          主请求失败时额度也用于立即重试，避免上游整体变慢时请求量翻倍。
+     *          只对GET和HEAD请求对冲，其他请求或不在IOManager中调用时等同于doRequest
+     * @param[in] req 请求结构体
+     * @param[in] timeout_ms 超时时间(毫秒)
+     */
+    HttpResult::ptr doHedgedRequest(HttpRequest::ptr req, uint64_t timeout_ms);
+
+    /**
+     * @brief 返回当前的对冲延迟(毫秒)，0表示不对冲
+     */
+    uint64_t getHedgeDelay();
+
+    /**
+     * @brief 返回到上游连接的统计组
+     * @details 组名为host:port，归还连接时按tcp.info_sample_interval的间隔采样TCP_INFO
+     */
+    SocketStatsGroup::ptr getSocketStats() const { return m_stats;}
+
+    /**
+     * @brief 返回上游的熔断器
+     * @details 熔断或并发已达上限时请求立即以CIRCUIT_OPEN失败，不再取连接
+     */
+    CircuitBreaker::ptr getCircuitBreaker() const { return m_breaker;}
 private:
+    /**
+     * @brief 一次对冲调用的状态
+     */
+    struct HedgeContext {
+        typedef std::shared_ptr<HedgeContext> ptr;
+        /// 保护以下字段
+        MutexType mutex;
+        /// 等待结果的协程
+        Fiber::ptr fiber;
+        /// 请求所在的调度器
+        IOManager* iom = nullptr;
+        /// 调用方的span上下文
+        SpanContext parent;
+        /// 整个调用的截止时间(ms)，对冲和重试请求只用剩余的时间
+        uint64_t deadline = 0;
+        /// 结果，done之前是最近一次失败的结果
+        HttpResult::ptr result;
+        /// 结果已确定，调用方已被唤醒
+        bool done = false;
+        /// 对冲请求还没有发出
+        bool hedgePending = true;
+        /// 正在执行的请求数
+        int running = 0;
+        /// 正在执行的请求占用的连接，胜出时用于取消落败的请求
+        std::vector<HttpConnection::ptr> conns;
+    };
+
+    /**
+     * @brief 按method、url、headers和body构造请求
+     */
+    HttpRequest::ptr makeRequest(HttpMethod method
+                            , const std::string& url
+                            , const std::map<std::string, std::string>& headers
+                            , const std::string& body);
+
+    /**
+     * @brief 不带链路追踪的doRequest实现
+     * @param[in] on_conn 取到连接后、发送请求前的回调，返回false时放弃请求
+     */
+    HttpResult::ptr doRequestImpl(HttpRequest::ptr req
+                            , uint64_t timeout_ms
+                            , const std::function<bool(HttpConnection::ptr)>& on_conn = nullptr);
+
+    /**
+     * @brief 执行对冲调用中的一个请求
+     * @param[in] hedge 是否是对冲请求
+     */
+    void hedgeAttempt(HedgeContext::ptr ctx, HttpRequest::ptr req, uint64_t timeout_ms, bool hedge);
+
+    /**
+     * @brief 发出对冲请求，额度不足或已经到截止时间时放弃
+     */
+    void startHedge(HedgeContext::ptr ctx, HttpRequest::ptr req);
+
+    /**
+     * @brief 取一份对冲额度
+     */
+    bool takeHedgeBudget();
+
     static void ReleasePtr(HttpConnection* ptr, HttpConnectionPool* pool);
 private:
     /// Host字段默认值
@@ -342,12 +513,38 @@ private:
     uint32_t m_maxAliveTime;
     /// 单个连接的最大复用次数
     uint32_t m_maxRequest;
+    /// 是否使用TLS连接
+    bool m_isHttps;
     /// 互斥锁
     MutexType m_mutex;
+    /// 连接池是否已关闭
+    bool m_closed = false;
     /// 连接池，链表形式存储
     std::list<HttpConnection*> m_conns;
     /// 当前连接池的可用连接数量
     std::atomic<int32_t> m_total = {0};
+    /// 到上游连接的统计组
+    SocketStatsGroup::ptr m_stats;
+    /// 上游的熔断器
+    CircuitBreaker::ptr m_breaker;
+    /// 成功请求的耗时(微秒)
+    HdrHistogram m_latency;
+    /// 固定的对冲延迟(毫秒)，0表示按耗时分位数
+    uint64_t m_hedgeDelayConf;
+    /// 对冲延迟取的耗时分位数
+    double m_hedgePercentile;
+    /// 对冲请求占总请求数的比例上限
+    double m_hedgeBudget;
+    /// 按耗时分位数算出的对冲延迟(毫秒)
+    std::atomic<uint64_t> m_hedgeDelay = {0};
+    /// 上次计算对冲延迟的时间(毫秒)
+    std::atomic<uint64_t> m_hedgeDelayTime = {0};
+    /// 对冲额度，1000为一次对冲
+    std::atomic<int64_t> m_hedgeCredits = {0};
+    /// 对冲请求数
+    Counter::ptr m_hedges;
+    /// 对冲请求胜出数
+    Counter::ptr m_hedgeWins;
 };
 
 }
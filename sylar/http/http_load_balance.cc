@@ -0,0 +1,350 @@
+/**
+ * @file http_load_balance.cc
+ * @brief 负载均衡的HTTP连接池实现
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "http_load_balance.h"
+#include <math.h>
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include "../config.h"
+#include "../log.h"
+#include "../util.h"
+
+namespace sylar {
+namespace http {
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_NAME("system");
+
+static sylar::ConfigVar<std::map<std::string, std::vector<std::string> > >::ptr g_upstreams =
+    sylar::Config::Lookup("http.upstreams", std::map<std::string, std::vector<std::string> >()
+            , "named upstream endpoint lists for HttpLoadBalancePool");
+
+static sylar::ConfigVar<uint64_t>::ptr g_lb_decay =
+    sylar::Config::Lookup("http.lb.decay_ms", (uint64_t)10000
+            , "decay time of the per endpoint latency ewma");
+
+static sylar::ConfigVar<uint64_t>::ptr g_lb_failure_penalty =
+    sylar::Config::Lookup("http.lb.failure_penalty_ms", (uint64_t)1000
+            , "max latency recorded for a failed request");
+
+/**
+ * @brief 线程局部的xorshift64*随机数，用于挑选候选上游
+ */
+static uint64_t Rand() {
+    static thread_local uint64_t t_state = 0;
+    if(!t_state) {
+        t_state = (GetCurrentUS() << 16) ^ ((uint64_t)GetThreadId() << 40)
+                    ^ (uint64_t)(uintptr_t)&t_state;
+        t_state |= 1;
+    }
+    t_state ^= t_state >> 12;
+    t_state ^= t_state << 25;
+    t_state ^= t_state >> 27;
+    return t_state * 0x2545F4914F6CDD1DULL;
+}
+
+double HttpLoadBalancePool::Endpoint::getLatency() {
+    Spinlock::Lock lock(mutex);
+    return ewma;
+}
+
+double HttpLoadBalancePool::Endpoint::getLatency(uint64_t now_us, double decay_us) {
+    Spinlock::Lock lock(mutex);
+    if(ewma > 0 && now_us > lastUpdate) {
+        ewma *= exp(-(double)(now_us - lastUpdate) / decay_us);
+        lastUpdate = now_us;
+    }
+    return ewma;
+}
+
+void HttpLoadBalancePool::Endpoint::observe(double rtt_us, uint64_t now_us, double decay_us) {
+    Spinlock::Lock lock(mutex);
+    if(ewma <= 0 || rtt_us > ewma) {
+        // 变慢时立即跟上，变快时按时间衰减
+        ewma = rtt_us;
+    } else if(now_us > lastUpdate) {
+        double w = exp(-(double)(now_us - lastUpdate) / decay_us);
+        ewma = ewma * w + rtt_us * (1 - w);
+    }
+    lastUpdate = std::max(lastUpdate, now_us);
+}
+
+HttpLoadBalancePool::HttpLoadBalancePool(const std::string& name
+                                         ,const std::string& vhost
+                                         ,uint32_t max_size
+                                         ,uint32_t max_alive_time
+                                         ,uint32_t max_request)
+    :m_name(name)
+    ,m_vhost(vhost)
+    ,m_maxSize(max_size)
+    ,m_maxAliveTime(max_alive_time)
+    ,m_maxRequest(max_request)
+    ,m_decay(std::max(g_lb_decay->getValue(), (uint64_t)1) * 1000.0)
+    ,m_failurePenalty(g_lb_failure_penalty->getValue() * 1000.0) {
+}
+
+HttpLoadBalancePool::~HttpLoadBalancePool() {
+    if(m_listener) {
+        g_upstreams->delListener(m_listener);
+    }
+}
+
+HttpLoadBalancePool::ptr HttpLoadBalancePool::Create(const std::string& name
+                                        ,const std::vector<std::string>& uris
+                                        ,const std::string& vhost
+                                        ,uint32_t max_size
+                                        ,uint32_t max_alive_time
+                                        ,uint32_t max_request) {
+    HttpLoadBalancePool::ptr pool = std::make_shared<HttpLoadBalancePool>(name
+            , vhost, max_size, max_alive_time, max_request);
+    pool->setEndpoints(uris);
+    return pool;
+}
+
+HttpLoadBalancePool::ptr HttpLoadBalancePool::CreateFromConfig(const std::string& name
+                                        ,const std::string& vhost
+                                        ,uint32_t max_size
+                                        ,uint32_t max_alive_time
+                                        ,uint32_t max_request) {
+    HttpLoadBalancePool::ptr pool = std::make_shared<HttpLoadBalancePool>(name
+            , vhost, max_size, max_alive_time, max_request);
+    std::weak_ptr<HttpLoadBalancePool> weak(pool);
+    pool->m_listener = g_upstreams->addListener([weak, name](
+                const std::map<std::string, std::vector<std::string> >& old_value
+                ,const std::map<std::string, std::vector<std::string> >& new_value) {
+        auto self = weak.lock();
+        if(!self) {
+            return;
+        }
+        auto it = new_value.find(name);
+        self->setEndpoints(it == new_value.end() ? std::vector<std::string>() : it->second);
+    });
+    auto upstreams = g_upstreams->getValue();
+    auto it = upstreams.find(name);
+    if(it != upstreams.end()) {
+        pool->setEndpoints(it->second);
+    }
+    return pool;
+}
+
+HttpLoadBalancePool::ptr HttpLoadBalancePool::CreateFromFile(const std::string& name
+                                        ,const std::string& path
+                                        ,const std::string& vhost
+                                        ,uint32_t max_size
+                                        ,uint32_t max_alive_time
+                                        ,uint32_t max_request) {
+    HttpLoadBalancePool::ptr pool = std::make_shared<HttpLoadBalancePool>(name
+            , vhost, max_size, max_alive_time, max_request);
+    if(!pool->loadFile(path)) {
+        return nullptr;
+    }
+    return pool;
+}
+
+HttpLoadBalancePool::Endpoint::ptr HttpLoadBalancePool::createEndpoint(const std::string& uri) {
+    Uri::ptr turi = Uri::Create(uri);
+    if(!turi) {
+        SYLAR_LOG_ERROR(g_logger) << "load balance " << m_name << " invalid endpoint=" << uri;
+        return nullptr;
+    }
+    Endpoint::ptr ep = std::make_shared<Endpoint>();
+    ep->uri = uri;
+    ep->host = turi->getHost();
+    ep->pool = std::make_shared<HttpConnectionPool>(turi->getHost(), m_vhost, turi->getPort()
+            , m_maxSize, m_maxAliveTime, m_maxRequest, turi->getScheme() == "https");
+
+    auto mgr = sylar::MetricsMgr::GetInstance();
+    MetricsRegistry::Labels labels = {{"name", m_name}, {"endpoint", uri}};
+    std::weak_ptr<Endpoint> weak(ep);
+    mgr->gauge("sylar_http_lb_inflight", "requests in flight per endpoint", labels, [weak]() {
+        auto ep = weak.lock();
+        return ep ? (double)ep->inflight.load(std::memory_order_relaxed) : 0.0;
+    });
+    mgr->gauge("sylar_http_lb_latency_seconds", "latency ewma per endpoint", labels, [weak]() {
+        auto ep = weak.lock();
+        return ep ? ep->getLatency() / 1000000.0 : 0.0;
+    });
+    ep->requests = mgr->counter("sylar_http_lb_requests_total", "requests per endpoint", labels);
+    return ep;
+}
+
+size_t HttpLoadBalancePool::setEndpoints(const std::vector<std::string>& uris) {
+    std::map<std::string, Endpoint::ptr> old;
+    {
+        RWMutexType::ReadLock lock(m_mutex);
+        for(auto& i : m_endpoints) {
+            old[i->uri] = i;
+        }
+    }
+    std::vector<Endpoint::ptr> endpoints;
+    std::set<std::string> seen;
+    for(auto& uri : uris) {
+        if(!seen.insert(uri).second) {
+            continue;
+        }
+        auto it = old.find(uri);
+        Endpoint::ptr ep = it == old.end() ? createEndpoint(uri) : it->second;
+        if(ep) {
+            endpoints.push_back(ep);
+        }
+    }
+    RWMutexType::WriteLock lock(m_mutex);
+    m_endpoints.swap(endpoints);
+    SYLAR_LOG_INFO(g_logger) << "load balance " << m_name << " endpoints=" << m_endpoints.size();
+    return m_endpoints.size();
+}
+
+bool HttpLoadBalancePool::loadFile(const std::string& path) {
+    std::ifstream ifs(path);
+    if(!ifs) {
+        SYLAR_LOG_ERROR(g_logger) << "load balance " << m_name << " open file fail: " << path;
+        return false;
+    }
+    std::vector<std::string> uris;
+    std::string line;
+    while(std::getline(ifs, line)) {
+        line = StringUtil::Trim(line);
+        if(line.empty() || line[0] == '#') {
+            continue;
+        }
+        uris.push_back(line);
+    }
+    setEndpoints(uris);
+    return true;
+}
+
+HttpLoadBalancePool::Endpoint::ptr HttpLoadBalancePool::select() {
+    RWMutexType::ReadLock lock(m_mutex);
+    size_t n = m_endpoints.size();
+    if(n <= 1) {
+        return n ? m_endpoints[0] : nullptr;
+    }
+    uint64_t r = Rand();
+    size_t i = r % n;
+    size_t j = (r >> 32) % (n - 1);
+    if(j >= i) {
+        ++j;
+    }
+    Endpoint::ptr a = m_endpoints[i];
+    Endpoint::ptr b = m_endpoints[j];
+    uint64_t now = GetCurrentMS();
+    bool a_ok = a->pool->getCircuitBreaker()->isAvailable(now);
+    bool b_ok = b->pool->getCircuitBreaker()->isAvailable(now);
+    if(a_ok != b_ok) {
+        return a_ok ? a : b;
+    }
+    if(!a_ok) {
+        // 两个候选都在熔断中，找任意一个可用的
+        for(auto& ep : m_endpoints) {
+            if(ep->pool->getCircuitBreaker()->isAvailable(now)) {
+                return ep;
+            }
+        }
+        return a;
+    }
+    lock.unlock();
+    // 没有样本的上游按另一个候选的耗时计算，只比较并发数
+    uint64_t now_us = GetCurrentUS();
+    double la = a->getLatency(now_us, m_decay);
+    double lb = b->getLatency(now_us, m_decay);
+    if(la <= 0) {
+        la = lb;
+    }
+    if(lb <= 0) {
+        lb = la;
+    }
+    if(la <= 0) {
+        la = lb = 1;
+    }
+    double sa = (a->inflight.load(std::memory_order_relaxed) + 1) * la;
+    double sb = (b->inflight.load(std::memory_order_relaxed) + 1) * lb;
+    return sa <= sb ? a : b;
+}
+
+HttpResult::ptr HttpLoadBalancePool::execute(const std::function<HttpResult::ptr(Endpoint::ptr)>& cb) {
+    Endpoint::ptr ep = select();
+    if(!ep) {
+        return std::make_shared<HttpResult>((int)HttpResult::Error::POOL_GET_CONNECTION
+                , nullptr, "load balance " + m_name + " has no endpoint");
+    }
+    ep->requests->inc();
+    ep->inflight.fetch_add(1, std::memory_order_relaxed);
+    uint64_t start = GetCurrentUS();
+    HttpResult::ptr result = cb(ep);
+    uint64_t now = GetCurrentUS();
+    ep->inflight.fetch_sub(1, std::memory_order_relaxed);
+    double rtt = now - start;
+    if(result->result == (int)HttpResult::Error::CIRCUIT_OPEN) {
+        return result;
+    }
+    if(result->result != 0 || (int)result->response->getStatus() >= 500) {
+        // 失败的请求往往返回得很快，按两倍耗时计入，避免失败的上游吸走请求。
+        // 连续失败时不能逐次翻倍，否则上游恢复后要很久才能衰减回来
+        double penalty = std::min(std::max(rtt, ep->getLatency()) * 2, m_failurePenalty);
+        rtt = std::max(rtt, penalty);
+    }
+    ep->observe(rtt, now, m_decay);
+    return result;
+}
+
+HttpResult::ptr HttpLoadBalancePool::doGet(const std::string& url
+                          , uint64_t timeout_ms
+                          , const std::map<std::string, std::string>& headers
+                          , const std::string& body) {
+    return doRequest(HttpMethod::GET, url, timeout_ms, headers, body);
+}
+
+HttpResult::ptr HttpLoadBalancePool::doPost(const std::string& url
+                           , uint64_t timeout_ms
+                           , const std::map<std::string, std::string>& headers
+                           , const std::string& body) {
+    return doRequest(HttpMethod::POST, url, timeout_ms, headers, body);
+}
+
+HttpResult::ptr HttpLoadBalancePool::doRequest(HttpMethod method
+                            , const std::string& url
+                            , uint64_t timeout_ms
+                            , const std::map<std::string, std::string>& headers
+                            , const std::string& body) {
+    return execute([&](Endpoint::ptr ep) {
+        return ep->pool->doRequest(method, url, timeout_ms, headers, body);
+    });
+}
+
+HttpResult::ptr HttpLoadBalancePool::doRequest(HttpRequest::ptr req, uint64_t timeout_ms) {
+    return execute([&](Endpoint::ptr ep) {
+        HttpRequest::ptr ureq = req;
+        if(req->getHeader("Host").empty()) {
+            ureq = std::make_shared<HttpRequest>(*req);
+            ureq->setHeader("Host", m_vhost.empty() ? ep->host : m_vhost);
+        }
+        return ep->pool->doRequest(ureq, timeout_ms);
+    });
+}
+
+std::vector<HttpLoadBalancePool::Endpoint::ptr> HttpLoadBalancePool::getEndpoints() {
+    RWMutexType::ReadLock lock(m_mutex);
+    return m_endpoints;
+}
+
+std::string HttpLoadBalancePool::toString() {
+    std::stringstream ss;
+    ss << "[HttpLoadBalancePool name=" << m_name;
+    for(auto& ep : getEndpoints()) {
+        ss << " [" << ep->uri
+           << " inflight=" << ep->inflight.load(std::memory_order_relaxed)
+           << " ewma_us=" << (uint64_t)ep->getLatency()
+           << " requests=" << ep->requests->get()
+           << " breaker=" << CircuitBreaker::StateToString(ep->pool->getCircuitBreaker()->getState())
+           << "]";
+    }
+    ss << "]";
+    return ss.str();
+}
+
+}
+}
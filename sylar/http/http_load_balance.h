@@ -0,0 +1,233 @@
+/**
+ * @file http_load_balance.h
+ * @brief 多上游负载均衡的HTTP连接池
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#ifndef __SYLAR_HTTP_LOAD_BALANCE_H__
+#define __SYLAR_HTTP_LOAD_BALANCE_H__
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "http_connection.h"
+#include "../metrics.h"
+#include "../mutex.h"
+
+namespace sylar {
+namespace http {
+
+/**
+ * @brief 负载均衡的HTTP连接池
+ * @details 每个上游(endpoint)有自己的HttpConnectionPool保持长连接，也各自熔断。
+ *          每个请求用power-of-two-choices挑选上游：随机取两个，比较 (并发数+1) * 耗时EWMA，
+ *          选较小的一个。耗时EWMA按时间衰减(http.lb.decay_ms)，变慢时立即跟上(peak EWMA)，
+ *          挑选时也按距上次更新的时间向0衰减，不再被选中的慢上游过一段时间后会重新得到请求。
+ *          失败按两倍耗时计入，但不超过http.lb.failure_penalty_ms，熔断中的上游不参与挑选。
+ *          相比轮询或DNS轮询，慢的或排队的上游会自动少分到请求，
+ *          相比全局最小值，两个随机候选避免了所有调用方同时涌向同一个上游。
+ *          上游列表可以直接给出，也可以来自配置http.upstreams(随配置变化更新)或文件
+ */
+class HttpLoadBalancePool : public std::enable_shared_from_this<HttpLoadBalancePool> {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<HttpLoadBalancePool> ptr;
+    /// 读写锁类型定义
+    typedef RWMutex RWMutexType;
+
+    /**
+     * @brief 一个上游
+     */
+    struct Endpoint {
+        /// 智能指针类型定义
+        typedef std::shared_ptr<Endpoint> ptr;
+
+        /**
+         * @brief 返回耗时EWMA(微秒)，0表示还没有样本
+         */
+        double getLatency();
+
+        /**
+         * @brief 按距上次更新的时间衰减后返回耗时EWMA(微秒)，0表示还没有样本
+         * @details 相当于在now_us记录了一次耗时为0的样本
+         * @param[in] now_us 当前时间(微秒)
+         * @param[in] decay_us 衰减时间(微秒)
+         */
+        double getLatency(uint64_t now_us, double decay_us);
+
+        /**
+         * @brief 记录一次请求的耗时
+         * @param[in] rtt_us 耗时(微秒)
+         * @param[in] now_us 当前时间(微秒)
+         * @param[in] decay_us 衰减时间(微秒)
+         */
+        void observe(double rtt_us, uint64_t now_us, double decay_us);
+
+        /// 上游地址，如http://host:port
+        std::string uri;
+        /// Host字段默认值
+        std::string host;
+        /// 到该上游的连接池
+        HttpConnectionPool::ptr pool;
+        /// 正在执行的请求数
+        std::atomic<uint32_t> inflight = {0};
+        /// 保护耗时EWMA
+        Spinlock mutex;
+        /// 耗时EWMA(微秒)
+        double ewma = 0;
+        /// 上次更新EWMA的时间(微秒)
+        uint64_t lastUpdate = 0;
+        /// 发往该上游的请求数
+        Counter::ptr requests;
+    };
+
+    /**
+     * @brief 构造函数
+     * @param[in] name 名称，用作指标的name标签
+     * @param[in] vhost 请求头中的Host字段默认值，为空时使用各上游的host
+     * @param[in] max_size 传给各上游的连接池
+     * @param[in] max_alive_time 单个连接的最大存活时间
+     * @param[in] max_request 单个连接可复用的最大次数
+     */
+    HttpLoadBalancePool(const std::string& name
+                        ,const std::string& vhost
+                        ,uint32_t max_size
+                        ,uint32_t max_alive_time
+                        ,uint32_t max_request);
+
+    /**
+     * @brief 析构函数，取消配置监听
+     */
+    ~HttpLoadBalancePool();
+
+    /**
+     * @brief 以给定的上游列表创建
+     * @param[in] uris 上游地址列表，形如 http://host:port
+     */
+    static HttpLoadBalancePool::ptr Create(const std::string& name
+                        ,const std::vector<std::string>& uris
+                        ,const std::string& vhost
+                        ,uint32_t max_size
+                        ,uint32_t max_alive_time
+                        ,uint32_t max_request);
+
+    /**
+     * @brief 以配置http.upstreams中name对应的上游列表创建，配置变化时更新上游
+     */
+    static HttpLoadBalancePool::ptr CreateFromConfig(const std::string& name
+                        ,const std::string& vhost
+                        ,uint32_t max_size
+                        ,uint32_t max_alive_time
+                        ,uint32_t max_request);
+
+    /**
+     * @brief 以文件中的上游列表创建，参考loadFile
+     * @return 文件无法读取时返回nullptr
+     */
+    static HttpLoadBalancePool::ptr CreateFromFile(const std::string& name
+                        ,const std::string& path
+                        ,const std::string& vhost
+                        ,uint32_t max_size
+                        ,uint32_t max_alive_time
+                        ,uint32_t max_request);
+
+    /**
+     * @brief 设置上游列表
+     * @details 列表中已有的上游保留原来的连接池和耗时统计，非法地址被忽略
+     * @return 有效的上游数
+     */
+    size_t setEndpoints(const std::vector<std::string>& uris);
+
+    /**
+     * @brief 从文件读取上游列表，每行一个地址，#开头的行是注释
+     * @return 文件无法读取时返回false
+     */
+    bool loadFile(const std::string& path);
+
+    /**
+     * @brief 按power-of-two-choices挑选一个上游
+     * @return 没有上游时返回nullptr
+     */
+    Endpoint::ptr select();
+
+    /**
+     * @brief 发送HTTP的GET请求
+     */
+    HttpResult::ptr doGet(const std::string& url
+                          , uint64_t timeout_ms
+                          , const std::map<std::string, std::string>& headers = {}
+                          , const std::string& body = "");
+
+    /**
+     * @brief 发送HTTP的POST请求
+     */
+    HttpResult::ptr doPost(const std::string& url
+                           , uint64_t timeout_ms
+                           , const std::map<std::string, std::string>& headers = {}
+                           , const std::string& body = "");
+
+    /**
+     * @brief 发送HTTP请求
+     */
+    HttpResult::ptr doRequest(HttpMethod method
+                            , const std::string& url
+                            , uint64_t timeout_ms
+                            , const std::map<std::string, std::string>& headers = {}
+                            , const std::string& body = "");
+
+    /**
+     * @brief 发送HTTP请求
+     * @details 请求没有Host时使用vhost或选中上游的host，请求对象不会被修改
+     */
+    HttpResult::ptr doRequest(HttpRequest::ptr req, uint64_t timeout_ms);
+
+    /**
+     * @brief 返回当前的上游列表
+     */
+    std::vector<Endpoint::ptr> getEndpoints();
+
+    /**
+     * @brief 返回名称
+     */
+    const std::string& getName() const { return m_name;}
+
+    std::string toString();
+private:
+    /**
+     * @brief 在选中的上游上执行请求并记录结果
+     */
+    HttpResult::ptr execute(const std::function<HttpResult::ptr(Endpoint::ptr)>& cb);
+
+    /**
+     * @brief 创建上游
+     */
+    Endpoint::ptr createEndpoint(const std::string& uri);
+private:
+    /// 名称
+    std::string m_name;
+    /// Host字段默认值
+    std::string m_vhost;
+    /// 传给各上游的连接池
+    uint32_t m_maxSize;
+    /// 单个连接的最大存活时间
+    uint32_t m_maxAliveTime;
+    /// 单个连接的最大复用次数
+    uint32_t m_maxRequest;
+    /// 耗时EWMA的衰减时间(微秒)
+    double m_decay;
+    /// 一次失败最多计入的耗时(微秒)
+    double m_failurePenalty;
+    /// 保护m_endpoints
+    RWMutexType m_mutex;
+    /// 上游列表
+    std::vector<Endpoint::ptr> m_endpoints;
+    /// 配置监听id，0表示没有监听
+    uint64_t m_listener = 0;
+};
+
+}
+}
+
+#endif
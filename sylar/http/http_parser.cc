@@ -78,6 +78,33 @@ struct _RequestSizeIniter {
 static _RequestSizeIniter _init;
 } // namespace
 
+/**
+ * @brief 解析累积的url，设置请求的path/query/fragment
+ */
+static bool parse_url(HttpRequestParser *parser) {
+    const std::string &url = parser->getUrl();
+    struct http_parser_url url_parser;
+    http_parser_url_init(&url_parser);
+    if (http_parser_parse_url(url.c_str(), url.size(), 0, &url_parser) != 0) {
+        SYLAR_LOG_DEBUG(g_logger) << "parse url fail";
+        return false;
+    }
+    const char *buf = url.c_str();
+    if (url_parser.field_set & (1 << UF_PATH)) {
+        parser->getData()->setPath(std::string(buf + url_parser.field_data[UF_PATH].off,
+                                               url_parser.field_data[UF_PATH].len));
+    }
+    if (url_parser.field_set & (1 << UF_QUERY)) {
+        parser->getData()->setQuery(std::string(buf + url_parser.field_data[UF_QUERY].off,
+                                                url_parser.field_data[UF_QUERY].len));
+    }
+    if (url_parser.field_set & (1 << UF_FRAGMENT)) {
+        parser->getData()->setFragment(std::string(buf + url_parser.field_data[UF_FRAGMENT].off,
+                                                   url_parser.field_data[UF_FRAGMENT].len));
+    }
+    return true;
+}
+
 /**
  * @brief http请求开始解析回调函数
  */
@@ -93,8 +120,13 @@ static int on_request_message_begin_cb(http_parser *p) {
 static int on_request_headers_complete_cb(http_parser *p) {
     SYLAR_LOG_DEBUG(g_logger) << "on_request_headers_complete_cb";
     HttpRequestParser *parser = static_cast<HttpRequestParser *>(p->data);
+    parser->flushHeader();
+    if (!parse_url(parser)) {
+        return -1;
+    }
     parser->getData()->setVersion(((p->http_major) << 0x4) | (p->http_minor));
     parser->getData()->setMethod((HttpMethod)(p->method));
+    parser->setHeaderFinished(true);
     return 0;
 }
 
@@ -104,7 +136,13 @@ static int on_request_headers_complete_cb(http_parser *p) {
 static int on_request_message_complete_cb(http_parser *p) {
     SYLAR_LOG_DEBUG(g_logger) << "on_request_message_complete_cb";
     HttpRequestParser *parser = static_cast<HttpRequestParser *>(p->data);
+    // chunked消息体后面的trailer头部
+    parser->flushHeader();
     parser->setFinished(true);
+    if (parser->isStreamBody()) {
+        // 暂停解析，execute在这条消息结束处返回，后面的数据属于下一条消息
+        http_parser_pause(p, 1);
+    }
     return 0;
 }
 
@@ -125,33 +163,12 @@ static int on_request_chunk_complete_cb(http_parser *p) {
 }
 
 /**
- * @brief http请求url解析完成回调
+ * @brief http请求url回调，url可能分多次返回，先累积，头部结束时再解析
  */
 static int on_request_url_cb(http_parser *p, const char *buf, size_t len) {
     SYLAR_LOG_DEBUG(g_logger) << "on_request_url_cb, url is:" << std::string(buf, len);
-
-    int ret;
-    struct http_parser_url url_parser;
     HttpRequestParser *parser = static_cast<HttpRequestParser *>(p->data);
-
-    http_parser_url_init(&url_parser);
-    ret = http_parser_parse_url(buf, len, 0, &url_parser);
-    if (ret != 0) {
-        SYLAR_LOG_DEBUG(g_logger) << "parse url fail";
-        return 1;
-    }
-    if (url_parser.field_set & (1 << UF_PATH)) {
-        parser->getData()->setPath(std::string(buf + url_parser.field_data[UF_PATH].off,
-                                               url_parser.field_data[UF_PATH].len));
-    }
-    if (url_parser.field_set & (1 << UF_QUERY)) {
-        parser->getData()->setQuery(std::string(buf + url_parser.field_data[UF_QUERY].off,
-                                                url_parser.field_data[UF_QUERY].len));
-    }
-    if (url_parser.field_set & (1 << UF_FRAGMENT)) {
-        parser->getData()->setFragment(std::string(buf + url_parser.field_data[UF_FRAGMENT].off,
-                                                   url_parser.field_data[UF_FRAGMENT].len));
-    }
+    parser->appendUrl(buf, len);
     return 0;
 }
 
@@ -159,10 +176,9 @@ static int on_request_url_cb(http_parser *p, const char *buf, size_t len) {
  * @brief http请求首部字段名称解析完成回调
  */
 static int on_request_header_field_cb(http_parser *p, const char *buf, size_t len) {
-    std::string field(buf, len);
-    SYLAR_LOG_DEBUG(g_logger) << "on_request_header_field_cb, field is:" << field;
+    SYLAR_LOG_DEBUG(g_logger) << "on_request_header_field_cb, field is:" << std::string(buf, len);
     HttpRequestParser *parser = static_cast<HttpRequestParser *>(p->data);
-    parser->setField(field);
+    parser->appendField(buf, len);
     return 0;
 }
 
@@ -170,10 +186,9 @@ static int on_request_header_field_cb(http_parser *p, const char *buf, size_t le
  * @brief http请求首部字段值解析完成回调
  */
 static int on_request_header_value_cb(http_parser *p, const char *buf, size_t len) {
-    std::string value(buf, len);
-    SYLAR_LOG_DEBUG(g_logger) << "on_request_header_value_cb, value is:" << value;
+    SYLAR_LOG_DEBUG(g_logger) << "on_request_header_value_cb, value is:" << std::string(buf, len);
     HttpRequestParser *parser = static_cast<HttpRequestParser *>(p->data);
-    parser->getData()->setHeader(parser->getField(), value);
+    parser->appendValue(buf, len);
     return 0;
 }
 
@@ -190,9 +205,13 @@ static int on_request_status_cb(http_parser *p, const char *buf, size_t len) {
  * @note 当传输编码是chunked时，每个chunked数据段都会触发一次当前回调，所以用append的方法将所有数据组合到一起
  */
 static int on_request_body_cb(http_parser *p, const char *buf, size_t len) {
+    HttpRequestParser *parser = static_cast<HttpRequestParser *>(p->data);
+    if (parser->isStreamBody()) {
+        parser->getStreamBody().append(buf, len);
+        return 0;
+    }
     std::string body(buf, len);
     SYLAR_LOG_DEBUG(g_logger) << "on_request_body_cb, body is:" << body;
-    HttpRequestParser *parser = static_cast<HttpRequestParser *>(p->data);
     parser->getData()->appendBody(body);
     return 0;
 }
@@ -225,10 +244,13 @@ size_t HttpRequestParser::execute(char *data, size_t len) {
         //处理新协议，暂时不处理
         SYLAR_LOG_DEBUG(g_logger) << "found upgrade, ignore";
         setError(HPE_UNKNOWN);
-    } else if (m_parser.http_errno != 0) {
+    } else if (m_parser.http_errno != 0 && m_parser.http_errno != HPE_PAUSED) {
         SYLAR_LOG_DEBUG(g_logger) << "parse request fail: " << http_errno_name(HTTP_PARSER_ERRNO(&m_parser));
         setError((int8_t)m_parser.http_errno);
     } else {
+        if (m_parser.http_errno == HPE_PAUSED) {
+            http_parser_pause(&m_parser, 0);
+        }
         if (nparsed < len) {
             memmove(data, data + nparsed, (len - nparsed));
         }
@@ -251,8 +273,10 @@ static int on_response_message_begin_cb(http_parser *p) {
 static int on_response_headers_complete_cb(http_parser *p) {
     SYLAR_LOG_DEBUG(g_logger) << "on_response_headers_complete_cb";
     HttpResponseParser *parser = static_cast<HttpResponseParser *>(p->data);
+    parser->flushHeader();
     parser->getData()->setVersion(((p->http_major) << 0x4) | (p->http_minor));
     parser->getData()->setStatus((HttpStatus)(p->status_code));
+    parser->setHeaderFinished(true);
     return 0;
 }
 
@@ -262,7 +286,13 @@ static int on_response_headers_complete_cb(http_parser *p) {
 static int on_response_message_complete_cb(http_parser *p) {
     SYLAR_LOG_DEBUG(g_logger) << "on_response_message_complete_cb";
     HttpResponseParser *parser = static_cast<HttpResponseParser *>(p->data);
+    // chunked消息体后面的trailer头部
+    parser->flushHeader();
     parser->setFinished(true);
+    if (parser->isStreamBody()) {
+        // 暂停解析，execute在这条消息结束处返回，后面的数据属于下一条消息
+        http_parser_pause(p, 1);
+    }
     return 0;
 }
 
@@ -294,10 +324,9 @@ static int on_response_url_cb(http_parser *p, const char *buf, size_t len) {
  * @brief http响应首部字段名称解析完成回调
  */
 static int on_response_header_field_cb(http_parser *p, const char *buf, size_t len) {
-    std::string field(buf, len);
-    SYLAR_LOG_DEBUG(g_logger) << "on_response_header_field_cb, field is:" << field;
+    SYLAR_LOG_DEBUG(g_logger) << "on_response_header_field_cb, field is:" << std::string(buf, len);
     HttpResponseParser *parser = static_cast<HttpResponseParser *>(p->data);
-    parser->setField(field);
+    parser->appendField(buf, len);
     return 0;
 }
 
@@ -305,10 +334,9 @@ static int on_response_header_field_cb(http_parser *p, const char *buf, size_t l
  * @brief http响应首部字段值解析完成回调
  */
 static int on_response_header_value_cb(http_parser *p, const char *buf, size_t len) {
-    std::string value(buf, len);
-    SYLAR_LOG_DEBUG(g_logger) << "on_response_header_value_cb, value is:" << value;
+    SYLAR_LOG_DEBUG(g_logger) << "on_response_header_value_cb, value is:" << std::string(buf, len);
     HttpResponseParser *parser = static_cast<HttpResponseParser *>(p->data);
-    parser->getData()->setHeader(parser->getField(), value);
+    parser->appendValue(buf, len);
     return 0;
 }
 
@@ -326,9 +354,13 @@ static int on_response_status_cb(http_parser *p, const char *buf, size_t len) {
  * @brief http响应消息体回调
  */
 static int on_response_body_cb(http_parser *p, const char *buf, size_t len) {
+    HttpResponseParser *parser = static_cast<HttpResponseParser *>(p->data);
+    if (parser->isStreamBody()) {
+        parser->getStreamBody().append(buf, len);
+        return 0;
+    }
     std::string body(buf, len);
     SYLAR_LOG_DEBUG(g_logger) << "on_response_body_cb, body is:" << body;
-    HttpResponseParser *parser = static_cast<HttpResponseParser *>(p->data);
     parser->getData()->appendBody(body);
     return 0;
 }
@@ -357,10 +389,13 @@ size_t HttpResponseParser::execute(char *data, size_t len) {
     // 在这里http_parser_settings s_request_settings提前注册回调
         // 调用http_parser_execute按提前注册好的回调去解析http响应，这个是nodejs/http-parser的解析库的接口
     size_t nparsed = http_parser_execute(&m_parser, &s_response_settings, data, len);
-    if (m_parser.http_errno != 0) {
+    if (m_parser.http_errno != 0 && m_parser.http_errno != HPE_PAUSED) {
         SYLAR_LOG_DEBUG(g_logger) << "parse response fail: " << http_errno_name(HTTP_PARSER_ERRNO(&m_parser));
         setError((int8_t)m_parser.http_errno);
     } else {
+        if (m_parser.http_errno == HPE_PAUSED) {
+            http_parser_pause(&m_parser, 0);
+        }
         if (nparsed < len) {
             memmove(data, data + nparsed, (len - nparsed));
         }
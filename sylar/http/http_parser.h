@@ -108,14 +108,78 @@ public:
     const http_parser &getParser() const { return m_parser; }
 
     /**
-     * @brief 获取当前的HTTP头部field
+     * @brief 追加当前HTTP头部的field
+     * @details http-parser在数据不完整时会把同一个field或value分成多次回调，
+     *          所以先累积，读到下一个field时再把上一个头部写入消息
      */
-    const std::string &getField() const { return m_field; }
+    void appendField(const char *buf, size_t len) {
+        if (m_inValue) {
+            flushHeader();
+        }
+        m_field.append(buf, len);
+    }
 
     /**
-     * @brief 设置当前的HTTP头部field
+     * @brief 追加请求的url，同样可能分多次回调
      */
-    void setField(const std::string &v) { m_field = v; }
+    void appendUrl(const char *buf, size_t len) { m_url.append(buf, len); }
+
+    /**
+     * @brief 获取累积的url
+     */
+    const std::string &getUrl() const { return m_url; }
+
+    /**
+     * @brief 追加当前HTTP头部的value
+     */
+    void appendValue(const char *buf, size_t len) {
+        m_inValue = true;
+        m_value.append(buf, len);
+    }
+
+    /**
+     * @brief 把累积的头部写入消息
+     */
+    void flushHeader() {
+        if (m_inValue) {
+            m_data->setHeader(m_field, m_value);
+        }
+        m_field.clear();
+        m_value.clear();
+        m_inValue = false;
+    }
+
+    /**
+     * @brief 是否流式读取消息体
+     * @details 流式模式下消息体不写入HttpRequest，而是暂存在getStreamBody()中由调用方取走；
+     *          一条消息解析完后解析器暂停，缓冲区中剩下的数据留给下一条消息
+     */
+    bool isStreamBody() const { return m_streamBody; }
+
+    /**
+     * @brief 设置是否流式读取消息体
+     */
+    void setStreamBody(bool v) { m_streamBody = v; }
+
+    /**
+     * @brief 头部是否解析结束
+     */
+    bool isHeaderFinished() const { return m_headerFinished; }
+
+    /**
+     * @brief 设置头部是否解析结束
+     */
+    void setHeaderFinished(bool v) { m_headerFinished = v; }
+
+    /**
+     * @brief 返回流式模式下已解析、尚未取走的消息体数据(已去掉chunked编码)
+     */
+    std::string &getStreamBody() { return m_streamBodyData; }
+
+    /**
+     * @brief 消息体是否为chunked编码
+     */
+    bool isChunked() const { return m_parser.flags & F_CHUNKED; }
 
 public:
     /**
@@ -137,8 +201,20 @@ private:
     int m_error;
     /// 是否解析结束
     bool m_finished;
+    /// 是否流式读取消息体
+    bool m_streamBody = false;
+    /// 头部是否解析结束
+    bool m_headerFinished = false;
+    /// 流式模式下尚未取走的消息体数据
+    std::string m_streamBodyData;
     /// 当前的HTTP头部field，http-parser解析HTTP头部是field和value分两次返回
     std::string m_field;
+    /// 当前的HTTP头部value
+    std::string m_value;
+    /// 是否已开始累积value
+    bool m_inValue = false;
+    /// 请求的url
+    std::string m_url;
 };
 
 /**
@@ -195,14 +271,68 @@ public:
     const http_parser &getParser() const { return m_parser; }
 
     /**
-     * @brief 获取当前的HTTP头部field
+     * @brief 追加当前HTTP头部的field
+     * @details http-parser在数据不完整时会把同一个field或value分成多次回调，
+     *          所以先累积，读到下一个field时再把上一个头部写入消息
+     */
+    void appendField(const char *buf, size_t len) {
+        if (m_inValue) {
+            flushHeader();
+        }
+        m_field.append(buf, len);
+    }
+
+    /**
+     * @brief 追加当前HTTP头部的value
+     */
+    void appendValue(const char *buf, size_t len) {
+        m_inValue = true;
+        m_value.append(buf, len);
+    }
+
+    /**
+     * @brief 把累积的头部写入消息
+     */
+    void flushHeader() {
+        if (m_inValue) {
+            m_data->setHeader(m_field, m_value);
+        }
+        m_field.clear();
+        m_value.clear();
+        m_inValue = false;
+    }
+
+    /**
+     * @brief 是否流式读取消息体
+     * @details 流式模式下消息体不写入HttpResponse，而是暂存在getStreamBody()中由调用方取走；
+     *          一条消息解析完后解析器暂停，缓冲区中剩下的数据留给下一条消息
+     */
+    bool isStreamBody() const { return m_streamBody; }
+
+    /**
+     * @brief 设置是否流式读取消息体
+     */
+    void setStreamBody(bool v) { m_streamBody = v; }
+
+    /**
+     * @brief 头部是否解析结束
+     */
+    bool isHeaderFinished() const { return m_headerFinished; }
+
+    /**
+     * @brief 设置头部是否解析结束
+     */
+    void setHeaderFinished(bool v) { m_headerFinished = v; }
+
+    /**
+     * @brief 返回流式模式下已解析、尚未取走的消息体数据(已去掉chunked编码)
      */
-    const std::string &getField() const { return m_field; }
+    std::string &getStreamBody() { return m_streamBodyData; }
 
     /**
-     * @brief 设置当前的HTTP头部field
+     * @brief 消息体是否为chunked编码
      */
-    void setField(const std::string &v) { m_field = v; }
+    bool isChunked() const { return m_parser.flags & F_CHUNKED; }
 
 public:
     /**
@@ -224,8 +354,18 @@ private:
     int m_error;
     /// 是否解析结束
     bool m_finished;
+    /// 是否流式读取消息体
+    bool m_streamBody = false;
+    /// 头部是否解析结束
+    bool m_headerFinished = false;
+    /// 流式模式下尚未取走的消息体数据
+    std::string m_streamBodyData;
     /// 当前的HTTP头部field
     std::string m_field;
+    /// 当前的HTTP头部value
+    std::string m_value;
+    /// 是否已开始累积value
+    bool m_inValue = false;
 };
 
 } // namespace http
@@ -0,0 +1,289 @@
+/**
+ * @file http_reader.h
+ * @brief 在Stream上增量解析HTTP消息，消息体可以流式读取
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#ifndef __SYLAR_HTTP_READER_H__
+#define __SYLAR_HTTP_READER_H__
+
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <string.h>
+#include "../stream.h"
+#include "../util.h"
+#include "http_parser.h"
+
+namespace sylar {
+namespace http {
+
+/**
+ * @brief 读取头部时的限制，用于防御慢速攻击(slowloris)和超大头部
+ */
+struct HttpHeaderLimits {
+    /**
+     * @brief 读取头部失败的原因
+     */
+    enum Error {
+        /// 成功
+        OK = 0,
+        /// 对端关闭或读失败
+        CLOSED,
+        /// 协议错误
+        INVALID,
+        /// 头部字节数超限
+        TOO_LARGE,
+        /// 头部字段数超限
+        TOO_MANY,
+        /// 发送速率过低
+        TOO_SLOW
+    };
+
+    /// 头部最大字节数，一行头部放不下时读缓冲区按需扩大到这个大小，0表示只受读缓冲区限制
+    uint64_t maxSize = 0;
+    /// 头部最大字段数，0表示不限制
+    uint32_t maxCount = 0;
+    /// 头部阶段的最低速率(字节/秒)，0表示不检查
+    uint64_t minRate = 0;
+    /// 开始检查速率前的宽限时间(毫秒)
+    uint64_t rateGrace = 1000;
+    /// 收到头部的第一个字节时调用，如开始计算头部阶段的截止时间
+    std::function<void()> onStart;
+    /// 失败原因
+    Error error = OK;
+};
+
+/**
+ * @brief HTTP消息读取器
+ * @details 先用recvHeader()读出头部，消息体再通过readBody()分段取走，整条消息不需要一次放进内存。
+ *          读缓冲区在多条消息之间复用，上一条消息之后多读到的数据会留给下一条消息。
+ *          对于有Content-Length的消息体，调用方也可以绕过读取器直接从socket搬运剩下的getBodyLeft()字节，
+ *          之后调用setBodyConsumed()
+ * @tparam Parser HttpRequestParser或HttpResponseParser
+ */
+template<class Parser>
+class HttpReader {
+public:
+    /// 消息类型
+    typedef decltype(std::declval<Parser&>().getData()) MessagePtr;
+
+    /**
+     * @brief 构造函数
+     * @param[in] stream 数据来源
+     */
+    HttpReader(Stream* stream)
+        :m_stream(stream) {
+    }
+
+    /**
+     * @brief 读取下一条消息的头部
+     * @param[in] buffer_size 读缓冲区的初始大小，也是单次读取的上限
+     * @param[in,out] limits 头部限制，失败原因写入limits->error，为空时不限制
+     * @return 对端关闭、读失败、协议错误或超出限制时返回nullptr
+     */
+    MessagePtr recvHeader(uint64_t buffer_size, HttpHeaderLimits* limits = nullptr) {
+        m_parser.reset(new Parser);
+        m_parser->setStreamBody(true);
+        if(!m_buffer) {
+            m_size = buffer_size;
+            m_buffer.reset(new char[m_size], [](char* ptr) {
+                delete[] ptr;
+            });
+        }
+        char* data = m_buffer.get();
+        bool need_read = (m_offset == 0);
+        // 头部阶段从第一个字节开始计时，等待下一个请求的空闲时间不算在内
+        uint64_t start = 0;
+        uint64_t received = m_offset;
+        uint64_t consumed = 0;
+        if(limits) {
+            limits->error = HttpHeaderLimits::OK;
+            if(m_offset) {
+                start = GetCurrentMS();
+                if(limits->onStart) {
+                    limits->onStart();
+                }
+            }
+        }
+        do {
+            if(need_read) {
+                if(m_offset == m_size) {
+                    // 半截的一行头部占满了缓冲区，没有超过头部上限时扩大缓冲区
+                    if(!limits || m_size >= limits->maxSize) {
+                        return fail(limits, HttpHeaderLimits::TOO_LARGE);
+                    }
+                    grow(std::min(m_size * 2, (size_t)limits->maxSize));
+                    data = m_buffer.get();
+                }
+                int len = m_stream->read(data + m_offset, m_size - m_offset);
+                if(len <= 0) {
+                    return fail(limits, HttpHeaderLimits::CLOSED);
+                }
+                m_offset += len;
+                received += len;
+                if(limits) {
+                    uint64_t now = GetCurrentMS();
+                    if(!start) {
+                        start = now;
+                        if(limits->onStart) {
+                            limits->onStart();
+                        }
+                    } else if(limits->minRate && now - start >= limits->rateGrace
+                            && received * 1000 < limits->minRate * (now - start)) {
+                        return fail(limits, HttpHeaderLimits::TOO_SLOW);
+                    }
+                }
+            }
+            size_t nparse = m_parser->execute(data, m_offset);
+            if(m_parser->hasError()) {
+                return fail(limits, HttpHeaderLimits::INVALID);
+            }
+            m_offset -= nparse;
+            consumed += nparse;
+            need_read = true;
+            if(limits && !m_parser->isHeaderFinished()) {
+                // 已解析的加上缓冲区里半截的头部
+                if(limits->maxSize && consumed + m_offset > limits->maxSize) {
+                    return fail(limits, HttpHeaderLimits::TOO_LARGE);
+                }
+                if(limits->maxCount && m_parser->getData()->getHeaders().size() > limits->maxCount) {
+                    return fail(limits, HttpHeaderLimits::TOO_MANY);
+                }
+            }
+        } while(!m_parser->isHeaderFinished());
+        if(limits && limits->maxCount
+                && m_parser->getData()->getHeaders().size() > limits->maxCount) {
+            return fail(limits, HttpHeaderLimits::TOO_MANY);
+        }
+        return m_parser->getData();
+    }
+
+    /**
+     * @brief 读取一段消息体
+     * @param[out] out 读到的数据，已去掉chunked编码
+     * @return >0 读到的字节数，=0 消息体结束，<0 对端提前关闭、读失败或协议错误
+     */
+    int readBody(std::string& out) {
+        out.clear();
+        char* data = m_buffer.get();
+        while(true) {
+            std::string& pending = m_parser->getStreamBody();
+            if(!pending.empty()) {
+                out.swap(pending);
+                return out.size();
+            }
+            if(m_parser->isFinished()) {
+                return 0;
+            }
+            int len = m_stream->read(data + m_offset, m_size - m_offset);
+            if(len < 0) {
+                return -1;
+            }
+            // len为0时把EOF交给解析器，以EOF结尾的响应由它判断为结束，其余情况会报错
+            m_offset += len;
+            size_t nparse = m_parser->execute(data, m_offset);
+            if(m_parser->hasError()) {
+                return -1;
+            }
+            m_offset -= nparse;
+            if(len == 0 && !m_parser->isFinished()) {
+                return -1;
+            }
+        }
+    }
+
+    /**
+     * @brief 读取剩余的全部消息体
+     * @param[out] body 消息体
+     * @param[in] max_size 消息体最大字节数
+     * @return 是否成功
+     */
+    bool recvBody(std::string& body, uint64_t max_size) {
+        std::string tmp;
+        int rt;
+        while((rt = readBody(tmp)) > 0) {
+            if(body.size() + tmp.size() > max_size) {
+                return false;
+            }
+            if(body.empty()) {
+                body.swap(tmp);
+            } else {
+                body.append(tmp);
+            }
+        }
+        return rt == 0;
+    }
+
+    /**
+     * @brief 消息体是否已经读完
+     */
+    bool isBodyFinished() const { return !m_parser || m_parser->isFinished();}
+
+    /**
+     * @brief 返回socket上尚未读取的消息体字节数
+     * @return 只有Content-Length确定、且已解析的数据都已取走时才返回剩余字节数，否则返回0
+     */
+    uint64_t getBodyLeft() const {
+        if(isBodyFinished() || m_parser->isChunked()
+                || !m_parser->getStreamBody().empty() || m_offset) {
+            return 0;
+        }
+        uint64_t left = m_parser->getParser().content_length;
+        return left == ULLONG_MAX ? 0 : left;
+    }
+
+    /**
+     * @brief 调用方已经直接从socket搬走了getBodyLeft()字节，当前消息结束
+     */
+    void setBodyConsumed() {
+        m_parser->setFinished(true);
+    }
+
+    /**
+     * @brief 缓冲区中是否还有属于后续消息的数据
+     */
+    bool hasBuffered() const { return m_offset > 0;}
+
+private:
+    /**
+     * @brief 记录失败原因
+     */
+    MessagePtr fail(HttpHeaderLimits* limits, HttpHeaderLimits::Error error) {
+        if(limits) {
+            limits->error = error;
+        }
+        return nullptr;
+    }
+private:
+    /**
+     * @brief 扩大读缓冲区，保留尚未解析的数据
+     */
+    void grow(size_t size) {
+        std::shared_ptr<char> buffer(new char[size], [](char* ptr) {
+            delete[] ptr;
+        });
+        memcpy(buffer.get(), m_buffer.get(), m_offset);
+        m_buffer = buffer;
+        m_size = size;
+    }
+private:
+    /// 数据来源
+    Stream* m_stream;
+    /// 当前消息的解析器
+    std::shared_ptr<Parser> m_parser;
+    /// 读缓冲区
+    std::shared_ptr<char> m_buffer;
+    /// 读缓冲区大小
+    size_t m_size = 0;
+    /// 读缓冲区中尚未解析的数据长度
+    size_t m_offset = 0;
+};
+
+}
+}
+
+#endif
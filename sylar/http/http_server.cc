@@ -1,31 +1,91 @@
 #include "http_server.h"
+#include <sys/ioctl.h>
+#include "../config.h"
 #include "../log.h"
+#include "../flight_recorder.h"
+#include "../metrics.h"
+#include "../probe.h"
+#include "../trace.h"
 //#include "servlets/config_servlet.h"
-//#include "servlets/status_servlet.h"
+#include "servlets/flight_recorder_servlet.h"
+#include "servlets/status_servlet.h"
 
 namespace sylar {
 namespace http {
 
 static sylar::Logger::ptr g_logger = SYLAR_LOG_NAME("system");
 
+static sylar::ConfigVar<bool>::ptr g_http_park_idle =
+    sylar::Config::Lookup("http.server.park_idle", false,
+            "park idle keepalive connections on the IOManager without a fiber");
+
+static sylar::ConfigVar<bool>::ptr g_http_admin =
+    sylar::Config::Lookup("http.server.admin", false,
+            "mount /_/status and /_/flight on every http server");
+
+static sylar::Gauge::ptr g_http_connections = sylar::MetricsMgr::GetInstance()->gauge(
+    "sylar_http_connections", "open http server connections");
+
+static sylar::Gauge::ptr g_http_parked = sylar::MetricsMgr::GetInstance()->gauge(
+    "sylar_http_parked_connections", "idle http connections parked without a fiber");
+
+static sylar::Histogram::ptr g_http_duration = sylar::MetricsMgr::GetInstance()->histogram(
+    "sylar_http_request_duration_seconds", "http request handling time");
+
+static sylar::Counter::ptr NewRequestCounter(const std::string& code) {
+    return sylar::MetricsMgr::GetInstance()->counter("sylar_http_requests_total"
+            , "http requests handled", {{"code", code}});
+}
+
+/// 按状态码类别(1xx~5xx)统计的请求数
+static sylar::Counter::ptr g_http_requests[5] = {
+    NewRequestCounter("1xx"),
+    NewRequestCounter("2xx"),
+    NewRequestCounter("3xx"),
+    NewRequestCounter("4xx"),
+    NewRequestCounter("5xx"),
+};
+
 HttpServer::HttpServer(bool keepalive
                ,sylar::IOManager* worker
                ,sylar::IOManager* io_worker
                ,sylar::IOManager* accept_worker)
     :TcpServer(io_worker, accept_worker)
-    ,m_isKeepalive(keepalive) {
+    ,m_isKeepalive(keepalive)
+    ,m_parkIdle(g_http_park_idle->getValue()) {
     m_dispatch.reset(new ServletDispatch);
+    m_headerDeadlines = std::make_shared<HeaderDeadlineQueue>(io_worker);
 
     m_type = "http";
-    //m_dispatch->addServlet("/_/status", Servlet::ptr(new StatusServlet));
     //m_dispatch->addServlet("/_/config", Servlet::ptr(new ConfigServlet));
 }
 
+bool HttpServer::start() {
+    if(g_http_admin->getValue()) {
+        addAdminServlets();
+    }
+    return TcpServer::start();
+}
+
+void HttpServer::addAdminServlets() {
+    if(!m_dispatch->getServlet("/_/status")) {
+        m_dispatch->addServlet("/_/status", Servlet::ptr(new StatusServlet));
+    }
+    if(!m_dispatch->getServlet("/_/flight")) {
+        m_dispatch->addServlet("/_/flight", Servlet::ptr(new FlightRecorderServlet));
+    }
+}
+
 void HttpServer::setName(const std::string& v) {
     TcpServer::setName(v);
     m_dispatch->setDefault(std::make_shared<NotFoundServlet>(v));
 }
 
+void HttpServer::stop() {
+    TcpServer::stop();
+    m_dispatch->close();
+}
+
 /*
     这个函数是TcpServer的handleClient函数，io调度主要执行的任务就是这个函数，
     将accept后得到的客户端套接字封装成HttpSession结构，以便于接收和发送HTTP消息。
@@ -33,26 +93,165 @@ void HttpServer::setName(const std::string& v) {
 void HttpServer::handleClient(Socket::ptr client) {
     SYLAR_LOG_DEBUG(g_logger) << "handleClient " << *client;
     HttpSession::ptr session(new HttpSession(client));
+    session->setHeaderDeadlines(m_headerDeadlines);
+    g_http_connections->inc();
+    serve(session);
+}
+
+namespace {
+
+/**
+ * @brief 停放中的连接，读事件和超时定时器谁先触发谁处理
+ */
+struct ParkedConn {
+    Spinlock mutex;
+    bool done = false;
+    Timer::ptr timer;
+};
+
+}
+
+bool HttpServer::park(HttpSession::ptr session) {
+    IOManager* iom = IOManager::GetThis();
+    int fd = session->getSocket()->getSocket();
+    // SSL库里可能还有解密好未读取的数据，socket上却不再可读，不停放
+    if(!iom || std::dynamic_pointer_cast<SSLSocket>(session->getSocket())) {
+        return false;
+    }
+    // 已经有数据到达时直接处理，省去一次epoll注册
+    int avail = 0;
+    if(ioctl(fd, FIONREAD, &avail) != 0 || avail > 0) {
+        return false;
+    }
+    std::shared_ptr<ParkedConn> parked = std::make_shared<ParkedConn>();
+    HttpServer::ptr self = std::static_pointer_cast<HttpServer>(shared_from_this());
+    g_http_parked->inc();
+    // 回调由IOManager放到新协程中执行，停放期间连接不占用协程
+    if(iom->addEvent(fd, IOManager::READ, [self, session, parked]() {
+                Spinlock::Lock lock(parked->mutex);
+                if(parked->done) {
+                    return;
+                }
+                parked->done = true;
+                Timer::ptr timer = parked->timer;
+                lock.unlock();
+                g_http_parked->dec();
+                if(timer) {
+                    timer->cancel();
+                }
+                self->serve(session, true);
+            })) {
+        g_http_parked->dec();
+        return false;
+    }
+    uint64_t timeout = getRecvTimeout();
+    if(timeout == 0 || timeout == (uint64_t)-1) {
+        return true;
+    }
+    Timer::ptr timer = iom->addTimer(timeout, [iom, fd, session, parked]() {
+                Spinlock::Lock lock(parked->mutex);
+                if(parked->done) {
+                    return;
+                }
+                parked->done = true;
+                lock.unlock();
+                g_http_parked->dec();
+                // 删除事件不触发回调，之后再关闭连接
+                iom->delEvent(fd, IOManager::READ);
+                SYLAR_LOG_DEBUG(g_logger) << "parked connection idle timeout: " << *session->getSocket();
+                session->close();
+                g_http_connections->dec();
+            });
+    Spinlock::Lock lock(parked->mutex);
+    if(parked->done) {
+        lock.unlock();
+        timer->cancel();
+    } else {
+        parked->timer = timer;
+    }
+    return true;
+}
+
+void HttpServer::serve(HttpSession::ptr session, bool readable) {
+    Socket::ptr client = session->getSocket();
     do {
-        auto req = session->recvRequest();
+        // 空闲时停放连接，协程结束，数据到达后在新协程中继续。
+        // 被读事件唤醒后先读一次，对方关闭连接时可读但没有数据，不能再次停放
+        if(!readable && m_parkIdle && !session->hasBuffered() && park(session)) {
+            return;
+        }
+        readable = false;
+        auto req = session->recvRequestHeader();
         if(!req) {
             SYLAR_LOG_DEBUG(g_logger) << "recv http request fail, errno="
                 << errno << " errstr=" << strerror(errno)
                 << " cliet:" << *client << " keep_alive=" << m_isKeepalive;
             break;
         }
-
+        uint64_t start = sylar::GetCurrentUS();
+        SYLAR_PROBE3(http_request_start, client->getSocket()
+                , HttpMethodToString(req->getMethod()), req->getPath().c_str());
+        FlightRecorder::Record(FlightRecorder::HTTP_START, client->getSocket(), 0);
+        // 延续调用方传来的traceparent，没有时开始新的调用链
+        SpanContext parent;
+        SpanContext::FromTraceparent(req->getHeader("traceparent"), parent);
+        Span span(std::string(HttpMethodToString(req->getMethod())) + " " + req->getPath()
+                    , parent, Span::SERVER);
         HttpResponse::ptr rsp(new HttpResponse(req->getVersion()
                             ,req->isClose() || !m_isKeepalive));
         rsp->setHeader("Server", getName());
-        m_dispatch->handle(req, rsp, session);
-        session->sendResponse(rsp);
+        // 过滤器在读取请求体之前执行，被拦截的请求不再读取消息体
+        auto chain = m_dispatch->getMatchedChain(req->getPath());
+        // 超出并发限制的请求直接返回503，不执行过滤器也不读取消息体
+        bool admitted = chain->acquire(rsp);
+        if(admitted) {
+            size_t passed = chain->before(req, rsp, session);
+            if(chain->isPassed(passed)) {
+                // 流式servlet自己读取消息体，其余servlet拿到的是完整的请求
+                if(!chain->isStreaming() && !session->recvBody(req)) {
+                    SYLAR_LOG_DEBUG(g_logger) << "recv http request body fail, errno="
+                        << errno << " errstr=" << strerror(errno)
+                        << " cliet:" << *client;
+                    chain->after(passed, req, rsp, session);
+                    chain->release(sylar::GetCurrentUS() - start, false);
+                    break;
+                }
+                chain->invoke(req, rsp, session);
+            }
+            chain->after(passed, req, rsp, session);
+        }
+        // 在发送响应前计数，客户端收到响应时统计已经可见
+        uint64_t used = sylar::GetCurrentUS() - start;
+        if(admitted) {
+            chain->release(used);
+        }
+        // 流式处理的消息体不在body里，优先按Content-Length统计
+        chain->getStats()->record(used
+                , req->getHeaderAs<uint64_t>("Content-Length", req->getBody().size())
+                , rsp->getHeaderAs<uint64_t>("Content-Length", rsp->getBody().size())
+                , (int)rsp->getStatus());
+        int code = (int)rsp->getStatus() / 100;
+        g_http_requests[code >= 1 && code <= 5 ? code - 1 : 4]->inc();
+        g_http_duration->observe(used / 1000000.0);
+        if(!session->isResponseSent()) {
+            if(!session->isBodyFinished()) {
+                rsp->setClose(true);
+            }
+            session->sendResponse(rsp);
+        }
+        span.setStatus((int32_t)rsp->getStatus());
+        SYLAR_PROBE3(http_request_end, client->getSocket()
+                , (int)rsp->getStatus(), used);
+        FlightRecorder::Record(FlightRecorder::HTTP_END, client->getSocket(), (uint64_t)rsp->getStatus());
 
-        if(!m_isKeepalive || req->isClose()) {
+        // 消息体没有读完的连接无法再解析下一个请求
+        if(!m_isKeepalive || req->isClose() || rsp->isClose()
+                || !session->isBodyFinished()) {
             break;
         }
     } while(true);
     session->close();
+    g_http_connections->dec();
 }
 
 }
@@ -48,11 +48,58 @@ public:
     void setServletDispatch(ServletDispatch::ptr v) { m_dispatch = v;}
 
     virtual void setName(const std::string& v) override;
+
+    /**
+     * @brief 启动服务，配置http.server.admin打开时先挂上管理接口
+     */
+    virtual bool start() override;
+
+    /**
+     * @brief 挂上管理接口/_/status(指标)和/_/flight(飞行记录)
+     * @details 接口没有访问控制，默认不挂。可以单独起一个只绑定内网/本机地址的
+     *          HttpServer作为管理端口并调用本方法。已经被用户精确注册的路径不会被覆盖
+     */
+    void addAdminServlets();
+
+    /**
+     * @brief 停止服务，并关闭所有servlet
+     */
+    virtual void stop() override;
+
+    /**
+     * @brief 是否停放空闲的长连接
+     */
+    bool isParkIdle() const { return m_parkIdle;}
+
+    /**
+     * @brief 设置是否停放空闲的长连接，默认取配置http.server.park_idle
+     * @details 停放时连接只在IOManager上注册一个读事件回调，不占用协程和协程栈，
+     *          收到数据后才在新协程中处理请求，响应发出后协程结束、栈回到缓存。
+     *          大量空闲长连接时可以省下每个连接一个协程栈(默认128K)的内存，
+     *          代价是每个请求多一次epoll注册和协程创建。SSL连接不停放
+     */
+    void setParkIdle(bool v) { m_parkIdle = v;}
 protected:
     virtual void handleClient(Socket::ptr client) override;
+
+    /**
+     * @brief 处理连接上的请求，连接空闲时停放并返回
+     * @param[in] readable 是否被读事件唤醒，是则先读取请求而不是停放
+     */
+    void serve(HttpSession::ptr session, bool readable = false);
+
+    /**
+     * @brief 停放空闲连接，数据到达时在新协程中继续serve，超过接收超时时间后关闭连接
+     * @return 是否停放成功
+     */
+    bool park(HttpSession::ptr session);
 private:
     /// 是否支持长连接
     bool m_isKeepalive;
+    /// 是否停放空闲的长连接
+    bool m_parkIdle;
+    /// 所有连接共用的请求头截止时间队列
+    HeaderDeadlineQueue::ptr m_headerDeadlines;
     /// Servlet分发器
     ServletDispatch::ptr m_dispatch;
 };
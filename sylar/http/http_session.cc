@@ -1,74 +1,215 @@
 #include "http_session.h"
+#include <sys/socket.h>
+#include <algorithm>
 #include "http_parser.h"
+#include "../config.h"
+#include "../log.h"
+#include "../metrics.h"
 
 namespace sylar {
 namespace http {
 
-HttpSession::HttpSession(Socket::ptr sock, bool owner)
-    : SocketStream(sock, owner) {
-}
+static sylar::Logger::ptr g_logger = SYLAR_LOG_NAME("system");
 
-HttpRequest::ptr HttpSession::recvRequest() {
-    HttpRequestParser::ptr parser(new HttpRequestParser);
-    uint64_t buff_size = HttpRequestParser::GetHttpRequestBufferSize();
-    std::shared_ptr<char> buffer(
-        new char[buff_size], [](char *ptr) {
-            delete[] ptr;
+static sylar::ConfigVar<uint64_t>::ptr g_header_timeout =
+    sylar::Config::Lookup("http.server.header_timeout_ms", (uint64_t)10000,
+            "max time from the first byte of a request to the end of its header, 0 disables");
+
+static sylar::ConfigVar<uint64_t>::ptr g_header_min_rate =
+    sylar::Config::Lookup("http.server.header_min_rate", (uint64_t)100,
+            "min bytes per second while receiving a request header, 0 disables");
+
+static sylar::ConfigVar<uint64_t>::ptr g_header_rate_grace =
+    sylar::Config::Lookup("http.server.header_rate_grace_ms", (uint64_t)2000,
+            "time before header_min_rate is enforced");
+
+static sylar::ConfigVar<uint32_t>::ptr g_max_header_count =
+    sylar::Config::Lookup("http.server.max_header_count", (uint32_t)100,
+            "max header fields in a request, 0 disables");
+
+static sylar::ConfigVar<uint64_t>::ptr g_max_header_size =
+    sylar::Config::Lookup("http.server.max_header_size", (uint64_t)(16 * 1024),
+            "max bytes of a request header, 0 disables");
+
+static uint64_t s_header_timeout = 0;
+static uint64_t s_header_min_rate = 0;
+static uint64_t s_header_rate_grace = 0;
+static uint32_t s_max_header_count = 0;
+static uint64_t s_max_header_size = 0;
+
+namespace {
+struct _HeaderLimitsIniter {
+    _HeaderLimitsIniter() {
+        s_header_timeout = g_header_timeout->getValue();
+        s_header_min_rate = g_header_min_rate->getValue();
+        s_header_rate_grace = g_header_rate_grace->getValue();
+        s_max_header_count = g_max_header_count->getValue();
+        s_max_header_size = g_max_header_size->getValue();
+
+        g_header_timeout->addListener([](const uint64_t& ov, const uint64_t& nv) {
+            s_header_timeout = nv;
+        });
+        g_header_min_rate->addListener([](const uint64_t& ov, const uint64_t& nv) {
+            s_header_min_rate = nv;
         });
-    char *data = buffer.get();
-    int offset = 0;
-    do {
-        int len = read(data + offset, buff_size - offset);
-        if (len <= 0) {
-            close();
-            return nullptr;
+        g_header_rate_grace->addListener([](const uint64_t& ov, const uint64_t& nv) {
+            s_header_rate_grace = nv;
+        });
+        g_max_header_count->addListener([](const uint32_t& ov, const uint32_t& nv) {
+            s_max_header_count = nv;
+        });
+        g_max_header_size->addListener([](const uint64_t& ov, const uint64_t& nv) {
+            s_max_header_size = nv;
+        });
+    }
+};
+
+static _HeaderLimitsIniter s_header_limits_initer;
+}
+
+static sylar::Counter::ptr NewRejectedCounter(const std::string& reason) {
+    return sylar::MetricsMgr::GetInstance()->counter("sylar_http_header_rejected_total"
+            , "requests rejected while receiving the header", {{"reason", reason}});
+}
+
+static sylar::Counter::ptr g_rejected_timeout = NewRejectedCounter("timeout");
+static sylar::Counter::ptr g_rejected_slow = NewRejectedCounter("slow");
+static sylar::Counter::ptr g_rejected_too_large = NewRejectedCounter("too_large");
+static sylar::Counter::ptr g_rejected_too_many = NewRejectedCounter("too_many");
+
+HeaderDeadlineQueue::HeaderDeadlineQueue(IOManager* iom)
+    :m_iom(iom) {
+}
+
+HeaderDeadlineQueue::Token::ptr HeaderDeadlineQueue::add(Socket::ptr sock, uint64_t timeout_ms) {
+    Token::ptr token = std::make_shared<Token>();
+    uint64_t now = GetCurrentMS();
+    MutexType::Lock lock(m_mutex);
+    m_entries.push_back({now + timeout_ms, sock, token});
+    if(!m_armed) {
+        arm(now);
+    }
+    return token;
+}
+
+size_t HeaderDeadlineQueue::size() {
+    MutexType::Lock lock(m_mutex);
+    return m_entries.size();
+}
+
+void HeaderDeadlineQueue::arm(uint64_t now) {
+    if(m_entries.empty() || !m_iom) {
+        m_armed = false;
+        return;
+    }
+    m_armed = true;
+    uint64_t deadline = m_entries.front().deadline;
+    // 已完成的请求不会提前出队，最多等1秒，队列空了IOManager才能退出
+    uint64_t delay = deadline > now ? std::min(deadline - now, (uint64_t)1000) : 0;
+    std::weak_ptr<HeaderDeadlineQueue> weak(shared_from_this());
+    m_iom->addConditionTimer(delay, std::bind(&HeaderDeadlineQueue::onTimer, this), weak);
+}
+
+void HeaderDeadlineQueue::onTimer() {
+    std::vector<Socket::ptr> expired;
+    uint64_t now = GetCurrentMS();
+    MutexType::Lock lock(m_mutex);
+    while(!m_entries.empty()) {
+        Entry& entry = m_entries.front();
+        if(entry.token->done) {
+            m_entries.pop_front();
+            continue;
         }
-        len += offset;
-        size_t nparse = parser->execute(data, len);
-        if (parser->hasError()) {
-            close();
-            return nullptr;
+        if(entry.deadline > now) {
+            break;
         }
-        offset = len - nparse;
-        if (offset == (int)buff_size) {
-            close();
-            return nullptr;
+        Socket::ptr sock = entry.sock.lock();
+        if(sock) {
+            expired.push_back(sock);
         }
-        if (parser->isFinished()) {
-            break;
+        m_entries.pop_front();
+    }
+    arm(now);
+    lock.unlock();
+    for(auto& i : expired) {
+        SYLAR_LOG_DEBUG(g_logger) << "http header timeout: " << *i;
+        g_rejected_timeout->inc();
+        // 连接仍归读取它的协程所有，这里只shutdown，fd的关闭由它负责
+        ::shutdown(i->getSocket(), SHUT_RDWR);
+    }
+}
+
+HttpSession::HttpSession(Socket::ptr sock, bool owner)
+    : SocketStream(sock, owner)
+    , m_reader(this) {
+}
+
+HttpRequest::ptr HttpSession::recvRequest() {
+    HttpRequest::ptr req = recvRequestHeader();
+    if (!req || !recvBody(req)) {
+        return nullptr;
+    }
+    return req;
+}
+
+HttpRequest::ptr HttpSession::recvRequestHeader() {
+    m_responseSent = false;
+    HttpHeaderLimits limits;
+    limits.maxSize = s_max_header_size;
+    limits.maxCount = s_max_header_count;
+    limits.minRate = s_header_min_rate;
+    limits.rateGrace = s_header_rate_grace;
+    HeaderDeadlineQueue::Token::ptr token;
+    uint64_t timeout = s_header_timeout;
+    if (m_headerDeadlines && timeout) {
+        limits.onStart = [this, &token, timeout]() {
+            token = m_headerDeadlines->add(getSocket(), timeout);
+        };
+    }
+    HttpRequest::ptr req = m_reader.recvHeader(HttpRequestParser::GetHttpRequestBufferSize(), &limits);
+    if (token) {
+        token->done = true;
+    }
+    if (!req) {
+        HttpStatus status = HttpStatus::OK;
+        if (limits.error == HttpHeaderLimits::TOO_LARGE) {
+            g_rejected_too_large->inc();
+            status = HttpStatus::REQUEST_HEADER_FIELDS_TOO_LARGE;
+        } else if (limits.error == HttpHeaderLimits::TOO_MANY) {
+            g_rejected_too_many->inc();
+            status = HttpStatus::REQUEST_HEADER_FIELDS_TOO_LARGE;
+        } else if (limits.error == HttpHeaderLimits::TOO_SLOW) {
+            g_rejected_slow->inc();
+            status = HttpStatus::REQUEST_TIMEOUT;
+        }
+        if (status != HttpStatus::OK) {
+            SYLAR_LOG_DEBUG(g_logger) << "reject http header: " << HttpStatusToString(status)
+                << " " << *getSocket();
+            HttpResponse::ptr rsp(new HttpResponse(0x11, true));
+            rsp->setStatus(status);
+            sendResponse(rsp);
         }
-    } while (true);
-
-    // 与sylar的HTTP解析库不一样的是，nodejs/http-parser解析结束时body部分已经解析完了，所以这里不再需要单独读取body
-    
-    // int64_t length = parser->getContentLength();
-    // if (length > 0) {
-    //     std::string body;
-    //     body.resize(length);
-
-    //     int len = 0;
-    //     if (length >= offset) {
-    //         memcpy(&body[0], data, offset);
-    //         len = offset;
-    //     } else {
-    //         memcpy(&body[0], data, length);
-    //         len = length;
-    //     }
-    //     length -= offset;
-    //     if (length > 0) {
-    //         if (readFixSize(&body[len], length) <= 0) {
-    //             close();
-    //             return nullptr;
-    //         }
-    //     }
-    //     parser->getData()->setBody(body);
-    // }
-    
-    parser->getData()->init();
-    return parser->getData();
+        close();
+        return nullptr;
+    }
+    req->init();
+    return req;
+}
+
+bool HttpSession::recvBody(HttpRequest::ptr req) {
+    std::string body;
+    if (!m_reader.recvBody(body, HttpRequestParser::GetHttpRequestMaxBodySize())) {
+        close();
+        return false;
+    }
+    if (!body.empty()) {
+        req->setBody(body);
+    }
+    return true;
 }
 
 int HttpSession::sendResponse(HttpResponse::ptr rsp) {
+    m_responseSent = true;
     std::stringstream ss;
     ss << *rsp;
     std::string data = ss.str();
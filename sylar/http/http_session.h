@@ -10,14 +10,97 @@
 #ifndef __SYLAR_HTTP_SESSION_H__
 #define __SYLAR_HTTP_SESSION_H__
 
+#include <atomic>
+#include <deque>
+#include "../iomanager.h"
 #include "../streams/socket_stream.h"
 #include "http.h"
+#include "http_reader.h"
 
 namespace sylar {
 namespace http {
 
+/**
+ * @brief 请求头阶段的截止时间检查
+ * @details 所有连接的头部超时时间相同(http.server.header_timeout_ms)，截止时间按加入的顺序递增，
+ *          一个FIFO队列加一个定时器就能检查全部连接，不用每个请求创建一个定时器。
+ *          到期仍未读完头部的连接被shutdown，阻塞在read上的协程随即返回。
+ *          读完头部的请求只做标记，由定时器顺带出队，定时器间隔不超过1秒，队列为空时不再设置
+ */
+class HeaderDeadlineQueue : public std::enable_shared_from_this<HeaderDeadlineQueue> {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<HeaderDeadlineQueue> ptr;
+    /// 锁类型定义
+    typedef Spinlock MutexType;
+
+    /**
+     * @brief 一个请求的头部阶段
+     */
+    struct Token {
+        /// 智能指针类型定义
+        typedef std::shared_ptr<Token> ptr;
+        /// 头部是否已读完
+        std::atomic<bool> done = {false};
+    };
+
+    /**
+     * @brief 构造函数
+     * @param[in] iom 设置定时器的IOManager
+     */
+    HeaderDeadlineQueue(IOManager* iom);
+
+    /**
+     * @brief 开始一个请求的头部阶段
+     * @param[in] sock 连接
+     * @param[in] timeout_ms 超时时间(毫秒)
+     * @return 读完头部后把done置为true
+     */
+    Token::ptr add(Socket::ptr sock, uint64_t timeout_ms);
+
+    /**
+     * @brief 返回队列中的请求数，包括已读完头部尚未出队的
+     */
+    size_t size();
+private:
+    /**
+     * @brief 设置定时器，调用方持有锁
+     */
+    void arm(uint64_t now);
+
+    /**
+     * @brief 处理到期的请求
+     */
+    void onTimer();
+private:
+    /**
+     * @brief 队列中的请求
+     */
+    struct Entry {
+        /// 截止时间(毫秒)
+        uint64_t deadline;
+        /// 连接
+        std::weak_ptr<Socket> sock;
+        /// 头部阶段
+        Token::ptr token;
+    };
+
+    /// 设置定时器的IOManager
+    IOManager* m_iom;
+    /// 保护以下成员
+    MutexType m_mutex;
+    /// 按截止时间排列的请求
+    std::deque<Entry> m_entries;
+    /// 是否已设置定时器
+    bool m_armed = false;
+};
+
 /**
  * @brief HTTPSession封装,接受HTTP请求由HttpRequestParser解析,还可以发送HTTP响应
+ * @details 读取请求头时按配置限制头部阶段的总时间(http.server.header_timeout_ms，需要setHeaderDeadlines)、
+ *          最低速率(http.server.header_min_rate)、字段数(http.server.max_header_count)
+ *          和字节数(http.server.max_header_size)，慢速或超大的请求头不会长时间占着协程和缓冲区。
+ *          读缓冲区初始为http.request.buffer_size，单行头部放不下时按需扩大，最大到max_header_size
  */
 class HttpSession : public SocketStream {
 public:
@@ -36,14 +119,72 @@ public:
      */
     HttpRequest::ptr recvRequest();
 
+    /**
+     * @brief 只接收HTTP请求头，消息体之后用readBody()流式读取，或用recvBody()一次读完
+     * @details 头部过大或字段过多时回复431，速率过低时回复408，之后关闭连接
+     */
+    HttpRequest::ptr recvRequestHeader();
+
+    /**
+     * @brief 设置检查头部阶段截止时间的队列，为空时不限制头部阶段的总时间
+     */
+    void setHeaderDeadlines(HeaderDeadlineQueue::ptr v) { m_headerDeadlines = v;}
+
+    /**
+     * @brief 把剩余的请求消息体读入req
+     * @return 对端关闭、读失败、协议错误或超过http.request.max_body_size时返回false
+     */
+    bool recvBody(HttpRequest::ptr req);
+
+    /**
+     * @brief 流式读取一段请求消息体
+     * @param[out] out 读到的数据，已去掉chunked编码
+     * @return >0 读到的字节数，=0 消息体结束，<0 出错
+     */
+    int readBody(std::string& out) { return m_reader.readBody(out);}
+
+    /**
+     * @brief 请求消息体是否已经读完
+     */
+    bool isBodyFinished() const { return m_reader.isBodyFinished();}
+
+    /**
+     * @brief 返回socket上尚未读取的请求消息体字节数，参考HttpReader::getBodyLeft
+     */
+    uint64_t getBodyLeft() const { return m_reader.getBodyLeft();}
+
+    /**
+     * @brief 调用方已经直接从socket搬走了getBodyLeft()字节
+     */
+    void setBodyConsumed() { m_reader.setBodyConsumed();}
+
+    /**
+     * @brief 读取器中是否还有已读入未解析的数据(如流水线上的下一个请求)
+     */
+    bool hasBuffered() const { return m_reader.hasBuffered();}
+
     /**
      * @brief 发送HTTP响应
+     * @details 响应的消息体为空时只发送头部，调用方可以接着用write写消息体
      * @param[in] rsp HTTP响应
      * @return >0 发送成功
      *         =0 对方关闭
      *         <0 Socket异常
      */
     int sendResponse(HttpResponse::ptr rsp);
+
+    /**
+     * @brief 当前请求的响应是否已经发出
+     */
+    bool isResponseSent() const { return m_responseSent;}
+
+private:
+    /// 请求读取器
+    HttpReader<HttpRequestParser> m_reader;
+    /// 当前请求的响应是否已经发出
+    bool m_responseSent = false;
+    /// 检查头部阶段截止时间的队列
+    HeaderDeadlineQueue::ptr m_headerDeadlines;
 };
 
 }
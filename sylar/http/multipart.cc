@@ -0,0 +1,373 @@
+#include "multipart.h"
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "../log.h"
+#include "../util.h"
+
+namespace sylar {
+namespace http {
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_NAME("system");
+
+/**
+ * @brief 解析形如 type; key=value; key="quoted value" 的头部值
+ * @param[out] params 参数，key不区分大小写
+ * @return 第一个分号之前的部分
+ */
+static std::string ParseHeaderParams(const std::string& value, HttpRequest::MapType& params) {
+    size_t pos = value.find(';');
+    std::string type = StringUtil::Trim(value.substr(0, pos));
+    while(pos < value.size()) {
+        ++pos;
+        size_t eq = value.find('=', pos);
+        size_t semi = value.find(';', pos);
+        if(eq == std::string::npos || eq > semi) {
+            pos = semi;
+            continue;
+        }
+        std::string key = StringUtil::Trim(value.substr(pos, eq - pos));
+        pos = eq + 1;
+        while(pos < value.size() && (value[pos] == ' ' || value[pos] == '\t')) {
+            ++pos;
+        }
+        std::string val;
+        if(pos < value.size() && value[pos] == '"') {
+            // 引号内的分号不是分隔符，反斜杠转义下一个字符
+            for(++pos; pos < value.size() && value[pos] != '"'; ++pos) {
+                if(value[pos] == '\\' && pos + 1 < value.size()) {
+                    ++pos;
+                }
+                val.append(1, value[pos]);
+            }
+            pos = value.find(';', pos);
+        } else {
+            semi = value.find(';', pos);
+            val = StringUtil::Trim(value.substr(pos, semi == std::string::npos
+                                    ? std::string::npos : semi - pos));
+            pos = semi;
+        }
+        if(!key.empty()) {
+            params[key] = val;
+        }
+    }
+    return type;
+}
+
+std::string MultipartParser::GetBoundary(const std::string& content_type) {
+    HttpRequest::MapType params;
+    std::string type = ParseHeaderParams(content_type, params);
+    if(strncasecmp(type.c_str(), "multipart/", 10) != 0) {
+        return "";
+    }
+    auto it = params.find("boundary");
+    // RFC 2046限制boundary最长70个字符
+    if(it == params.end() || it->second.size() > 70) {
+        return "";
+    }
+    return it->second;
+}
+
+MultipartParser::MultipartParser(const std::string& boundary, uint64_t max_header_size)
+    :m_delimiter("\r\n--" + boundary)
+    ,m_maxHeaderSize(max_header_size)
+    // 第一个分隔符前面可能没有CRLF，补上后所有分隔符的格式相同
+    ,m_buffer("\r\n") {
+}
+
+bool MultipartParser::execute(const char* data, size_t len) {
+    if(m_state == ERROR) {
+        return false;
+    }
+    if(m_state == FINISHED) {
+        return true;
+    }
+    if(m_buffer.empty()) {
+        // 没有遗留数据时直接在调用方的数据上解析，只拷贝末尾不完整的部分
+        size_t n = parse(data, len);
+        if(m_state == ERROR) {
+            return false;
+        }
+        m_buffer.assign(data + n, len - n);
+    } else {
+        m_buffer.append(data, len);
+        size_t n = parse(m_buffer.c_str(), m_buffer.size());
+        if(m_state == ERROR) {
+            return false;
+        }
+        m_buffer.erase(0, n);
+    }
+    return true;
+}
+
+bool MultipartParser::readFrom(HttpSession::ptr session) {
+    std::string data;
+    while(true) {
+        int rt = session->readBody(data);
+        if(rt < 0) {
+            return false;
+        }
+        if(rt == 0) {
+            break;
+        }
+        if(!execute(data.c_str(), data.size())) {
+            return false;
+        }
+    }
+    if(!isFinished()) {
+        SYLAR_LOG_DEBUG(g_logger) << "multipart body ends before the close delimiter";
+        fail(INVALID);
+        return false;
+    }
+    return true;
+}
+
+size_t MultipartParser::findDelimiter(const char* data, size_t len, size_t& partial) const {
+    const char* delim = m_delimiter.c_str();
+    size_t dlen = m_delimiter.size();
+    const char* end = data + len;
+    const char* p = data;
+#ifdef __SSE2__
+    // 一次检查16个起始位置：首字节和末字节同时相等时才比较中间部分，
+    // 只处理分隔符能完整放下的位置，剩下的末尾交给下面的循环
+    const __m128i first = _mm_set1_epi8(delim[0]);
+    const __m128i last = _mm_set1_epi8(delim[dlen - 1]);
+    while(end - p >= (ptrdiff_t)(dlen + 15)) {
+        __m128i a = _mm_loadu_si128((const __m128i*)p);
+        __m128i b = _mm_loadu_si128((const __m128i*)(p + dlen - 1));
+        unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first)
+                                                        , _mm_cmpeq_epi8(b, last)));
+        while(mask) {
+            int i = __builtin_ctz(mask);
+            if(memcmp(p + i + 1, delim + 1, dlen - 2) == 0) {
+                return p + i - data;
+            }
+            mask &= mask - 1;
+        }
+        p += 16;
+    }
+#endif
+    while(p < end && (p = (const char*)memchr(p, '\r', end - p))) {
+        size_t left = end - p;
+        if(left >= dlen) {
+            if(memcmp(p, delim, dlen) == 0) {
+                return p - data;
+            }
+        } else if(memcmp(p, delim, left) == 0) {
+            partial = p - data;
+            return len;
+        }
+        ++p;
+    }
+    partial = len;
+    return len;
+}
+
+bool MultipartParser::parseHeaderLine(const char* data, size_t len) {
+    const char* colon = (const char*)memchr(data, ':', len);
+    if(!colon) {
+        return false;
+    }
+    std::string name = StringUtil::Trim(std::string(data, colon - data));
+    if(name.empty()) {
+        return false;
+    }
+    m_part.headers[name] = StringUtil::Trim(std::string(colon + 1, data + len - colon - 1));
+    return true;
+}
+
+size_t MultipartParser::fail(Error error) {
+    m_state = ERROR;
+    m_error = error;
+    return 0;
+}
+
+size_t MultipartParser::parse(const char* data, size_t len) {
+    size_t pos = 0;
+    while(pos < len) {
+        switch(m_state) {
+            case PREAMBLE: {
+                size_t partial = 0;
+                size_t i = findDelimiter(data + pos, len - pos, partial);
+                if(i == len - pos) {
+                    return pos + partial;
+                }
+                pos += i + m_delimiter.size();
+                m_state = BOUNDARY;
+                break;
+            }
+            case BOUNDARY: {
+                // 分隔符后紧跟"--"表示结束，否则是可选的空白和CRLF
+                if(len - pos < 2) {
+                    return pos;
+                }
+                if(data[pos] == '-' && data[pos + 1] == '-') {
+                    m_state = FINISHED;
+                    return len;
+                }
+                size_t i = pos;
+                while(i < len && (data[i] == ' ' || data[i] == '\t')) {
+                    ++i;
+                }
+                if(i - pos > 256) {
+                    return fail(INVALID);
+                }
+                if(len - i < 2) {
+                    return pos;
+                }
+                if(data[i] != '\r' || data[i + 1] != '\n') {
+                    return fail(INVALID);
+                }
+                pos = i + 2;
+                m_part = Part();
+                m_headerSize = 0;
+                m_state = HEADER;
+                break;
+            }
+            case HEADER: {
+                const char* end = data + len;
+                const char* eol = data + pos;
+                while((eol = (const char*)memchr(eol, '\r', end - eol))
+                        && eol + 1 < end && eol[1] != '\n') {
+                    ++eol;
+                }
+                if(!eol || eol + 1 >= end) {
+                    if(m_headerSize + (len - pos) > m_maxHeaderSize) {
+                        return fail(TOO_LARGE);
+                    }
+                    return pos;
+                }
+                size_t line = eol - data - pos;
+                m_headerSize += line + 2;
+                if(m_headerSize > m_maxHeaderSize) {
+                    return fail(TOO_LARGE);
+                }
+                if(line) {
+                    if(!parseHeaderLine(data + pos, line)) {
+                        return fail(INVALID);
+                    }
+                    pos += line + 2;
+                    break;
+                }
+                pos += 2;
+                HttpRequest::MapType params;
+                auto it = m_part.headers.find("Content-Disposition");
+                if(it != m_part.headers.end()) {
+                    ParseHeaderParams(it->second, params);
+                }
+                m_part.name = params["name"];
+                m_part.filename = params["filename"];
+                // RFC 5987: filename*=UTF-8''%e2%82%ac.txt
+                auto ext = params.find("filename*");
+                if(m_part.filename.empty() && ext != params.end()) {
+                    size_t quote = ext->second.find('\'', ext->second.find('\'') + 1);
+                    if(quote != std::string::npos) {
+                        m_part.filename = StringUtil::UrlDecode(ext->second.substr(quote + 1), false);
+                    }
+                }
+                it = m_part.headers.find("Content-Type");
+                m_part.contentType = it == m_part.headers.end() ? "" : it->second;
+                ++m_partCount;
+                if(m_onPartBegin && !m_onPartBegin(m_part)) {
+                    return fail(ABORTED);
+                }
+                m_state = BODY;
+                break;
+            }
+            case BODY: {
+                // 末尾可能是分隔符前缀的几个字节留到下一次，其余的内容立即交给调用方
+                size_t partial = 0;
+                size_t i = findDelimiter(data + pos, len - pos, partial);
+                bool found = i != len - pos;
+                size_t n = found ? i : partial;
+                if(n && m_onPartData && !m_onPartData(data + pos, n)) {
+                    return fail(ABORTED);
+                }
+                if(!found) {
+                    return pos + n;
+                }
+                pos += i + m_delimiter.size();
+                if(m_onPartEnd && !m_onPartEnd()) {
+                    return fail(ABORTED);
+                }
+                m_state = BOUNDARY;
+                break;
+            }
+            default:
+                return len;
+        }
+    }
+    return pos;
+}
+
+FormUrlencodedParser::FormUrlencodedParser(ParamCb cb, uint64_t max_param_size)
+    :m_cb(cb)
+    ,m_maxParamSize(max_param_size) {
+}
+
+bool FormUrlencodedParser::emit() {
+    size_t eq = m_param.find('=');
+    // 与HttpRequest::initBodyParam一致，没有'='的参数忽略
+    bool rt = true;
+    if(eq != std::string::npos) {
+        rt = m_cb(StringUtil::UrlDecode(m_param.substr(0, eq))
+                , StringUtil::UrlDecode(m_param.substr(eq + 1)));
+    }
+    m_param.clear();
+    if(!rt) {
+        m_error = true;
+    }
+    return rt;
+}
+
+bool FormUrlencodedParser::execute(const char* data, size_t len) {
+    if(m_error) {
+        return false;
+    }
+    const char* end = data + len;
+    while(data < end) {
+        const char* amp = (const char*)memchr(data, '&', end - data);
+        const char* stop = amp ? amp : end;
+        if(m_param.size() + (stop - data) > m_maxParamSize) {
+            m_error = true;
+            return false;
+        }
+        m_param.append(data, stop - data);
+        if(!amp) {
+            break;
+        }
+        if(!emit()) {
+            return false;
+        }
+        data = amp + 1;
+    }
+    return true;
+}
+
+bool FormUrlencodedParser::finish() {
+    if(m_error) {
+        return false;
+    }
+    return emit();
+}
+
+bool FormUrlencodedParser::readFrom(HttpSession::ptr session) {
+    std::string data;
+    while(true) {
+        int rt = session->readBody(data);
+        if(rt < 0) {
+            return false;
+        }
+        if(rt == 0) {
+            break;
+        }
+        if(!execute(data.c_str(), data.size())) {
+            return false;
+        }
+    }
+    return finish();
+}
+
+}
+}
@@ -0,0 +1,245 @@
+/**
+ * @file multipart.h
+ * @brief 流式解析multipart/form-data和application/x-www-form-urlencoded消息体
+ * @version 0.1
+ * @date 2026-10-19
+ */
+#ifndef __SYLAR_HTTP_MULTIPART_H__
+#define __SYLAR_HTTP_MULTIPART_H__
+
+#include <functional>
+#include <memory>
+#include <string>
+#include "http.h"
+#include "http_session.h"
+
+namespace sylar {
+namespace http {
+
+/**
+ * @brief multipart/form-data流式解析器
+ * @details 消息体分段喂给execute()，每个part的头部解析完后回调onPartBegin，
+ *          内容按到达的顺序回调onPartData，不会缓存整个part，上传的文件可以边收边写盘或转发。
+ *          解析器只保留可能是分隔符前缀的末尾几个字节和未完整的part头部。
+ *          分隔符在SSE2下每次取16个位置，同时比较分隔符的首字节'\r'和末字节，两者都命中才逐字节比较，
+ *          二进制内容里随机出现的'\r'几乎不会触发比较；没有SSE2时用memchr查找'\r'再比较
+ */
+class MultipartParser {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<MultipartParser> ptr;
+
+    /**
+     * @brief 一个part的头部信息
+     */
+    struct Part {
+        /// part的全部头部
+        HttpRequest::MapType headers;
+        /// Content-Disposition中的name
+        std::string name;
+        /// Content-Disposition中的filename(或filename*)，普通字段为空。由客户端提供，写盘前需要自行校验
+        std::string filename;
+        /// Content-Type，未设置时为空
+        std::string contentType;
+
+        /**
+         * @brief 是否为上传的文件
+         */
+        bool isFile() const { return !filename.empty();}
+    };
+
+    /**
+     * @brief 解析错误
+     */
+    enum Error {
+        /// 成功
+        OK = 0,
+        /// 格式错误
+        INVALID,
+        /// part头部过大
+        TOO_LARGE,
+        /// 回调返回false中止解析
+        ABORTED
+    };
+
+    /// part开始回调，返回false中止解析
+    typedef std::function<bool(const Part& part)> PartBeginCb;
+    /// part内容回调，一个part的内容可能分多次回调，返回false中止解析
+    typedef std::function<bool(const char* data, size_t len)> PartDataCb;
+    /// part结束回调，返回false中止解析
+    typedef std::function<bool()> PartEndCb;
+
+    /**
+     * @brief 从Content-Type中取出boundary
+     * @param[in] content_type 如multipart/form-data; boundary="abc"
+     * @return 不是multipart或没有boundary时返回空串
+     */
+    static std::string GetBoundary(const std::string& content_type);
+
+    /**
+     * @brief 构造函数
+     * @param[in] boundary 分隔符，不含前导的"--"
+     * @param[in] max_header_size 单个part头部的最大字节数
+     */
+    MultipartParser(const std::string& boundary, uint64_t max_header_size = 8 * 1024);
+
+    /**
+     * @brief 设置part开始回调
+     */
+    void setOnPartBegin(PartBeginCb v) { m_onPartBegin = v;}
+
+    /**
+     * @brief 设置part内容回调
+     */
+    void setOnPartData(PartDataCb v) { m_onPartData = v;}
+
+    /**
+     * @brief 设置part结束回调
+     */
+    void setOnPartEnd(PartEndCb v) { m_onPartEnd = v;}
+
+    /**
+     * @brief 解析一段消息体
+     * @details 数据不需要按part或行对齐，不完整的部分留到下一次
+     * @return 出错时返回false，原因见getError()
+     */
+    bool execute(const char* data, size_t len);
+
+    /**
+     * @brief 从session流式读取剩余的请求消息体并解析
+     * @return 读失败、格式错误、中止或消息体在结束分隔符之前结束时返回false
+     */
+    bool readFrom(HttpSession::ptr session);
+
+    /**
+     * @brief 是否已读到结束分隔符
+     */
+    bool isFinished() const { return m_state == FINISHED;}
+
+    /**
+     * @brief 返回错误
+     */
+    Error getError() const { return m_error;}
+
+    /**
+     * @brief 返回已解析的part数
+     */
+    uint32_t getPartCount() const { return m_partCount;}
+private:
+    /**
+     * @brief 解析状态
+     */
+    enum State {
+        /// 第一个分隔符之前的内容
+        PREAMBLE,
+        /// 分隔符之后，判断是下一个part还是结束
+        BOUNDARY,
+        /// part头部
+        HEADER,
+        /// part内容
+        BODY,
+        /// 已读到结束分隔符，之后的内容忽略
+        FINISHED,
+        /// 出错
+        ERROR
+    };
+
+    /**
+     * @brief 解析data，返回可以丢弃的字节数
+     */
+    size_t parse(const char* data, size_t len);
+
+    /**
+     * @brief 查找分隔符
+     * @param[out] partial 找不到时，末尾可能是分隔符前缀的起始位置
+     * @return 分隔符的位置，找不到时返回len
+     */
+    size_t findDelimiter(const char* data, size_t len, size_t& partial) const;
+
+    /**
+     * @brief 解析一行part头部
+     */
+    bool parseHeaderLine(const char* data, size_t len);
+
+    /**
+     * @brief 设置错误
+     */
+    size_t fail(Error error);
+private:
+    /// "\r\n--boundary"
+    std::string m_delimiter;
+    /// 单个part头部的最大字节数
+    uint64_t m_maxHeaderSize;
+    /// 解析状态
+    State m_state = PREAMBLE;
+    /// 错误
+    Error m_error = OK;
+    /// 上次没有解析完的数据
+    std::string m_buffer;
+    /// 当前part
+    Part m_part;
+    /// 当前part头部已解析的字节数
+    uint64_t m_headerSize = 0;
+    /// 已解析的part数
+    uint32_t m_partCount = 0;
+    /// part开始回调
+    PartBeginCb m_onPartBegin;
+    /// part内容回调
+    PartDataCb m_onPartData;
+    /// part结束回调
+    PartEndCb m_onPartEnd;
+};
+
+/**
+ * @brief application/x-www-form-urlencoded流式解析器
+ * @details 只缓存当前的一个key=value，参数解码后逐个回调
+ */
+class FormUrlencodedParser {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<FormUrlencodedParser> ptr;
+    /// 参数回调，返回false中止解析
+    typedef std::function<bool(const std::string& key, const std::string& value)> ParamCb;
+
+    /**
+     * @brief 构造函数
+     * @param[in] cb 参数回调
+     * @param[in] max_param_size 单个key=value编码后的最大字节数
+     */
+    FormUrlencodedParser(ParamCb cb, uint64_t max_param_size = 64 * 1024);
+
+    /**
+     * @brief 解析一段消息体
+     * @return 参数过大或回调中止时返回false
+     */
+    bool execute(const char* data, size_t len);
+
+    /**
+     * @brief 消息体结束，回调最后一个参数
+     */
+    bool finish();
+
+    /**
+     * @brief 从session流式读取剩余的请求消息体并解析
+     */
+    bool readFrom(HttpSession::ptr session);
+private:
+    /**
+     * @brief 解码并回调一个参数
+     */
+    bool emit();
+private:
+    /// 参数回调
+    ParamCb m_cb;
+    /// 单个参数的最大字节数
+    uint64_t m_maxParamSize;
+    /// 当前参数
+    std::string m_param;
+    /// 是否出错
+    bool m_error = false;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,57 @@
+/**
+ * @file route_stats.cc
+ * @brief 按路由统计实现
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "route_stats.h"
+#include <sstream>
+
+namespace sylar {
+namespace http {
+
+RouteStats::RouteStats(const std::string& route)
+    :m_route(route) {
+    auto mgr = sylar::MetricsMgr::GetInstance();
+    MetricsRegistry::Labels labels = {{"route", route}};
+    m_latency = mgr->summary("sylar_http_route_latency_seconds"
+                    , "http request handling time by route", labels, 1e-6);
+    m_reqBytes = mgr->summary("sylar_http_route_request_bytes"
+                    , "http request body size by route", labels);
+    m_rspBytes = mgr->summary("sylar_http_route_response_bytes"
+                    , "http response body size by route", labels);
+    for(int i = 0; i < 5; ++i) {
+        labels["code"] = std::to_string(i + 1) + "xx";
+        m_status[i] = mgr->counter("sylar_http_route_requests_total"
+                    , "http requests handled by route", labels);
+    }
+}
+
+void RouteStats::record(uint64_t latency_us, uint64_t req_bytes, uint64_t rsp_bytes, int status) {
+    m_latency->observe(latency_us);
+    m_reqBytes->observe(req_bytes);
+    m_rspBytes->observe(rsp_bytes);
+    int cls = status / 100;
+    m_status[cls >= 1 && cls <= 5 ? cls - 1 : 4]->inc();
+}
+
+uint64_t RouteStats::getStatusCount(int cls) const {
+    return cls >= 1 && cls <= 5 ? m_status[cls - 1]->get() : 0;
+}
+
+std::string RouteStats::toString() const {
+    std::stringstream ss;
+    ss << "route=" << m_route
+       << " latency_us[" << getLatency().toString() << "]"
+       << " req_bytes[" << getRequestBytes().toString() << "]"
+       << " rsp_bytes[" << getResponseBytes().toString() << "]"
+       << " status[";
+    for(int i = 1; i <= 5; ++i) {
+        ss << (i > 1 ? " " : "") << i << "xx=" << getStatusCount(i);
+    }
+    ss << "]";
+    return ss.str();
+}
+
+}
+}
@@ -0,0 +1,90 @@
+/**
+ * @file route_stats.h
+ * @brief 按路由统计的HTTP请求耗时、请求和响应大小及状态码
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#ifndef __SYLAR_HTTP_ROUTE_STATS_H__
+#define __SYLAR_HTTP_ROUTE_STATS_H__
+
+#include <memory>
+#include <string>
+#include "../metrics.h"
+
+namespace sylar {
+namespace http {
+
+/**
+ * @brief 一个路由的统计
+ * @details 指标注册在MetricsMgr里，以route标签区分，通过 /_/status 管理接口导出：
+ *          sylar_http_route_latency_seconds、sylar_http_route_request_bytes、
+ *          sylar_http_route_response_bytes 三个分位数摘要和按状态码类别的
+ *          sylar_http_route_requests_total。同名路由共用同一组指标
+ */
+class RouteStats {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<RouteStats> ptr;
+
+    /**
+     * @brief 构造函数
+     * @param[in] route 路由，精准匹配的路径或模糊匹配的模式串
+     */
+    RouteStats(const std::string& route);
+
+    /**
+     * @brief 记录一次请求
+     * @param[in] latency_us 处理耗时(微秒)
+     * @param[in] req_bytes 请求体大小
+     * @param[in] rsp_bytes 响应体大小
+     * @param[in] status 响应状态码
+     */
+    void record(uint64_t latency_us, uint64_t req_bytes, uint64_t rsp_bytes, int status);
+
+    /**
+     * @brief 返回路由
+     */
+    const std::string& getRoute() const { return m_route;}
+
+    /**
+     * @brief 耗时分布(微秒)
+     */
+    HdrSnapshot getLatency() const { return m_latency->snapshot();}
+
+    /**
+     * @brief 请求体大小分布
+     */
+    HdrSnapshot getRequestBytes() const { return m_reqBytes->snapshot();}
+
+    /**
+     * @brief 响应体大小分布
+     */
+    HdrSnapshot getResponseBytes() const { return m_rspBytes->snapshot();}
+
+    /**
+     * @brief 返回某类状态码的请求数
+     * @param[in] cls 状态码类别，1~5
+     */
+    uint64_t getStatusCount(int cls) const;
+
+    /**
+     * @brief 输出路由的统计摘要
+     */
+    std::string toString() const;
+private:
+    /// 路由
+    std::string m_route;
+    /// 耗时(微秒)
+    Summary::ptr m_latency;
+    /// 请求体大小
+    Summary::ptr m_reqBytes;
+    /// 响应体大小
+    Summary::ptr m_rspBytes;
+    /// 按状态码类别(1xx~5xx)的请求数
+    Counter::ptr m_status[5];
+};
+
+}
+}
+
+#endif
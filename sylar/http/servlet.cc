@@ -17,29 +17,134 @@ int32_t FunctionServlet::handle(sylar::http::HttpRequest::ptr request
 
 
 
+ServletChain::ServletChain(const std::vector<ServletFilter::ptr>& filters
+                           ,IServletCreator::ptr creator
+                           ,RouteStats::ptr stats
+                           ,ConcurrencyLimiter::ptr limiter)
+    :m_filters(filters)
+    ,m_creator(creator)
+    ,m_stats(stats)
+    ,m_limiter(limiter) {
+    if(!creator) {
+        return;
+    }
+    if(std::dynamic_pointer_cast<HoldServletCreator>(creator)) {
+        m_servlet = creator->get();
+    }
+    Servlet::ptr slt = m_servlet ? m_servlet : creator->get();
+    m_streaming = slt && slt->isStreaming();
+}
+
+size_t ServletChain::before(const sylar::http::HttpRequest::ptr& request
+               , const sylar::http::HttpResponse::ptr& response
+               , const sylar::http::HttpSession::ptr& session) const {
+    size_t i = 0;
+    for(; i < m_filters.size(); ++i) {
+        if(!m_filters[i]->doFilter(request, response, session)) {
+            break;
+        }
+    }
+    return i;
+}
+
+int32_t ServletChain::invoke(const sylar::http::HttpRequest::ptr& request
+               , const sylar::http::HttpResponse::ptr& response
+               , const sylar::http::HttpSession::ptr& session) const {
+    if(m_servlet) {
+        return m_servlet->handle(request, response, session);
+    }
+    if(!m_creator) {
+        return 0;
+    }
+    Servlet::ptr slt = m_creator->get();
+    return slt ? slt->handle(request, response, session) : 0;
+}
+
+void ServletChain::after(size_t passed
+               , const sylar::http::HttpRequest::ptr& request
+               , const sylar::http::HttpResponse::ptr& response
+               , const sylar::http::HttpSession::ptr& session) const {
+    while(passed) {
+        m_filters[--passed]->afterHandle(request, response, session);
+    }
+}
+
+bool ServletChain::acquire(const sylar::http::HttpResponse::ptr& response) const {
+    if(!m_limiter || m_limiter->acquire()) {
+        return true;
+    }
+    response->setStatus(HttpStatus::SERVICE_UNAVAILABLE);
+    response->setBody("service overloaded");
+    return false;
+}
+
+int32_t ServletChain::handle(const sylar::http::HttpRequest::ptr& request
+               , const sylar::http::HttpResponse::ptr& response
+               , const sylar::http::HttpSession::ptr& session) const {
+    if(!acquire(response)) {
+        return 0;
+    }
+    uint64_t start = m_limiter ? sylar::GetCurrentUS() : 0;
+    size_t passed = before(request, response, session);
+    int32_t rt = 0;
+    if(isPassed(passed)) {
+        rt = invoke(request, response, session);
+    }
+    after(passed, request, response, session);
+    if(m_limiter) {
+        m_limiter->release(sylar::GetCurrentUS() - start);
+    }
+    return rt;
+}
+
 ServletDispatch::ServletDispatch()
     :Servlet("ServletDispatch") {
     m_default.reset(new NotFoundServlet("sylar/1.0"));
+    m_defaultChain = compose("", std::make_shared<HoldServletCreator>(m_default));
 }
 
 int32_t ServletDispatch::handle(sylar::http::HttpRequest::ptr request
                , sylar::http::HttpResponse::ptr response
                , sylar::http::HttpSession::ptr session) {
-    auto slt = getMatchedServlet(request->getPath());
-    if(slt) {
-        slt->handle(request, response, session);
-    }
+    getMatchedChain(request->getPath())->handle(request, response, session);
     return 0;
 }
 
-void ServletDispatch::addServlet(const std::string& uri, Servlet::ptr slt) {
+void ServletDispatch::close() {
+    std::vector<IServletCreator::ptr> creators;
+    Servlet::ptr def;
+    {
+        RWMutexType::ReadLock lock(m_mutex);
+        for(auto& i : m_datas) {
+            creators.push_back(i.second);
+        }
+        for(auto& i : m_globs) {
+            creators.push_back(i.second);
+        }
+        def = m_default;
+    }
+    for(auto& i : creators) {
+        i->close();
+    }
+    if(def) {
+        def->close();
+    }
+}
+
+void ServletDispatch::setDefault(Servlet::ptr v) {
     RWMutexType::WriteLock lock(m_mutex);
-    m_datas[uri] = std::make_shared<HoldServletCreator>(slt);
+    m_default = v;
+    m_defaultChain = compose("", v ? std::make_shared<HoldServletCreator>(v) : nullptr);
+}
+
+void ServletDispatch::addServlet(const std::string& uri, Servlet::ptr slt) {
+    addServletCreator(uri, std::make_shared<HoldServletCreator>(slt));
 }
 
 void ServletDispatch::addServletCreator(const std::string& uri, IServletCreator::ptr creator) {
     RWMutexType::WriteLock lock(m_mutex);
     m_datas[uri] = creator;
+    m_chains[uri] = compose(uri, creator);
 }
 
 void ServletDispatch::addGlobServletCreator(const std::string& uri, IServletCreator::ptr creator) {
@@ -52,27 +157,17 @@ void ServletDispatch::addGlobServletCreator(const std::string& uri, IServletCrea
         }
     }
     m_globs.push_back(std::make_pair(uri, creator));
+    rebuildGlobs();
 }
 
 void ServletDispatch::addServlet(const std::string& uri
                         ,FunctionServlet::callback cb) {
-    RWMutexType::WriteLock lock(m_mutex);
-    m_datas[uri] = std::make_shared<HoldServletCreator>(
-                        std::make_shared<FunctionServlet>(cb));
+    addServlet(uri, std::make_shared<FunctionServlet>(cb));
 }
 
 void ServletDispatch::addGlobServlet(const std::string& uri
                                     ,Servlet::ptr slt) {
-    RWMutexType::WriteLock lock(m_mutex);
-    for(auto it = m_globs.begin();
-            it != m_globs.end(); ++it) {
-        if(it->first == uri) {
-            m_globs.erase(it);
-            break;
-        }
-    }
-    m_globs.push_back(std::make_pair(uri
-                , std::make_shared<HoldServletCreator>(slt)));
+    addGlobServletCreator(uri, std::make_shared<HoldServletCreator>(slt));
 }
 
 void ServletDispatch::addGlobServlet(const std::string& uri
@@ -83,6 +178,7 @@ void ServletDispatch::addGlobServlet(const std::string& uri
 void ServletDispatch::delServlet(const std::string& uri) {
     RWMutexType::WriteLock lock(m_mutex);
     m_datas.erase(uri);
+    m_chains.erase(uri);
 }
 
 void ServletDispatch::delGlobServlet(const std::string& uri) {
@@ -94,6 +190,7 @@ void ServletDispatch::delGlobServlet(const std::string& uri) {
             break;
         }
     }
+    rebuildGlobs();
 }
 
 Servlet::ptr ServletDispatch::getServlet(const std::string& uri) {
@@ -128,6 +225,73 @@ Servlet::ptr ServletDispatch::getMatchedServlet(const std::string& uri) {
     return m_default;
 }
 
+void ServletDispatch::addFilter(ServletFilter::ptr filter, const std::string& uri) {
+    RWMutexType::WriteLock lock(m_mutex);
+    m_filters.push_back(std::make_pair(uri, filter));
+    rebuildAll();
+}
+
+void ServletDispatch::delFilter(const std::string& name) {
+    RWMutexType::WriteLock lock(m_mutex);
+    for(auto it = m_filters.begin();
+            it != m_filters.end(); ++it) {
+        if(it->second->getName() == name) {
+            m_filters.erase(it);
+            break;
+        }
+    }
+    rebuildAll();
+}
+
+ServletChain::ptr ServletDispatch::getMatchedChain(const std::string& uri) {
+    RWMutexType::ReadLock lock(m_mutex);
+    auto mit = m_chains.find(uri);
+    if(mit != m_chains.end()) {
+        return mit->second;
+    }
+    for(auto it = m_globChains.begin();
+            it != m_globChains.end(); ++it) {
+        if(!fnmatch(it->first.c_str(), uri.c_str(), 0)) {
+            return it->second;
+        }
+    }
+    return m_defaultChain;
+}
+
+ServletChain::ptr ServletDispatch::compose(const std::string& uri, IServletCreator::ptr creator) {
+    std::vector<ServletFilter::ptr> filters;
+    for(auto& i : m_filters) {
+        bool match = uri.empty() ? i.first == "*"
+                        : (i.first == uri || !fnmatch(i.first.c_str(), uri.c_str(), 0));
+        if(match) {
+            filters.push_back(i.second);
+        }
+    }
+    std::string route = uri.empty() ? "default" : uri;
+    RouteStats::ptr& stats = m_stats[route];
+    if(!stats) {
+        stats.reset(new RouteStats(route));
+    }
+    auto it = m_limiters.find(uri);
+    return std::make_shared<ServletChain>(filters, creator, stats
+                , it == m_limiters.end() ? nullptr : it->second);
+}
+
+void ServletDispatch::rebuildGlobs() {
+    m_globChains.clear();
+    for(auto& i : m_globs) {
+        m_globChains.push_back(std::make_pair(i.first, compose(i.first, i.second)));
+    }
+}
+
+void ServletDispatch::rebuildAll() {
+    for(auto& i : m_datas) {
+        m_chains[i.first] = compose(i.first, i.second);
+    }
+    rebuildGlobs();
+    m_defaultChain = compose("", m_default ? std::make_shared<HoldServletCreator>(m_default) : nullptr);
+}
+
 void ServletDispatch::listAllServletCreator(std::map<std::string, IServletCreator::ptr>& infos) {
     RWMutexType::ReadLock lock(m_mutex);
     for(auto& i : m_datas) {
@@ -142,6 +306,29 @@ void ServletDispatch::listAllGlobServletCreator(std::map<std::string, IServletCr
     }
 }
 
+void ServletDispatch::setConcurrencyLimiter(const std::string& uri, ConcurrencyLimiter::ptr limiter) {
+    RWMutexType::WriteLock lock(m_mutex);
+    if(limiter) {
+        m_limiters[uri] = limiter;
+    } else {
+        m_limiters.erase(uri);
+    }
+    rebuildAll();
+}
+
+ConcurrencyLimiter::ptr ServletDispatch::getConcurrencyLimiter(const std::string& uri) {
+    RWMutexType::ReadLock lock(m_mutex);
+    auto it = m_limiters.find(uri);
+    return it == m_limiters.end() ? nullptr : it->second;
+}
+
+void ServletDispatch::listRouteStats(std::map<std::string, RouteStats::ptr>& infos) {
+    RWMutexType::ReadLock lock(m_mutex);
+    for(auto& i : m_stats) {
+        infos[i.first] = i.second;
+    }
+}
+
 NotFoundServlet::NotFoundServlet(const std::string& name)
     :Servlet("NotFoundServlet")
     ,m_name(name) {
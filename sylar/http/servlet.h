@@ -16,6 +16,8 @@
 #include <unordered_map>
 #include "http.h"
 #include "http_session.h"
+#include "route_stats.h"
+#include "../concurrency_limiter.h"
 #include "../thread.h"
 #include "../util.h"
 
@@ -85,6 +87,18 @@ public:
                    , sylar::http::HttpResponse::ptr response
                    , sylar::http::HttpSession::ptr session) = 0;
                    
+    /**
+     * @brief 是否流式处理请求
+     * @details 为true时HttpServer只读完请求头就调用handle，消息体由servlet通过HttpSession::readBody读取；
+     *          servlet也可以直接在session上发送响应头并写出消息体
+     */
+    virtual bool isStreaming() const { return false;}
+
+    /**
+     * @brief 服务器停止时调用，释放servlet持有的资源(例如上游的空闲连接)
+     */
+    virtual void close() {}
+
     /**
      * @brief 返回Servlet名称
      */
@@ -120,12 +134,65 @@ private:
     callback m_cb;
 };
 
+/**
+ * @brief Servlet过滤器(中间件)
+ * @details doFilter在读取请求体和调用servlet之前执行，用于限流、鉴权等前置检查，可以直接拦截请求；
+ *          afterHandle在servlet处理完、响应发出之前执行，用于统计、压缩、补充CORS头部等。
+ *          参数以常量引用传递，经过过滤器链时不会复制智能指针
+ */
+class ServletFilter {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<ServletFilter> ptr;
+
+    /**
+     * @brief 构造函数
+     * @param[in] name 名称
+     */
+    ServletFilter(const std::string& name)
+        :m_name(name) {}
+
+    /**
+     * @brief 析构函数
+     */
+    virtual ~ServletFilter() {}
+
+    /**
+     * @brief 前置检查
+     * @param[in] request HTTP请求，流式servlet和被拦截的请求此时还没有消息体
+     * @param[in] response HTTP响应
+     * @param[in] session HTTP连接
+     * @return true继续处理，false请求被拦截，由过滤器填写response
+     */
+    virtual bool doFilter(const sylar::http::HttpRequest::ptr& request
+                   , const sylar::http::HttpResponse::ptr& response
+                   , const sylar::http::HttpSession::ptr& session) { return true;}
+
+    /**
+     * @brief 后置处理
+     * @details 只对doFilter返回true的过滤器调用，顺序与doFilter相反；请求被后面的过滤器拦截时也会调用
+     */
+    virtual void afterHandle(const sylar::http::HttpRequest::ptr& request
+                   , const sylar::http::HttpResponse::ptr& response
+                   , const sylar::http::HttpSession::ptr& session) {}
+
+    /**
+     * @brief 返回过滤器名称
+     */
+    const std::string& getName() const { return m_name;}
+protected:
+    /// 名称
+    std::string m_name;
+};
+
 class IServletCreator {
 public:
     typedef std::shared_ptr<IServletCreator> ptr;
     virtual ~IServletCreator() {}
     virtual Servlet::ptr get() const = 0;
     virtual std::string getName() const = 0;
+    /// 服务器停止时调用，持有servlet实例的创建器转发给servlet
+    virtual void close() {}
 };
 
 class HoldServletCreator : public IServletCreator {
@@ -142,6 +209,10 @@ public:
     std::string getName() const override {
         return m_servlet->getName();
     }
+
+    void close() override {
+        m_servlet->close();
+    }
 private:
     Servlet::ptr m_servlet;
 };
@@ -163,6 +234,113 @@ public:
     }
 };
 
+/**
+ * @brief 过滤器链
+ * @details 注册servlet或过滤器时，ServletDispatch把适用于该路径的过滤器和servlet组合成一条平坦的调用链，
+ *          请求到来时按下标依次调用，不再为每个横切逻辑包一层servlet
+ */
+class ServletChain {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<ServletChain> ptr;
+
+    /**
+     * @brief 构造函数
+     * @param[in] filters 按执行顺序排列的过滤器
+     * @param[in] creator servlet创建器，为空时链上只有过滤器
+     * @param[in] stats 路由统计，可以为空
+     * @param[in] limiter 并发限制，可以为空
+     */
+    ServletChain(const std::vector<ServletFilter::ptr>& filters, IServletCreator::ptr creator
+                 ,RouteStats::ptr stats = nullptr, ConcurrencyLimiter::ptr limiter = nullptr);
+
+    /**
+     * @brief 依次执行过滤器的doFilter，遇到拦截时停止
+     * @return 通过的过滤器个数，等于过滤器总数时表示全部通过
+     */
+    size_t before(const sylar::http::HttpRequest::ptr& request
+                  , const sylar::http::HttpResponse::ptr& response
+                  , const sylar::http::HttpSession::ptr& session) const;
+
+    /**
+     * @brief 调用servlet
+     */
+    int32_t invoke(const sylar::http::HttpRequest::ptr& request
+                   , const sylar::http::HttpResponse::ptr& response
+                   , const sylar::http::HttpSession::ptr& session) const;
+
+    /**
+     * @brief 逆序执行通过的过滤器的afterHandle
+     * @param[in] passed before()的返回值
+     */
+    void after(size_t passed
+               , const sylar::http::HttpRequest::ptr& request
+               , const sylar::http::HttpResponse::ptr& response
+               , const sylar::http::HttpSession::ptr& session) const;
+
+    /**
+     * @brief 占用并发名额，没有设置并发限制时总是成功
+     * @return 超出并发限制时返回false并填写503响应
+     */
+    bool acquire(const sylar::http::HttpResponse::ptr& response) const;
+
+    /**
+     * @brief 归还acquire()占用的名额
+     * @param[in] latency_us 请求耗时(微秒)
+     * @param[in] sample 是否把耗时计入并发限制的统计
+     */
+    void release(uint64_t latency_us, bool sample = true) const {
+        if(m_limiter) {
+            m_limiter->release(latency_us, sample);
+        }
+    }
+
+    /**
+     * @brief 执行完整的调用链
+     */
+    int32_t handle(const sylar::http::HttpRequest::ptr& request
+                   , const sylar::http::HttpResponse::ptr& response
+                   , const sylar::http::HttpSession::ptr& session) const;
+
+    /**
+     * @brief before()的返回值是否表示全部通过
+     */
+    bool isPassed(size_t passed) const { return passed == m_filters.size();}
+
+    /**
+     * @brief servlet是否流式处理请求
+     */
+    bool isStreaming() const { return m_streaming;}
+
+    /**
+     * @brief 返回过滤器
+     */
+    const std::vector<ServletFilter::ptr>& getFilters() const { return m_filters;}
+
+    /**
+     * @brief 返回路由统计
+     */
+    RouteStats::ptr getStats() const { return m_stats;}
+
+    /**
+     * @brief 返回并发限制
+     */
+    ConcurrencyLimiter::ptr getLimiter() const { return m_limiter;}
+private:
+    /// 过滤器
+    std::vector<ServletFilter::ptr> m_filters;
+    /// servlet创建器
+    IServletCreator::ptr m_creator;
+    /// 路由统计
+    RouteStats::ptr m_stats;
+    /// 并发限制
+    ConcurrencyLimiter::ptr m_limiter;
+    /// 共享的servlet实例，创建器每次新建servlet时为空
+    Servlet::ptr m_servlet;
+    /// servlet是否流式处理请求
+    bool m_streaming = false;
+};
+
 /**
  * @brief Servlet分发器
  */
@@ -181,6 +359,11 @@ public:
                    , sylar::http::HttpResponse::ptr response
                    , sylar::http::HttpSession::ptr session) override;
 
+    /**
+     * @brief 依次关闭所有servlet
+     */
+    virtual void close() override;
+
     /**
      * @brief 添加servlet
      * @param[in] uri uri
@@ -243,7 +426,7 @@ public:
      * @brief 设置默认servlet
      * @param[in] v servlet
      */
-    void setDefault(Servlet::ptr v) { m_default = v;}
+    void setDefault(Servlet::ptr v);
 
 
     /**
@@ -267,8 +450,65 @@ public:
      */
     Servlet::ptr getMatchedServlet(const std::string& uri);
 
+    /**
+     * @brief 添加过滤器，按添加顺序执行
+     * @details 过滤器在注册时就组合进各路径的调用链。uri按fnmatch匹配精准路径和模糊匹配的模式串，
+     *          默认servlet只使用uri为"*"的过滤器
+     * @param[in] filter 过滤器
+     * @param[in] uri 适用的路径
+     */
+    void addFilter(ServletFilter::ptr filter, const std::string& uri = "*");
+
+    /**
+     * @brief 按名称删除过滤器
+     * @param[in] name 过滤器名称
+     */
+    void delFilter(const std::string& name);
+
+    /**
+     * @brief 为路由设置自适应并发限制
+     * @details 超出限制的请求在执行过滤器和读取请求体之前直接返回503
+     * @param[in] uri 注册servlet时的精准路径或模糊匹配的模式串，为空时设置默认servlet
+     * @param[in] limiter 并发限制，为空时取消
+     */
+    void setConcurrencyLimiter(const std::string& uri, ConcurrencyLimiter::ptr limiter);
+
+    /**
+     * @brief 返回路由的并发限制
+     */
+    ConcurrencyLimiter::ptr getConcurrencyLimiter(const std::string& uri);
+
+    /**
+     * @brief 通过uri获取调用链
+     * @return 优先精准匹配,其次模糊匹配,最后返回默认servlet的调用链
+     */
+    ServletChain::ptr getMatchedChain(const std::string& uri);
+
     void listAllServletCreator(std::map<std::string, IServletCreator::ptr>& infos);
     void listAllGlobServletCreator(std::map<std::string, IServletCreator::ptr>& infos);
+
+    /**
+     * @brief 列出各路由的统计
+     * @details 路由为精准匹配的路径或模糊匹配的模式串，默认servlet的路由为"default"。
+     *          删除servlet后统计仍保留
+     */
+    void listRouteStats(std::map<std::string, RouteStats::ptr>& infos);
+private:
+    /**
+     * @brief 把适用于uri的过滤器和servlet组合成调用链
+     * @details 同一路由重新组合时沿用已有的统计
+     */
+    ServletChain::ptr compose(const std::string& uri, IServletCreator::ptr creator);
+
+    /**
+     * @brief 重新组合模糊匹配的调用链
+     */
+    void rebuildGlobs();
+
+    /**
+     * @brief 重新组合全部调用链
+     */
+    void rebuildAll();
 private:
     /// 读写互斥量
     RWMutexType m_mutex;
@@ -280,6 +520,18 @@ private:
     std::vector<std::pair<std::string, IServletCreator::ptr> > m_globs;
     /// 默认servlet，所有路径都没匹配到时使用
     Servlet::ptr m_default;
+    /// 过滤器及其适用的路径
+    std::vector<std::pair<std::string, ServletFilter::ptr> > m_filters;
+    /// 精准匹配的调用链
+    std::unordered_map<std::string, ServletChain::ptr> m_chains;
+    /// 模糊匹配的调用链，与m_globs一一对应
+    std::vector<std::pair<std::string, ServletChain::ptr> > m_globChains;
+    /// 默认servlet的调用链
+    ServletChain::ptr m_defaultChain;
+    /// 路由 -> 统计
+    std::map<std::string, RouteStats::ptr> m_stats;
+    /// 路由 -> 并发限制
+    std::unordered_map<std::string, ConcurrencyLimiter::ptr> m_limiters;
 };
 
 /**
@@ -0,0 +1,26 @@
+/**
+ * @file flight_recorder_servlet.cc
+ * @brief 导出飞行记录器的Servlet实现
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "flight_recorder_servlet.h"
+#include "../../flight_recorder.h"
+
+namespace sylar {
+namespace http {
+
+FlightRecorderServlet::FlightRecorderServlet()
+    :Servlet("FlightRecorderServlet") {
+}
+
+int32_t FlightRecorderServlet::handle(sylar::http::HttpRequest::ptr request
+                   , sylar::http::HttpResponse::ptr response
+                   , sylar::http::HttpSession::ptr session) {
+    response->setHeader("Content-Type", "text/plain");
+    response->setBody(FlightRecorder::Dump(request->getParamAs<size_t>("last", 0)));
+    return 0;
+}
+
+}
+}
@@ -0,0 +1,37 @@
+/**
+ * @file flight_recorder_servlet.h
+ * @brief 导出飞行记录器的Servlet
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#ifndef __SYLAR_HTTP_SERVLETS_FLIGHT_RECORDER_SERVLET_H__
+#define __SYLAR_HTTP_SERVLETS_FLIGHT_RECORDER_SERVLET_H__
+
+#include "../servlet.h"
+
+namespace sylar {
+namespace http {
+
+/**
+ * @brief 飞行记录器导出Servlet
+ * @details 由HttpServer::addAdminServlets挂在/_/flight，参数last指定每个线程最多返回最近的多少个事件
+ */
+class FlightRecorderServlet : public Servlet {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<FlightRecorderServlet> ptr;
+
+    /**
+     * @brief 构造函数
+     */
+    FlightRecorderServlet();
+
+    virtual int32_t handle(sylar::http::HttpRequest::ptr request
+                   , sylar::http::HttpResponse::ptr response
+                   , sylar::http::HttpSession::ptr session) override;
+};
+
+}
+}
+
+#endif
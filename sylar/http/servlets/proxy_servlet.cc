@@ -0,0 +1,260 @@
+/**
+ * @file proxy_servlet.cc
+ * @brief HTTP反向代理Servlet实现
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "proxy_servlet.h"
+#include <string.h>
+#include "../../config.h"
+#include "../../log.h"
+#include "../../splice.h"
+#include "../../trace.h"
+
+namespace sylar {
+namespace http {
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_NAME("system");
+
+static sylar::ConfigVar<bool>::ptr g_http_proxy_splice =
+    sylar::Config::Lookup("http.proxy.splice", true,
+            "http proxy forwards content-length bodies with splice");
+
+/**
+ * @brief 逐跳头部，只对单个连接有意义，不能转发
+ */
+static const char* s_hop_headers[] = {
+    "connection",
+    "keep-alive",
+    "proxy-authenticate",
+    "proxy-authorization",
+    "proxy-connection",
+    "te",
+    "trailer",
+    "transfer-encoding",
+    "upgrade",
+};
+
+static bool IsHopHeader(const std::string& name) {
+    for(auto& i : s_hop_headers) {
+        if(strcasecmp(i, name.c_str()) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 复制端到端头部，去掉逐跳头部以及Connection头部中列出的头部
+ */
+template<class MapType, class Message>
+static void CopyHeaders(const MapType& headers, Message& msg) {
+    MapType skip;
+    auto it = headers.find("connection");
+    if(it != headers.end()) {
+        std::string tokens = it->second;
+        size_t pos = 0;
+        while(pos < tokens.size()) {
+            size_t end = tokens.find(',', pos);
+            if(end == std::string::npos) {
+                end = tokens.size();
+            }
+            std::string name = sylar::StringUtil::Trim(tokens.substr(pos, end - pos));
+            if(!name.empty()) {
+                skip[name] = "";
+            }
+            pos = end + 1;
+        }
+    }
+    for(auto& i : headers) {
+        if(IsHopHeader(i.first) || skip.count(i.first)) {
+            continue;
+        }
+        msg.setHeader(i.first, i.second);
+    }
+}
+
+static bool IsChunked(const std::string& transfer_encoding) {
+    return strcasestr(transfer_encoding.c_str(), "chunked") != nullptr;
+}
+
+/**
+ * @brief 把src上剩余的消息体转发到dst
+ * @param[in] src HttpSession或HttpConnection
+ * @param[in] chunked 是否以chunked编码写出
+ * @param[in] splice 是否允许用splice搬运Content-Length确定的部分
+ */
+template<class Source>
+static bool ForwardBody(Source& src, SocketStream& dst, bool chunked
+                        ,bool splice, SplicePipe::ptr& pipe) {
+    std::string data;
+    while(true) {
+        uint64_t left = splice ? src.getBodyLeft() : 0;
+        if(left) {
+            if(!pipe) {
+                pipe.reset(new SplicePipe);
+            }
+            int64_t n = pipe->transfer(src.getSocket(), dst.getSocket(), left);
+            if(n != (int64_t)left) {
+                return false;
+            }
+            src.setBodyConsumed();
+            break;
+        }
+        int rt = src.readBody(data);
+        if(rt < 0) {
+            return false;
+        }
+        if(rt == 0) {
+            break;
+        }
+        if(chunked) {
+            char head[32];
+            int len = snprintf(head, sizeof(head), "%x\r\n", rt);
+            data.insert(0, head, len);
+            data.append("\r\n", 2);
+        }
+        if(dst.writeFixSize(data.c_str(), data.size()) <= 0) {
+            return false;
+        }
+    }
+    if(chunked && dst.writeFixSize("0\r\n\r\n", 5) <= 0) {
+        return false;
+    }
+    return true;
+}
+
+ProxyServlet::ProxyServlet(HttpConnectionPool::ptr pool, uint64_t timeout_ms)
+    :Servlet("ProxyServlet")
+    ,m_pool(pool)
+    ,m_timeout(timeout_ms)
+    ,m_splice(g_http_proxy_splice->getValue()) {
+}
+
+int32_t ProxyServlet::handle(sylar::http::HttpRequest::ptr request
+                   , sylar::http::HttpResponse::ptr response
+                   , sylar::http::HttpSession::ptr session) {
+    auto breaker = m_pool->getCircuitBreaker();
+    if(!breaker->allow()) {
+        response->setStatus(HttpStatus::SERVICE_UNAVAILABLE);
+        response->setBody("upstream circuit open");
+        return 0;
+    }
+    uint64_t start = sylar::GetCurrentUS();
+    auto conn = m_pool->getConnection();
+    if(!conn) {
+        breaker->record(false, sylar::GetCurrentUS() - start);
+        response->setStatus(HttpStatus::BAD_GATEWAY);
+        response->setClose(true);
+        response->setBody("connect upstream fail");
+        return 0;
+    }
+    Socket::ptr usock = conn->getSocket();
+    usock->setRecvTimeout(m_timeout);
+    usock->setSendTimeout(m_timeout);
+
+    HttpRequest::ptr ureq(new HttpRequest(0x11, false));
+    ureq->setMethod(request->getMethod());
+    ureq->setPath(request->getPath());
+    ureq->setQuery(request->getQuery());
+    CopyHeaders(request->getHeaders(), *ureq);
+    // 上游的父span是代理处理这个请求的span
+    if(Span* span = Span::GetCurrent()) {
+        ureq->setHeader("traceparent", span->getContext().toTraceparent());
+    }
+    std::string peer = session->getRemoteAddressString();
+    size_t colon = peer.rfind(':');
+    if(colon != std::string::npos) {
+        peer = peer.substr(0, colon);
+    }
+    std::string xff = request->getHeader("X-Forwarded-For");
+    ureq->setHeader("X-Forwarded-For", xff.empty() ? peer : xff + ", " + peer);
+    bool req_chunked = IsChunked(request->getHeader("Transfer-Encoding"));
+    if(req_chunked) {
+        ureq->delHeader("Content-Length");
+        ureq->setHeader("Transfer-Encoding", "chunked");
+    }
+
+    bool splice = m_splice && SplicePipe::IsSupported(session->getSocket())
+                    && SplicePipe::IsSupported(usock);
+    SplicePipe::ptr pipe;
+    if(conn->sendRequest(ureq) <= 0
+            || !ForwardBody(*session, *conn, req_chunked, splice, pipe)) {
+        SYLAR_LOG_DEBUG(g_logger) << "proxy send request fail errno=" << errno
+            << " errstr=" << strerror(errno) << " upstream=" << *usock;
+        conn->close();
+        breaker->record(false, sylar::GetCurrentUS() - start);
+        response->setStatus(HttpStatus::BAD_GATEWAY);
+        response->setClose(true);
+        response->setBody("send to upstream fail");
+        return 0;
+    }
+
+    auto ursp = conn->recvResponseHeader();
+    // 以收到响应头为准记录上游的结果，5xx和失败一样计入熔断
+    breaker->record(ursp && (int)ursp->getStatus() < 500, sylar::GetCurrentUS() - start);
+    if(!ursp) {
+        bool timeout = (errno == ETIMEDOUT || errno == EAGAIN);
+        SYLAR_LOG_DEBUG(g_logger) << "proxy recv response fail errno=" << errno
+            << " errstr=" << strerror(errno) << " upstream=" << *usock;
+        response->setStatus(timeout ? HttpStatus::GATEWAY_TIMEOUT : HttpStatus::BAD_GATEWAY);
+        response->setClose(true);
+        response->setBody(timeout ? "upstream timeout" : "recv from upstream fail");
+        return 0;
+    }
+
+    response->setStatus(ursp->getStatus());
+    CopyHeaders(ursp->getHeaders(), *response);
+    int status = (int)ursp->getStatus();
+    bool has_body = request->getMethod() != HttpMethod::HEAD
+                    && status >= 200 && status != 204 && status != 304;
+    bool rsp_chunked = false;
+    if(has_body) {
+        if(IsChunked(ursp->getHeader("Transfer-Encoding"))) {
+            rsp_chunked = true;
+        } else if(ursp->getHeader("Content-Length").empty()) {
+            // 上游以关闭连接表示消息体结束，HTTP/1.1的客户端改用chunked，HTTP/1.0只能同样以关闭连接结束
+            rsp_chunked = request->getVersion() >= 0x11;
+            if(!rsp_chunked) {
+                response->setClose(true);
+                response->setStreamBody(true);
+            }
+        }
+        if(rsp_chunked) {
+            response->delHeader("Content-Length");
+            response->setHeader("Transfer-Encoding", "chunked");
+        }
+    }
+    if(request->getMethod() == HttpMethod::HEAD) {
+        // 上游没有给出长度时照原样转发，不能替它声明GET的消息体为空
+        response->setStreamBody(true);
+    }
+    if(session->sendResponse(response) <= 0) {
+        conn->close();
+        response->setClose(true);
+        return 0;
+    }
+    // 上游声明了connection: close，读完响应后连接已经或即将被关闭，不能放回池里
+    bool upstream_close = strcasecmp(ursp->getHeader("connection").c_str(), "close") == 0;
+    if(!has_body) {
+        if(upstream_close || request->getMethod() == HttpMethod::HEAD) {
+            // 解析器仍在等待HEAD响应的消息体，这条连接不能再复用
+            conn->close();
+        }
+        return 0;
+    }
+    if(!ForwardBody(*conn, *session, rsp_chunked, splice, pipe)) {
+        SYLAR_LOG_DEBUG(g_logger) << "proxy forward response body fail errno=" << errno
+            << " errstr=" << strerror(errno) << " upstream=" << *usock;
+        // 响应头已经发出，只能断开客户端连接
+        conn->close();
+        session->close();
+        response->setClose(true);
+    } else if(upstream_close) {
+        conn->close();
+    }
+    return 0;
+}
+
+}
+}
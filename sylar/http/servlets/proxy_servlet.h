@@ -0,0 +1,69 @@
+/**
+ * @file proxy_servlet.h
+ * @brief HTTP反向代理Servlet
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#ifndef __SYLAR_HTTP_SERVLETS_PROXY_SERVLET_H__
+#define __SYLAR_HTTP_SERVLETS_PROXY_SERVLET_H__
+
+#include "../servlet.h"
+#include "../http_connection.h"
+
+namespace sylar {
+namespace http {
+
+/**
+ * @brief 反向代理Servlet
+ * @details 请求通过连接池里的长连接转发给上游，响应原样回给客户端。
+ *          请求体和响应体都是边读边转发，不会整体放进内存；Content-Length确定的消息体在两端都不是TLS时
+ *          用splice直接在socket之间搬运，chunked和以EOF结尾的消息体按段转发。
+ *          转发时去掉逐跳头部(Connection及其列出的头部、Keep-Alive、Transfer-Encoding等)，并追加X-Forwarded-For。
+ *          上游连接失败或超时时返回502/504
+ */
+class ProxyServlet : public Servlet {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<ProxyServlet> ptr;
+
+    /**
+     * @brief 构造函数
+     * @param[in] pool 上游连接池
+     * @param[in] timeout_ms 上游连接的读写超时时间(毫秒)
+     */
+    ProxyServlet(HttpConnectionPool::ptr pool, uint64_t timeout_ms = 5000);
+
+    virtual int32_t handle(sylar::http::HttpRequest::ptr request
+                   , sylar::http::HttpResponse::ptr response
+                   , sylar::http::HttpSession::ptr session) override;
+
+    virtual bool isStreaming() const override { return true;}
+
+    /**
+     * @brief 关闭上游连接池，让上游不再等待空闲长连接上的请求
+     */
+    virtual void close() override { m_pool->close();}
+
+    /**
+     * @brief 是否允许使用splice转发消息体
+     */
+    bool isSplice() const { return m_splice;}
+
+    /**
+     * @brief 设置是否允许使用splice转发消息体，默认取http.proxy.splice配置
+     */
+    void setSplice(bool v) { m_splice = v;}
+
+private:
+    /// 上游连接池
+    HttpConnectionPool::ptr m_pool;
+    /// 上游读写超时时间(毫秒)
+    uint64_t m_timeout;
+    /// 是否允许使用splice
+    bool m_splice;
+};
+
+}
+}
+
+#endif
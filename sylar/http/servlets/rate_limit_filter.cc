@@ -0,0 +1,47 @@
+/**
+ * @file rate_limit_filter.cc
+ * @brief 基于令牌桶的请求限流过滤器实现
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "rate_limit_filter.h"
+#include <math.h>
+
+namespace sylar {
+namespace http {
+
+RateLimitFilter::RateLimitFilter(RateLimiter::ptr limiter, const std::string& key_header)
+    :ServletFilter("RateLimitFilter")
+    ,m_limiter(limiter)
+    ,m_keyHeader(key_header) {
+    // 空桶攒够一个令牌需要的时间
+    double rate = limiter->getRate();
+    uint64_t retry = rate > 0 ? (uint64_t)ceil(1 / rate) : 60;
+    m_retryAfter = std::to_string(retry ? retry : 1);
+}
+
+bool RateLimitFilter::doFilter(const sylar::http::HttpRequest::ptr& request
+                   , const sylar::http::HttpResponse::ptr& response
+                   , const sylar::http::HttpSession::ptr& session) {
+    std::string key;
+    if(!m_keyHeader.empty()) {
+        std::string value = request->getHeader(m_keyHeader);
+        if(!value.empty()) {
+            key = "key:" + value;
+        }
+    }
+    if(key.empty()) {
+        key = "ip:" + RateLimiter::AddressKey(session->getRemoteAddress());
+    }
+    if(m_limiter->allow(key)) {
+        return true;
+    }
+    ++m_rejected;
+    response->setStatus(HttpStatus::TOO_MANY_REQUESTS);
+    response->setHeader("Retry-After", m_retryAfter);
+    response->setBody("too many requests");
+    return false;
+}
+
+}
+}
@@ -0,0 +1,61 @@
+/**
+ * @file rate_limit_filter.h
+ * @brief 基于令牌桶的请求限流过滤器
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#ifndef __SYLAR_HTTP_SERVLETS_RATE_LIMIT_FILTER_H__
+#define __SYLAR_HTTP_SERVLETS_RATE_LIMIT_FILTER_H__
+
+#include "../servlet.h"
+#include "../../rate_limiter.h"
+
+namespace sylar {
+namespace http {
+
+/**
+ * @brief 请求限流过滤器
+ * @details 每个请求取一个令牌，取不到时返回429和Retry-After，请求体不再读取。
+ *          设置了key_header且请求带有该头部时按头部的值(如API key)限流，否则按客户端IP限流
+ */
+class RateLimitFilter : public ServletFilter {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<RateLimitFilter> ptr;
+
+    /**
+     * @brief 构造函数
+     * @param[in] limiter 限流器
+     * @param[in] key_header 作为限流key的请求头部，为空时只按IP限流
+     */
+    RateLimitFilter(RateLimiter::ptr limiter, const std::string& key_header = "");
+
+    virtual bool doFilter(const sylar::http::HttpRequest::ptr& request
+                   , const sylar::http::HttpResponse::ptr& response
+                   , const sylar::http::HttpSession::ptr& session) override;
+
+    /**
+     * @brief 返回限流器
+     */
+    RateLimiter::ptr getRateLimiter() const { return m_limiter;}
+
+    /**
+     * @brief 返回被拒绝的请求数
+     */
+    uint64_t getRejected() const { return m_rejected;}
+
+private:
+    /// 限流器
+    RateLimiter::ptr m_limiter;
+    /// 作为限流key的请求头部
+    std::string m_keyHeader;
+    /// Retry-After头部的值(秒)
+    std::string m_retryAfter;
+    /// 被拒绝的请求数
+    std::atomic<uint64_t> m_rejected = {0};
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,26 @@
+/**
+ * @file status_servlet.cc
+ * @brief 指标导出Servlet实现
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "status_servlet.h"
+#include "../../metrics.h"
+
+namespace sylar {
+namespace http {
+
+StatusServlet::StatusServlet()
+    :Servlet("StatusServlet") {
+}
+
+int32_t StatusServlet::handle(sylar::http::HttpRequest::ptr request
+                   , sylar::http::HttpResponse::ptr response
+                   , sylar::http::HttpSession::ptr session) {
+    response->setHeader("Content-Type", "text/plain; version=0.0.4");
+    response->setBody(MetricsMgr::GetInstance()->toPrometheus());
+    return 0;
+}
+
+}
+}
@@ -0,0 +1,37 @@
+/**
+ * @file status_servlet.h
+ * @brief 以Prometheus文本格式导出指标的Servlet
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#ifndef __SYLAR_HTTP_SERVLETS_STATUS_SERVLET_H__
+#define __SYLAR_HTTP_SERVLETS_STATUS_SERVLET_H__
+
+#include "../servlet.h"
+
+namespace sylar {
+namespace http {
+
+/**
+ * @brief 指标导出Servlet
+ * @details 返回MetricsMgr中全部指标，由HttpServer::addAdminServlets挂在/_/status
+ */
+class StatusServlet : public Servlet {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<StatusServlet> ptr;
+
+    /**
+     * @brief 构造函数
+     */
+    StatusServlet();
+
+    virtual int32_t handle(sylar::http::HttpRequest::ptr request
+                   , sylar::http::HttpResponse::ptr response
+                   , sylar::http::HttpSession::ptr session) override;
+};
+
+}
+}
+
+#endif
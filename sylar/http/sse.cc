@@ -0,0 +1,405 @@
+#include "sse.h"
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include "../config.h"
+#include "../iomanager.h"
+#include "../log.h"
+
+namespace sylar {
+namespace http {
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_NAME("system");
+
+static sylar::ConfigVar<uint32_t>::ptr g_sse_queue_size =
+    sylar::Config::Lookup("http.sse.queue_size", (uint32_t)256,
+            "max events queued for one sse subscriber");
+
+static sylar::ConfigVar<uint64_t>::ptr g_sse_heartbeat =
+    sylar::Config::Lookup("http.sse.heartbeat_ms", (uint64_t)15000,
+            "idle time before writing an sse comment line, 0 disables");
+
+static sylar::ConfigVar<uint64_t>::ptr g_sse_send_timeout =
+    sylar::Config::Lookup("http.sse.send_timeout_ms", (uint64_t)30000,
+            "an sse subscriber blocked in a write longer than this is disconnected");
+
+static uint32_t s_sse_queue_size = 0;
+static uint64_t s_sse_heartbeat = 0;
+static uint64_t s_sse_send_timeout = 0;
+
+namespace {
+struct _SseIniter {
+    _SseIniter() {
+        s_sse_queue_size = g_sse_queue_size->getValue();
+        s_sse_heartbeat = g_sse_heartbeat->getValue();
+        s_sse_send_timeout = g_sse_send_timeout->getValue();
+
+        g_sse_queue_size->addListener([](const uint32_t& ov, const uint32_t& nv) {
+            s_sse_queue_size = nv;
+        });
+        g_sse_heartbeat->addListener([](const uint64_t& ov, const uint64_t& nv) {
+            s_sse_heartbeat = nv;
+        });
+        g_sse_send_timeout->addListener([](const uint64_t& ov, const uint64_t& nv) {
+            s_sse_send_timeout = nv;
+        });
+    }
+};
+
+static _SseIniter s_sse_initer;
+}
+
+/// 一次writev最多写出的事件数
+static const size_t s_batch = 64;
+
+/// 心跳，注释行会被客户端忽略
+static const SseBuffer s_heartbeat = std::make_shared<const std::string>(":\n\n");
+
+SseSubscriber::SseSubscriber(HttpSession::ptr session, size_t queue_size
+                             ,OverflowPolicy policy, bool chunked)
+    :m_session(session)
+    ,m_queueSize(std::max(queue_size, (size_t)1))
+    ,m_policy(policy)
+    ,m_chunked(chunked) {
+}
+
+bool SseSubscriber::push(const SseBuffer& buf) {
+    MutexType::Lock lock(m_mutex);
+    if(m_closed) {
+        return false;
+    }
+    if(m_queue.size() >= m_queueSize) {
+        if(m_policy == DISCONNECT) {
+            if(m_disconnectedCounter) {
+                m_disconnectedCounter->inc();
+            }
+            SYLAR_LOG_DEBUG(g_logger) << "sse subscriber too slow, disconnect: "
+                << *m_session->getSocket();
+            // 不释放锁：上面已在锁内确认未关闭，run不会赶在shutdown之前返回并关闭fd
+            doAbort(lock);
+            return false;
+        }
+        ++m_dropped;
+        if(m_droppedCounter) {
+            m_droppedCounter->inc();
+        }
+        if(m_policy == DROP_NEWEST) {
+            return false;
+        }
+        m_queue.pop_front();
+    }
+    m_queue.push_back(buf);
+    wake(lock);
+    return true;
+}
+
+void SseSubscriber::wake(MutexType::Lock& lock) {
+    if(!m_waiter) {
+        return;
+    }
+    Fiber::ptr fiber;
+    fiber.swap(m_waiter);
+    Scheduler* scheduler = m_scheduler;
+    lock.unlock();
+    scheduler->schedule(fiber);
+}
+
+void SseSubscriber::run(uint64_t heartbeat_ms) {
+    std::vector<SseBuffer> batch;
+    batch.reserve(s_batch);
+    IOManager* iom = IOManager::GetThis();
+    bool ok = true;
+    while(ok) {
+        MutexType::Lock lock(m_mutex);
+        if(m_queue.empty()) {
+            if(m_closed) {
+                break;
+            }
+            if(!m_heartbeat) {
+                // 在锁内登记，push和定时器都在锁内取走等待者，只有一方会调度
+                m_waiter = Fiber::GetThis();
+                m_scheduler = Scheduler::GetThis();
+                lock.unlock();
+                Timer::ptr timer;
+                if(heartbeat_ms && iom) {
+                    ptr self = shared_from_this();
+                    timer = iom->addTimer(heartbeat_ms, [self]() {
+                        MutexType::Lock lock(self->m_mutex);
+                        if(self->m_waiter) {
+                            self->m_heartbeat = true;
+                            self->wake(lock);
+                        }
+                    });
+                }
+                Fiber::GetThis()->yield();
+                if(timer) {
+                    timer->cancel();
+                }
+                continue;
+            }
+            m_heartbeat = false;
+            batch.push_back(s_heartbeat);
+        } else {
+            m_heartbeat = false;
+            while(!m_queue.empty() && batch.size() < s_batch) {
+                batch.push_back(std::move(m_queue.front()));
+                m_queue.pop_front();
+            }
+        }
+        lock.unlock();
+        ok = write(batch);
+        batch.clear();
+    }
+
+    MutexType::Lock lock(m_mutex);
+    m_closed = true;
+    m_finished = true;
+    m_queue.clear();
+    bool aborted = m_aborted;
+    lock.unlock();
+    // 正常结束时写出结束块，客户端据此知道是服务端主动结束而不是连接异常
+    if(ok && !aborted && m_chunked) {
+        m_session->getSocket()->send("0\r\n\r\n", 5);
+    }
+}
+
+bool SseSubscriber::write(const std::vector<SseBuffer>& bufs) {
+    iovec iov[s_batch + 2];
+    size_t n = 0;
+    char head[32];
+    if(m_chunked) {
+        size_t total = 0;
+        for(auto& i : bufs) {
+            total += i->size();
+        }
+        iov[n].iov_base = head;
+        iov[n++].iov_len = snprintf(head, sizeof(head), "%zx\r\n", total);
+    }
+    // 直接写出共享的缓冲区，不拼接也不复制
+    for(auto& i : bufs) {
+        iov[n].iov_base = (void*)i->data();
+        iov[n++].iov_len = i->size();
+    }
+    if(m_chunked) {
+        iov[n].iov_base = (void*)"\r\n";
+        iov[n++].iov_len = 2;
+    }
+
+    Socket::ptr sock = m_session->getSocket();
+    iovec* p = iov;
+    while(n) {
+        int rt = sock->send(p, n);
+        if(rt <= 0) {
+            SYLAR_LOG_DEBUG(g_logger) << "sse write fail rt=" << rt << " errno=" << errno
+                << " errstr=" << strerror(errno) << " " << *sock;
+            return false;
+        }
+        size_t left = rt;
+        while(n && left >= p->iov_len) {
+            left -= p->iov_len;
+            ++p;
+            --n;
+        }
+        if(n) {
+            p->iov_base = (char*)p->iov_base + left;
+            p->iov_len -= left;
+        }
+    }
+    return true;
+}
+
+void SseSubscriber::close() {
+    MutexType::Lock lock(m_mutex);
+    m_closed = true;
+    wake(lock);
+}
+
+void SseSubscriber::abort() {
+    MutexType::Lock lock(m_mutex);
+    doAbort(lock);
+}
+
+void SseSubscriber::doAbort(MutexType::Lock& lock) {
+    // run返回后连接随时会被关闭，fd可能已被别的连接复用，不能再shutdown
+    if(m_aborted || m_finished) {
+        return;
+    }
+    m_closed = true;
+    m_aborted = true;
+    m_queue.clear();
+    // 连接仍归run所在的协程所有，这里只shutdown，阻塞在写上的协程随即返回，fd由它关闭
+    ::shutdown(m_session->getSocket()->getSocket(), SHUT_RDWR);
+    wake(lock);
+}
+
+bool SseSubscriber::isClosed() {
+    MutexType::Lock lock(m_mutex);
+    return m_closed;
+}
+
+size_t SseSubscriber::getQueueSize() {
+    MutexType::Lock lock(m_mutex);
+    return m_queue.size();
+}
+
+uint64_t SseSubscriber::getDropped() {
+    MutexType::Lock lock(m_mutex);
+    return m_dropped;
+}
+
+SseHub::SseHub(const std::string& name, SseSubscriber::OverflowPolicy policy, size_t queue_size)
+    :m_name(name)
+    ,m_policy(policy)
+    ,m_queueSize(queue_size ? queue_size : s_sse_queue_size) {
+    auto mgr = MetricsMgr::GetInstance();
+    MetricsRegistry::Labels labels = {{"hub", name}};
+    m_subscriberGauge = mgr->gauge("sylar_sse_subscribers"
+                    , "connected sse subscribers", labels);
+    m_events = mgr->counter("sylar_sse_events_total"
+                    , "events published", labels);
+    m_dropped = mgr->counter("sylar_sse_dropped_total"
+                    , "events dropped because a subscriber queue was full", labels);
+    m_disconnected = mgr->counter("sylar_sse_disconnected_total"
+                    , "subscribers disconnected because their queue was full", labels);
+}
+
+/**
+ * @brief 追加一个单行字段，值在第一个换行处截断
+ */
+static void AppendField(std::string& out, const char* name, const std::string& value) {
+    out.append(name);
+    out.append(value.c_str(), strcspn(value.c_str(), "\r\n"));
+    out.append(1, '\n');
+}
+
+SseBuffer SseHub::Encode(const std::string& data, const std::string& event
+                         ,const std::string& id, uint32_t retry) {
+    std::shared_ptr<std::string> out = std::make_shared<std::string>();
+    out->reserve(data.size() + event.size() + id.size() + 32);
+    if(!event.empty()) {
+        AppendField(*out, "event: ", event);
+    }
+    if(!id.empty()) {
+        AppendField(*out, "id: ", id);
+    }
+    if(retry) {
+        out->append("retry: ").append(std::to_string(retry)).append(1, '\n');
+    }
+    // 每行一个data字段，CRLF、CR和LF都算换行
+    const char* p = data.c_str();
+    const char* end = p + data.size();
+    while(true) {
+        const char* eol = p;
+        while(eol < end && *eol != '\r' && *eol != '\n') {
+            ++eol;
+        }
+        out->append("data: ").append(p, eol - p).append(1, '\n');
+        if(eol == end) {
+            break;
+        }
+        p = eol + ((*eol == '\r' && eol + 1 < end && eol[1] == '\n') ? 2 : 1);
+    }
+    out->append(1, '\n');
+    return out;
+}
+
+size_t SseHub::publish(const std::string& data, const std::string& event
+                       ,const std::string& id) {
+    return publish(Encode(data, event, id));
+}
+
+size_t SseHub::publish(const SseBuffer& buf) {
+    m_events->inc();
+    size_t count = 0;
+    RWMutexType::ReadLock lock(m_mutex);
+    for(auto& i : m_subscribers) {
+        if(i->push(buf)) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+SseSubscriber::ptr SseHub::createSubscriber(HttpSession::ptr session, bool chunked) {
+    SseSubscriber::ptr sub = std::make_shared<SseSubscriber>(session, m_queueSize, m_policy, chunked);
+    sub->m_droppedCounter = m_dropped;
+    sub->m_disconnectedCounter = m_disconnected;
+    return sub;
+}
+
+bool SseHub::subscribe(SseSubscriber::ptr sub) {
+    RWMutexType::WriteLock lock(m_mutex);
+    if(m_stopped) {
+        return false;
+    }
+    if(m_subscribers.insert(sub).second) {
+        m_subscriberGauge->inc();
+    }
+    return true;
+}
+
+void SseHub::unsubscribe(SseSubscriber::ptr sub) {
+    RWMutexType::WriteLock lock(m_mutex);
+    if(m_subscribers.erase(sub)) {
+        m_subscriberGauge->dec();
+    }
+}
+
+void SseHub::stop() {
+    std::unordered_set<SseSubscriber::ptr> subs;
+    {
+        RWMutexType::WriteLock lock(m_mutex);
+        m_stopped = true;
+        subs.swap(m_subscribers);
+        m_subscriberGauge->dec(subs.size());
+    }
+    for(auto& i : subs) {
+        i->close();
+    }
+}
+
+size_t SseHub::getSubscriberCount() {
+    RWMutexType::ReadLock lock(m_mutex);
+    return m_subscribers.size();
+}
+
+SseServlet::SseServlet(SseHub::ptr hub, ConnectCallback cb)
+    :Servlet("SseServlet")
+    ,m_hub(hub)
+    ,m_cb(cb) {
+}
+
+int32_t SseServlet::handle(sylar::http::HttpRequest::ptr request
+                           , sylar::http::HttpResponse::ptr response
+                           , sylar::http::HttpSession::ptr session) {
+    // 没有chunked编码时只能以关闭连接结束消息体，而响应头总会带上Content-Length
+    if(request->getVersion() < 0x11) {
+        response->setStatus(HttpStatus::HTTP_VERSION_NOT_SUPPORTED);
+        response->setClose(true);
+        return 0;
+    }
+    SseSubscriber::ptr sub = m_hub->createSubscriber(session, true);
+    if(m_cb && !m_cb(request, response, sub)) {
+        return 0;
+    }
+    response->setHeader("Content-Type", "text/event-stream");
+    response->setHeader("Cache-Control", "no-cache");
+    response->setHeader("X-Accel-Buffering", "no");
+    response->setHeader("Transfer-Encoding", "chunked");
+    response->setClose(true);
+    if(session->sendResponse(response) <= 0) {
+        return 0;
+    }
+    if(s_sse_send_timeout) {
+        session->getSocket()->setSendTimeout(s_sse_send_timeout);
+    }
+    if(!m_hub->subscribe(sub)) {
+        sub->close();
+    }
+    sub->run(s_sse_heartbeat);
+    m_hub->unsubscribe(sub);
+    return 0;
+}
+
+}
+}
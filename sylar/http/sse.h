@@ -0,0 +1,303 @@
+/**
+ * @file sse.h
+ * @brief Server-Sent Events：长连接推送的Servlet和共享缓冲区的广播中心
+ * @version 0.1
+ * @date 2026-10-19
+ */
+#ifndef __SYLAR_HTTP_SSE_H__
+#define __SYLAR_HTTP_SSE_H__
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include "../fiber.h"
+#include "../metrics.h"
+#include "../mutex.h"
+#include "../scheduler.h"
+#include "servlet.h"
+
+namespace sylar {
+namespace http {
+
+/**
+ * @brief 编码好的事件，所有订阅者共享同一份，只读
+ */
+typedef std::shared_ptr<const std::string> SseBuffer;
+
+/**
+ * @brief 一个SSE连接
+ * @details 发布者把事件放进有界队列后立即返回，由连接自己的协程批量取出，
+ *          用一次writev把多个共享缓冲区写出，发布者不会被慢连接阻塞。
+ *          队列满时按溢出策略丢弃或断开，空闲超过心跳间隔时写一个注释行，写失败即认为对端已断开
+ */
+class SseSubscriber : public std::enable_shared_from_this<SseSubscriber> {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<SseSubscriber> ptr;
+    /// 锁类型定义
+    typedef Spinlock MutexType;
+
+    /**
+     * @brief 队列满时的处理方式
+     */
+    enum OverflowPolicy {
+        /// 丢弃队列中最旧的事件
+        DROP_OLDEST = 0,
+        /// 丢弃新事件
+        DROP_NEWEST = 1,
+        /// 断开连接
+        DISCONNECT = 2
+    };
+
+    /**
+     * @brief 构造函数
+     * @param[in] session 连接，响应头已经发出
+     * @param[in] queue_size 队列长度
+     * @param[in] policy 队列满时的处理方式
+     * @param[in] chunked 是否以chunked编码写出
+     */
+    SseSubscriber(HttpSession::ptr session, size_t queue_size
+                  ,OverflowPolicy policy, bool chunked);
+
+    /**
+     * @brief 放入一个事件，可以在任意线程调用
+     * @return 被丢弃或连接已关闭时返回false
+     */
+    bool push(const SseBuffer& buf);
+
+    /**
+     * @brief 写出队列中的事件，直到连接关闭或写失败，在连接所属的协程中调用
+     * @param[in] heartbeat_ms 空闲多久写一次心跳，0表示不写
+     */
+    void run(uint64_t heartbeat_ms);
+
+    /**
+     * @brief 关闭连接，run写完已在队列中的事件和结束块后返回
+     */
+    void close();
+
+    /**
+     * @brief 立即断开连接，丢弃队列中的事件，阻塞在写上的run随即返回；run已经返回时什么也不做
+     */
+    void abort();
+
+    /**
+     * @brief 是否已关闭
+     */
+    bool isClosed();
+
+    /**
+     * @brief 队列中的事件数
+     */
+    size_t getQueueSize();
+
+    /**
+     * @brief 因队列满丢弃的事件数
+     */
+    uint64_t getDropped();
+
+    /**
+     * @brief 返回连接
+     */
+    HttpSession::ptr getSession() const { return m_session;}
+private:
+    /**
+     * @brief 写出一批事件
+     */
+    bool write(const std::vector<SseBuffer>& bufs);
+
+    /**
+     * @brief 唤醒等待中的协程
+     * @param[in] lock 持有的锁，调度前释放
+     */
+    void wake(MutexType::Lock& lock);
+
+    /**
+     * @brief 在锁内断开连接，run已经返回时什么也不做
+     * @param[in] lock 持有的锁，shutdown之后才释放
+     */
+    void doAbort(MutexType::Lock& lock);
+private:
+    /// 连接
+    HttpSession::ptr m_session;
+    /// 队列长度
+    size_t m_queueSize;
+    /// 队列满时的处理方式
+    OverflowPolicy m_policy;
+    /// 是否以chunked编码写出
+    bool m_chunked;
+    /// 保护以下成员
+    MutexType m_mutex;
+    /// 待写出的事件
+    std::deque<SseBuffer> m_queue;
+    /// 等待事件的协程
+    Fiber::ptr m_waiter;
+    /// 协程所在的调度器
+    Scheduler* m_scheduler = nullptr;
+    /// 是否由心跳定时器唤醒
+    bool m_heartbeat = false;
+    /// 是否已关闭
+    bool m_closed = false;
+    /// 是否已断开
+    bool m_aborted = false;
+    /// run是否已返回，之后连接可能已被关闭
+    bool m_finished = false;
+    /// 丢弃的事件数
+    uint64_t m_dropped = 0;
+    /// 广播中心的丢弃计数
+    Counter::ptr m_droppedCounter;
+    /// 广播中心的断开计数
+    Counter::ptr m_disconnectedCounter;
+
+    friend class SseHub;
+};
+
+/**
+ * @brief SSE广播中心
+ * @details 每个事件只编码一次，放进引用计数的只读缓冲区，所有订阅者的队列里存的是同一个缓冲区，
+ *          写出时也直接用它，不按订阅者复制。发布在读锁下遍历订阅者，订阅和退订加写锁。
+ *          队列长度默认为http.sse.queue_size
+ */
+class SseHub : public std::enable_shared_from_this<SseHub> {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<SseHub> ptr;
+    /// 读写锁类型定义
+    typedef RWMutex RWMutexType;
+
+    /**
+     * @brief 构造函数
+     * @param[in] name 名称，用作指标的hub标签
+     * @param[in] policy 队列满时的处理方式
+     * @param[in] queue_size 每个订阅者的队列长度，0表示使用http.sse.queue_size
+     */
+    SseHub(const std::string& name
+           ,SseSubscriber::OverflowPolicy policy = SseSubscriber::DROP_OLDEST
+           ,size_t queue_size = 0);
+
+    /**
+     * @brief 按text/event-stream格式编码一个事件
+     * @param[in] data 数据，多行时每行一个data字段
+     * @param[in] event 事件类型，为空时不写
+     * @param[in] id 事件id，为空时不写
+     * @param[in] retry 建议的重连间隔(毫秒)，0表示不写
+     */
+    static SseBuffer Encode(const std::string& data, const std::string& event = ""
+                            ,const std::string& id = "", uint32_t retry = 0);
+
+    /**
+     * @brief 编码并广播一个事件
+     * @return 放入队列的订阅者数
+     */
+    size_t publish(const std::string& data, const std::string& event = ""
+                   ,const std::string& id = "");
+
+    /**
+     * @brief 广播一个已经编码好的事件
+     * @return 放入队列的订阅者数
+     */
+    size_t publish(const SseBuffer& buf);
+
+    /**
+     * @brief 为已发出响应头的连接创建订阅者，使用广播中心的队列长度和溢出策略，尚未加入广播
+     * @param[in] chunked 是否以chunked编码写出
+     */
+    SseSubscriber::ptr createSubscriber(HttpSession::ptr session, bool chunked);
+
+    /**
+     * @brief 加入广播，之后发布的事件都会放进它的队列
+     * @return 已停止时返回false
+     */
+    bool subscribe(SseSubscriber::ptr sub);
+
+    /**
+     * @brief 退订
+     */
+    void unsubscribe(SseSubscriber::ptr sub);
+
+    /**
+     * @brief 停止广播，关闭全部订阅者，之后的订阅返回false
+     */
+    void stop();
+
+    /**
+     * @brief 订阅者数
+     */
+    size_t getSubscriberCount();
+
+    /**
+     * @brief 返回名称
+     */
+    const std::string& getName() const { return m_name;}
+private:
+    /// 名称
+    std::string m_name;
+    /// 队列满时的处理方式
+    SseSubscriber::OverflowPolicy m_policy;
+    /// 每个订阅者的队列长度
+    size_t m_queueSize;
+    /// 保护以下成员
+    RWMutexType m_mutex;
+    /// 订阅者
+    std::unordered_set<SseSubscriber::ptr> m_subscribers;
+    /// 是否已停止
+    bool m_stopped = false;
+    /// 订阅者数
+    Gauge::ptr m_subscriberGauge;
+    /// 广播的事件数
+    Counter::ptr m_events;
+    /// 因队列满丢弃的事件数
+    Counter::ptr m_dropped;
+    /// 因队列满断开的连接数
+    Counter::ptr m_disconnected;
+};
+
+/**
+ * @brief SSE Servlet
+ * @details 流式处理请求：发出text/event-stream响应头后把连接加入广播中心，
+ *          之后一直写出事件，直到广播中心停止、连接断开或因队列满被断开，返回后关闭连接。
+ *          HTTP/1.1以chunked编码写出，HTTP/1.0回复505。
+ *          写阻塞超过http.sse.send_timeout_ms的连接被断开，空闲超过http.sse.heartbeat_ms时写一行注释
+ */
+class SseServlet : public Servlet {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<SseServlet> ptr;
+    /**
+     * @brief 连接加入广播前调用，此时响应头尚未发出
+     * @details 可以检查请求，或按Last-Event-ID用sub->push补发事件；
+     *          返回false时拒绝该连接，以response作为普通响应发出
+     */
+    typedef std::function<bool(HttpRequest::ptr request, HttpResponse::ptr response
+                               ,SseSubscriber::ptr sub)> ConnectCallback;
+
+    /**
+     * @brief 构造函数
+     * @param[in] hub 广播中心
+     * @param[in] cb 连接加入广播前调用，可以为空
+     */
+    SseServlet(SseHub::ptr hub, ConnectCallback cb = nullptr);
+
+    bool isStreaming() const override { return true;}
+
+    virtual int32_t handle(sylar::http::HttpRequest::ptr request
+                   , sylar::http::HttpResponse::ptr response
+                   , sylar::http::HttpSession::ptr session) override;
+
+    /**
+     * @brief 返回广播中心
+     */
+    SseHub::ptr getHub() const { return m_hub;}
+private:
+    /// 广播中心
+    SseHub::ptr m_hub;
+    /// 连接加入广播前调用
+    ConnectCallback m_cb;
+};
+
+}
+}
+
+#endif
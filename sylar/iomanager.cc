@@ -9,8 +9,10 @@
 #include <sys/epoll.h> // for epoll_xxx()
 #include <fcntl.h>     // for fcntl()
 #include "iomanager.h"
+#include "flight_recorder.h"
 #include "log.h"
 #include "macro.h"
+#include "probe.h"
 
 namespace sylar {
 
@@ -89,6 +91,8 @@ void IOManager::FdContext::triggerEvent(IOManager::Event event) {
      * 也就是说，注册的IO事件是一次性的，如果想持续关注某个socket fd的读写事件，那么每次触发事件之后都要重新添加
      */
     events = (Event)(events & ~event);
+    SYLAR_PROBE2(iom_trigger_event, fd, event);
+    FlightRecorder::Record(FlightRecorder::IO_TRIGGER, fd, event);
     // 调度对应的协程
     EventContext &ctx = getEventContext(event);
     if (ctx.cb) {
@@ -127,11 +131,20 @@ IOManager::IOManager(size_t threads, bool use_caller, const std::string &name)
 
     contextResize(32);
 
+    auto metrics = MetricsMgr::GetInstance();
+    metrics->gauge("sylar_iomanager_pending_events", "io events waiting to fire", getMetricLabels(),
+                   [this]() { return (double)getPendingEventCount(); });
+    metrics->gauge("sylar_iomanager_timers", "timers waiting to expire", getMetricLabels(),
+                   [this]() { return (double)getTimerCount(); });
+
     start();
 }
 
 IOManager::~IOManager() {
     stop();
+    auto metrics = MetricsMgr::GetInstance();
+    metrics->remove("sylar_iomanager_pending_events", getMetricLabels());
+    metrics->remove("sylar_iomanager_timers", getMetricLabels());
     close(m_epfd);
     close(m_tickleFds[0]);
     close(m_tickleFds[1]);
@@ -199,6 +212,8 @@ int IOManager::addEvent(int fd, Event event, std::function<void()> cb) {
 
     // 待执行IO事件数加1
     ++m_pendingEventCount;
+    SYLAR_PROBE2(iom_add_event, fd, event);
+    FlightRecorder::Record(FlightRecorder::IO_ADD, fd, event);
 
     // 找到这个fd的event事件对应的EventContext，对其中的scheduler, cb, fiber赋值，这时候赋值都是空值
     fd_ctx->events                     = (Event)(fd_ctx->events | event);
@@ -247,6 +262,8 @@ bool IOManager::delEvent(int fd, Event event) {
 
     // 待执行事件数减1
     --m_pendingEventCount;
+    SYLAR_PROBE2(iom_del_event, fd, event);
+    FlightRecorder::Record(FlightRecorder::IO_DEL, fd, event);
     // 重置该fd对应的event事件上下文
     fd_ctx->events                     = new_events;
     FdContext::EventContext &event_ctx = fd_ctx->getEventContext(event);
@@ -397,6 +414,7 @@ void IOManager::idle() {
                 next_timeout = MAX_TIMEOUT;
             }
             //只是超时的话，返回值为0
+            FlightRecorder::Record(FlightRecorder::IDLE_WAIT, (int)next_timeout, 0);
             rt = epoll_wait(m_epfd, events, MAX_EVNETS, (int)next_timeout);
             if(rt < 0 && errno == EINTR) {
                 continue;
@@ -404,6 +422,7 @@ void IOManager::idle() {
                 break;
             }
         } while(true);
+        FlightRecorder::Record(FlightRecorder::IDLE_WAKE, rt, 0);
 
         // 收集所有已超时的定时器，执行回调函数
         std::vector<std::function<void()>> cbs;
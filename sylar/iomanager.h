@@ -134,6 +134,11 @@ public:
      */
     bool cancelAll(int fd);
 
+    /**
+     * @brief 返回当前等待触发的IO事件数
+     */
+    size_t getPendingEventCount() const { return m_pendingEventCount; }
+
     /**
      * @brief 返回当前的IOManager
      */
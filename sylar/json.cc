@@ -0,0 +1,1047 @@
+#include "json.h"
+#include <locale.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace sylar {
+
+static const char s_digits[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static const uint64_t s_ones = 0x0101010101010101ull;
+static const uint64_t s_highs = 0x8080808080808080ull;
+
+/**
+ * @brief 8个字节中是否有需要转义的字节('"'、'\\'或小于0x20)
+ * @details 经典的按字节找零技巧：(x - 0x01..) & ~x & 0x80..在某个字节为0时非零，
+ *          可能误报匹配字节之后的字节，但不会漏报，命中后再逐字节处理这8个字节
+ */
+static inline bool NeedEscape(uint64_t x) {
+    uint64_t quote = x ^ (s_ones * '"');
+    uint64_t slash = x ^ (s_ones * '\\');
+    uint64_t rt = ((quote - s_ones) & ~quote)
+                | ((slash - s_ones) & ~slash)
+                | ((x - s_ones * 0x20) & ~x);
+    return rt & s_highs;
+}
+
+static inline void EscapeChar(std::string& out, unsigned char c) {
+    switch(c) {
+        case '"': out.append("\\\"", 2); break;
+        case '\\': out.append("\\\\", 2); break;
+        case '\b': out.append("\\b", 2); break;
+        case '\f': out.append("\\f", 2); break;
+        case '\n': out.append("\\n", 2); break;
+        case '\r': out.append("\\r", 2); break;
+        case '\t': out.append("\\t", 2); break;
+        default: {
+            char buf[6] = {'\\', 'u', '0', '0', "0123456789abcdef"[c >> 4], "0123456789abcdef"[c & 0xf]};
+            out.append(buf, 6);
+        }
+    }
+}
+
+void JsonWriter::AppendString(std::string& out, const char* s, size_t len) {
+    out.reserve(out.size() + len + 2);
+    out.append(1, '"');
+    const char* end = s + len;
+    const char* run = s;
+    const char* p = s;
+#ifdef __SSE2__
+    // 一次检查16个字节，命中时直接跳到第一个需要转义的字节
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i slash = _mm_set1_epi8('\\');
+    const __m128i ctrl = _mm_set1_epi8(0x1f);
+    while(end - p >= 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*)p);
+        // 无符号比较x <= 0x1f：min(x, 0x1f) == x
+        __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, quote), _mm_cmpeq_epi8(x, slash))
+                                   , _mm_cmpeq_epi8(_mm_min_epu8(x, ctrl), x));
+        unsigned mask = _mm_movemask_epi8(hit);
+        if(!mask) {
+            p += 16;
+            continue;
+        }
+        p += __builtin_ctz(mask);
+        out.append(run, p - run);
+        EscapeChar(out, *p);
+        run = ++p;
+    }
+#endif
+    while(p < end) {
+        if(end - p >= 8) {
+            uint64_t x;
+            memcpy(&x, p, 8);
+            if(!NeedEscape(x)) {
+                p += 8;
+                continue;
+            }
+        }
+        // 命中的8个字节或末尾不足8个字节逐个检查
+        const char* stop = end - p >= 8 ? p + 8 : end;
+        for(; p < stop; ++p) {
+            unsigned char c = *p;
+            if(c == '"' || c == '\\' || c < 0x20) {
+                out.append(run, p - run);
+                EscapeChar(out, c);
+                run = p + 1;
+            }
+        }
+    }
+    out.append(run, end - run);
+    out.append(1, '"');
+}
+
+void JsonWriter::AppendUint(std::string& out, uint64_t v) {
+    char buf[20];
+    char* p = buf + sizeof(buf);
+    while(v >= 100) {
+        unsigned i = (v % 100) * 2;
+        v /= 100;
+        *--p = s_digits[i + 1];
+        *--p = s_digits[i];
+    }
+    if(v >= 10) {
+        *--p = s_digits[v * 2 + 1];
+        *--p = s_digits[v * 2];
+    } else {
+        *--p = '0' + v;
+    }
+    out.append(p, buf + sizeof(buf) - p);
+}
+
+void JsonWriter::AppendInt(std::string& out, int64_t v) {
+    if(v < 0) {
+        out.append(1, '-');
+        // 先转成无符号再取反，INT64_MIN也不会溢出
+        AppendUint(out, 0 - (uint64_t)v);
+    } else {
+        AppendUint(out, v);
+    }
+}
+
+namespace {
+
+/**
+ * @brief 64位有效数字和二进制指数表示的浮点数 f * 2^e，用于Grisu2
+ */
+struct DiyFp {
+    DiyFp() {}
+    DiyFp(uint64_t f_, int e_) : f(f_), e(e_) {}
+
+    /**
+     * @brief 从double拆出有效数字和指数，不规格化
+     */
+    explicit DiyFp(double d) {
+        uint64_t u;
+        memcpy(&u, &d, sizeof(u));
+        int biased = (int)((u >> 52) & 0x7FF);
+        uint64_t significand = u & s_significandMask;
+        if(biased) {
+            f = significand + s_hiddenBit;
+            e = biased - 1075;
+        } else {
+            f = significand;
+            e = -1074;
+        }
+    }
+
+    DiyFp operator-(const DiyFp& rhs) const {
+        return DiyFp(f - rhs.f, e);
+    }
+
+    /**
+     * @brief 乘积取高64位并四舍五入
+     */
+    DiyFp operator*(const DiyFp& rhs) const {
+        __extension__ typedef unsigned __int128 uint128;
+        uint128 p = (uint128)f * rhs.f;
+        uint64_t h = (uint64_t)(p >> 64);
+        uint64_t l = (uint64_t)p;
+        if(l & (1ull << 63)) {
+            ++h;
+        }
+        return DiyFp(h, e + rhs.e + 64);
+    }
+
+    DiyFp normalize() const {
+        int s = __builtin_clzll(f);
+        return DiyFp(f << s, e - s);
+    }
+
+    /**
+     * @brief 规格化后的上下边界m+和m-，两者指数相同
+     */
+    void normalizedBoundaries(DiyFp* minus, DiyFp* plus) const {
+        DiyFp pl = DiyFp((f << 1) + 1, e - 1).normalize();
+        DiyFp mi = (f == s_hiddenBit) ? DiyFp((f << 2) - 1, e - 2) : DiyFp((f << 1) - 1, e - 1);
+        mi.f <<= mi.e - pl.e;
+        mi.e = pl.e;
+        *plus = pl;
+        *minus = mi;
+    }
+
+    static const uint64_t s_hiddenBit = 0x0010000000000000ull;
+    static const uint64_t s_significandMask = 0x000FFFFFFFFFFFFFull;
+
+    uint64_t f = 0;
+    int e = 0;
+};
+
+/**
+ * @brief 10^k的64位规格化近似值，四舍五入到最近
+ * @details 用大整数精确计算：k>=0时直接连乘，k<0时用足够大的2^s逐次除以10
+ */
+DiyFp Pow10(int k) {
+    // 小端的32位分段
+    std::vector<uint32_t> big;
+    int s = 0;
+    if(k >= 0) {
+        big.push_back(1);
+    } else {
+        // 10^-k < 2^(3.33 * -k)，多留66位保证商至少有65位
+        s = -k * 3322 / 1000 + 1 + 66;
+        big.assign(s / 32 + 1, 0);
+        big.back() = 1u << (s % 32);
+    }
+    for(int i = 0; i < (k >= 0 ? k : -k); ++i) {
+        if(k >= 0) {
+            uint64_t carry = 0;
+            for(auto& limb : big) {
+                uint64_t x = (uint64_t)limb * 10 + carry;
+                limb = (uint32_t)x;
+                carry = x >> 32;
+            }
+            if(carry) {
+                big.push_back((uint32_t)carry);
+            }
+        } else {
+            // 逐次整除10等于一次整除10^-k
+            uint64_t rem = 0;
+            for(size_t j = big.size(); j > 0; --j) {
+                uint64_t x = (rem << 32) | big[j - 1];
+                big[j - 1] = (uint32_t)(x / 10);
+                rem = x % 10;
+            }
+            while(big.size() > 1 && big.back() == 0) {
+                big.pop_back();
+            }
+        }
+    }
+    int bits = (int)(big.size() - 1) * 32 + (32 - __builtin_clz(big.back()));
+    auto bit = [&big](int i) -> uint64_t {
+        return i < 0 ? 0 : (big[i / 32] >> (i % 32)) & 1;
+    };
+    uint64_t f = 0;
+    for(int i = bits - 1; i >= bits - 64; --i) {
+        f = (f << 1) | bit(i);
+    }
+    int e = bits - 64 - s;
+    if(bit(bits - 65)) {
+        if(++f == 0) {
+            f = 1ull << 63;
+            ++e;
+        }
+    }
+    return DiyFp(f, e);
+}
+
+/**
+ * @brief Grisu2用的10^(-348 + 8 * i)，i = 0..86
+ * @details 启动时计算而不是抄一张常量表，首次使用时初始化一次
+ */
+struct CachedPowers {
+    CachedPowers() {
+        for(int i = 0; i < 87; ++i) {
+            powers[i] = Pow10(-348 + 8 * i);
+        }
+    }
+    DiyFp powers[87];
+};
+
+/**
+ * @brief 取一个缓存的10^-K，使w*10^-K的二进制指数落在[-60, -32]
+ */
+DiyFp GetCachedPower(int e, int* K) {
+    static const CachedPowers s_cached;
+    double dk = (-61 - e) * 0.30102999566398114 + 347;
+    int k = (int)dk;
+    if(dk - k > 0.0) {
+        ++k;
+    }
+    unsigned index = (unsigned)((k >> 3) + 1);
+    *K = -(-348 + (int)(index * 8));
+    return s_cached.powers[index];
+}
+
+const uint64_t s_pow10[] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull
+    , 100000000ull, 1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull
+    , 10000000000000ull, 100000000000000ull, 1000000000000000ull, 10000000000000000ull
+    , 100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull
+};
+
+/**
+ * @brief 在安全区间内把最后一位往w靠近
+ */
+void GrisuRound(char* buffer, int len, uint64_t delta, uint64_t rest
+                , uint64_t ten_kappa, uint64_t wp_w) {
+    while(rest < wp_w && delta - rest >= ten_kappa
+            && (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+        --buffer[len - 1];
+        rest += ten_kappa;
+    }
+}
+
+/**
+ * @brief 从m+开始逐位生成数字，落进(m-, m+)后停止
+ */
+void DigitGen(const DiyFp& W, const DiyFp& Mp, uint64_t delta, char* buffer, int* len, int* K) {
+    const DiyFp one(1ull << -Mp.e, Mp.e);
+    const DiyFp wp_w = Mp - W;
+    uint32_t p1 = (uint32_t)(Mp.f >> -one.e);
+    uint64_t p2 = Mp.f & (one.f - 1);
+    int kappa = 1;
+    while(kappa < 10 && p1 >= s_pow10[kappa]) {
+        ++kappa;
+    }
+    *len = 0;
+    while(kappa > 0) {
+        uint32_t d = p1 / (uint32_t)s_pow10[kappa - 1];
+        p1 %= (uint32_t)s_pow10[kappa - 1];
+        if(d || *len) {
+            buffer[(*len)++] = (char)('0' + d);
+        }
+        --kappa;
+        uint64_t tmp = ((uint64_t)p1 << -one.e) + p2;
+        if(tmp <= delta) {
+            *K += kappa;
+            GrisuRound(buffer, *len, delta, tmp, s_pow10[kappa] << -one.e, wp_w.f);
+            return;
+        }
+    }
+    while(true) {
+        p2 *= 10;
+        delta *= 10;
+        char d = (char)(p2 >> -one.e);
+        if(d || *len) {
+            buffer[(*len)++] = (char)('0' + d);
+        }
+        p2 &= one.f - 1;
+        --kappa;
+        if(p2 < delta) {
+            *K += kappa;
+            GrisuRound(buffer, *len, delta, p2, one.f
+                    , wp_w.f * (-kappa < 20 ? s_pow10[-kappa] : 0));
+            return;
+        }
+    }
+}
+
+/**
+ * @brief 生成正数v的十进制数字，v = buffer * 10^K
+ */
+void Grisu2(double v, char* buffer, int* len, int* K) {
+    DiyFp w_m, w_p;
+    DiyFp(v).normalizedBoundaries(&w_m, &w_p);
+    const DiyFp c_mk = GetCachedPower(w_p.e, K);
+    const DiyFp W = DiyFp(v).normalize() * c_mk;
+    DiyFp Wp = w_p * c_mk;
+    DiyFp Wm = w_m * c_mk;
+    // 乘法有误差，两端各收缩1保证结果落在真实区间内
+    ++Wm.f;
+    --Wp.f;
+    DigitGen(W, Wp, Wp.f - Wm.f, buffer, len, K);
+}
+
+char* WriteExponent(int k, char* p) {
+    *p++ = 'e';
+    if(k < 0) {
+        *p++ = '-';
+        k = -k;
+    } else {
+        *p++ = '+';
+    }
+    if(k >= 100) {
+        *p++ = (char)('0' + k / 100);
+        k %= 100;
+        *p++ = s_digits[k * 2];
+        *p++ = s_digits[k * 2 + 1];
+    } else if(k >= 10) {
+        *p++ = s_digits[k * 2];
+        *p++ = s_digits[k * 2 + 1];
+    } else {
+        *p++ = (char)('0' + k);
+    }
+    return p;
+}
+
+/**
+ * @brief 把buffer * 10^k排成JSON数字，返回结尾
+ */
+char* Prettify(char* buffer, int len, int k) {
+    // 10^(kk-1) <= v < 10^kk
+    const int kk = len + k;
+    if(k >= 0 && kk <= 21) {
+        // 1234e7 -> 12340000000
+        memset(buffer + len, '0', k);
+        return buffer + kk;
+    } else if(kk > 0 && kk <= 21) {
+        // 1234e-2 -> 12.34
+        memmove(buffer + kk + 1, buffer + kk, len - kk);
+        buffer[kk] = '.';
+        return buffer + len + 1;
+    } else if(kk > -6 && kk <= 0) {
+        // 1234e-6 -> 0.001234
+        const int offset = 2 - kk;
+        memmove(buffer + offset, buffer, len);
+        buffer[0] = '0';
+        buffer[1] = '.';
+        memset(buffer + 2, '0', offset - 2);
+        return buffer + len + offset;
+    } else if(len == 1) {
+        // 1e30
+        return WriteExponent(kk - 1, buffer + 1);
+    }
+    // 1234e30 -> 1.234e+33
+    memmove(buffer + 2, buffer + 1, len - 1);
+    buffer[1] = '.';
+    return WriteExponent(kk - 1, buffer + len + 1);
+}
+
+/**
+ * @brief strtod受LC_NUMERIC影响，解析JSON固定用C locale
+ */
+locale_t CLocale() {
+    static locale_t s_locale = newlocale(LC_ALL_MASK, "C", (locale_t)0);
+    return s_locale;
+}
+
+}
+
+void JsonWriter::AppendDouble(std::string& out, double v) {
+    if(!isfinite(v)) {
+        out.append("null", 4);
+        return;
+    }
+    // 整数值直接按整数格式化
+    if(fabs(v) < 1e15 && v == (double)(int64_t)v) {
+        AppendInt(out, (int64_t)v);
+        return;
+    }
+    char buf[32];
+    char* p = buf;
+    if(v < 0) {
+        *p++ = '-';
+        v = -v;
+    }
+    int len = 0;
+    int k = 0;
+    Grisu2(v, p, &len, &k);
+    out.append(buf, Prettify(p, len, k) - buf);
+}
+
+JsonWriter::JsonWriter(std::string& out)
+    :m_out(&out) {
+}
+
+JsonWriter::JsonWriter(ByteArray::ptr ba)
+    :m_out(&m_buffer)
+    ,m_ba(ba) {
+    m_buffer.reserve(s_chunk + 256);
+}
+
+JsonWriter::~JsonWriter() {
+    flush();
+}
+
+void JsonWriter::flush() {
+    if(m_ba && !m_buffer.empty()) {
+        m_ba->write(m_buffer.c_str(), m_buffer.size());
+        m_buffer.clear();
+    }
+}
+
+void JsonWriter::prefix() {
+    if(m_afterKey) {
+        m_afterKey = false;
+        return;
+    }
+    if(!m_stack.empty()) {
+        if(m_stack.back()) {
+            m_out->append(1, ',');
+        } else {
+            m_stack.back() = true;
+        }
+    }
+}
+
+JsonWriter& JsonWriter::startObject() {
+    prefix();
+    m_out->append(1, '{');
+    m_stack.push_back(false);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    m_stack.pop_back();
+    m_out->append(1, '}');
+    check();
+    return *this;
+}
+
+JsonWriter& JsonWriter::startArray() {
+    prefix();
+    m_out->append(1, '[');
+    m_stack.push_back(false);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    m_stack.pop_back();
+    m_out->append(1, ']');
+    check();
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(const char* k, size_t len) {
+    prefix();
+    AppendString(*m_out, k, len);
+    m_out->append(1, ':');
+    m_afterKey = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(const char* k) {
+    return key(k, strlen(k));
+}
+
+JsonWriter& JsonWriter::value(const char* v, size_t len) {
+    prefix();
+    AppendString(*m_out, v, len);
+    check();
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const char* v) {
+    if(!v) {
+        return null();
+    }
+    return value(v, strlen(v));
+}
+
+JsonWriter& JsonWriter::value(bool v) {
+    prefix();
+    if(v) {
+        m_out->append("true", 4);
+    } else {
+        m_out->append("false", 5);
+    }
+    check();
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(int64_t v) {
+    prefix();
+    AppendInt(*m_out, v);
+    check();
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(uint64_t v) {
+    prefix();
+    AppendUint(*m_out, v);
+    check();
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(double v) {
+    prefix();
+    AppendDouble(*m_out, v);
+    check();
+    return *this;
+}
+
+JsonWriter& JsonWriter::null() {
+    prefix();
+    m_out->append("null", 4);
+    check();
+    return *this;
+}
+
+JsonWriter& JsonWriter::raw(const char* json, size_t len) {
+    prefix();
+    m_out->append(json, len);
+    check();
+    return *this;
+}
+
+JsonReader::JsonReader(const char* data, size_t len, uint32_t max_depth)
+    :m_data(data)
+    ,m_pos(data)
+    ,m_end(data + len)
+    ,m_maxDepth(max_depth) {
+}
+
+bool JsonReader::fail() {
+    m_error = true;
+    return false;
+}
+
+char JsonReader::next() {
+    while(m_pos < m_end) {
+        char c = *m_pos;
+        if(c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+            return c;
+        }
+        ++m_pos;
+    }
+    return 0;
+}
+
+JsonReader::Type JsonReader::peek() {
+    if(m_error) {
+        return NONE;
+    }
+    switch(next()) {
+        case '{': return OBJECT;
+        case '[': return ARRAY;
+        case '"': return STRING;
+        case 't':
+        case 'f': return BOOL;
+        case 'n': return NUL;
+        case '-':
+        case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9':
+            return NUMBER;
+        default:
+            return NONE;
+    }
+}
+
+bool JsonReader::enterObject() {
+    if(peek() != OBJECT) {
+        return false;
+    }
+    if(m_stack.size() >= m_maxDepth) {
+        return fail();
+    }
+    ++m_pos;
+    m_stack.push_back({false, false});
+    return true;
+}
+
+bool JsonReader::enterArray() {
+    if(peek() != ARRAY) {
+        return false;
+    }
+    if(m_stack.size() >= m_maxDepth) {
+        return fail();
+    }
+    ++m_pos;
+    m_stack.push_back({true, false});
+    return true;
+}
+
+bool JsonReader::nextKey(std::string& key) {
+    return nextKey(&key);
+}
+
+bool JsonReader::nextKey(std::string* key) {
+    if(m_error || m_stack.empty() || m_stack.back().array) {
+        return fail();
+    }
+    Level& level = m_stack.back();
+    char c = next();
+    if(c == '}') {
+        ++m_pos;
+        m_stack.pop_back();
+        return false;
+    }
+    if(level.started) {
+        if(c != ',') {
+            return fail();
+        }
+        ++m_pos;
+        c = next();
+    }
+    level.started = true;
+    if(c != '"' || !parseString(key)) {
+        return fail();
+    }
+    if(next() != ':') {
+        return fail();
+    }
+    ++m_pos;
+    return true;
+}
+
+bool JsonReader::nextElement() {
+    if(m_error || m_stack.empty() || !m_stack.back().array) {
+        return fail();
+    }
+    Level& level = m_stack.back();
+    char c = next();
+    if(c == ']') {
+        ++m_pos;
+        m_stack.pop_back();
+        return false;
+    }
+    if(level.started) {
+        if(c != ',') {
+            return fail();
+        }
+        ++m_pos;
+    }
+    level.started = true;
+    // 逗号后面必须是一个值
+    if(peek() == NONE) {
+        return fail();
+    }
+    return true;
+}
+
+static inline bool IsDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static inline int HexValue(char c) {
+    if(c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c |= 0x20;
+    if(c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+static bool ParseHex4(const char* p, const char* end, uint32_t& v) {
+    if(end - p < 4) {
+        return false;
+    }
+    v = 0;
+    for(int i = 0; i < 4; ++i) {
+        int h = HexValue(p[i]);
+        if(h < 0) {
+            return false;
+        }
+        v = (v << 4) | h;
+    }
+    return true;
+}
+
+static void AppendUtf8(std::string& out, uint32_t cp) {
+    char buf[4];
+    if(cp < 0x80) {
+        out.append(1, (char)cp);
+    } else if(cp < 0x800) {
+        buf[0] = 0xc0 | (cp >> 6);
+        buf[1] = 0x80 | (cp & 0x3f);
+        out.append(buf, 2);
+    } else if(cp < 0x10000) {
+        buf[0] = 0xe0 | (cp >> 12);
+        buf[1] = 0x80 | ((cp >> 6) & 0x3f);
+        buf[2] = 0x80 | (cp & 0x3f);
+        out.append(buf, 3);
+    } else {
+        buf[0] = 0xf0 | (cp >> 18);
+        buf[1] = 0x80 | ((cp >> 12) & 0x3f);
+        buf[2] = 0x80 | ((cp >> 6) & 0x3f);
+        buf[3] = 0x80 | (cp & 0x3f);
+        out.append(buf, 4);
+    }
+}
+
+bool JsonReader::parseString(std::string* v) {
+    // m_pos指向开头的引号
+    const char* p = m_pos + 1;
+    if(v) {
+        v->clear();
+    }
+    while(true) {
+        const char* run = p;
+        while(p < m_end && *p != '"' && *p != '\\' && (unsigned char)*p >= 0x20) {
+            ++p;
+        }
+        if(v) {
+            v->append(run, p - run);
+        }
+        if(p >= m_end || (unsigned char)*p < 0x20) {
+            m_pos = p;
+            return fail();
+        }
+        if(*p == '"') {
+            m_pos = p + 1;
+            return true;
+        }
+        // 转义
+        if(++p >= m_end) {
+            m_pos = p;
+            return fail();
+        }
+        char c = *p++;
+        char ch = 0;
+        switch(c) {
+            case '"': ch = '"'; break;
+            case '\\': ch = '\\'; break;
+            case '/': ch = '/'; break;
+            case 'b': ch = '\b'; break;
+            case 'f': ch = '\f'; break;
+            case 'n': ch = '\n'; break;
+            case 'r': ch = '\r'; break;
+            case 't': ch = '\t'; break;
+            case 'u': {
+                uint32_t cp = 0;
+                if(!ParseHex4(p, m_end, cp)) {
+                    m_pos = p;
+                    return fail();
+                }
+                p += 4;
+                if(cp >= 0xdc00 && cp <= 0xdfff) {
+                    m_pos = p;
+                    return fail();
+                }
+                if(cp >= 0xd800 && cp <= 0xdbff) {
+                    // 代理对
+                    uint32_t low = 0;
+                    if(m_end - p < 6 || p[0] != '\\' || p[1] != 'u'
+                            || !ParseHex4(p + 2, m_end, low)
+                            || low < 0xdc00 || low > 0xdfff) {
+                        m_pos = p;
+                        return fail();
+                    }
+                    p += 6;
+                    cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+                }
+                if(v) {
+                    AppendUtf8(*v, cp);
+                }
+                continue;
+            }
+            default:
+                m_pos = p - 1;
+                return fail();
+        }
+        if(v) {
+            v->append(1, ch);
+        }
+    }
+}
+
+const char* JsonReader::scanNumber(bool& integer) {
+    const char* p = m_pos;
+    integer = true;
+    if(p < m_end && *p == '-') {
+        ++p;
+    }
+    if(p >= m_end || !IsDigit(*p)) {
+        return nullptr;
+    }
+    // 不允许前导0
+    if(*p == '0') {
+        ++p;
+    } else {
+        while(p < m_end && IsDigit(*p)) {
+            ++p;
+        }
+    }
+    if(p < m_end && *p == '.') {
+        integer = false;
+        if(++p >= m_end || !IsDigit(*p)) {
+            return nullptr;
+        }
+        while(p < m_end && IsDigit(*p)) {
+            ++p;
+        }
+    }
+    if(p < m_end && (*p == 'e' || *p == 'E')) {
+        integer = false;
+        ++p;
+        if(p < m_end && (*p == '+' || *p == '-')) {
+            ++p;
+        }
+        if(p >= m_end || !IsDigit(*p)) {
+            return nullptr;
+        }
+        while(p < m_end && IsDigit(*p)) {
+            ++p;
+        }
+    }
+    return p;
+}
+
+bool JsonReader::readUint64(uint64_t& v) {
+    if(peek() != NUMBER || *m_pos == '-') {
+        return false;
+    }
+    bool integer = false;
+    const char* end = scanNumber(integer);
+    if(!end) {
+        return fail();
+    }
+    if(!integer) {
+        return false;
+    }
+    uint64_t rt = 0;
+    for(const char* p = m_pos; p < end; ++p) {
+        uint64_t d = *p - '0';
+        if(rt > (UINT64_MAX - d) / 10) {
+            return false;
+        }
+        rt = rt * 10 + d;
+    }
+    v = rt;
+    m_pos = end;
+    return true;
+}
+
+bool JsonReader::readInt64(int64_t& v) {
+    if(peek() != NUMBER) {
+        return false;
+    }
+    bool integer = false;
+    const char* end = scanNumber(integer);
+    if(!end) {
+        return fail();
+    }
+    if(!integer) {
+        return false;
+    }
+    bool neg = *m_pos == '-';
+    uint64_t limit = neg ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+    uint64_t rt = 0;
+    for(const char* p = m_pos + neg; p < end; ++p) {
+        uint64_t d = *p - '0';
+        if(rt > (limit - d) / 10) {
+            return false;
+        }
+        rt = rt * 10 + d;
+    }
+    v = neg ? (int64_t)(0 - rt) : (int64_t)rt;
+    m_pos = end;
+    return true;
+}
+
+bool JsonReader::readDouble(double& v) {
+    if(peek() != NUMBER) {
+        return false;
+    }
+    bool integer = false;
+    const char* end = scanNumber(integer);
+    if(!end) {
+        return fail();
+    }
+    // 输入不一定以'\0'结尾，复制出来再交给strtod
+    size_t len = end - m_pos;
+    char buf[64];
+    if(len < sizeof(buf)) {
+        memcpy(buf, m_pos, len);
+        buf[len] = '\0';
+        v = strtod_l(buf, nullptr, CLocale());
+    } else {
+        v = strtod_l(std::string(m_pos, len).c_str(), nullptr, CLocale());
+    }
+    m_pos = end;
+    return true;
+}
+
+bool JsonReader::literal(const char* word, size_t len) {
+    if((size_t)(m_end - m_pos) < len || memcmp(m_pos, word, len) != 0) {
+        return fail();
+    }
+    m_pos += len;
+    return true;
+}
+
+bool JsonReader::readBool(bool& v) {
+    if(peek() != BOOL) {
+        return false;
+    }
+    v = *m_pos == 't';
+    return v ? literal("true", 4) : literal("false", 5);
+}
+
+bool JsonReader::readNull() {
+    if(peek() != NUL) {
+        return false;
+    }
+    return literal("null", 4);
+}
+
+bool JsonReader::readString(std::string& v) {
+    if(peek() != STRING) {
+        return false;
+    }
+    return parseString(&v);
+}
+
+bool JsonReader::skipScalar() {
+    bool integer = false;
+    const char* end = nullptr;
+    switch(peek()) {
+        case STRING:
+            return parseString(nullptr);
+        case NUMBER:
+            end = scanNumber(integer);
+            if(!end) {
+                return fail();
+            }
+            m_pos = end;
+            return true;
+        case BOOL:
+            return *m_pos == 't' ? literal("true", 4) : literal("false", 5);
+        case NUL:
+            return literal("null", 4);
+        default:
+            return fail();
+    }
+}
+
+bool JsonReader::skip() {
+    Type type = peek();
+    if(type != OBJECT && type != ARRAY) {
+        return skipScalar();
+    }
+    // 用m_stack代替递归，嵌套再深也不会栈溢出
+    size_t depth = m_stack.size();
+    if(type == OBJECT ? !enterObject() : !enterArray()) {
+        return false;
+    }
+    while(m_stack.size() > depth && !m_error) {
+        bool more = m_stack.back().array ? nextElement() : nextKey(nullptr);
+        if(!more) {
+            continue;
+        }
+        type = peek();
+        if(type == OBJECT) {
+            enterObject();
+        } else if(type == ARRAY) {
+            enterArray();
+        } else {
+            skipScalar();
+        }
+    }
+    return !m_error;
+}
+
+bool JsonReader::isEnd() {
+    return !m_error && m_stack.empty() && next() == 0 && m_pos == m_end;
+}
+
+}
@@ -0,0 +1,344 @@
+/**
+ * @file json.h
+ * @brief 流式JSON写入器和按需读取器，不建立DOM
+ * @version 0.1
+ * @date 2026-10-19
+ */
+#ifndef __SYLAR_JSON_H__
+#define __SYLAR_JSON_H__
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "bytearray.h"
+
+namespace sylar {
+
+/**
+ * @brief 流式JSON写入器
+ * @details 直接写进目标std::string(如随后move进HttpResponse的消息体)，
+ *          或按块写进ByteArray，中间不经过stringstream。
+ *          逗号和冒号由写入器按嵌套层次自动添加，调用方只需按顺序写key和value。
+ *          整数按两位一组查表格式化，字符串在SSE2下每次检查16个字节(否则8个字节)是否需要转义，不需要转义的部分整段拷贝
+ */
+class JsonWriter {
+public:
+    /**
+     * @brief 写进out，out原有的内容保留
+     */
+    JsonWriter(std::string& out);
+
+    /**
+     * @brief 写进ba，内容先在内部缓冲区中攒满一块再写入，最后需要调用flush
+     */
+    JsonWriter(ByteArray::ptr ba);
+
+    /**
+     * @brief 析构时把剩余内容写入ByteArray
+     */
+    ~JsonWriter();
+
+    /**
+     * @brief 开始一个对象
+     */
+    JsonWriter& startObject();
+
+    /**
+     * @brief 结束当前对象
+     */
+    JsonWriter& endObject();
+
+    /**
+     * @brief 开始一个数组
+     */
+    JsonWriter& startArray();
+
+    /**
+     * @brief 结束当前数组
+     */
+    JsonWriter& endArray();
+
+    /**
+     * @brief 写对象的key，之后必须写一个value
+     */
+    JsonWriter& key(const char* k, size_t len);
+    JsonWriter& key(const char* k);
+    JsonWriter& key(const std::string& k) { return key(k.c_str(), k.size());}
+
+    /**
+     * @brief 写字符串
+     */
+    JsonWriter& value(const char* v, size_t len);
+    JsonWriter& value(const char* v);
+    JsonWriter& value(const std::string& v) { return value(v.c_str(), v.size());}
+
+    /**
+     * @brief 写布尔值
+     */
+    JsonWriter& value(bool v);
+
+    /**
+     * @brief 写整数
+     */
+    JsonWriter& value(int32_t v) { return value((int64_t)v);}
+    JsonWriter& value(uint32_t v) { return value((uint64_t)v);}
+    JsonWriter& value(int64_t v);
+    JsonWriter& value(uint64_t v);
+
+    /**
+     * @brief 写浮点数，NaN和无穷写成null
+     */
+    JsonWriter& value(double v);
+
+    /**
+     * @brief 写null
+     */
+    JsonWriter& null();
+
+    /**
+     * @brief 原样写入一段已经编码好的JSON
+     */
+    JsonWriter& raw(const char* json, size_t len);
+    JsonWriter& raw(const std::string& json) { return raw(json.c_str(), json.size());}
+
+    /**
+     * @brief 把内部缓冲区中的内容写入ByteArray，写进std::string时什么也不做
+     */
+    void flush();
+
+    /**
+     * @brief 当前的嵌套层数
+     */
+    size_t getDepth() const { return m_stack.size();}
+
+    /**
+     * @brief 把s转义后加上引号追加到out
+     */
+    static void AppendString(std::string& out, const char* s, size_t len);
+
+    /**
+     * @brief 把整数的十进制追加到out
+     */
+    static void AppendInt(std::string& out, int64_t v);
+    static void AppendUint(std::string& out, uint64_t v);
+
+    /**
+     * @brief 把浮点数按能还原的最短精度追加到out
+     * @details 用Grisu2生成数字，不受locale影响，输出总能被strtod精确还原。
+     *          Grisu2在极少数情况下比真正最短的表示多一位，换来不需要大整数回退的固定耗时
+     */
+    static void AppendDouble(std::string& out, double v);
+private:
+    /**
+     * @brief 写value或key之前按需要加逗号
+     */
+    void prefix();
+
+    /**
+     * @brief 写进ByteArray时，缓冲区满了就写入
+     */
+    void check() {
+        if(m_ba && m_buffer.size() >= s_chunk) {
+            flush();
+        }
+    }
+private:
+    /// 写进ByteArray时每块的大小
+    static const size_t s_chunk = 4096;
+    /// 写入目标
+    std::string* m_out;
+    /// 写进ByteArray时的缓冲区
+    std::string m_buffer;
+    /// 目标ByteArray
+    ByteArray::ptr m_ba;
+    /// 每一层是否已有元素，最外层不需要逗号
+    std::vector<bool> m_stack;
+    /// 刚写完key，下一个value前不加逗号
+    bool m_afterKey = false;
+};
+
+/**
+ * @brief 按需读取的JSON读取器
+ * @details 直接在输入上逐个读取token，调用方按期望的结构取值，不关心的字段用skip()跳过，
+ *          不为整个文档分配内存。输入必须在读取期间保持有效。
+ *          读取的类型与实际不符时返回false，不消耗输入；语法错误后所有读取都返回false，错误位置见getOffset()
+ *
+ * @code
+ *  JsonReader reader(req->getBody());
+ *  std::string key;
+ *  if(reader.enterObject()) {
+ *      while(reader.nextKey(key)) {
+ *          if(key == "id") {
+ *              reader.readInt64(id);
+ *          } else {
+ *              reader.skip();
+ *          }
+ *      }
+ *  }
+ *  if(reader.hasError() || !reader.isEnd()) { ... }
+ * @endcode
+ */
+class JsonReader {
+public:
+    /**
+     * @brief 值的类型
+     */
+    enum Type {
+        /// 输入结束或出错
+        NONE = 0,
+        OBJECT,
+        ARRAY,
+        STRING,
+        NUMBER,
+        BOOL,
+        NUL
+    };
+
+    /**
+     * @brief 构造函数
+     * @param[in] data 输入
+     * @param[in] len 输入长度
+     * @param[in] max_depth 最大嵌套层数
+     */
+    JsonReader(const char* data, size_t len, uint32_t max_depth = 128);
+    JsonReader(const std::string& data, uint32_t max_depth = 128)
+        :JsonReader(data.c_str(), data.size(), max_depth) {}
+    /// 读取器不持有输入，不能读临时字符串
+    JsonReader(std::string&& data, uint32_t max_depth = 128) = delete;
+
+    /**
+     * @brief 下一个值的类型，不消耗输入
+     */
+    Type peek();
+
+    /**
+     * @brief 进入对象
+     */
+    bool enterObject();
+
+    /**
+     * @brief 读取对象的下一个key
+     * @return 对象结束时返回false并离开对象
+     */
+    bool nextKey(std::string& key);
+
+    /**
+     * @brief 进入数组
+     */
+    bool enterArray();
+
+    /**
+     * @brief 数组中是否还有下一个元素
+     * @return 数组结束时返回false并离开数组
+     */
+    bool nextElement();
+
+    /**
+     * @brief 读取字符串，\\u转义解码为UTF-8
+     */
+    bool readString(std::string& v);
+
+    /**
+     * @brief 读取整数，不是整数或超出范围时返回false
+     */
+    bool readInt64(int64_t& v);
+    bool readUint64(uint64_t& v);
+
+    /**
+     * @brief 读取数字
+     */
+    bool readDouble(double& v);
+
+    /**
+     * @brief 读取布尔值
+     */
+    bool readBool(bool& v);
+
+    /**
+     * @brief 读取null
+     */
+    bool readNull();
+
+    /**
+     * @brief 跳过下一个值，包括嵌套的对象和数组
+     */
+    bool skip();
+
+    /**
+     * @brief 是否已读完全部输入，只剩空白
+     */
+    bool isEnd();
+
+    /**
+     * @brief 是否出错
+     */
+    bool hasError() const { return m_error;}
+
+    /**
+     * @brief 当前读取位置，出错时为出错的位置
+     */
+    size_t getOffset() const { return m_pos - m_data;}
+private:
+    /**
+     * @brief 跳过空白，返回下一个字符，输入结束时返回0
+     */
+    char next();
+
+    /**
+     * @brief 读取key，key为空时只跳过
+     */
+    bool nextKey(std::string* key);
+
+    /**
+     * @brief 跳过一个字符串、数字、布尔值或null
+     */
+    bool skipScalar();
+
+    /**
+     * @brief 扫描数字，返回数字的结束位置
+     */
+    const char* scanNumber(bool& integer);
+
+    /**
+     * @brief 匹配字面量true/false/null
+     */
+    bool literal(const char* word, size_t len);
+
+    /**
+     * @brief 解析字符串，v为空时只跳过
+     */
+    bool parseString(std::string* v);
+
+    /**
+     * @brief 设置错误
+     */
+    bool fail();
+private:
+    /**
+     * @brief 每一层的状态
+     */
+    struct Level {
+        /// 是否为数组
+        bool array;
+        /// 是否已读过元素
+        bool started;
+    };
+
+    /// 输入起始位置
+    const char* m_data;
+    /// 当前位置
+    const char* m_pos;
+    /// 输入结束位置
+    const char* m_end;
+    /// 最大嵌套层数
+    uint32_t m_maxDepth;
+    /// 嵌套层次
+    std::vector<Level> m_stack;
+    /// 是否出错
+    bool m_error = false;
+};
+
+}
+
+#endif
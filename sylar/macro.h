@@ -11,6 +11,7 @@
 
 #include <string.h>
 #include <assert.h>
+#include "flight_recorder.h"
 #include "log.h"
 #include "util.h"
 
@@ -30,6 +31,7 @@
         SYLAR_LOG_ERROR(SYLAR_LOG_ROOT()) << "ASSERTION: " #x                          \
                                           << "\nbacktrace:\n"                          \
                                           << sylar::BacktraceToString(100, 2, "    "); \
+        sylar::FlightRecorder::OnAssert();                                             \
         assert(x);                                                                     \
     }
 
@@ -41,6 +43,7 @@
                                           << w                                         \
                                           << "\nbacktrace:\n"                          \
                                           << sylar::BacktraceToString(100, 2, "    "); \
+        sylar::FlightRecorder::OnAssert();                                             \
         assert(x);                                                                     \
     }
 
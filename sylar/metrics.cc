@@ -0,0 +1,310 @@
+/**
+ * @file metrics.cc
+ * @brief 指标注册表实现
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "metrics.h"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <sstream>
+#include "log.h"
+
+namespace sylar {
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_NAME("system");
+
+static std::atomic<size_t> s_next_slot = {0};
+
+/**
+ * @brief 按Prometheus的写法输出浮点数
+ */
+static std::string FormatValue(double v) {
+    if(isnan(v)) {
+        return "NaN";
+    }
+    if(isinf(v)) {
+        return v > 0 ? "+Inf" : "-Inf";
+    }
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.12g", v);
+    return buf;
+}
+
+static void WriteSample(std::ostream& os, const std::string& name
+                        ,const std::string& labels, const std::string& value) {
+    os << name;
+    if(!labels.empty()) {
+        os << '{' << labels << '}';
+    }
+    os << ' ' << value << '\n';
+}
+
+const char* Metric::TypeToString(Type type) {
+    switch(type) {
+        case COUNTER:
+            return "counter";
+        case GAUGE:
+            return "gauge";
+        case HISTOGRAM:
+            return "histogram";
+        case SUMMARY:
+            return "summary";
+        default:
+            return "untyped";
+    }
+}
+
+size_t Metric::GetSlot() {
+    static thread_local size_t t_slot = s_next_slot++ % s_slots;
+    return t_slot;
+}
+
+Counter::Counter()
+    :Metric(COUNTER) {
+    for(auto& i : m_cells) {
+        i.value = 0;
+    }
+}
+
+uint64_t Counter::get() const {
+    uint64_t v = 0;
+    for(auto& i : m_cells) {
+        v += i.value.load(std::memory_order_relaxed);
+    }
+    return v;
+}
+
+void Counter::write(std::ostream& os, const std::string& name, const std::string& labels) {
+    WriteSample(os, name, labels, std::to_string(get()));
+}
+
+Gauge::Gauge(Callback cb)
+    :Metric(GAUGE)
+    ,m_cb(cb) {
+}
+
+double Gauge::get() const {
+    return m_cb ? m_cb() : m_value.load(std::memory_order_relaxed);
+}
+
+void Gauge::write(std::ostream& os, const std::string& name, const std::string& labels) {
+    WriteSample(os, name, labels, FormatValue(get()));
+}
+
+Histogram::Histogram(const std::vector<double>& bounds)
+    :Metric(HISTOGRAM)
+    ,m_bounds(bounds) {
+    std::sort(m_bounds.begin(), m_bounds.end());
+    m_bounds.erase(std::unique(m_bounds.begin(), m_bounds.end()), m_bounds.end());
+    for(auto& s : m_slots) {
+        s.counts.reset(new std::atomic<uint64_t>[m_bounds.size() + 1]);
+        for(size_t i = 0; i <= m_bounds.size(); ++i) {
+            s.counts[i] = 0;
+        }
+    }
+}
+
+const std::vector<double>& Histogram::DefaultBounds() {
+    static std::vector<double> s_bounds = {0.0005, 0.001, 0.0025, 0.005, 0.01
+        ,0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10};
+    return s_bounds;
+}
+
+void Histogram::observe(double v) {
+    Slot& s = m_slots[GetSlot()];
+    size_t idx = std::lower_bound(m_bounds.begin(), m_bounds.end(), v) - m_bounds.begin();
+    s.counts[idx].fetch_add(1, std::memory_order_relaxed);
+    // 槽只被少数线程写，CAS基本不会失败
+    uint64_t old_bits = s.sum.load(std::memory_order_relaxed);
+    uint64_t new_bits;
+    do {
+        double d;
+        memcpy(&d, &old_bits, sizeof(d));
+        d += v;
+        memcpy(&new_bits, &d, sizeof(d));
+    } while(!s.sum.compare_exchange_weak(old_bits, new_bits, std::memory_order_relaxed));
+}
+
+uint64_t Histogram::getCount() const {
+    uint64_t v = 0;
+    for(auto& s : m_slots) {
+        for(size_t i = 0; i <= m_bounds.size(); ++i) {
+            v += s.counts[i].load(std::memory_order_relaxed);
+        }
+    }
+    return v;
+}
+
+double Histogram::getSum() const {
+    double v = 0;
+    for(auto& s : m_slots) {
+        uint64_t bits = s.sum.load(std::memory_order_relaxed);
+        double d;
+        memcpy(&d, &bits, sizeof(d));
+        v += d;
+    }
+    return v;
+}
+
+void Histogram::write(std::ostream& os, const std::string& name, const std::string& labels) {
+    std::vector<uint64_t> counts(m_bounds.size() + 1, 0);
+    double sum = 0;
+    for(auto& s : m_slots) {
+        for(size_t i = 0; i < counts.size(); ++i) {
+            counts[i] += s.counts[i].load(std::memory_order_relaxed);
+        }
+        uint64_t bits = s.sum.load(std::memory_order_relaxed);
+        double d;
+        memcpy(&d, &bits, sizeof(d));
+        sum += d;
+    }
+    std::string prefix = labels.empty() ? "" : labels + ",";
+    uint64_t total = 0;
+    for(size_t i = 0; i < counts.size(); ++i) {
+        total += counts[i];
+        std::string le = i < m_bounds.size() ? FormatValue(m_bounds[i]) : "+Inf";
+        WriteSample(os, name + "_bucket", prefix + "le=\"" + le + "\"", std::to_string(total));
+    }
+    WriteSample(os, name + "_sum", labels, FormatValue(sum));
+    WriteSample(os, name + "_count", labels, std::to_string(total));
+}
+
+Summary::Summary(double scale, uint64_t max_value)
+    :Metric(SUMMARY)
+    ,m_scale(scale)
+    ,m_hist(max_value) {
+}
+
+void Summary::write(std::ostream& os, const std::string& name, const std::string& labels) {
+    HdrSnapshot snap = m_hist.snapshot();
+    std::string prefix = labels.empty() ? "" : labels + ",";
+    static const double s_quantiles[] = {0.5, 0.9, 0.99, 0.999};
+    for(double q : s_quantiles) {
+        double v = snap.getCount() ? snap.percentile(q * 100) * m_scale : NAN;
+        WriteSample(os, name, prefix + "quantile=\"" + FormatValue(q) + "\"", FormatValue(v));
+    }
+    WriteSample(os, name + "_sum", labels, FormatValue(snap.getSum() * m_scale));
+    WriteSample(os, name + "_count", labels, std::to_string(snap.getCount()));
+}
+
+Counter::ptr MetricsRegistry::counter(const std::string& name, const std::string& help
+                                      ,const Labels& labels) {
+    return std::static_pointer_cast<Counter>(getOrCreate(name, help, labels
+                , Metric::COUNTER, []() { return std::make_shared<Counter>(); }));
+}
+
+Gauge::ptr MetricsRegistry::gauge(const std::string& name, const std::string& help
+                                  ,const Labels& labels) {
+    return std::static_pointer_cast<Gauge>(getOrCreate(name, help, labels
+                , Metric::GAUGE, []() { return std::make_shared<Gauge>(); }));
+}
+
+Gauge::ptr MetricsRegistry::gauge(const std::string& name, const std::string& help
+                                  ,const Labels& labels, Gauge::Callback cb) {
+    return std::static_pointer_cast<Gauge>(getOrCreate(name, help, labels
+                , Metric::GAUGE, [cb]() { return std::make_shared<Gauge>(cb); }, true));
+}
+
+Histogram::ptr MetricsRegistry::histogram(const std::string& name, const std::string& help
+                                          ,const Labels& labels
+                                          ,const std::vector<double>& bounds) {
+    return std::static_pointer_cast<Histogram>(getOrCreate(name, help, labels
+                , Metric::HISTOGRAM, [bounds]() {
+                    return std::make_shared<Histogram>(bounds.empty()
+                                ? Histogram::DefaultBounds() : bounds);
+                }));
+}
+
+Summary::ptr MetricsRegistry::summary(const std::string& name, const std::string& help
+                                      ,const Labels& labels, double scale) {
+    return std::static_pointer_cast<Summary>(getOrCreate(name, help, labels
+                , Metric::SUMMARY, [scale]() { return std::make_shared<Summary>(scale); }));
+}
+
+Metric::ptr MetricsRegistry::getOrCreate(const std::string& name, const std::string& help
+                                         ,const Labels& labels, Metric::Type type
+                                         ,std::function<Metric::ptr()> creator, bool replace) {
+    std::string key = FormatLabels(labels);
+    if(!replace) {
+        RWMutexType::ReadLock lock(m_mutex);
+        auto it = m_families.find(name);
+        if(it != m_families.end()) {
+            auto mit = it->second.metrics.find(key);
+            if(mit != it->second.metrics.end()) {
+                return mit->second->getType() == type ? mit->second : nullptr;
+            }
+        }
+    }
+    RWMutexType::WriteLock lock(m_mutex);
+    auto it = m_families.find(name);
+    if(it == m_families.end()) {
+        Family family;
+        family.help = help;
+        family.type = type;
+        it = m_families.insert(std::make_pair(name, family)).first;
+    } else if(it->second.type != type) {
+        SYLAR_LOG_ERROR(g_logger) << "metric " << name << " registered as "
+            << Metric::TypeToString(it->second.type)
+            << " not " << Metric::TypeToString(type);
+        return nullptr;
+    }
+    Metric::ptr& m = it->second.metrics[key];
+    if(!m || replace) {
+        m = creator();
+    }
+    return m;
+}
+
+void MetricsRegistry::remove(const std::string& name, const Labels& labels) {
+    RWMutexType::WriteLock lock(m_mutex);
+    auto it = m_families.find(name);
+    if(it == m_families.end()) {
+        return;
+    }
+    it->second.metrics.erase(FormatLabels(labels));
+    if(it->second.metrics.empty()) {
+        m_families.erase(it);
+    }
+}
+
+std::string MetricsRegistry::toPrometheus() {
+    std::stringstream ss;
+    // 采集期间持有读锁，删除指标的一方会等采集结束，回调里引用的对象不会提前析构
+    RWMutexType::ReadLock lock(m_mutex);
+    for(auto& i : m_families) {
+        if(!i.second.help.empty()) {
+            ss << "# HELP " << i.first << ' ' << i.second.help << '\n';
+        }
+        ss << "# TYPE " << i.first << ' ' << Metric::TypeToString(i.second.type) << '\n';
+        for(auto& m : i.second.metrics) {
+            m.second->write(ss, i.first, m.first);
+        }
+    }
+    return ss.str();
+}
+
+std::string MetricsRegistry::FormatLabels(const Labels& labels) {
+    std::string str;
+    for(auto& i : labels) {
+        if(!str.empty()) {
+            str += ',';
+        }
+        str += i.first + "=\"";
+        for(char c : i.second) {
+            if(c == '\\' || c == '"') {
+                str += '\\';
+                str += c;
+            } else if(c == '\n') {
+                str += "\\n";
+            } else {
+                str += c;
+            }
+        }
+        str += '"';
+    }
+    return str;
+}
+
+}
@@ -0,0 +1,357 @@
+/**
+ * @file metrics.h
+ * @brief 指标注册表，按Prometheus文本格式导出
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#ifndef __SYLAR_METRICS_H__
+#define __SYLAR_METRICS_H__
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "hdr_histogram.h"
+#include "mutex.h"
+#include "singleton.h"
+
+namespace sylar {
+
+/**
+ * @brief 指标基类
+ * @details 计数器、直方图按线程分槽累加，每个线程只写自己的槽，热路径上只有一次无竞争的原子加，
+ *          只有被采集时才把各槽的值汇总
+ */
+class Metric {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<Metric> ptr;
+
+    /**
+     * @brief 指标类型
+     */
+    enum Type {
+        COUNTER,
+        GAUGE,
+        HISTOGRAM,
+        SUMMARY
+    };
+
+    /**
+     * @brief 构造函数
+     * @param[in] type 指标类型
+     */
+    Metric(Type type)
+        :m_type(type) {}
+
+    /**
+     * @brief 析构函数
+     */
+    virtual ~Metric() {}
+
+    /**
+     * @brief 返回指标类型
+     */
+    Type getType() const { return m_type;}
+
+    /**
+     * @brief 以Prometheus文本格式输出样本
+     * @param[in] os 输出流
+     * @param[in] name 指标名
+     * @param[in] labels 已格式化的标签，如 a="1",b="2"，可以为空
+     */
+    virtual void write(std::ostream& os, const std::string& name, const std::string& labels) = 0;
+
+    /**
+     * @brief 返回类型对应的Prometheus类型名
+     */
+    static const char* TypeToString(Type type);
+
+    /**
+     * @brief 返回当前线程使用的槽位
+     */
+    static size_t GetSlot();
+
+    /// 每个指标的槽数
+    static const size_t s_slots = 32;
+private:
+    /// 指标类型
+    Type m_type;
+};
+
+/**
+ * @brief 单调递增的计数器
+ */
+class Counter : public Metric {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<Counter> ptr;
+
+    Counter();
+
+    /**
+     * @brief 增加计数
+     */
+    void inc(uint64_t v = 1) {
+        m_cells[GetSlot()].value.fetch_add(v, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 汇总各槽的值
+     */
+    uint64_t get() const;
+
+    void write(std::ostream& os, const std::string& name, const std::string& labels) override;
+private:
+    /**
+     * @brief 占满一个缓存行的槽，避免不同线程的槽共享缓存行
+     */
+    struct Cell {
+        std::atomic<uint64_t> value;
+        char pad[64 - sizeof(std::atomic<uint64_t>)];
+    };
+    /// 各线程的槽
+    Cell m_cells[s_slots];
+};
+
+/**
+ * @brief 可增可减的瞬时值
+ * @details 设置了回调时只在采集时调用回调取值，适合导出队列长度等已有的状态
+ */
+class Gauge : public Metric {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<Gauge> ptr;
+    /// 取值回调
+    typedef std::function<double()> Callback;
+
+    /**
+     * @brief 构造函数
+     * @param[in] cb 取值回调，为空时使用set/inc/dec维护的值
+     */
+    Gauge(Callback cb = nullptr);
+
+    /**
+     * @brief 设置当前值
+     */
+    void set(int64_t v) { m_value.store(v, std::memory_order_relaxed);}
+
+    /**
+     * @brief 增加
+     */
+    void inc(int64_t v = 1) { m_value.fetch_add(v, std::memory_order_relaxed);}
+
+    /**
+     * @brief 减少
+     */
+    void dec(int64_t v = 1) { m_value.fetch_sub(v, std::memory_order_relaxed);}
+
+    /**
+     * @brief 返回当前值
+     */
+    double get() const;
+
+    void write(std::ostream& os, const std::string& name, const std::string& labels) override;
+private:
+    /// 取值回调
+    Callback m_cb;
+    /// 当前值
+    std::atomic<int64_t> m_value = {0};
+};
+
+/**
+ * @brief 直方图
+ * @details 桶边界在创建时确定，每次观测按边界二分查找到桶，在当前线程的槽里计数
+ */
+class Histogram : public Metric {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<Histogram> ptr;
+
+    /**
+     * @brief 构造函数
+     * @param[in] bounds 升序的桶上界，+Inf桶自动添加
+     */
+    Histogram(const std::vector<double>& bounds);
+
+    /**
+     * @brief 记录一次观测值
+     */
+    void observe(double v);
+
+    /**
+     * @brief 汇总后的观测次数
+     */
+    uint64_t getCount() const;
+
+    /**
+     * @brief 汇总后的观测值之和
+     */
+    double getSum() const;
+
+    /**
+     * @brief 返回桶上界
+     */
+    const std::vector<double>& getBounds() const { return m_bounds;}
+
+    /**
+     * @brief 返回默认的桶上界，适用于以秒为单位的耗时
+     */
+    static const std::vector<double>& DefaultBounds();
+
+    void write(std::ostream& os, const std::string& name, const std::string& labels) override;
+private:
+    /**
+     * @brief 一个线程的槽
+     */
+    struct Slot {
+        /// 各桶的计数，最后一个是+Inf桶
+        std::unique_ptr<std::atomic<uint64_t>[]> counts;
+        /// 观测值之和，以double的位模式保存
+        std::atomic<uint64_t> sum = {0};
+    };
+    /// 桶上界
+    std::vector<double> m_bounds;
+    /// 各线程的槽
+    Slot m_slots[s_slots];
+};
+
+/**
+ * @brief 分位数摘要
+ * @details 用HdrHistogram记录整数值，采集时合并各线程的分段，输出0.5/0.9/0.99/0.999分位、和与次数。
+ *          不需要事先确定桶边界，长尾分位的误差不超过HdrHistogram的精度
+ */
+class Summary : public Metric {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<Summary> ptr;
+
+    /**
+     * @brief 构造函数
+     * @param[in] scale 输出时乘上的系数，如记录微秒、按秒输出时为1e-6
+     * @param[in] max_value 可区分的最大值
+     */
+    Summary(double scale = 1, uint64_t max_value = 1ull << 36);
+
+    /**
+     * @brief 记录一次观测值
+     */
+    void observe(uint64_t v) { m_hist.record(v);}
+
+    /**
+     * @brief 返回合并后的快照，值未乘系数
+     */
+    HdrSnapshot snapshot() const { return m_hist.snapshot();}
+
+    /**
+     * @brief 返回输出系数
+     */
+    double getScale() const { return m_scale;}
+
+    void write(std::ostream& os, const std::string& name, const std::string& labels) override;
+private:
+    /// 输出系数
+    double m_scale;
+    /// 直方图
+    HdrHistogram m_hist;
+};
+
+/**
+ * @brief 指标注册表
+ * @details 同名的指标组成一族，族内按标签区分。注册时加写锁，采集时加读锁，更新指标不经过注册表
+ */
+class MetricsRegistry {
+public:
+    /// 读写锁类型定义
+    typedef RWMutex RWMutexType;
+    /// 标签类型定义
+    typedef std::map<std::string, std::string> Labels;
+
+    /**
+     * @brief 获取或创建计数器
+     * @param[in] name 指标名
+     * @param[in] help 说明
+     * @param[in] labels 标签
+     * @return 同名指标类型不同时返回nullptr
+     */
+    Counter::ptr counter(const std::string& name, const std::string& help
+                         ,const Labels& labels = Labels());
+
+    /**
+     * @brief 获取或创建瞬时值
+     */
+    Gauge::ptr gauge(const std::string& name, const std::string& help
+                     ,const Labels& labels = Labels());
+
+    /**
+     * @brief 创建回调取值的瞬时值，已存在相同标签的指标时替换
+     */
+    Gauge::ptr gauge(const std::string& name, const std::string& help
+                     ,const Labels& labels, Gauge::Callback cb);
+
+    /**
+     * @brief 获取或创建直方图
+     * @param[in] bounds 桶上界，为空时使用Histogram::DefaultBounds()
+     */
+    Histogram::ptr histogram(const std::string& name, const std::string& help
+                             ,const Labels& labels = Labels()
+                             ,const std::vector<double>& bounds = std::vector<double>());
+
+    /**
+     * @brief 获取或创建分位数摘要
+     * @param[in] scale 输出系数
+     */
+    Summary::ptr summary(const std::string& name, const std::string& help
+                         ,const Labels& labels = Labels(), double scale = 1);
+
+    /**
+     * @brief 删除指标
+     * @details 回调引用了对象成员的指标需要在对象析构前删除
+     */
+    void remove(const std::string& name, const Labels& labels);
+
+    /**
+     * @brief 按Prometheus文本格式(0.0.4)输出所有指标
+     */
+    std::string toPrometheus();
+
+    /**
+     * @brief 把标签格式化为 a="1",b="2"
+     */
+    static std::string FormatLabels(const Labels& labels);
+private:
+    /**
+     * @brief 同名指标族
+     */
+    struct Family {
+        /// 说明
+        std::string help;
+        /// 类型
+        Metric::Type type;
+        /// 格式化后的标签 -> 指标
+        std::map<std::string, Metric::ptr> metrics;
+    };
+
+    /**
+     * @brief 获取或创建指标
+     * @param[in] replace 已存在时是否用新建的指标替换
+     */
+    Metric::ptr getOrCreate(const std::string& name, const std::string& help
+                            ,const Labels& labels, Metric::Type type
+                            ,std::function<Metric::ptr()> creator, bool replace = false);
+private:
+    /// 读写锁
+    RWMutexType m_mutex;
+    /// 指标名 -> 指标族
+    std::map<std::string, Family> m_families;
+};
+
+/// 指标注册表单例
+typedef sylar::Singleton<MetricsRegistry> MetricsMgr;
+
+}
+
+#endif
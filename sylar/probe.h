@@ -0,0 +1,51 @@
+/**
+ * @file probe.h
+ * @brief USDT静态探针
+ * @details 编译时找到sys/sdt.h(systemtap-sdt-dev)就定义SYLAR_HAVE_SDT，探针编译成一条nop，
+ *          并在ELF的.note.stapsdt段登记位置和参数，bpftrace/perf挂上后才会触发，没有挂载时只多一条nop。
+ *          没有sys/sdt.h时探针宏展开为空，参数也不求值。
+ *          所有探针的provider都是sylar，bpftrace中写作 usdt:<libsylar.so路径>:sylar:<探针名>，
+ *          示例脚本见 tools/bpftrace/
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#ifndef __SYLAR_PROBE_H__
+#define __SYLAR_PROBE_H__
+
+#ifdef SYLAR_HAVE_SDT
+#include <sys/sdt.h>
+
+#define SYLAR_PROBE(name) DTRACE_PROBE(sylar, name)
+#define SYLAR_PROBE1(name, a1) DTRACE_PROBE1(sylar, name, a1)
+#define SYLAR_PROBE2(name, a1, a2) DTRACE_PROBE2(sylar, name, a1, a2)
+#define SYLAR_PROBE3(name, a1, a2, a3) DTRACE_PROBE3(sylar, name, a1, a2, a3)
+#define SYLAR_PROBE4(name, a1, a2, a3, a4) DTRACE_PROBE4(sylar, name, a1, a2, a3, a4)
+
+#else
+
+#define SYLAR_PROBE(name) ((void)0)
+#define SYLAR_PROBE1(name, a1) ((void)0)
+#define SYLAR_PROBE2(name, a1, a2) ((void)0)
+#define SYLAR_PROBE3(name, a1, a2, a3) ((void)0)
+#define SYLAR_PROBE4(name, a1, a2, a3, a4) ((void)0)
+
+#endif
+
+/*
+ * 探针列表(参数按顺序为arg0, arg1, ...)
+ *
+ * fiber_create(uint64 fiber_id, uint32 stack_size)  创建带栈的协程
+ * fiber_resume(uint64 fiber_id)                     切入协程
+ * fiber_yield(uint64 fiber_id)                      协程让出执行权(未结束)
+ * fiber_term(uint64 fiber_id)                       协程函数执行完
+ * sched_enqueue(Scheduler*, uint64 task_id, size_t queued)  任务加入调度队列，queued为入队前的队列长度
+ * sched_dequeue(Scheduler*, uint64 task_id, uint64 fiber_id) 调度线程取出任务，回调任务的fiber_id为0
+ * iom_add_event(int fd, int event)      注册IO事件，event为1(读)或4(写)
+ * iom_del_event(int fd, int event)      不触发回调删除IO事件
+ * iom_trigger_event(int fd, int event)  IO事件就绪或被取消，等待的协程重新入队
+ * timer_fire(Timer*, uint64 period_ms, int64 late_ms)  定时器到期，late_ms为比预定时间晚了多少
+ * http_request_start(int fd, const char* method, const char* path)  收到请求头
+ * http_request_end(int fd, int status, uint64 duration_us)          响应发送完
+ */
+
+#endif
@@ -0,0 +1,124 @@
+/**
+ * @file rate_limiter.cc
+ * @brief 令牌桶限流器实现
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "rate_limiter.h"
+#include <algorithm>
+#include <functional>
+#include <sstream>
+#include "config.h"
+#include "util.h"
+
+namespace sylar {
+
+static sylar::ConfigVar<uint64_t>::ptr g_rate_limiter_idle_timeout =
+    sylar::Config::Lookup("rate_limiter.idle_timeout", (uint64_t)(60 * 1000),
+            "rate limiter idle bucket eviction timeout");
+
+static sylar::ConfigVar<uint32_t>::ptr g_rate_limiter_shards =
+    sylar::Config::Lookup("rate_limiter.shards", (uint32_t)16,
+            "rate limiter shard count");
+
+RateLimiter::RateLimiter(double rate, double burst, uint64_t idle_timeout, uint32_t shards)
+    :m_ratePerMs(rate / 1000)
+    ,m_rate(rate)
+    ,m_burst(std::max(burst, 1.0)) {
+    if(idle_timeout == 0) {
+        idle_timeout = g_rate_limiter_idle_timeout->getValue();
+    }
+    if(shards == 0) {
+        shards = g_rate_limiter_shards->getValue();
+    }
+    m_tick = std::max(idle_timeout / s_wheel_size, (uint64_t)1);
+    m_shards = std::vector<Shard>(std::max(shards, (uint32_t)1));
+}
+
+bool RateLimiter::allow(const std::string& key, double tokens) {
+    return allow(key, tokens, GetCurrentMS());
+}
+
+bool RateLimiter::allow(const std::string& key, double tokens, uint64_t now_ms) {
+    Shard& shard = m_shards[std::hash<std::string>()(key) % m_shards.size()];
+    uint64_t now_tick = now_ms / m_tick;
+    Spinlock::Lock lock(shard.mutex);
+    advance(shard, now_tick);
+
+    auto it = shard.buckets.find(key);
+    if(it == shard.buckets.end()) {
+        it = shard.buckets.insert(std::make_pair(key, Bucket{m_burst, now_ms, now_tick})).first;
+        shard.wheel[now_tick % s_wheel_size].push_back(key);
+    } else {
+        Bucket& b = it->second;
+        if(now_ms > b.last) {
+            b.tokens = std::min(m_burst, b.tokens + (now_ms - b.last) * m_ratePerMs);
+            b.last = now_ms;
+        }
+        if(b.tick != now_tick) {
+            b.tick = now_tick;
+            shard.wheel[now_tick % s_wheel_size].push_back(key);
+        }
+    }
+    Bucket& b = it->second;
+    if(b.tokens < tokens) {
+        return false;
+    }
+    b.tokens -= tokens;
+    return true;
+}
+
+void RateLimiter::advance(Shard& shard, uint64_t now_tick) {
+    if(now_tick <= shard.tick) {
+        return;
+    }
+    // 超过一圈没有推进时每个槽只需要处理一次
+    uint64_t from = std::max(shard.tick + 1, now_tick - s_wheel_size + 1);
+    for(uint64_t t = from; t <= now_tick; ++t) {
+        std::vector<std::string>& slot = shard.wheel[t % s_wheel_size];
+        for(auto& key : slot) {
+            // 之后又被访问过的桶已经登记到了更新的槽里
+            auto it = shard.buckets.find(key);
+            if(it != shard.buckets.end() && it->second.tick + s_wheel_size <= t) {
+                shard.buckets.erase(it);
+            }
+        }
+        slot.clear();
+    }
+    shard.tick = now_tick;
+}
+
+size_t RateLimiter::size() {
+    size_t total = 0;
+    for(auto& i : m_shards) {
+        Spinlock::Lock lock(i.mutex);
+        total += i.buckets.size();
+    }
+    return total;
+}
+
+std::string RateLimiter::AddressKey(Address::ptr addr) {
+    if(!addr) {
+        return "";
+    }
+    std::string str = addr->toString();
+    if(std::dynamic_pointer_cast<IPAddress>(addr)) {
+        size_t pos = str.rfind(':');
+        if(pos != std::string::npos) {
+            str.resize(pos);
+        }
+    }
+    return str;
+}
+
+std::string RateLimiter::toString() {
+    std::stringstream ss;
+    ss << "[RateLimiter rate=" << m_rate
+       << " burst=" << m_burst
+       << " idle_timeout=" << getIdleTimeout()
+       << " shards=" << m_shards.size()
+       << " size=" << size() << "]";
+    return ss.str();
+}
+
+}
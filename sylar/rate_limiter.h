@@ -0,0 +1,133 @@
+/**
+ * @file rate_limiter.h
+ * @brief 按key分桶的令牌桶限流器
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#ifndef __SYLAR_RATE_LIMITER_H__
+#define __SYLAR_RATE_LIMITER_H__
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "address.h"
+#include "mutex.h"
+#include "noncopyable.h"
+
+namespace sylar {
+
+/**
+ * @brief 令牌桶限流器
+ * @details 每个key(客户端IP、API key等)一个令牌桶，以rate个/秒的速度补充，最多攒burst个。
+ *          桶按key的哈希分散到多个分片，每个分片一把自旋锁，临界区只有一次查表和几次浮点运算。
+ *          每个分片带一个时间轮：桶被访问时登记到当前刻度的槽里，时间轮转过一圈仍未再被访问的桶被淘汰，
+ *          淘汰在allow()中顺带完成，不需要额外的定时器。
+ *          被淘汰的桶下次出现时是满的，所以idle_timeout应不小于burst / rate
+ */
+class RateLimiter : Noncopyable {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<RateLimiter> ptr;
+
+    /**
+     * @brief 构造函数
+     * @param[in] rate 每秒补充的令牌数
+     * @param[in] burst 桶容量
+     * @param[in] idle_timeout 桶空闲多久后淘汰(毫秒)，0表示取rate_limiter.idle_timeout配置
+     * @param[in] shards 分片数，0表示取rate_limiter.shards配置
+     */
+    RateLimiter(double rate, double burst, uint64_t idle_timeout = 0, uint32_t shards = 0);
+
+    /**
+     * @brief 取令牌
+     * @param[in] key 限流的key
+     * @param[in] tokens 需要的令牌数
+     * @return 令牌足够时扣除并返回true，否则返回false
+     */
+    bool allow(const std::string& key, double tokens = 1);
+
+    /**
+     * @brief 以指定的当前时间取令牌
+     * @param[in] now_ms 当前时间(毫秒)，需要单调不减
+     */
+    bool allow(const std::string& key, double tokens, uint64_t now_ms);
+
+    /**
+     * @brief 返回每秒补充的令牌数
+     */
+    double getRate() const { return m_rate;}
+
+    /**
+     * @brief 返回桶容量
+     */
+    double getBurst() const { return m_burst;}
+
+    /**
+     * @brief 返回桶的空闲淘汰时间(毫秒)
+     */
+    uint64_t getIdleTimeout() const { return m_tick * s_wheel_size;}
+
+    /**
+     * @brief 返回当前的桶数
+     */
+    size_t size();
+
+    /**
+     * @brief 返回地址对应的限流key，IP地址不含端口
+     */
+    static std::string AddressKey(Address::ptr addr);
+
+    std::string toString();
+
+private:
+    /// 时间轮的槽数
+    static const size_t s_wheel_size = 8;
+
+    /**
+     * @brief 令牌桶
+     */
+    struct Bucket {
+        /// 剩余令牌
+        double tokens;
+        /// 上次补充令牌的时间(毫秒)
+        uint64_t last;
+        /// 最近一次登记到时间轮的刻度
+        uint64_t tick;
+    };
+
+    /**
+     * @brief 分片
+     */
+    struct Shard {
+        /// 分片锁
+        Spinlock mutex;
+        /// key -> 令牌桶
+        std::unordered_map<std::string, Bucket> buckets;
+        /// 时间轮，每个槽记录在该刻度被访问过的key
+        std::vector<std::string> wheel[s_wheel_size];
+        /// 时间轮当前刻度
+        uint64_t tick = 0;
+    };
+
+    /**
+     * @brief 把时间轮推进到now_tick，淘汰转过一圈仍未被访问的桶
+     */
+    void advance(Shard& shard, uint64_t now_tick);
+
+private:
+    /// 每毫秒补充的令牌数
+    double m_ratePerMs;
+    /// 每秒补充的令牌数
+    double m_rate;
+    /// 桶容量
+    double m_burst;
+    /// 时间轮每个刻度的长度(毫秒)
+    uint64_t m_tick;
+    /// 分片
+    std::vector<Shard> m_shards;
+};
+
+}
+
+#endif
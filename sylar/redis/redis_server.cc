@@ -0,0 +1,315 @@
+/**
+ * @file redis_server.cc
+ * @brief 兼容RESP2协议的KV服务器实现
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "redis_server.h"
+#include <strings.h>
+#include "../config.h"
+#include "../log.h"
+#include "../util.h"
+
+namespace sylar {
+namespace redis {
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_NAME("system");
+
+static sylar::ConfigVar<uint32_t>::ptr g_redis_buffer_size =
+    sylar::Config::Lookup("redis.buffer_size", (uint32_t)(16 * 1024), "redis read buffer size");
+
+static sylar::ConfigVar<uint32_t>::ptr g_redis_max_request_size =
+    sylar::Config::Lookup("redis.max_request_size", (uint32_t)(64 * 1024 * 1024), "redis max request size");
+
+RedisSession::RedisSession(Socket::ptr sock, bool owner)
+    :SocketStream(sock, owner)
+    ,m_maxRequestSize(g_redis_max_request_size->getValue()) {
+    m_rbuf.resize(g_redis_buffer_size->getValue());
+}
+
+bool RedisSession::recvCommands(std::vector<RespCommand>& cmds) {
+    cmds.clear();
+    do {
+        while(m_rpos < m_wpos) {
+            RespCommand cmd;
+            int n = m_parser.parse(&m_rbuf[m_rpos], m_wpos - m_rpos, cmd);
+            if(n < 0) {
+                SYLAR_LOG_WARN(g_logger) << "invalid resp request, peer="
+                    << getRemoteAddressString();
+                close();
+                return false;
+            }
+            if(n == 0) {
+                break;
+            }
+            m_rpos += n;
+            if(!cmd.empty()) {
+                cmds.push_back(std::move(cmd));
+            }
+        }
+        if(m_rpos == m_wpos) {
+            m_rpos = m_wpos = 0;
+        }
+        if(!cmds.empty()) {
+            return true;
+        }
+
+        // 命令不完整，把剩余数据挪到缓冲区头部，缓冲区满了就扩容
+        if(m_rpos > 0) {
+            memmove(&m_rbuf[0], &m_rbuf[m_rpos], m_wpos - m_rpos);
+            m_wpos -= m_rpos;
+            m_rpos = 0;
+        }
+        if(m_wpos == m_rbuf.size()) {
+            if(m_rbuf.size() >= m_maxRequestSize) {
+                SYLAR_LOG_WARN(g_logger) << "resp request too large, peer="
+                    << getRemoteAddressString();
+                close();
+                return false;
+            }
+            m_rbuf.resize(std::min((size_t)m_maxRequestSize, m_rbuf.size() * 2));
+        }
+        int rt = read(&m_rbuf[m_wpos], m_rbuf.size() - m_wpos);
+        if(rt <= 0) {
+            close();
+            return false;
+        }
+        m_wpos += rt;
+    } while(true);
+}
+
+RedisServer::RedisServer(const std::vector<sylar::IOManager*>& io_workers
+                         ,sylar::IOManager* accept_worker)
+    :TcpServer(io_workers[0], accept_worker)
+    ,m_ioWorkers(io_workers)
+    ,m_store(new RedisStore(io_workers)) {
+    m_type = "redis";
+}
+
+void RedisServer::dispatchClient(Socket::ptr client) {
+    IOManager* worker = m_ioWorkers[m_next++ % m_ioWorkers.size()];
+    worker->schedule(std::bind(&RedisServer::handleClient,
+                std::static_pointer_cast<RedisServer>(shared_from_this()), client));
+}
+
+namespace {
+
+/**
+ * @brief 一条命令的回复方式
+ */
+struct Reply {
+    enum Type {
+        /// 直接回复text中的内容
+        RAW,
+        /// 单个GET
+        GET,
+        /// SET
+        SET,
+        /// 命中个数，DEL/EXPIRE
+        COUNT,
+        /// MGET
+        MGET,
+    };
+    Type type = RAW;
+    /// 对应操作在操作列表中的起始下标
+    size_t first = 0;
+    /// 对应操作的个数
+    size_t count = 0;
+    /// RAW类型的回复
+    std::string text;
+};
+
+bool ParseInt(const std::string& str, int64_t& v) {
+    if(str.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    errno = 0;
+    v = strtoll(str.c_str(), &end, 10);
+    return errno == 0 && *end == '\0';
+}
+
+/**
+ * @brief 把以unit_ms为单位的过期时间换算成毫秒
+ * @details 和redis一样，换算或加上当前时间后超出int64的值视为非法
+ */
+bool ToTtlMs(int64_t value, int64_t unit_ms, int64_t& ttl_ms) {
+    if(value > (INT64_MAX - (int64_t)GetCurrentMS()) / unit_ms) {
+        return false;
+    }
+    ttl_ms = value * unit_ms;
+    return true;
+}
+
+void WrongArgs(Reply& r, const std::string& name) {
+    RespAppendError(r.text, "ERR wrong number of arguments for '" + name + "' command");
+}
+
+}
+
+bool RedisServer::execute(std::vector<RespCommand>& cmds, std::string& out) {
+    std::vector<RedisOp> ops;
+    std::vector<Reply> replies(cmds.size());
+    bool quit = false;
+    for(size_t i = 0; i < cmds.size() && !quit; ++i) {
+        RespCommand& cmd = cmds[i];
+        Reply& r = replies[i];
+        r.first = ops.size();
+        const char* name = cmd[0].c_str();
+        if(!strcasecmp(name, "GET")) {
+            if(cmd.size() != 2) {
+                WrongArgs(r, "get");
+                continue;
+            }
+            r.type = Reply::GET;
+            ops.emplace_back(RedisOp::GET, cmd[1]);
+        } else if(!strcasecmp(name, "SET")) {
+            if(cmd.size() < 3) {
+                WrongArgs(r, "set");
+                continue;
+            }
+            int64_t ttl = -1;
+            bool ok = true;
+            for(size_t j = 3; j < cmd.size(); j += 2) {
+                bool ex = !strcasecmp(cmd[j].c_str(), "EX");
+                if((!ex && strcasecmp(cmd[j].c_str(), "PX")) || j + 1 >= cmd.size()) {
+                    RespAppendError(r.text, "ERR syntax error");
+                    ok = false;
+                    break;
+                }
+                if(!ParseInt(cmd[j + 1], ttl) || ttl <= 0
+                        || !ToTtlMs(ttl, ex ? 1000 : 1, ttl)) {
+                    RespAppendError(r.text, "ERR invalid expire time in 'set' command");
+                    ok = false;
+                    break;
+                }
+            }
+            if(!ok) {
+                continue;
+            }
+            r.type = Reply::SET;
+            ops.emplace_back(RedisOp::SET, cmd[1]);
+            ops.back().value.swap(cmd[2]);
+            ops.back().ttl_ms = ttl;
+        } else if(!strcasecmp(name, "DEL")) {
+            if(cmd.size() < 2) {
+                WrongArgs(r, "del");
+                continue;
+            }
+            r.type = Reply::COUNT;
+            for(size_t j = 1; j < cmd.size(); ++j) {
+                ops.emplace_back(RedisOp::DEL, cmd[j]);
+            }
+        } else if(!strcasecmp(name, "EXPIRE")) {
+            if(cmd.size() != 3) {
+                WrongArgs(r, "expire");
+                continue;
+            }
+            int64_t seconds = 0;
+            if(!ParseInt(cmd[2], seconds)) {
+                RespAppendError(r.text, "ERR value is not an integer or out of range");
+                continue;
+            }
+            // 不大于0的过期时间直接删除key
+            int64_t ttl = 0;
+            if(seconds > 0 && !ToTtlMs(seconds, 1000, ttl)) {
+                RespAppendError(r.text, "ERR invalid expire time in 'expire' command");
+                continue;
+            }
+            r.type = Reply::COUNT;
+            ops.emplace_back(RedisOp::EXPIRE, cmd[1]);
+            ops.back().ttl_ms = ttl;
+        } else if(!strcasecmp(name, "MGET")) {
+            if(cmd.size() < 2) {
+                WrongArgs(r, "mget");
+                continue;
+            }
+            r.type = Reply::MGET;
+            for(size_t j = 1; j < cmd.size(); ++j) {
+                ops.emplace_back(RedisOp::GET, cmd[j]);
+            }
+        } else if(!strcasecmp(name, "PING")) {
+            if(cmd.size() > 2) {
+                WrongArgs(r, "ping");
+            } else if(cmd.size() == 2) {
+                RespAppendBulk(r.text, cmd[1]);
+            } else {
+                RespAppendStatus(r.text, "PONG");
+            }
+        } else if(!strcasecmp(name, "QUIT")) {
+            RespAppendStatus(r.text, "OK");
+            quit = true;
+            replies.resize(i + 1);
+        } else {
+            RespAppendError(r.text, "ERR unknown command '" + cmd[0] + "'");
+        }
+        r.count = ops.size() - r.first;
+    }
+
+    m_store->execute(ops);
+
+    for(auto& r : replies) {
+        switch(r.type) {
+            case Reply::RAW:
+                out.append(r.text);
+                break;
+            case Reply::GET:
+                if(ops[r.first].found) {
+                    RespAppendBulk(out, ops[r.first].value);
+                } else {
+                    RespAppendNull(out);
+                }
+                break;
+            case Reply::SET:
+                RespAppendStatus(out, "OK");
+                break;
+            case Reply::COUNT:
+            {
+                int64_t n = 0;
+                for(size_t j = r.first; j < r.first + r.count; ++j) {
+                    n += ops[j].found;
+                }
+                RespAppendInteger(out, n);
+                break;
+            }
+            case Reply::MGET:
+                RespAppendArrayHeader(out, r.count);
+                for(size_t j = r.first; j < r.first + r.count; ++j) {
+                    if(ops[j].found) {
+                        RespAppendBulk(out, ops[j].value);
+                    } else {
+                        RespAppendNull(out);
+                    }
+                }
+                break;
+        }
+    }
+    return quit;
+}
+
+void RedisServer::handleClient(Socket::ptr client) {
+    SYLAR_LOG_DEBUG(g_logger) << "handleClient " << *client;
+    RedisSession::ptr session(new RedisSession(client));
+    std::vector<RespCommand> cmds;
+    std::string out;
+    do {
+        if(!session->recvCommands(cmds)) {
+            SYLAR_LOG_DEBUG(g_logger) << "recv resp request fail, errno="
+                << errno << " errstr=" << strerror(errno)
+                << " client:" << *client;
+            break;
+        }
+        out.clear();
+        bool quit = execute(cmds, out);
+        if(session->writeFixSize(out.c_str(), out.size()) <= 0) {
+            break;
+        }
+        if(quit) {
+            break;
+        }
+    } while(true);
+    session->close();
+}
+
+}
+}
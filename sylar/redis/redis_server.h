@@ -0,0 +1,109 @@
+/**
+ * @file redis_server.h
+ * @brief 兼容RESP2协议的KV服务器
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#ifndef __SYLAR_REDIS_SERVER_H__
+#define __SYLAR_REDIS_SERVER_H__
+
+#include <atomic>
+#include "../tcp_server.h"
+#include "../streams/socket_stream.h"
+#include "resp.h"
+#include "redis_store.h"
+
+namespace sylar {
+namespace redis {
+
+/**
+ * @brief RESP连接
+ * @details 读方向带缓冲，一次read到的数据中所有完整的命令会一起返回，
+ *          服务端据此批量执行流水线命令，并把回复合并成一次写
+ */
+class RedisSession : public SocketStream {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<RedisSession> ptr;
+
+    /**
+     * @brief 构造函数
+     * @param[in] sock Socket类型
+     * @param[in] owner 是否托管
+     */
+    RedisSession(Socket::ptr sock, bool owner = true);
+
+    /**
+     * @brief 接收一批命令，至少包含一条
+     * @param[out] cmds 命令列表
+     * @return 对端关闭、读失败或协议错误时返回false
+     */
+    bool recvCommands(std::vector<RespCommand>& cmds);
+
+private:
+    /// 命令解析器，保存不完整命令的解析进度
+    RespParser m_parser;
+    /// 读缓冲区
+    std::string m_rbuf;
+    /// 读缓冲区中未解析数据的起始位置
+    size_t m_rpos = 0;
+    /// 读缓冲区中有效数据的结束位置
+    size_t m_wpos = 0;
+    /// 单条命令的最大字节数
+    uint32_t m_maxRequestSize;
+};
+
+/**
+ * @brief RESP2服务器，继承自TcpServer
+ * @details 支持PING/GET/SET/DEL/EXPIRE/MGET/QUIT，SET支持EX/PX参数。
+ *          每个IO worker是一个单线程IOManager，既负责一部分连接的读写，也持有一个数据分片，
+ *          新连接轮流分配给各个IO worker。连接协程把一批流水线命令拆成单key操作，
+ *          交给分片所属的IO worker执行，全部完成后按命令顺序组装回复
+ */
+class RedisServer : public TcpServer {
+public:
+    /// 智能指针类型
+    typedef std::shared_ptr<RedisServer> ptr;
+
+    /**
+     * @brief 构造函数
+     * @param[in] io_workers IO worker列表，每个都必须只有一个调度线程，每个持有一个分片
+     * @param[in] accept_worker 接收连接调度器
+     */
+    RedisServer(const std::vector<sylar::IOManager*>& io_workers
+                ,sylar::IOManager* accept_worker = sylar::IOManager::GetThis());
+
+    /**
+     * @brief 返回存储
+     */
+    RedisStore::ptr getStore() const { return m_store;}
+
+    /**
+     * @brief 执行一批命令
+     * @param[in] cmds 命令列表
+     * @param[out] out 按命令顺序追加的回复
+     * @return 是否需要关闭连接(收到QUIT)
+     */
+    bool execute(std::vector<RespCommand>& cmds, std::string& out);
+
+protected:
+    virtual void handleClient(Socket::ptr client) override;
+
+    /**
+     * @brief 新连接轮流分配给各个IO worker
+     */
+    virtual void dispatchClient(Socket::ptr client) override;
+
+private:
+    /// IO worker列表
+    std::vector<IOManager*> m_ioWorkers;
+    /// 下一个连接分配到的IO worker
+    std::atomic<uint32_t> m_next = {0};
+    /// 存储
+    RedisStore::ptr m_store;
+};
+
+}
+}
+
+#endif
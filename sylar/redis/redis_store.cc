@@ -0,0 +1,194 @@
+/**
+ * @file redis_store.cc
+ * @brief 按线程分片的内存KV存储实现
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "redis_store.h"
+#include <atomic>
+#include <functional>
+#include "../log.h"
+#include "../macro.h"
+#include "../util.h"
+
+namespace sylar {
+namespace redis {
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_NAME("system");
+
+RedisShard::RedisShard(IOManager* iom)
+    :m_iom(iom) {
+}
+
+RedisShard::MapType::iterator RedisShard::find(const std::string& key) {
+    auto it = m_datas.find(key);
+    if(it != m_datas.end() && it->second.expire_at
+            && it->second.expire_at <= GetCurrentMS()) {
+        erase(it);
+        return m_datas.end();
+    }
+    return it;
+}
+
+void RedisShard::erase(MapType::iterator it) {
+    if(it->second.timer) {
+        it->second.timer->cancel();
+    }
+    m_datas.erase(it);
+}
+
+void RedisShard::setExpire(const std::string& key, Entry& e, int64_t ttl_ms) {
+    if(e.timer) {
+        e.timer->cancel();
+        e.timer.reset();
+    }
+    if(ttl_ms < 0) {
+        e.expire_at = 0;
+        return;
+    }
+    e.expire_at = GetCurrentMS() + ttl_ms;
+
+    // 定时器登记在所属IOManager上，回调必然在分片所属线程上执行
+    std::weak_ptr<RedisShard> weak_self(shared_from_this());
+    uint64_t expire_at = e.expire_at;
+    e.timer = m_iom->addTimer(ttl_ms, [weak_self, key, expire_at]() {
+        auto self = weak_self.lock();
+        if(self) {
+            self->onExpire(key, expire_at);
+        }
+    });
+}
+
+void RedisShard::onExpire(const std::string& key, uint64_t expire_at) {
+    auto it = m_datas.find(key);
+    if(it != m_datas.end() && it->second.expire_at == expire_at) {
+        it->second.timer.reset();
+        m_datas.erase(it);
+    }
+}
+
+void RedisShard::execute(RedisOp& op) {
+    switch(op.type) {
+        case RedisOp::GET:
+        {
+            auto it = find(op.key);
+            op.found = it != m_datas.end();
+            if(op.found) {
+                op.value = it->second.value;
+            }
+            break;
+        }
+        case RedisOp::SET:
+        {
+            Entry& e = m_datas[op.key];
+            e.value.swap(op.value);
+            // 与redis一致，不带过期参数的SET会清除原有的过期时间
+            setExpire(op.key, e, op.ttl_ms);
+            op.found = true;
+            break;
+        }
+        case RedisOp::DEL:
+        {
+            auto it = find(op.key);
+            op.found = it != m_datas.end();
+            if(op.found) {
+                erase(it);
+            }
+            break;
+        }
+        case RedisOp::EXPIRE:
+        {
+            auto it = find(op.key);
+            op.found = it != m_datas.end();
+            if(op.found) {
+                if(op.ttl_ms <= 0) {
+                    erase(it);
+                } else {
+                    setExpire(op.key, it->second, op.ttl_ms);
+                }
+            }
+            break;
+        }
+        default:
+            SYLAR_LOG_ERROR(g_logger) << "unknown redis op type=" << op.type;
+            break;
+    }
+}
+
+RedisStore::RedisStore(const std::vector<IOManager*>& workers) {
+    SYLAR_ASSERT(!workers.empty());
+    for(auto i : workers) {
+        m_shards.push_back(std::make_shared<RedisShard>(i));
+    }
+}
+
+size_t RedisStore::getShardIndex(const std::string& key) const {
+    return std::hash<std::string>()(key) % m_shards.size();
+}
+
+namespace {
+
+/**
+ * @brief 一批等待执行的操作
+ */
+struct Batch {
+    /// 按分片分组的操作
+    std::vector<std::vector<RedisOp*> > groups;
+    /// 尚未完成的分组数，额外加1防止分发过程中提前唤醒
+    std::atomic<int> remaining = {1};
+    /// 等待结果的协程
+    Fiber::ptr fiber;
+    /// 等待结果的协程所在的调度器
+    Scheduler* scheduler = nullptr;
+};
+
+}
+
+void RedisStore::execute(std::vector<RedisOp>& ops) {
+    SYLAR_ASSERT2(Scheduler::GetThis(), "RedisStore::execute must run in a scheduler");
+    if(ops.empty()) {
+        return;
+    }
+    std::shared_ptr<Batch> batch(new Batch);
+    batch->groups.resize(m_shards.size());
+    for(auto& i : ops) {
+        batch->groups[getShardIndex(i.key)].push_back(&i);
+    }
+    batch->fiber = Fiber::GetThis();
+    batch->scheduler = Scheduler::GetThis();
+
+    int local = -1;
+    IOManager* iom = IOManager::GetThis();
+    for(size_t i = 0; i < m_shards.size(); ++i) {
+        if(batch->groups[i].empty()) {
+            continue;
+        }
+        RedisShard::ptr shard = m_shards[i];
+        if(shard->getIOManager() == iom) {
+            local = i;
+            continue;
+        }
+        ++batch->remaining;
+        shard->getIOManager()->schedule([batch, shard, i]() {
+            for(auto op : batch->groups[i]) {
+                shard->execute(*op);
+            }
+            if(--batch->remaining == 0) {
+                batch->scheduler->schedule(batch->fiber);
+            }
+        });
+    }
+    // 当前IO worker分片上的操作不经过调度器，与远端分组并行执行
+    if(local >= 0) {
+        for(auto op : batch->groups[local]) {
+            m_shards[local]->execute(*op);
+        }
+    }
+    if(--batch->remaining != 0) {
+        Fiber::GetThis()->yield();
+    }
+    batch->fiber.reset();
+}
+
+}
+}
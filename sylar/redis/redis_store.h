@@ -0,0 +1,170 @@
+/**
+ * @file redis_store.h
+ * @brief 按线程分片的内存KV存储
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#ifndef __SYLAR_REDIS_STORE_H__
+#define __SYLAR_REDIS_STORE_H__
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../iomanager.h"
+#include "../noncopyable.h"
+
+namespace sylar {
+namespace redis {
+
+/**
+ * @brief 对单个key的一次操作，多key命令会被拆成多个操作
+ */
+struct RedisOp {
+    /**
+     * @brief 操作类型
+     */
+    enum Type {
+        GET    = 1,
+        SET    = 2,
+        DEL    = 3,
+        EXPIRE = 4,
+    };
+
+    RedisOp(Type t, const std::string& k)
+        :type(t), key(k) {}
+
+    /// 操作类型
+    Type type;
+    /// key
+    std::string key;
+    /// SET的值，GET的结果
+    std::string value;
+    /// SET/EXPIRE的过期时间(毫秒)，-1表示不过期
+    int64_t ttl_ms = -1;
+    /// GET是否命中，DEL/EXPIRE是否生效
+    bool found = false;
+};
+
+/**
+ * @brief 一个分片，只在所属IOManager的唯一线程上访问，因此不需要加锁
+ * @details 过期有两条路径：访问时发现已过期立即删除；
+ *          设置过期时间时向所属IOManager的TimerManager登记定时器，到期后直接删除，
+ *          保证不再访问的key也能释放内存
+ */
+class RedisShard : public std::enable_shared_from_this<RedisShard>, Noncopyable {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<RedisShard> ptr;
+
+    /**
+     * @brief 构造函数
+     * @param[in] iom 分片所属的IOManager，必须只有一个调度线程
+     */
+    RedisShard(IOManager* iom);
+
+    /**
+     * @brief 执行一个操作，必须在所属线程上调用
+     */
+    void execute(RedisOp& op);
+
+    /**
+     * @brief 返回所属IOManager
+     */
+    IOManager* getIOManager() const { return m_iom;}
+
+    /**
+     * @brief 返回key的数量(包含已过期但尚未删除的key)
+     */
+    size_t size() const { return m_datas.size();}
+
+private:
+    /**
+     * @brief 一个value
+     */
+    struct Entry {
+        /// 值
+        std::string value;
+        /// 过期的绝对时间(毫秒)，0表示不过期
+        uint64_t expire_at = 0;
+        /// 过期定时器
+        Timer::ptr timer;
+    };
+
+    typedef std::unordered_map<std::string, Entry> MapType;
+
+    /**
+     * @brief 查找未过期的key，已过期的key会被顺带删除
+     */
+    MapType::iterator find(const std::string& key);
+
+    /**
+     * @brief 删除key并取消它的定时器
+     */
+    void erase(MapType::iterator it);
+
+    /**
+     * @brief 设置过期时间
+     * @param[in] ttl_ms 过期时间(毫秒)，-1表示取消过期时间
+     */
+    void setExpire(const std::string& key, Entry& e, int64_t ttl_ms);
+
+    /**
+     * @brief 定时器到期，删除key
+     * @param[in] expire_at 登记定时器时的过期时间，用来识别已被覆盖的定时器
+     */
+    void onExpire(const std::string& key, uint64_t expire_at);
+
+private:
+    /// 所属IOManager
+    IOManager* m_iom;
+    /// 数据
+    MapType m_datas;
+};
+
+/**
+ * @brief 分片KV存储，每个IO worker持有一个分片
+ * @details 每个IO worker是一个单线程的IOManager，key按哈希值落到某个分片上，
+ *          操作被调度到分片所属的IO worker执行，分片之间没有共享数据，也就没有锁竞争。
+ *          之所以不用一个多线程IOManager再按线程id指定调度，是因为多个线程共享同一个epoll，
+ *          tickle无法定向唤醒某个线程，指定线程的任务可能要等到epoll_wait超时才被执行
+ */
+class RedisStore : Noncopyable {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<RedisStore> ptr;
+
+    /**
+     * @brief 构造函数
+     * @param[in] workers IO worker列表，每个都必须只有一个调度线程(threads=1, use_caller=false)，
+     *                    生命周期由调用方保证
+     */
+    RedisStore(const std::vector<IOManager*>& workers);
+
+    /**
+     * @brief 执行一批操作，返回时所有操作都已完成
+     * @details 操作按分片分组，每个分片只调度一次；落在当前IO worker分片上的操作直接执行，
+     *          其余分组调度到所属IO worker，当前协程挂起直到最后一个分组完成。
+     *          必须在协程中调用
+     */
+    void execute(std::vector<RedisOp>& ops);
+
+    /**
+     * @brief 返回分片数量
+     */
+    size_t getShardCount() const { return m_shards.size();}
+
+    /**
+     * @brief 返回key所在的分片下标
+     */
+    size_t getShardIndex(const std::string& key) const;
+
+private:
+    /// 分片
+    std::vector<RedisShard::ptr> m_shards;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,236 @@
+/**
+ * @file resp.cc
+ * @brief RESP2协议解析与编码实现
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "resp.h"
+#include <string.h>
+#include <algorithm>
+
+namespace sylar {
+namespace redis {
+
+/// 单个批量字符串的最大长度，与redis的proto-max-bulk-len一致
+static const int64_t s_max_bulk_len = 512 * 1024 * 1024;
+/// 单条命令的最大参数个数
+static const int64_t s_max_args = 1024 * 1024;
+/// 内联命令的最大长度
+static const size_t s_max_inline_len = 64 * 1024;
+
+/**
+ * @brief 从pos处解析以\r\n结尾的整数
+ * @return >0 解析结束后的位置(\r\n之后)，0 数据不完整，<0 格式错误
+ */
+static int64_t ParseInteger(const char* data, size_t len, size_t pos, int64_t& v) {
+    const char* begin = data + pos;
+    const char* end = (const char*)memchr(begin, '\r', len - pos);
+    if(!end) {
+        return len - pos > 32 ? -1 : 0;
+    }
+    if(end + 1 >= data + len) {
+        return 0;
+    }
+    if(end[1] != '\n' || end == begin) {
+        return -1;
+    }
+    bool neg = false;
+    const char* p = begin;
+    if(*p == '-') {
+        neg = true;
+        ++p;
+    }
+    if(p == end || end - p > 18) {
+        return -1;
+    }
+    v = 0;
+    for(; p < end; ++p) {
+        if(*p < '0' || *p > '9') {
+            return -1;
+        }
+        v = v * 10 + (*p - '0');
+    }
+    if(neg) {
+        v = -v;
+    }
+    return end + 2 - data;
+}
+
+static int ParseInline(const char* data, size_t len, RespCommand& cmd) {
+    const char* nl = (const char*)memchr(data, '\n', len);
+    if(!nl) {
+        return len > s_max_inline_len ? -1 : 0;
+    }
+    const char* end = nl;
+    if(end > data && end[-1] == '\r') {
+        --end;
+    }
+    cmd.clear();
+    const char* p = data;
+    while(p < end) {
+        while(p < end && (*p == ' ' || *p == '\t')) {
+            ++p;
+        }
+        const char* s = p;
+        while(p < end && *p != ' ' && *p != '\t') {
+            ++p;
+        }
+        if(p > s) {
+            cmd.push_back(std::string(s, p - s));
+        }
+    }
+    return nl + 1 - data;
+}
+
+void RespParser::reset() {
+    m_pos = 0;
+    m_argc = -1;
+    m_cmd.clear();
+}
+
+int RespParser::parse(const char* data, size_t len, RespCommand& cmd) {
+    if(len == 0) {
+        return 0;
+    }
+    if(data[0] != '*') {
+        return ParseInline(data, len, cmd);
+    }
+
+    if(m_argc < 0) {
+        int64_t n = 0;
+        int64_t pos = ParseInteger(data, len, 1, n);
+        if(pos <= 0) {
+            return pos;
+        }
+        if(n > s_max_args) {
+            return -1;
+        }
+        m_argc = n < 0 ? 0 : n;
+        m_pos = pos;
+        m_cmd.clear();
+        // 参数个数来自客户端，每个参数至少占4个字节($0\r\n)，只按已经到达的数据预留
+        m_cmd.reserve(std::min<int64_t>(m_argc, (int64_t)(len - pos) / 4 + 1));
+    }
+    while((int64_t)m_cmd.size() < m_argc) {
+        int64_t pos = m_pos;
+        if((size_t)pos >= len) {
+            return 0;
+        }
+        if(data[pos] != '$') {
+            return -1;
+        }
+        int64_t blen = 0;
+        pos = ParseInteger(data, len, pos + 1, blen);
+        if(pos <= 0) {
+            return pos;
+        }
+        if(blen < 0 || blen > s_max_bulk_len) {
+            return -1;
+        }
+        if((size_t)(pos + blen + 2) > len) {
+            return 0;
+        }
+        if(data[pos + blen] != '\r' || data[pos + blen + 1] != '\n') {
+            return -1;
+        }
+        m_cmd.push_back(std::string(data + pos, blen));
+        m_pos = pos + blen + 2;
+    }
+    int rt = m_pos;
+    cmd.swap(m_cmd);
+    reset();
+    return rt;
+}
+
+int RespParseCommand(const char* data, size_t len, RespCommand& cmd) {
+    RespParser parser;
+    return parser.parse(data, len, cmd);
+}
+
+int RespSkipReply(const char* data, size_t len) {
+    if(len == 0) {
+        return 0;
+    }
+    int64_t v = 0;
+    switch(data[0]) {
+        case '+':
+        case '-':
+        {
+            const char* nl = (const char*)memchr(data, '\n', len);
+            return nl ? nl + 1 - data : 0;
+        }
+        case ':':
+            return ParseInteger(data, len, 1, v);
+        case '$':
+        {
+            int64_t pos = ParseInteger(data, len, 1, v);
+            if(pos <= 0 || v < 0) {
+                return pos;
+            }
+            return (size_t)(pos + v + 2) > len ? 0 : pos + v + 2;
+        }
+        case '*':
+        {
+            int64_t pos = ParseInteger(data, len, 1, v);
+            if(pos <= 0) {
+                return pos;
+            }
+            for(int64_t i = 0; i < v; ++i) {
+                int rt = RespSkipReply(data + pos, len - pos);
+                if(rt <= 0) {
+                    return rt;
+                }
+                pos += rt;
+            }
+            return pos;
+        }
+        default:
+            return -1;
+    }
+}
+
+void RespAppendStatus(std::string& out, const char* status) {
+    out.append(1, '+');
+    out.append(status);
+    out.append("\r\n", 2);
+}
+
+void RespAppendError(std::string& out, const std::string& err) {
+    out.append(1, '-');
+    out.append(err);
+    out.append("\r\n", 2);
+}
+
+void RespAppendInteger(std::string& out, int64_t v) {
+    out.append(1, ':');
+    out.append(std::to_string(v));
+    out.append("\r\n", 2);
+}
+
+void RespAppendBulk(std::string& out, const std::string& v) {
+    out.append(1, '$');
+    out.append(std::to_string(v.size()));
+    out.append("\r\n", 2);
+    out.append(v);
+    out.append("\r\n", 2);
+}
+
+void RespAppendNull(std::string& out) {
+    out.append("$-1\r\n", 5);
+}
+
+void RespAppendArrayHeader(std::string& out, size_t n) {
+    out.append(1, '*');
+    out.append(std::to_string(n));
+    out.append("\r\n", 2);
+}
+
+void RespAppendCommand(std::string& out, const RespCommand& cmd) {
+    RespAppendArrayHeader(out, cmd.size());
+    for(auto& i : cmd) {
+        RespAppendBulk(out, i);
+    }
+}
+
+}
+}
@@ -0,0 +1,124 @@
+/**
+ * @file resp.h
+ * @brief RESP2协议解析与编码
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#ifndef __SYLAR_REDIS_RESP_H__
+#define __SYLAR_REDIS_RESP_H__
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/*
+    RESP2请求有两种形式：
+
+    1. 批量字符串数组(客户端库使用)
+       *<参数个数>\r\n$<长度>\r\n<参数>\r\n ...
+
+    2. 内联命令(telnet/redis-cli手工输入)
+       SET key value\r\n
+
+    回复的五种类型：
+       +<简单字符串>\r\n
+       -<错误>\r\n
+       :<整数>\r\n
+       $<长度>\r\n<数据>\r\n    ($-1\r\n表示nil)
+       *<元素个数>\r\n<元素>...
+*/
+
+namespace sylar {
+namespace redis {
+
+/// 一条命令，第一个元素是命令名
+typedef std::vector<std::string> RespCommand;
+
+/**
+ * @brief 增量的RESP命令解析器
+ * @details 命令不完整时保留已经解析完的参数和位置，数据补齐后从断点继续，
+ *          不会在每次读到新数据时从命令头部重新解析。
+ *          每次调用传入的data都必须从当前命令的第一个字节开始，已解析的部分不能改变
+ */
+class RespParser {
+public:
+    /**
+     * @brief 解析一条命令
+     * @param[in] data 从命令起始位置开始的数据
+     * @param[in] len 数据长度
+     * @param[out] cmd 命令完整时移入解析出的命令
+     * @return >0 命令的总字节数，解析器复位，可以开始解析下一条命令
+     *         =0 数据不完整，需要继续读
+     *         <0 协议错误
+     */
+    int parse(const char* data, size_t len, RespCommand& cmd);
+
+    /**
+     * @brief 丢弃未完成的命令
+     */
+    void reset();
+private:
+    /// 当前命令已解析的字节数
+    size_t m_pos = 0;
+    /// 数组形式命令的参数个数，-1表示还没有解析出头部
+    int64_t m_argc = -1;
+    /// 已解析出的参数
+    RespCommand m_cmd;
+};
+
+/**
+ * @brief 从缓冲区头部解析一条完整的命令
+ * @param[in] data 数据
+ * @param[in] len 数据长度
+ * @param[out] cmd 解析出的命令
+ * @return >0 消耗的字节数
+ *         =0 数据不完整，需要继续读
+ *         <0 协议错误
+ */
+int RespParseCommand(const char* data, size_t len, RespCommand& cmd);
+
+/**
+ * @brief 跳过缓冲区头部的一个完整回复，客户端用来切分流水线回复
+ * @return 同RespParseCommand
+ */
+int RespSkipReply(const char* data, size_t len);
+
+/**
+ * @brief 追加简单字符串回复，如 +OK
+ */
+void RespAppendStatus(std::string& out, const char* status);
+
+/**
+ * @brief 追加错误回复
+ */
+void RespAppendError(std::string& out, const std::string& err);
+
+/**
+ * @brief 追加整数回复
+ */
+void RespAppendInteger(std::string& out, int64_t v);
+
+/**
+ * @brief 追加批量字符串回复
+ */
+void RespAppendBulk(std::string& out, const std::string& v);
+
+/**
+ * @brief 追加nil回复
+ */
+void RespAppendNull(std::string& out);
+
+/**
+ * @brief 追加数组回复的头部，之后再追加n个元素
+ */
+void RespAppendArrayHeader(std::string& out, size_t n);
+
+/**
+ * @brief 把命令编码为批量字符串数组，客户端发送请求时使用
+ */
+void RespAppendCommand(std::string& out, const RespCommand& cmd);
+
+}
+}
+
+#endif
@@ -0,0 +1,548 @@
+/**
+ * @file resource_pool.h
+ * @brief 协程友好的通用资源池
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#ifndef __SYLAR_RESOURCE_POOL_H__
+#define __SYLAR_RESOURCE_POOL_H__
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "fiber.h"
+#include "iomanager.h"
+#include "metrics.h"
+#include "mutex.h"
+#include "noncopyable.h"
+#include "util.h"
+
+namespace sylar {
+
+/**
+ * @brief 通用资源池，用于数据库、Redis、RPC等连接的复用
+ * @details 资源由factory创建，validator校验(归还时和从池中取出时)，用delete销毁。
+ *          资源总数(使用中+空闲)不超过max_size，池满时acquire在协程上挂起等待归还，超时返回nullptr，
+ *          等待者按先来先得的顺序直接接手归还的资源。
+ *          空闲资源后进先出，刚用过的连接优先复用，多余的连接自然空闲到max_idle_ms后被淘汰；
+ *          超过max_lifetime_ms的资源不再复用。淘汰由TimerManager上的定时器周期执行。
+ *          每个线程有一个容量为local_size的空闲缓存，大部分acquire/release只碰线程自己的缓存，
+ *          不争用共享空闲列表；线程缓存满了才放回共享列表，池满时等待者会从所有缓存中取资源。
+ *          资源总数、等待数、创建数和等待超时数以name标签导出到MetricsMgr
+ */
+template<class T>
+class ResourcePool : public std::enable_shared_from_this<ResourcePool<T> >, Noncopyable {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<ResourcePool> ptr;
+    /// 锁类型定义
+    typedef Mutex MutexType;
+    /// 创建资源，失败返回nullptr
+    typedef std::function<T*()> Factory;
+    /// 校验资源是否可以继续使用
+    typedef std::function<bool(T*)> Validator;
+
+    /**
+     * @brief 创建资源池
+     * @param[in] name 名称，用作指标的name标签
+     * @param[in] factory 创建资源
+     * @param[in] validator 校验资源，为空时不校验
+     * @param[in] max_size 资源总数上限
+     * @param[in] max_idle_ms 空闲超过该时间的资源被淘汰，0表示不淘汰
+     * @param[in] max_lifetime_ms 创建超过该时间的资源被淘汰，0表示不限制
+     * @param[in] local_size 每个线程缓存的空闲资源数，0表示不使用线程缓存
+     * @param[in] timer 执行淘汰的定时器管理器，为空时只在acquire时淘汰
+     */
+    static ptr Create(const std::string& name
+                      ,Factory factory
+                      ,Validator validator
+                      ,uint32_t max_size
+                      ,uint64_t max_idle_ms = 60 * 1000
+                      ,uint64_t max_lifetime_ms = 0
+                      ,uint32_t local_size = 2
+                      ,TimerManager* timer = IOManager::GetThis()) {
+        ptr pool(new ResourcePool(name, factory, validator, max_size
+                    , max_idle_ms, max_lifetime_ms, local_size));
+        uint64_t interval = std::min(max_idle_ms ? max_idle_ms : (uint64_t)~0ull
+                    , max_lifetime_ms ? max_lifetime_ms : (uint64_t)~0ull);
+        if(timer && interval != (uint64_t)~0ull) {
+            std::weak_ptr<ResourcePool> weak(pool);
+            pool->m_evictTimer = timer->addConditionTimer(std::max(interval / 2, (uint64_t)1)
+                    , std::bind(&ResourcePool::evict, pool.get()), weak, true);
+        }
+        return pool;
+    }
+
+    /**
+     * @brief 析构函数，销毁空闲资源
+     * @details 取出的资源持有资源池的智能指针，析构时不会有资源在使用中
+     */
+    ~ResourcePool() {
+        if(m_evictTimer) {
+            m_evictTimer->cancel();
+        }
+        for(auto& i : m_free) {
+            delete i.res;
+        }
+        for(auto& i : m_locals) {
+            for(auto& n : i.items) {
+                delete n.res;
+            }
+        }
+        m_totalGauge->dec(m_total);
+    }
+
+    /**
+     * @brief 取出一个资源
+     * @details 优先复用空闲资源，没有时创建，池满时挂起当前协程等待归还。
+     *          返回的智能指针析构时资源归还到池中
+     * @param[in] timeout_ms 等待超时时间(毫秒)，0表示不等待，~0ull表示一直等待
+     * @return 创建失败或等待超时返回nullptr
+     */
+    std::shared_ptr<T> acquire(uint64_t timeout_ms = ~0ull) {
+        uint64_t now = GetCurrentMS();
+        uint64_t deadline = timeout_ms == ~0ull ? ~0ull : now + timeout_ms;
+        Item item;
+        while(true) {
+            now = GetCurrentMS();
+            if(popLocal(item) || popShared(item)) {
+                if(check(item, now, true)) {
+                    return wrap(item);
+                }
+                destroy(item);
+                continue;
+            }
+            if(reserve()) {
+                return create(now);
+            }
+            int rt = wait(item, now, deadline);
+            if(rt < 0) {
+                m_timeouts->inc();
+                return nullptr;
+            }
+            if(rt > 0) {
+                if(check(item, GetCurrentMS(), true)) {
+                    return wrap(item);
+                }
+                destroy(item);
+            }
+        }
+    }
+
+    /**
+     * @brief 淘汰空闲超时和超过生命周期的资源
+     */
+    void evict() {
+        uint64_t now = GetCurrentMS();
+        std::vector<Item> expired;
+        MutexType::Lock lock(m_mutex);
+        filter(m_free, now, expired);
+        for(auto& i : m_locals) {
+            Spinlock::Lock l(i.mutex);
+            filter(i.items, now, expired);
+        }
+        lock.unlock();
+        for(auto& i : expired) {
+            destroy(i);
+        }
+    }
+
+    /**
+     * @brief 返回资源总数，包括使用中和空闲的
+     */
+    uint32_t getTotal() {
+        MutexType::Lock lock(m_mutex);
+        return m_total;
+    }
+
+    /**
+     * @brief 返回空闲资源数
+     */
+    uint32_t getIdle() {
+        MutexType::Lock lock(m_mutex);
+        size_t idle = m_free.size();
+        for(auto& i : m_locals) {
+            Spinlock::Lock l(i.mutex);
+            idle += i.items.size();
+        }
+        return idle;
+    }
+
+    /**
+     * @brief 返回等待中的协程数
+     */
+    uint32_t getWaiting() const { return m_waiting;}
+
+    /**
+     * @brief 返回名称
+     */
+    const std::string& getName() const { return m_name;}
+private:
+    /**
+     * @brief 池中的资源
+     */
+    struct Item {
+        /// 资源
+        T* res = nullptr;
+        /// 创建时间(毫秒)
+        uint64_t createTime = 0;
+        /// 最近一次归还的时间(毫秒)
+        uint64_t lastUsed = 0;
+    };
+
+    /**
+     * @brief 等待资源的协程
+     */
+    struct Waiter {
+        /// 等待的协程
+        Fiber::ptr fiber;
+        /// 协程所在的调度器
+        Scheduler* scheduler = nullptr;
+        /// 接手的资源，为空表示有了创建名额，需要重新获取
+        Item item;
+        /// 是否超时
+        bool timeout = false;
+    };
+
+    /**
+     * @brief 线程的空闲缓存
+     */
+    struct LocalCache {
+        /// 保护items，基本只有所属线程访问
+        Spinlock mutex;
+        /// 空闲资源，后进先出
+        std::vector<Item> items;
+        /// 避免相邻缓存共享缓存行
+        char padding[64];
+    };
+
+    /// 线程缓存数，超过该数的线程共享缓存
+    static const size_t LOCAL_COUNT = 16;
+
+    ResourcePool(const std::string& name
+                 ,Factory factory
+                 ,Validator validator
+                 ,uint32_t max_size
+                 ,uint64_t max_idle_ms
+                 ,uint64_t max_lifetime_ms
+                 ,uint32_t local_size)
+        :m_name(name)
+        ,m_factory(factory)
+        ,m_validator(validator)
+        ,m_maxSize(std::max(max_size, (uint32_t)1))
+        ,m_maxIdle(max_idle_ms)
+        ,m_maxLifetime(max_lifetime_ms)
+        ,m_localSize(local_size) {
+        auto mgr = MetricsMgr::GetInstance();
+        MetricsRegistry::Labels labels = {{"name", name}};
+        m_totalGauge = mgr->gauge("sylar_resource_pool_total"
+                        , "resources in use or idle", labels);
+        m_waitingGauge = mgr->gauge("sylar_resource_pool_waiting"
+                        , "fibers waiting for a resource", labels);
+        m_created = mgr->counter("sylar_resource_pool_created_total"
+                        , "resources created", labels);
+        m_timeouts = mgr->counter("sylar_resource_pool_timeouts_total"
+                        , "acquires timed out waiting for a resource", labels);
+    }
+
+    /**
+     * @brief 返回当前线程的缓存
+     * @details 线程按首次访问的顺序轮流分配，不用每次调用gettid
+     */
+    LocalCache& local() {
+        static std::atomic<uint32_t> s_next(0);
+        static thread_local uint32_t t_index = s_next++;
+        return m_locals[t_index % LOCAL_COUNT];
+    }
+
+    bool popLocal(Item& item) {
+        if(!m_localSize) {
+            return false;
+        }
+        LocalCache& cache = local();
+        Spinlock::Lock lock(cache.mutex);
+        if(cache.items.empty()) {
+            return false;
+        }
+        item = cache.items.back();
+        cache.items.pop_back();
+        return true;
+    }
+
+    bool pushLocal(const Item& item) {
+        if(!m_localSize) {
+            return false;
+        }
+        LocalCache& cache = local();
+        Spinlock::Lock lock(cache.mutex);
+        if(cache.items.size() >= m_localSize) {
+            return false;
+        }
+        cache.items.push_back(item);
+        return true;
+    }
+
+    bool popShared(Item& item) {
+        MutexType::Lock lock(m_mutex);
+        if(m_free.empty()) {
+            return false;
+        }
+        item = m_free.back();
+        m_free.pop_back();
+        return true;
+    }
+
+    /**
+     * @brief 从共享列表或任一线程缓存取一个空闲资源，调用方持有m_mutex
+     */
+    bool takeAny(Item& item) {
+        if(!m_free.empty()) {
+            item = m_free.back();
+            m_free.pop_back();
+            return true;
+        }
+        for(auto& i : m_locals) {
+            Spinlock::Lock lock(i.mutex);
+            if(!i.items.empty()) {
+                item = i.items.back();
+                i.items.pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief 资源是否可以继续使用
+     * @param[in] idle 是否从空闲资源中取出，是则检查空闲时间
+     */
+    bool check(const Item& item, uint64_t now, bool idle) {
+        if(m_maxLifetime && now >= item.createTime + m_maxLifetime) {
+            return false;
+        }
+        if(idle && m_maxIdle && now >= item.lastUsed + m_maxIdle) {
+            return false;
+        }
+        return !m_validator || m_validator(item.res);
+    }
+
+    /**
+     * @brief 把过期的资源从列表移到expired，调用方持有对应的锁
+     */
+    void filter(std::vector<Item>& items, uint64_t now, std::vector<Item>& expired) {
+        auto it = items.begin();
+        for(auto& i : items) {
+            if((m_maxLifetime && now >= i.createTime + m_maxLifetime)
+                    || (m_maxIdle && now >= i.lastUsed + m_maxIdle)) {
+                expired.push_back(i);
+            } else {
+                *it++ = i;
+            }
+        }
+        items.erase(it, items.end());
+    }
+
+    /**
+     * @brief 占用一个创建名额
+     */
+    bool reserve() {
+        MutexType::Lock lock(m_mutex);
+        if(m_total >= m_maxSize) {
+            return false;
+        }
+        ++m_total;
+        m_totalGauge->inc();
+        return true;
+    }
+
+    /**
+     * @brief 归还创建名额，有等待者时唤醒一个去创建
+     */
+    void unreserve() {
+        MutexType::Lock lock(m_mutex);
+        --m_total;
+        m_totalGauge->dec();
+        if(m_waiters.empty()) {
+            return;
+        }
+        std::shared_ptr<Waiter> waiter = m_waiters.front();
+        m_waiters.pop_front();
+        --m_waiting;
+        m_waitingGauge->dec();
+        lock.unlock();
+        waiter->scheduler->schedule(waiter->fiber);
+    }
+
+    std::shared_ptr<T> create(uint64_t now) {
+        Item item;
+        item.res = m_factory();
+        if(!item.res) {
+            unreserve();
+            return nullptr;
+        }
+        m_created->inc();
+        item.createTime = item.lastUsed = now;
+        return wrap(item);
+    }
+
+    void destroy(Item& item) {
+        delete item.res;
+        item.res = nullptr;
+        unreserve();
+    }
+
+    std::shared_ptr<T> wrap(const Item& item) {
+        ptr self = this->shared_from_this();
+        return std::shared_ptr<T>(item.res, [self, item](T*) {
+            self->release(item);
+        });
+    }
+
+    /**
+     * @brief 挂起当前协程等待资源
+     * @return 1 接手了资源，0 有了创建名额，-1 超时
+     */
+    int wait(Item& item, uint64_t now, uint64_t deadline) {
+        if(now >= deadline || !Scheduler::GetThis()) {
+            return -1;
+        }
+        std::shared_ptr<Waiter> waiter(new Waiter);
+        waiter->fiber = Fiber::GetThis();
+        waiter->scheduler = Scheduler::GetThis();
+        {
+            MutexType::Lock lock(m_mutex);
+            // 先登记再检查，和release的"先放入缓存再检查等待数"配合，资源不会滞留在其他线程的缓存里
+            ++m_waiting;
+            if(takeAny(item)) {
+                --m_waiting;
+                return 1;
+            }
+            if(m_total < m_maxSize) {
+                --m_waiting;
+                return 0;
+            }
+            m_waiters.push_back(waiter);
+            m_waitingGauge->inc();
+        }
+        Timer::ptr timer;
+        if(deadline != ~0ull) {
+            TimerManager* tm = IOManager::GetThis();
+            if(tm) {
+                ptr self = this->shared_from_this();
+                timer = tm->addTimer(deadline - now, [self, waiter]() {
+                    self->timeoutWaiter(waiter);
+                });
+            }
+        }
+        Fiber::GetThis()->yield();
+        if(timer) {
+            timer->cancel();
+        }
+        waiter->fiber.reset();
+        if(waiter->timeout) {
+            return -1;
+        }
+        item = waiter->item;
+        return item.res ? 1 : 0;
+    }
+
+    void timeoutWaiter(std::shared_ptr<Waiter> waiter) {
+        MutexType::Lock lock(m_mutex);
+        for(auto it = m_waiters.begin(); it != m_waiters.end(); ++it) {
+            if(*it == waiter) {
+                m_waiters.erase(it);
+                --m_waiting;
+                m_waitingGauge->dec();
+                waiter->timeout = true;
+                lock.unlock();
+                waiter->scheduler->schedule(waiter->fiber);
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief 把空闲资源交给等待者
+     */
+    void dispatch() {
+        std::vector<std::shared_ptr<Waiter> > wakes;
+        MutexType::Lock lock(m_mutex);
+        while(!m_waiters.empty()) {
+            Item item;
+            if(!takeAny(item)) {
+                break;
+            }
+            std::shared_ptr<Waiter> waiter = m_waiters.front();
+            m_waiters.pop_front();
+            --m_waiting;
+            m_waitingGauge->dec();
+            waiter->item = item;
+            wakes.push_back(waiter);
+        }
+        lock.unlock();
+        for(auto& i : wakes) {
+            i->scheduler->schedule(i->fiber);
+        }
+    }
+
+    void release(Item item) {
+        uint64_t now = GetCurrentMS();
+        if(!check(item, now, false)) {
+            destroy(item);
+            return;
+        }
+        item.lastUsed = now;
+        if(!pushLocal(item)) {
+            MutexType::Lock lock(m_mutex);
+            m_free.push_back(item);
+        }
+        if(m_waiting) {
+            dispatch();
+        }
+    }
+private:
+    /// 名称
+    std::string m_name;
+    /// 创建资源
+    Factory m_factory;
+    /// 校验资源
+    Validator m_validator;
+    /// 资源总数上限
+    uint32_t m_maxSize;
+    /// 最大空闲时间(毫秒)
+    uint64_t m_maxIdle;
+    /// 最大生命周期(毫秒)
+    uint64_t m_maxLifetime;
+    /// 每个线程缓存的空闲资源数
+    uint32_t m_localSize;
+    /// 保护m_free、m_waiters和m_total
+    MutexType m_mutex;
+    /// 共享空闲列表，后进先出
+    std::vector<Item> m_free;
+    /// 等待资源的协程，先进先出
+    std::deque<std::shared_ptr<Waiter> > m_waiters;
+    /// 资源总数
+    uint32_t m_total = 0;
+    /// 等待者数，release不加锁检查
+    std::atomic<uint32_t> m_waiting = {0};
+    /// 线程缓存
+    LocalCache m_locals[LOCAL_COUNT];
+    /// 淘汰定时器
+    Timer::ptr m_evictTimer;
+    /// 资源总数
+    Gauge::ptr m_totalGauge;
+    /// 等待者数
+    Gauge::ptr m_waitingGauge;
+    /// 累计创建数
+    Counter::ptr m_created;
+    /// 累计等待超时数
+    Counter::ptr m_timeouts;
+};
+
+}
+
+#endif
@@ -0,0 +1,98 @@
+/**
+ * @file rpc.cc
+ * @brief RPC协议消息编解码实现
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "rpc.h"
+#include <sstream>
+#include <stdexcept>
+#include <string.h>
+
+namespace sylar {
+namespace rpc {
+
+std::string RpcMessage::encode() const {
+    ByteArray::ptr ba(new ByteArray(256));
+    ba->writeFuint8(MAGIC);
+    ba->writeFuint8(type);
+    ba->writeUint64(id);
+    ba->writeInt32(result);
+    ba->writeInt32(status);
+    ba->writeStringVint(method);
+    ba->writeStringVint(body);
+    ba->setPosition(0);
+
+    // 长度前缀与ByteArray::writeUint32的编码方式一致
+    uint32_t len = ba->getSize();
+    uint8_t prefix[5];
+    uint8_t n = 0;
+    while(len >= 0x80) {
+        prefix[n++] = (len & 0x7F) | 0x80;
+        len >>= 7;
+    }
+    prefix[n++] = len;
+
+    std::string data;
+    data.resize(n + ba->getSize());
+    memcpy(&data[0], prefix, n);
+    ba->read(&data[n], ba->getSize());
+    return data;
+}
+
+bool RpcMessage::decode(ByteArray::ptr ba) {
+    try {
+        if(ba->readFuint8() != MAGIC) {
+            return false;
+        }
+        type = ba->readFuint8();
+        id = ba->readUint64();
+        result = ba->readInt32();
+        status = ba->readInt32();
+        method = ba->readStringVint();
+        body = ba->readStringVint();
+    } catch(std::out_of_range&) {
+        return false;
+    }
+    return type == REQUEST || type == RESPONSE;
+}
+
+std::string RpcMessage::toString() const {
+    std::stringstream ss;
+    ss << "[RpcMessage type=" << (uint32_t)type
+       << " id=" << id
+       << " result=" << result
+       << " status=" << status
+       << " method=" << method
+       << " body_size=" << body.size()
+       << "]";
+    return ss.str();
+}
+
+std::string RpcResult::toString() const {
+    std::stringstream ss;
+    ss << "[RpcResult result=" << result
+       << " status=" << status
+       << " error=" << error
+       << " response_size=" << response.size()
+       << "]";
+    return ss.str();
+}
+
+int DecodeVarint32(const char* data, size_t len, uint32_t& value) {
+    value = 0;
+    for(size_t i = 0; i < 5; ++i) {
+        if(i >= len) {
+            return 0;
+        }
+        uint8_t b = data[i];
+        value |= ((uint32_t)(b & 0x7f)) << (7 * i);
+        if(b < 0x80) {
+            return i + 1;
+        }
+    }
+    return -1;
+}
+
+}
+}
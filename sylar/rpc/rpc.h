@@ -0,0 +1,151 @@
+/**
+ * @file rpc.h
+ * @brief RPC协议消息定义及编解码
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#ifndef __SYLAR_RPC_RPC_H__
+#define __SYLAR_RPC_RPC_H__
+
+#include <memory>
+#include <string>
+#include <stdint.h>
+#include "../bytearray.h"
+
+/*
+    RPC帧格式（所有整数均使用ByteArray的varint编码）：
+
+    +----------------+---------+------+--------+--------+--------+----------------+--------------+
+    | length(varint) | magic   | type | id     | result | status | method(string) | body(string) |
+    |                | (uint8) | (u8) | (vu64) | (vi32) | (vi32) | (varint+bytes) | (varint+bytes)|
+    +----------------+---------+------+--------+--------+--------+----------------+--------------+
+
+    length是其后所有字段的总字节数，接收方据此切分帧。
+    id由客户端为每次调用分配，响应原样带回，因此同一连接上可以同时存在多个未完成的调用，
+    响应可以乱序返回。
+    result为框架层错误码(RpcResult::Error)，status为业务方法的返回值。
+*/
+
+namespace sylar {
+namespace rpc {
+
+/**
+ * @brief RPC消息
+ */
+struct RpcMessage {
+    /// 智能指针类型定义
+    typedef std::shared_ptr<RpcMessage> ptr;
+
+    /**
+     * @brief 消息类型
+     */
+    enum Type {
+        /// 请求
+        REQUEST  = 1,
+        /// 响应
+        RESPONSE = 2,
+    };
+
+    /// 帧魔数，用于快速识别非法数据
+    static const uint8_t MAGIC = 0xab;
+
+    /**
+     * @brief 序列化为完整的帧(带长度前缀)
+     * @return 帧数据
+     */
+    std::string encode() const;
+
+    /**
+     * @brief 从ByteArray中解析帧内容(不含长度前缀)
+     * @param[in] ba 帧内容，读取位置位于魔数处
+     * @return 是否解析成功
+     */
+    bool decode(ByteArray::ptr ba);
+
+    /**
+     * @brief 转成字符串，用于调试
+     */
+    std::string toString() const;
+
+    /// 消息类型
+    uint8_t type = REQUEST;
+    /// 调用序号
+    uint64_t id = 0;
+    /// 框架层错误码
+    int32_t result = 0;
+    /// 业务返回值
+    int32_t status = 0;
+    /// 方法名
+    std::string method;
+    /// 消息体
+    std::string body;
+};
+
+/**
+ * @brief RPC调用结果
+ */
+struct RpcResult {
+    /// 智能指针类型定义
+    typedef std::shared_ptr<RpcResult> ptr;
+
+    /**
+     * @brief 错误码定义
+     */
+    enum class Error {
+        /// 正常
+        OK = 0,
+        /// 方法不存在
+        METHOD_NOT_FOUND = 1,
+        /// 超时
+        TIMEOUT = 2,
+        /// 连接失败
+        CONNECT_FAIL = 3,
+        /// 发送请求失败
+        SEND_FAIL = 4,
+        /// 连接被关闭
+        CONNECTION_CLOSED = 5,
+    };
+
+    /**
+     * @brief 构造函数
+     * @param[in] _result 错误码
+     * @param[in] _status 业务返回值
+     * @param[in] _response 响应消息体
+     * @param[in] _error 错误描述
+     */
+    RpcResult(int _result
+              ,int32_t _status
+              ,const std::string& _response
+              ,const std::string& _error)
+        :result(_result)
+        ,status(_status)
+        ,response(_response)
+        ,error(_error) {}
+
+    /// 错误码
+    int result;
+    /// 业务返回值
+    int32_t status;
+    /// 响应消息体
+    std::string response;
+    /// 错误描述
+    std::string error;
+    /// 转字符串
+    std::string toString() const;
+};
+
+/**
+ * @brief 从内存中解析varint32长度前缀
+ * @param[in] data 数据起始地址
+ * @param[in] len 可用字节数
+ * @param[out] value 解析出的值
+ * @return >0 长度前缀占用的字节数
+ *         =0 数据不完整，需要继续读取
+ *         <0 数据非法
+ */
+int DecodeVarint32(const char* data, size_t len, uint32_t& value);
+
+}
+}
+
+#endif
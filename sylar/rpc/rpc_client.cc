@@ -0,0 +1,219 @@
+/**
+ * @file rpc_client.cc
+ * @brief RPC客户端实现
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "rpc_client.h"
+#include <sys/socket.h>
+#include "../log.h"
+#include "../macro.h"
+
+namespace sylar {
+namespace rpc {
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_NAME("system");
+
+bool RpcClient::Connection::add(uint64_t id, CallContext::ptr ctx) {
+    MutexType::Lock lock(mutex);
+    if(closed) {
+        return false;
+    }
+    pending[id] = ctx;
+    return true;
+}
+
+RpcClient::CallContext::ptr RpcClient::Connection::take(uint64_t id) {
+    MutexType::Lock lock(mutex);
+    auto it = pending.find(id);
+    if(it == pending.end()) {
+        return nullptr;
+    }
+    CallContext::ptr ctx = it->second;
+    pending.erase(it);
+    return ctx;
+}
+
+void RpcClient::Connection::failAll() {
+    std::unordered_map<uint64_t, CallContext::ptr> tmp;
+    {
+        MutexType::Lock lock(mutex);
+        closed = true;
+        tmp.swap(pending);
+    }
+    for(auto& i : tmp) {
+        i.second->error = RpcResult::Error::CONNECTION_CLOSED;
+        Wakeup(i.second);
+    }
+}
+
+RpcClient::RpcClient(Address::ptr addr, uint32_t max_conns, IOManager* iom)
+    :m_addr(addr)
+    ,m_maxConns(max_conns ? max_conns : 1)
+    ,m_iom(iom) {
+    m_conns.resize(m_maxConns);
+}
+
+RpcClient::~RpcClient() {
+    close();
+}
+
+void RpcClient::Wakeup(CallContext::ptr ctx) {
+    MutexType::Lock lock(ctx->mutex);
+    ctx->done = true;
+    if(ctx->parked) {
+        ctx->parked = false;
+        ctx->scheduler->schedule(ctx->fiber);
+    }
+}
+
+void RpcClient::ReadLoop(Connection::ptr conn) {
+    do {
+        auto msg = conn->session->recvMessage();
+        if(!msg) {
+            break;
+        }
+        if(msg->type != RpcMessage::RESPONSE) {
+            SYLAR_LOG_WARN(g_logger) << "unexpected rpc message " << msg->toString();
+            continue;
+        }
+        auto ctx = conn->take(msg->id);
+        if(!ctx) {
+            // 调用已超时，丢弃迟到的响应
+            continue;
+        }
+        ctx->response = msg;
+        Wakeup(ctx);
+    } while(true);
+    conn->session->close();
+    conn->failAll();
+}
+
+RpcClient::Connection::ptr RpcClient::getConnection() {
+    uint32_t idx = m_next++ % m_maxConns;
+    {
+        MutexType::Lock lock(m_mutex);
+        Connection::ptr conn = m_conns[idx];
+        if(conn && conn->session->isConnected()) {
+            return conn;
+        }
+    }
+
+    Socket::ptr sock = Socket::CreateTCP(m_addr);
+    if(!sock) {
+        SYLAR_LOG_ERROR(g_logger) << "create sock fail: " << *m_addr;
+        return nullptr;
+    }
+    if(!sock->connect(m_addr)) {
+        SYLAR_LOG_ERROR(g_logger) << "sock connect fail: " << *m_addr;
+        return nullptr;
+    }
+
+    Connection::ptr conn(new Connection);
+    conn->session.reset(new RpcSession(sock));
+    {
+        MutexType::Lock lock(m_mutex);
+        Connection::ptr old = m_conns[idx];
+        if(old && old->session->isConnected()) {
+            // 其他协程已经抢先建好了连接
+            lock.unlock();
+            sock->close();
+            return old;
+        }
+        m_conns[idx] = conn;
+    }
+    m_iom->schedule(std::bind(&RpcClient::ReadLoop, conn));
+    return conn;
+}
+
+RpcResult::ptr RpcClient::call(const std::string& method
+                               ,const std::string& request
+                               ,uint64_t timeout_ms) {
+    SYLAR_ASSERT2(Scheduler::GetThis(), "RpcClient::call must run in a scheduler");
+    auto conn = getConnection();
+    if(!conn) {
+        return std::make_shared<RpcResult>((int)RpcResult::Error::CONNECT_FAIL
+                , 0, "", "connect fail: " + m_addr->toString());
+    }
+
+    CallContext::ptr ctx(new CallContext);
+    ctx->fiber = Fiber::GetThis();
+    ctx->scheduler = Scheduler::GetThis();
+    uint64_t id = ++m_sn;
+    if(!conn->add(id, ctx)) {
+        return std::make_shared<RpcResult>((int)RpcResult::Error::CONNECTION_CLOSED
+                , 0, "", "connection closed: " + m_addr->toString());
+    }
+
+    RpcMessage::ptr req(new RpcMessage);
+    req->type = RpcMessage::REQUEST;
+    req->id = id;
+    req->method = method;
+    req->body = request;
+
+    Timer::ptr timer;
+    if(timeout_ms != (uint64_t)-1) {
+        timer = m_iom->addTimer(timeout_ms, [conn, id]() {
+            auto ctx = conn->take(id);
+            if(ctx) {
+                ctx->error = RpcResult::Error::TIMEOUT;
+                Wakeup(ctx);
+            }
+        });
+    }
+
+    if(conn->session->sendMessage(req) <= 0) {
+        if(conn->take(id)) {
+            if(timer) {
+                timer->cancel();
+            }
+            return std::make_shared<RpcResult>((int)RpcResult::Error::SEND_FAIL
+                    , 0, "", "send request fail errno=" + std::to_string(errno)
+                    + " errstr=" + std::string(strerror(errno)));
+        }
+        // 调用已经被读协程或定时器取走，等待它的唤醒
+    }
+
+    {
+        MutexType::Lock lock(ctx->mutex);
+        if(!ctx->done) {
+            ctx->parked = true;
+            lock.unlock();
+            Fiber::GetThis()->yield();
+        }
+    }
+    if(timer) {
+        timer->cancel();
+    }
+    ctx->fiber.reset();
+
+    if(ctx->error != RpcResult::Error::OK) {
+        return std::make_shared<RpcResult>((int)ctx->error, 0, ""
+                , (ctx->error == RpcResult::Error::TIMEOUT ? "timeout: " : "connection closed: ")
+                + m_addr->toString());
+    }
+    auto rsp = ctx->response;
+    if(rsp->result != (int32_t)RpcResult::Error::OK) {
+        return std::make_shared<RpcResult>(rsp->result, rsp->status, ""
+                , "method not found: " + method);
+    }
+    return std::make_shared<RpcResult>((int)RpcResult::Error::OK
+            , rsp->status, rsp->body, "ok");
+}
+
+void RpcClient::close() {
+    std::vector<Connection::ptr> conns;
+    {
+        MutexType::Lock lock(m_mutex);
+        conns = m_conns;
+    }
+    for(auto& i : conns) {
+        if(i && i->session->isConnected()) {
+            // shutdown让读协程读到EOF，由读协程自己关闭连接并唤醒未完成的调用
+            ::shutdown(i->session->getSocket()->getSocket(), SHUT_RDWR);
+        }
+    }
+}
+
+}
+}
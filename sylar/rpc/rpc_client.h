@@ -0,0 +1,161 @@
+/**
+ * @file rpc_client.h
+ * @brief RPC客户端封装
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#ifndef __SYLAR_RPC_CLIENT_H__
+#define __SYLAR_RPC_CLIENT_H__
+
+#include <atomic>
+#include <unordered_map>
+#include <vector>
+#include "../address.h"
+#include "../fiber.h"
+#include "../iomanager.h"
+#include "../noncopyable.h"
+#include "rpc_session.h"
+
+namespace sylar {
+namespace rpc {
+
+/**
+ * @brief RPC客户端
+ * @details 客户端持有到同一服务端的若干条长连接，调用按轮询方式分摊到各连接上，
+ *          每条连接可以同时承载任意多个未完成的调用。
+ *          call()发出请求后挂起当前协程，连接上的读协程收到id匹配的响应后再把它调度回来，
+ *          超时由定时器负责唤醒。call()必须在IOManager的协程中调用
+ */
+class RpcClient : public std::enable_shared_from_this<RpcClient>, Noncopyable {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<RpcClient> ptr;
+    /// 锁类型
+    typedef Mutex MutexType;
+
+    /**
+     * @brief 构造函数
+     * @param[in] addr 服务端地址
+     * @param[in] max_conns 最多使用的连接数
+     * @param[in] iom 运行读协程和定时器的IOManager
+     */
+    RpcClient(Address::ptr addr
+              ,uint32_t max_conns = 1
+              ,IOManager* iom = IOManager::GetThis());
+
+    /**
+     * @brief 析构函数，关闭所有连接
+     */
+    ~RpcClient();
+
+    /**
+     * @brief 发起一次RPC调用
+     * @param[in] method 方法名
+     * @param[in] request 请求消息体
+     * @param[in] timeout_ms 超时时间(毫秒)，-1表示不超时
+     * @return 调用结果
+     */
+    RpcResult::ptr call(const std::string& method
+                        ,const std::string& request
+                        ,uint64_t timeout_ms = -1);
+
+    /**
+     * @brief 关闭所有连接，所有未完成的调用返回CONNECTION_CLOSED
+     */
+    void close();
+
+    /**
+     * @brief 返回服务端地址
+     */
+    Address::ptr getAddress() const { return m_addr;}
+
+private:
+    /**
+     * @brief 一次未完成的调用
+     */
+    struct CallContext {
+        typedef std::shared_ptr<CallContext> ptr;
+        /// 发起调用的协程
+        Fiber::ptr fiber;
+        /// 发起调用协程所在的调度器
+        Scheduler* scheduler = nullptr;
+        /// 响应消息
+        RpcMessage::ptr response;
+        /// 框架层错误码
+        RpcResult::Error error = RpcResult::Error::OK;
+        /// 保护done和parked
+        MutexType mutex;
+        /// 结果已经填好
+        bool done = false;
+        /// 调用协程已经准备好挂起，只有此时才能调度它。
+        /// 在此之前调用协程可能还停在hook的write里，提前调度会被当成写事件就绪
+        bool parked = false;
+    };
+
+    /**
+     * @brief 一条复用的连接及其上未完成的调用
+     */
+    struct Connection {
+        typedef std::shared_ptr<Connection> ptr;
+        /// 连接
+        RpcSession::ptr session;
+        /// 锁
+        MutexType mutex;
+        /// 调用序号 -> 未完成的调用
+        std::unordered_map<uint64_t, CallContext::ptr> pending;
+        /// 连接是否已失效
+        bool closed = false;
+
+        /**
+         * @brief 登记一个调用
+         * @return 连接已失效时返回false
+         */
+        bool add(uint64_t id, CallContext::ptr ctx);
+
+        /**
+         * @brief 取出一个调用，取出者负责唤醒调用协程
+         */
+        CallContext::ptr take(uint64_t id);
+
+        /**
+         * @brief 连接失效，唤醒所有未完成的调用
+         */
+        void failAll();
+    };
+
+    /**
+     * @brief 取一条可用的连接，必要时建立新连接
+     */
+    Connection::ptr getConnection();
+
+    /**
+     * @brief 连接上的读协程，把响应分发给对应的调用
+     */
+    static void ReadLoop(Connection::ptr conn);
+
+    /**
+     * @brief 标记调用已完成，调用协程已挂起时唤醒它
+     */
+    static void Wakeup(CallContext::ptr ctx);
+
+private:
+    /// 服务端地址
+    Address::ptr m_addr;
+    /// 最大连接数
+    uint32_t m_maxConns;
+    /// IOManager
+    IOManager* m_iom;
+    /// 锁
+    MutexType m_mutex;
+    /// 连接数组
+    std::vector<Connection::ptr> m_conns;
+    /// 轮询下标
+    std::atomic<uint32_t> m_next = {0};
+    /// 调用序号
+    std::atomic<uint64_t> m_sn = {0};
+};
+
+}
+}
+
+#endif
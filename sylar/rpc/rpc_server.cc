@@ -0,0 +1,79 @@
+/**
+ * @file rpc_server.cc
+ * @brief RPC服务器实现
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "rpc_server.h"
+#include "../log.h"
+
+namespace sylar {
+namespace rpc {
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_NAME("system");
+
+RpcServer::RpcServer(sylar::IOManager* worker
+                     ,sylar::IOManager* io_worker
+                     ,sylar::IOManager* accept_worker)
+    :TcpServer(io_worker, accept_worker)
+    ,m_worker(worker) {
+    m_type = "rpc";
+}
+
+void RpcServer::registerMethod(const std::string& name, Method cb) {
+    RWMutexType::WriteLock lock(m_mutex);
+    m_methods[name] = cb;
+}
+
+void RpcServer::unregisterMethod(const std::string& name) {
+    RWMutexType::WriteLock lock(m_mutex);
+    m_methods.erase(name);
+}
+
+RpcServer::Method RpcServer::getMethod(const std::string& name) {
+    RWMutexType::ReadLock lock(m_mutex);
+    auto it = m_methods.find(name);
+    return it == m_methods.end() ? nullptr : it->second;
+}
+
+void RpcServer::handleClient(Socket::ptr client) {
+    SYLAR_LOG_DEBUG(g_logger) << "handleClient " << *client;
+    RpcSession::ptr session(new RpcSession(client));
+    do {
+        auto msg = session->recvMessage();
+        if(!msg) {
+            SYLAR_LOG_DEBUG(g_logger) << "recv rpc message fail, errno="
+                << errno << " errstr=" << strerror(errno)
+                << " client:" << *client;
+            break;
+        }
+        if(msg->type != RpcMessage::REQUEST) {
+            SYLAR_LOG_WARN(g_logger) << "unexpected rpc message " << msg->toString();
+            continue;
+        }
+        m_worker->schedule(std::bind(&RpcServer::handleRequest
+                    ,std::static_pointer_cast<RpcServer>(shared_from_this())
+                    ,session, msg));
+    } while(true);
+    session->close();
+}
+
+void RpcServer::handleRequest(RpcSession::ptr session, RpcMessage::ptr request) {
+    RpcMessage::ptr rsp(new RpcMessage);
+    rsp->type = RpcMessage::RESPONSE;
+    rsp->id = request->id;
+
+    Method cb = getMethod(request->method);
+    if(cb) {
+        rsp->result = (int32_t)RpcResult::Error::OK;
+        rsp->status = cb(request->body, rsp->body);
+    } else {
+        rsp->result = (int32_t)RpcResult::Error::METHOD_NOT_FOUND;
+    }
+    if(session->sendMessage(rsp) <= 0) {
+        SYLAR_LOG_DEBUG(g_logger) << "send rpc response fail " << rsp->toString();
+    }
+}
+
+}
+}
@@ -0,0 +1,88 @@
+/**
+ * @file rpc_server.h
+ * @brief RPC服务器封装
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#ifndef __SYLAR_RPC_SERVER_H__
+#define __SYLAR_RPC_SERVER_H__
+
+#include <functional>
+#include <unordered_map>
+#include "../tcp_server.h"
+#include "rpc_session.h"
+
+namespace sylar {
+namespace rpc {
+
+/**
+ * @brief RPC服务器，继承自TcpServer
+ * @details 每个连接由一个协程循环读取请求帧，每个请求再单独调度到worker上的协程中执行，
+ *          因此同一连接上的慢请求不会阻塞后续请求，响应按完成顺序写回
+ */
+class RpcServer : public TcpServer {
+public:
+    /// 智能指针类型
+    typedef std::shared_ptr<RpcServer> ptr;
+    /// 读写锁类型定义
+    typedef RWMutex RWMutexType;
+    /**
+     * @brief RPC方法回调
+     * @param[in] request 请求消息体
+     * @param[out] response 响应消息体
+     * @return 业务返回值，原样带回给调用方
+     */
+    typedef std::function<int32_t (const std::string& request
+                                   ,std::string& response)> Method;
+
+    /**
+     * @brief 构造函数
+     * @param[in] worker 执行RPC方法的调度器
+     * @param[in] io_worker 读写连接的调度器
+     * @param[in] accept_worker 接收连接调度器
+     */
+    RpcServer(sylar::IOManager* worker = sylar::IOManager::GetThis()
+              ,sylar::IOManager* io_worker = sylar::IOManager::GetThis()
+              ,sylar::IOManager* accept_worker = sylar::IOManager::GetThis());
+
+    /**
+     * @brief 注册RPC方法，同名方法会被覆盖
+     * @param[in] name 方法名
+     * @param[in] cb 方法回调
+     */
+    void registerMethod(const std::string& name, Method cb);
+
+    /**
+     * @brief 删除RPC方法
+     * @param[in] name 方法名
+     */
+    void unregisterMethod(const std::string& name);
+
+    /**
+     * @brief 查找RPC方法
+     * @param[in] name 方法名
+     * @return 不存在时返回nullptr
+     */
+    Method getMethod(const std::string& name);
+
+protected:
+    virtual void handleClient(Socket::ptr client) override;
+
+    /**
+     * @brief 执行一个RPC请求并写回响应
+     */
+    void handleRequest(RpcSession::ptr session, RpcMessage::ptr request);
+
+private:
+    /// 执行RPC方法的调度器
+    IOManager* m_worker;
+    /// 读写锁
+    RWMutexType m_mutex;
+    /// 方法名 -> 方法回调
+    std::unordered_map<std::string, Method> m_methods;
+};
+
+}
+}
+
+#endif
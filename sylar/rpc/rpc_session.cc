@@ -0,0 +1,113 @@
+/**
+ * @file rpc_session.cc
+ * @brief RPC连接封装实现
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "rpc_session.h"
+#include "../config.h"
+#include "../log.h"
+
+namespace sylar {
+namespace rpc {
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_NAME("system");
+
+static sylar::ConfigVar<uint32_t>::ptr g_rpc_buffer_size =
+    sylar::Config::Lookup("rpc.buffer_size", (uint32_t)(16 * 1024), "rpc read buffer size");
+
+static sylar::ConfigVar<uint32_t>::ptr g_rpc_max_frame_size =
+    sylar::Config::Lookup("rpc.max_frame_size", (uint32_t)(16 * 1024 * 1024), "rpc max frame size");
+
+RpcSession::RpcSession(Socket::ptr sock, bool owner)
+    :SocketStream(sock, owner)
+    ,m_maxFrameSize(g_rpc_max_frame_size->getValue()) {
+    m_rbuf.resize(g_rpc_buffer_size->getValue());
+}
+
+RpcMessage::ptr RpcSession::recvMessage() {
+    do {
+        uint32_t len = 0;
+        int n = DecodeVarint32(&m_rbuf[m_rpos], m_wpos - m_rpos, len);
+        if(n < 0 || len > m_maxFrameSize) {
+            SYLAR_LOG_ERROR(g_logger) << "invalid rpc frame, len=" << len
+                << " peer=" << getRemoteAddressString();
+            close();
+            return nullptr;
+        }
+        if(n > 0 && m_wpos - m_rpos >= n + len) {
+            ByteArray::ptr ba(new ByteArray(len > 0 ? len : 1));
+            ba->write(&m_rbuf[m_rpos + n], len);
+            ba->setPosition(0);
+            m_rpos += n + len;
+
+            RpcMessage::ptr msg(new RpcMessage);
+            if(!msg->decode(ba)) {
+                SYLAR_LOG_ERROR(g_logger) << "decode rpc frame fail, peer="
+                    << getRemoteAddressString();
+                close();
+                return nullptr;
+            }
+            return msg;
+        }
+
+        // 帧不完整，先把剩余数据挪到缓冲区头部，必要时扩容，再继续读
+        if(m_rpos > 0) {
+            memmove(&m_rbuf[0], &m_rbuf[m_rpos], m_wpos - m_rpos);
+            m_wpos -= m_rpos;
+            m_rpos = 0;
+        }
+        if(n > 0 && n + len > m_rbuf.size()) {
+            m_rbuf.resize(n + len);
+        }
+        int rt = read(&m_rbuf[m_wpos], m_rbuf.size() - m_wpos);
+        if(rt <= 0) {
+            close();
+            return nullptr;
+        }
+        m_wpos += rt;
+    } while(true);
+}
+
+int RpcSession::sendMessage(RpcMessage::ptr msg) {
+    std::string data = msg->encode();
+    int size = data.size();
+    {
+        MutexType::Lock lock(m_mutex);
+        m_sendQueue.push_back(std::move(data));
+        if(m_sending) {
+            return size;
+        }
+        m_sending = true;
+    }
+
+    do {
+        std::list<std::string> queue;
+        {
+            MutexType::Lock lock(m_mutex);
+            if(m_sendQueue.empty()) {
+                m_sending = false;
+                break;
+            }
+            queue.swap(m_sendQueue);
+        }
+        std::string buf;
+        if(queue.size() == 1) {
+            buf.swap(queue.front());
+        } else {
+            for(auto& i : queue) {
+                buf.append(i);
+            }
+        }
+        if(writeFixSize(buf.c_str(), buf.size()) <= 0) {
+            MutexType::Lock lock(m_mutex);
+            m_sendQueue.clear();
+            m_sending = false;
+            return -1;
+        }
+    } while(true);
+    return size;
+}
+
+}
+}
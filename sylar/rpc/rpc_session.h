@@ -0,0 +1,73 @@
+/**
+ * @file rpc_session.h
+ * @brief RPC连接封装
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#ifndef __SYLAR_RPC_SESSION_H__
+#define __SYLAR_RPC_SESSION_H__
+
+#include <list>
+#include "../streams/socket_stream.h"
+#include "../mutex.h"
+#include "rpc.h"
+
+namespace sylar {
+namespace rpc {
+
+/**
+ * @brief RPC连接，服务端和客户端共用
+ * @details 读方向带缓冲，一次read可以切出多个帧；
+ *          写方向由多个协程并发调用sendMessage，消息先进入发送队列，
+ *          由第一个发现队列空闲的协程负责把队列中的帧合并写出，其余协程直接返回，
+ *          因此写操作不会在持锁期间让出协程
+ */
+class RpcSession : public SocketStream {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<RpcSession> ptr;
+    /// 锁类型
+    typedef Mutex MutexType;
+
+    /**
+     * @brief 构造函数
+     * @param[in] sock Socket类型
+     * @param[in] owner 是否托管
+     */
+    RpcSession(Socket::ptr sock, bool owner = true);
+
+    /**
+     * @brief 接收一个RPC消息
+     * @return 失败或对端关闭时返回nullptr，同一时刻只能有一个协程调用
+     */
+    RpcMessage::ptr recvMessage();
+
+    /**
+     * @brief 发送一个RPC消息
+     * @param[in] msg 消息
+     * @return >0 发送成功或已进入发送队列
+     *         <=0 Socket异常
+     */
+    int sendMessage(RpcMessage::ptr msg);
+
+private:
+    /// 读缓冲区
+    std::string m_rbuf;
+    /// 读缓冲区中未解析数据的起始位置
+    size_t m_rpos = 0;
+    /// 读缓冲区中有效数据的结束位置
+    size_t m_wpos = 0;
+    /// 单帧最大字节数
+    uint32_t m_maxFrameSize;
+    /// 发送队列锁
+    MutexType m_mutex;
+    /// 待发送的帧
+    std::list<std::string> m_sendQueue;
+    /// 是否有协程正在写
+    bool m_sending = false;
+};
+
+}
+}
+
+#endif
@@ -48,6 +48,19 @@ Scheduler::Scheduler(size_t threads, bool use_caller, const std::string &name) {
         m_rootThread = -1;
     }
     m_threadCount = threads;
+
+    static std::atomic<uint64_t> s_scheduler_id = {0};
+    m_metricLabels["scheduler"] = m_name;
+    m_metricLabels["id"]        = std::to_string(++s_scheduler_id);
+    auto metrics = MetricsMgr::GetInstance();
+    metrics->gauge("sylar_scheduler_threads", "scheduler threads", m_metricLabels,
+                   [this]() { return (double)getThreadCount(); });
+    metrics->gauge("sylar_scheduler_active_threads", "scheduler threads running a task", m_metricLabels,
+                   [this]() { return (double)getActiveThreadCount(); });
+    metrics->gauge("sylar_scheduler_idle_threads", "scheduler threads in idle", m_metricLabels,
+                   [this]() { return (double)getIdleThreadCount(); });
+    metrics->gauge("sylar_scheduler_tasks", "tasks waiting in the scheduler queue", m_metricLabels,
+                   [this]() { return (double)getTaskCount(); });
 }
 
 Scheduler *Scheduler::GetThis() { 
@@ -58,12 +71,22 @@ Fiber *Scheduler::GetMainFiber() {
     return t_scheduler_fiber;
 }
 
+size_t Scheduler::getTaskCount() {
+    MutexType::Lock lock(m_mutex);
+    return m_tasks.size();
+}
+
 void Scheduler::setThis() {
     t_scheduler = this;
 }
 
 Scheduler::~Scheduler() {
     SYLAR_LOG_DEBUG(g_logger) << "Scheduler::~Scheduler()";
+    auto metrics = MetricsMgr::GetInstance();
+    metrics->remove("sylar_scheduler_threads", m_metricLabels);
+    metrics->remove("sylar_scheduler_active_threads", m_metricLabels);
+    metrics->remove("sylar_scheduler_idle_threads", m_metricLabels);
+    metrics->remove("sylar_scheduler_tasks", m_metricLabels);
     SYLAR_ASSERT(m_stopping);
     if (GetThis() == this) {
         t_scheduler = nullptr;
@@ -234,6 +257,8 @@ void Scheduler::run() {
                 
                 // 当前调度线程找到一个任务，准备开始调度，将其从任务队列中剔除，活动线程数加1
                 task = *it;
+                SYLAR_PROBE3(sched_dequeue, this, task.id, task.fiber ? task.fiber->getId() : 0);
+                FlightRecorder::Record(FlightRecorder::SCHED_DEQUEUE, 0, task.id);
                 m_tasks.erase(it++);
                 ++m_activeThreadCount;
                 break;
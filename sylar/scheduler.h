@@ -13,7 +13,10 @@
 #include <memory>
 #include <string>
 #include "fiber.h"
+#include "flight_recorder.h"
 #include "log.h"
+#include "metrics.h"
+#include "probe.h"
 #include "thread.h"
 
 namespace sylar {
@@ -46,6 +49,26 @@ public:
      */
     const std::string &getName() const { return m_name; }
 
+    /**
+     * @brief 返回线程数，包含use_caller的主线程
+     */
+    size_t getThreadCount() const { return m_threadCount + (m_useCaller ? 1 : 0); }
+
+    /**
+     * @brief 返回正在执行任务的线程数
+     */
+    size_t getActiveThreadCount() const { return m_activeThreadCount; }
+
+    /**
+     * @brief 返回idle线程数
+     */
+    size_t getIdleThreadCount() const { return m_idleThreadCount; }
+
+    /**
+     * @brief 返回等待调度的任务数
+     */
+    size_t getTaskCount();
+
     /**
      * @brief 获取当前线程调度器指针
      */
@@ -111,6 +134,11 @@ protected:
      */
     void setThis();
 
+    /**
+     * @brief 导出指标时使用的标签
+     */
+    const MetricsRegistry::Labels &getMetricLabels() const { return m_metricLabels; }
+
     /**
      * @brief 返回是否有空闲线程
      * @details 当调度协程进入idle时空闲线程数加1，从idle协程返回时空闲线程数减1
@@ -129,6 +157,9 @@ private:
         bool need_tickle = m_tasks.empty();
         ScheduleTask task(fc, thread);
         if (task.fiber || task.cb) {
+            task.id = ++m_taskSeq;
+            SYLAR_PROBE3(sched_enqueue, this, task.id, m_tasks.size());
+            FlightRecorder::Record(FlightRecorder::SCHED_ENQUEUE, m_tasks.size(), task.id);
             m_tasks.push_back(task);
         }
         return need_tickle;
@@ -142,6 +173,8 @@ private:
         Fiber::ptr fiber;
         std::function<void()> cb;
         int thread;
+        /// 任务序号，探针用它关联入队和出队
+        uint64_t id = 0;
 
         ScheduleTask(Fiber::ptr f, int thr) {
             fiber  = f;
@@ -161,6 +194,7 @@ private:
             fiber  = nullptr;
             cb     = nullptr;
             thread = -1;
+            id     = 0;
         }
     };
 
@@ -173,6 +207,8 @@ private:
     std::vector<Thread::ptr> m_threads;
     /// 任务队列
     std::list<ScheduleTask> m_tasks;
+    /// 已入队的任务数，用于生成任务序号
+    uint64_t m_taskSeq = 0;
     /// 线程池的线程ID数组
     std::vector<int> m_threadIds;
     /// 工作线程数量，不包含use_caller的主线程
@@ -191,6 +227,8 @@ private:
 
     /// 是否正在停止
     bool m_stopping = false;
+    /// 导出指标时使用的标签
+    MetricsRegistry::Labels m_metricLabels;
 };
 
 } // end namespace sylar
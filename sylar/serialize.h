@@ -0,0 +1,657 @@
+/**
+ * @file serialize.h
+ * @brief 基于模板的ByteArray结构体序列化/反序列化
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#ifndef __SYLAR_SERIALIZE_H__
+#define __SYLAR_SERIALIZE_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <string.h>
+#include <list>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "bytearray.h"
+#include "endian.h"
+
+/*
+    用法：
+        struct Order {
+            int32_t id;
+            int32_t qty;
+            int64_t price;
+        };
+        SYLAR_SERIALIZE(Order, id, qty, price)
+
+        sylar::Serialize(ba, order);
+        sylar::Deserialize(ba, order);
+
+    SYLAR_SERIALIZE需要写在结构体所在的命名空间中(不能写在结构体内部)，字段按列出的顺序编码：
+    1. 算术类型使用定长编码(writeFint8/16/32/64, writeFloat, writeDouble)，字节序跟随ByteArray的设置
+    2. std::string使用writeStringVint
+    3. std::vector/std::list/std::map/std::unordered_map先写varint元素个数，再依次写元素
+    4. 同样用SYLAR_SERIALIZE声明过的结构体递归编码
+
+    字段列表在编译期展开成逐字段的读写代码，不存在运行时查表，字段偏移由offsetof在编译期给出。
+    只包含算术类型字段(bool除外)的结构体，以及这种结构体和算术类型的vector，不逐字段调用ByteArray：
+    1. ByteArray的字节序与本机一致，且结构体可平凡复制、字段按声明顺序列出、之间没有填充时，
+       直接按内存布局memcpy
+    2. 否则(包括ByteArray默认的大端)先在栈上的缓冲区里按字段逐个交换字节序并紧密排列，
+       凑满一块后一次写入ByteArray；读取时一次读出一块再拆开
+    编码结果与逐字段编码完全相同。
+*/
+
+/// 参数个数，最多支持32个字段
+#define SYLAR_PP_NARG(...) \
+    SYLAR_PP_NARG_(__VA_ARGS__, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, \
+                   20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1)
+#define SYLAR_PP_NARG_(...) SYLAR_PP_ARG_N(__VA_ARGS__)
+#define SYLAR_PP_ARG_N(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, \
+                       _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, \
+                       _31, _32, N, ...) N
+#define SYLAR_PP_CAT(a, b) SYLAR_PP_CAT_(a, b)
+#define SYLAR_PP_CAT_(a, b) a##b
+
+/// 对每个参数x展开m(d, x)
+#define SYLAR_PP_FOR_EACH(m, d, ...) \
+    SYLAR_PP_CAT(SYLAR_PP_FOR_EACH_, SYLAR_PP_NARG(__VA_ARGS__))(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_1(m, d, x) m(d, x)
+#define SYLAR_PP_FOR_EACH_2(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_1(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_3(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_2(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_4(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_3(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_5(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_4(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_6(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_5(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_7(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_6(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_8(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_7(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_9(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_8(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_10(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_9(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_11(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_10(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_12(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_11(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_13(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_12(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_14(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_13(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_15(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_14(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_16(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_15(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_17(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_16(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_18(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_17(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_19(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_18(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_20(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_19(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_21(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_20(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_22(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_21(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_23(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_22(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_24(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_23(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_25(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_24(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_26(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_25(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_27(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_26(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_28(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_27(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_29(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_28(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_30(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_29(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_31(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_30(m, d, __VA_ARGS__)
+#define SYLAR_PP_FOR_EACH_32(m, d, x, ...) m(d, x) SYLAR_PP_FOR_EACH_31(m, d, __VA_ARGS__)
+
+/// 生成一个字段描述符类型
+#define SYLAR_SERIALIZE_FIELD(type, field) \
+    , ::sylar::serialize::Field<type, decltype(type::field), &type::field, offsetof(type, field)>
+
+/**
+ * @brief 声明结构体参与序列化的字段
+ * @param[in] type 结构体类型
+ * @param[in] ... 字段名列表
+ * @note 生成的函数只用于类型推导(通过ADL查找)，不会被真正调用
+ */
+#define SYLAR_SERIALIZE(type, ...)                                                      \
+    _Pragma("GCC diagnostic push")                                                      \
+    _Pragma("GCC diagnostic ignored \"-Winvalid-offsetof\"")                            \
+    inline ::sylar::serialize::FieldList<void                                           \
+        SYLAR_PP_FOR_EACH(SYLAR_SERIALIZE_FIELD, type, __VA_ARGS__)>                    \
+    sylar_serialize_fields(const type*) {                                               \
+        return ::sylar::serialize::FieldList<void                                       \
+            SYLAR_PP_FOR_EACH(SYLAR_SERIALIZE_FIELD, type, __VA_ARGS__)>();             \
+    }                                                                                   \
+    _Pragma("GCC diagnostic pop")                                                       \
+    inline const char* sylar_serialize_field_names(const type*) { return #__VA_ARGS__; }
+
+namespace sylar {
+namespace serialize {
+
+/**
+ * @brief 字段描述符
+ * @tparam C 结构体类型
+ * @tparam M 字段类型
+ * @tparam Ptr 成员指针
+ * @tparam Off 字段在结构体中的偏移(offsetof)
+ */
+template<class C, class M, M C::*Ptr, size_t Off>
+struct Field {
+    typedef C class_type;
+    typedef M value_type;
+
+    static M& Get(C& c) { return c.*Ptr; }
+    static const M& Get(const C& c) { return c.*Ptr; }
+
+    /**
+     * @brief 字段在结构体中的偏移
+     */
+    static constexpr size_t Offset() { return Off; }
+};
+
+/**
+ * @brief 可以按内存布局直接拷贝的算术类型，bool除外(任意字节拷进bool是未定义行为)
+ */
+template<class T>
+struct IsPlainArithmetic {
+    static constexpr bool value = std::is_arithmetic<T>::value
+                                  && !std::is_same<T, bool>::value;
+};
+
+/**
+ * @brief 类型T是否可以按内存布局直接拷贝(不考虑字节序)
+ */
+template<class T, class Enable = void>
+struct IsBulk {
+    static constexpr bool Value() { return false; }
+};
+
+template<class T>
+struct IsBulk<T, typename std::enable_if<IsPlainArithmetic<T>::value>::type> {
+    static constexpr bool Value() { return true; }
+};
+
+/**
+ * @brief ByteArray的字节序是否与本机一致
+ */
+inline bool IsHostOrder(const ByteArray& ba) {
+    return ba.isLittleEndian() == (SYLAR_BYTE_ORDER == SYLAR_LITTLE_ENDIAN);
+}
+
+/**
+ * @brief 与算术类型等长的无符号整数
+ */
+template<size_t Size>
+struct UintOf;
+template<> struct UintOf<1> { typedef uint8_t type; };
+template<> struct UintOf<2> { typedef uint16_t type; };
+template<> struct UintOf<4> { typedef uint32_t type; };
+template<> struct UintOf<8> { typedef uint64_t type; };
+
+inline uint8_t SwapBytes(uint8_t v) { return v; }
+inline uint16_t SwapBytes(uint16_t v) { return byteswap(v); }
+inline uint32_t SwapBytes(uint32_t v) { return byteswap(v); }
+inline uint64_t SwapBytes(uint64_t v) { return byteswap(v); }
+
+/**
+ * @brief 把算术值写到p，Swap为true时交换字节序，结果与ByteArray::writeFintXX/writeDouble一致
+ */
+template<bool Swap, class T>
+inline void StoreValue(char* p, const T& v) {
+    typename UintOf<sizeof(T)>::type u;
+    memcpy(&u, &v, sizeof(T));
+    if(Swap) {
+        u = SwapBytes(u);
+    }
+    memcpy(p, &u, sizeof(T));
+}
+
+/**
+ * @brief 从p读出算术值，Swap为true时交换字节序
+ */
+template<bool Swap, class T>
+inline void LoadValue(const char* p, T& v) {
+    typename UintOf<sizeof(T)>::type u;
+    memcpy(&u, p, sizeof(T));
+    if(Swap) {
+        u = SwapBytes(u);
+    }
+    memcpy(&v, &u, sizeof(T));
+}
+
+template<class T, class Enable = void>
+struct Serializer;
+
+/**
+ * @brief 定长整数读写，按字节数和符号映射到ByteArray的定长接口
+ */
+template<size_t Size, bool Signed>
+struct IntIO;
+
+#define XX(size, sign, type, wfun, rfun)                                     \
+    template<>                                                               \
+    struct IntIO<size, sign> {                                               \
+        template<class T>                                                    \
+        static void Write(ByteArray& ba, T v) { ba.wfun((type)v); }          \
+        template<class T>                                                    \
+        static void Read(ByteArray& ba, T& v) { v = (T)ba.rfun(); }          \
+    };
+XX(1, true, int8_t, writeFint8, readFint8)
+XX(1, false, uint8_t, writeFuint8, readFuint8)
+XX(2, true, int16_t, writeFint16, readFint16)
+XX(2, false, uint16_t, writeFuint16, readFuint16)
+XX(4, true, int32_t, writeFint32, readFint32)
+XX(4, false, uint32_t, writeFuint32, readFuint32)
+XX(8, true, int64_t, writeFint64, readFint64)
+XX(8, false, uint64_t, writeFuint64, readFuint64)
+#undef XX
+
+/**
+ * @brief 整数(含bool/char)
+ */
+template<class T>
+struct Serializer<T, typename std::enable_if<std::is_integral<T>::value>::type> {
+    static void Write(ByteArray& ba, const T& v) {
+        IntIO<sizeof(T), std::is_signed<T>::value>::Write(ba, v);
+    }
+    static void Read(ByteArray& ba, T& v) {
+        IntIO<sizeof(T), std::is_signed<T>::value>::Read(ba, v);
+    }
+};
+
+template<>
+struct Serializer<float> {
+    static void Write(ByteArray& ba, const float& v) { ba.writeFloat(v); }
+    static void Read(ByteArray& ba, float& v) { v = ba.readFloat(); }
+};
+
+template<>
+struct Serializer<double> {
+    static void Write(ByteArray& ba, const double& v) { ba.writeDouble(v); }
+    static void Read(ByteArray& ba, double& v) { v = ba.readDouble(); }
+};
+
+template<>
+struct Serializer<std::string> {
+    static void Write(ByteArray& ba, const std::string& v) { ba.writeStringVint(v); }
+    static void Read(ByteArray& ba, std::string& v) { v = ba.readStringVint(); }
+};
+
+/**
+ * @brief 编译期字段列表，第一个模板参数固定为void，便于宏展开时在每个字段前加逗号
+ */
+template<class Head, class... Fs>
+struct FieldList;
+
+template<>
+struct FieldList<void> {
+    static constexpr bool AllArithmetic() { return true; }
+    static constexpr size_t FixedSize() { return 0; }
+    static constexpr bool Contiguous(size_t) { return true; }
+    template<class C>
+    static void Write(ByteArray&, const C&) {}
+    template<class C>
+    static void Read(ByteArray&, C&) {}
+    template<bool Swap, class C>
+    static void Pack(char*, const C&) {}
+    template<bool Swap, class C>
+    static void Unpack(const char*, C&) {}
+};
+
+template<class F, class... Fs>
+struct FieldList<void, F, Fs...> {
+    typedef FieldList<void, Fs...> Next;
+    typedef typename F::value_type value_type;
+
+    /// 是否全部字段都是可直接拷贝的算术类型
+    static constexpr bool AllArithmetic() {
+        return IsPlainArithmetic<value_type>::value && Next::AllArithmetic();
+    }
+
+    /// 全部字段的字节数之和
+    static constexpr size_t FixedSize() {
+        return sizeof(value_type) + Next::FixedSize();
+    }
+
+    /// 字段是否按列出顺序紧密排列
+    static constexpr bool Contiguous(size_t offset) {
+        return F::Offset() == offset
+            && Next::Contiguous(offset + sizeof(value_type));
+    }
+
+    template<class C>
+    static void Write(ByteArray& ba, const C& c) {
+        Serializer<value_type>::Write(ba, F::Get(c));
+        Next::Write(ba, c);
+    }
+
+    template<class C>
+    static void Read(ByteArray& ba, C& c) {
+        Serializer<value_type>::Read(ba, F::Get(c));
+        Next::Read(ba, c);
+    }
+
+    /// 按列出顺序把字段紧密写入out，共FixedSize()字节，只用于AllArithmetic()的字段列表
+    template<bool Swap, class C>
+    static void Pack(char* out, const C& c) {
+        StoreValue<Swap>(out, F::Get(c));
+        Next::template Pack<Swap>(out + sizeof(value_type), c);
+    }
+
+    /// Pack的逆操作
+    template<bool Swap, class C>
+    static void Unpack(const char* in, C& c) {
+        LoadValue<Swap>(in, F::Get(c));
+        Next::template Unpack<Swap>(in + sizeof(value_type), c);
+    }
+};
+
+/**
+ * @brief 获取结构体T的字段列表类型
+ */
+template<class T>
+struct Reflect {
+    typedef decltype(sylar_serialize_fields((const T*)nullptr)) Fields;
+
+    /// 编译期可判定的部分：可平凡复制、全部为算术字段、且没有填充
+    static constexpr bool MaybeBulk() {
+        return std::is_trivially_copyable<T>::value
+            && Fields::AllArithmetic()
+            && Fields::FixedSize() == sizeof(T);
+    }
+};
+
+/**
+ * @brief 类型T是否用SYLAR_SERIALIZE声明过
+ */
+template<class T>
+struct HasFields {
+private:
+    template<class U>
+    static char Test(decltype(sylar_serialize_fields((const U*)nullptr))*);
+    template<class U>
+    static int Test(...);
+public:
+    static constexpr bool value = sizeof(Test<T>(nullptr)) == sizeof(char);
+};
+
+template<class T>
+struct IsBulk<T, typename std::enable_if<HasFields<T>::value>::type> {
+    static constexpr bool Value() {
+        return Reflect<T>::MaybeBulk()
+            && Reflect<T>::Fields::Contiguous(0);
+    }
+};
+
+/**
+ * @brief 类型T能否按定长紧密排列的方式成块编码(算术类型，或只有算术字段的结构体)
+ */
+template<class T, class Enable = void>
+struct Packed {
+    static constexpr bool value = false;
+};
+
+template<class T>
+struct Packed<T, typename std::enable_if<IsPlainArithmetic<T>::value>::type> {
+    static constexpr bool value = true;
+    static constexpr size_t Size() { return sizeof(T); }
+    template<bool Swap>
+    static void Pack(char* out, const T& v) { StoreValue<Swap>(out, v); }
+    template<bool Swap>
+    static void Unpack(const char* in, T& v) { LoadValue<Swap>(in, v); }
+};
+
+template<class T, bool = HasFields<T>::value>
+struct AllArithmeticFields {
+    static constexpr bool value = false;
+};
+
+template<class T>
+struct AllArithmeticFields<T, true> {
+    static constexpr bool value = Reflect<T>::Fields::AllArithmetic();
+};
+
+template<class T>
+struct Packed<T, typename std::enable_if<AllArithmeticFields<T>::value>::type> {
+    static constexpr bool value = true;
+    static constexpr size_t Size() { return Reflect<T>::Fields::FixedSize(); }
+    template<bool Swap>
+    static void Pack(char* out, const T& v) { Reflect<T>::Fields::template Pack<Swap>(out, v); }
+    template<bool Swap>
+    static void Unpack(const char* in, T& v) { Reflect<T>::Fields::template Unpack<Swap>(in, v); }
+};
+
+/**
+ * @brief SYLAR_SERIALIZE声明过的结构体
+ */
+template<class T>
+struct Serializer<T, typename std::enable_if<HasFields<T>::value>::type> {
+    typedef std::integral_constant<bool, Packed<T>::value> packed_type;
+
+    static void Write(ByteArray& ba, const T& v) {
+        Write(ba, v, packed_type());
+    }
+    static void Read(ByteArray& ba, T& v) {
+        Read(ba, v, packed_type());
+    }
+private:
+    static void Write(ByteArray& ba, const T& v, std::true_type) {
+        if(IsBulk<T>::Value() && IsHostOrder(ba)) {
+            ba.write(&v, sizeof(T));
+            return;
+        }
+        char buf[Packed<T>::Size()];
+        if(IsHostOrder(ba)) {
+            Packed<T>::template Pack<false>(buf, v);
+        } else {
+            Packed<T>::template Pack<true>(buf, v);
+        }
+        ba.write(buf, sizeof(buf));
+    }
+    static void Write(ByteArray& ba, const T& v, std::false_type) {
+        Reflect<T>::Fields::Write(ba, v);
+    }
+    static void Read(ByteArray& ba, T& v, std::true_type) {
+        if(IsBulk<T>::Value() && IsHostOrder(ba)) {
+            ba.read(&v, sizeof(T));
+            return;
+        }
+        char buf[Packed<T>::Size()];
+        ba.read(buf, sizeof(buf));
+        if(IsHostOrder(ba)) {
+            Packed<T>::template Unpack<false>(buf, v);
+        } else {
+            Packed<T>::template Unpack<true>(buf, v);
+        }
+    }
+    static void Read(ByteArray& ba, T& v, std::false_type) {
+        Reflect<T>::Fields::Read(ba, v);
+    }
+};
+
+/**
+ * @brief 定长元素数组的成块编解码
+ * @details 元素逐个紧密排列到栈上的缓冲区(需要时交换字节序)，缓冲区满了再一次写入ByteArray，
+ *          元素大小是编译期常量，循环体没有分支，编译器可以展开
+ */
+template<class T>
+struct PackedArray {
+    /// 缓冲区大小
+    static constexpr size_t kBlock = 4096;
+    /// 每块的元素个数
+    static constexpr size_t kCount = Packed<T>::Size() >= kBlock ? 1 : kBlock / Packed<T>::Size();
+
+    template<bool Swap>
+    static void Write(ByteArray& ba, const T* v, size_t size) {
+        char buf[kCount * Packed<T>::Size()];
+        while(size) {
+            size_t n = size;
+            if(n > kCount) {
+                n = kCount;
+            }
+            for(size_t i = 0; i < n; ++i) {
+                Packed<T>::template Pack<Swap>(buf + i * Packed<T>::Size(), v[i]);
+            }
+            ba.write(buf, n * Packed<T>::Size());
+            v += n;
+            size -= n;
+        }
+    }
+
+    template<bool Swap>
+    static void Read(ByteArray& ba, T* v, size_t size) {
+        char buf[kCount * Packed<T>::Size()];
+        while(size) {
+            size_t n = size;
+            if(n > kCount) {
+                n = kCount;
+            }
+            ba.read(buf, n * Packed<T>::Size());
+            for(size_t i = 0; i < n; ++i) {
+                Packed<T>::template Unpack<Swap>(buf + i * Packed<T>::Size(), v[i]);
+            }
+            v += n;
+            size -= n;
+        }
+    }
+};
+
+template<class T>
+struct Serializer<std::vector<T> > {
+    typedef std::integral_constant<bool, Packed<T>::value> packed_type;
+
+    static void Write(ByteArray& ba, const std::vector<T>& v) {
+        ba.writeUint64(v.size());
+        if(v.empty()) {
+            return;
+        }
+        Write(ba, v, packed_type());
+    }
+    static void Read(ByteArray& ba, std::vector<T>& v) {
+        uint64_t size = ba.readUint64();
+        v.clear();
+        if(size == 0) {
+            return;
+        }
+        Read(ba, v, size, packed_type());
+    }
+private:
+    static void Write(ByteArray& ba, const std::vector<T>& v, std::true_type) {
+        if(IsBulk<T>::Value() && (sizeof(T) == 1 || IsHostOrder(ba))) {
+            ba.write(&v[0], v.size() * sizeof(T));
+        } else if(IsHostOrder(ba)) {
+            PackedArray<T>::template Write<false>(ba, &v[0], v.size());
+        } else {
+            PackedArray<T>::template Write<true>(ba, &v[0], v.size());
+        }
+    }
+    static void Write(ByteArray& ba, const std::vector<T>& v, std::false_type) {
+        for(auto& i : v) {
+            Serializer<T>::Write(ba, i);
+        }
+    }
+    static void Read(ByteArray& ba, std::vector<T>& v, uint64_t size, std::true_type) {
+        if(size > ba.getReadSize() / Packed<T>::Size()) {
+            throw std::out_of_range("not enough len");
+        }
+        v.resize(size);
+        if(IsBulk<T>::Value() && (sizeof(T) == 1 || IsHostOrder(ba))) {
+            ba.read(&v[0], size * sizeof(T));
+        } else if(IsHostOrder(ba)) {
+            PackedArray<T>::template Read<false>(ba, &v[0], size);
+        } else {
+            PackedArray<T>::template Read<true>(ba, &v[0], size);
+        }
+    }
+    static void Read(ByteArray& ba, std::vector<T>& v, uint64_t size, std::false_type) {
+        // 元素个数来自网络数据，不能直接按它预分配
+        v.reserve(std::min<uint64_t>(size, ba.getReadSize()));
+        for(uint64_t i = 0; i < size; ++i) {
+            v.emplace_back();
+            Serializer<T>::Read(ba, v.back());
+        }
+    }
+};
+
+template<class T>
+struct Serializer<std::list<T> > {
+    static void Write(ByteArray& ba, const std::list<T>& v) {
+        ba.writeUint64(v.size());
+        for(auto& i : v) {
+            Serializer<T>::Write(ba, i);
+        }
+    }
+    static void Read(ByteArray& ba, std::list<T>& v) {
+        uint64_t size = ba.readUint64();
+        v.clear();
+        for(uint64_t i = 0; i < size; ++i) {
+            v.emplace_back();
+            Serializer<T>::Read(ba, v.back());
+        }
+    }
+};
+
+/**
+ * @brief map类容器的公共实现
+ */
+template<class MapType>
+struct MapSerializer {
+    typedef typename MapType::key_type key_type;
+    typedef typename MapType::mapped_type mapped_type;
+
+    static void Write(ByteArray& ba, const MapType& v) {
+        ba.writeUint64(v.size());
+        for(auto& i : v) {
+            Serializer<key_type>::Write(ba, i.first);
+            Serializer<mapped_type>::Write(ba, i.second);
+        }
+    }
+    static void Read(ByteArray& ba, MapType& v) {
+        uint64_t size = ba.readUint64();
+        v.clear();
+        for(uint64_t i = 0; i < size; ++i) {
+            key_type k;
+            Serializer<key_type>::Read(ba, k);
+            Serializer<mapped_type>::Read(ba, v[k]);
+        }
+    }
+};
+
+template<class K, class V>
+struct Serializer<std::map<K, V> > : public MapSerializer<std::map<K, V> > {
+};
+
+template<class K, class V>
+struct Serializer<std::unordered_map<K, V> > : public MapSerializer<std::unordered_map<K, V> > {
+};
+
+}
+
+/**
+ * @brief 把v序列化写入ba
+ */
+template<class T>
+void Serialize(ByteArray& ba, const T& v) {
+    serialize::Serializer<T>::Write(ba, v);
+}
+
+/**
+ * @brief 把v序列化写入ba
+ */
+template<class T>
+void Serialize(ByteArray::ptr ba, const T& v) {
+    serialize::Serializer<T>::Write(*ba, v);
+}
+
+/**
+ * @brief 从ba中反序列化到v
+ * @exception 数据不足时抛出std::out_of_range
+ */
+template<class T>
+void Deserialize(ByteArray& ba, T& v) {
+    serialize::Serializer<T>::Read(ba, v);
+}
+
+/**
+ * @brief 从ba中反序列化到v
+ * @exception 数据不足时抛出std::out_of_range
+ */
+template<class T>
+void Deserialize(ByteArray::ptr ba, T& v) {
+    serialize::Serializer<T>::Read(*ba, v);
+}
+
+}
+
+#endif
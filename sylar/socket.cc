@@ -4,12 +4,48 @@
 #include "log.h"
 #include "macro.h"
 #include "hook.h"
+#include "config.h"
+#include "singleton.h"
+#include "metrics.h"
+#include "socket_stats.h"
 #include <limits.h>
+#include <string.h>
+#include <sstream>
+#include <signal.h>
+#include <unordered_map>
 
 namespace sylar {
 
 static sylar::Logger::ptr g_logger = SYLAR_LOG_NAME("system");
 
+static sylar::Gauge::ptr g_socket_count = sylar::MetricsMgr::GetInstance()->gauge(
+    "sylar_sockets", "live Socket objects");
+static sylar::Counter::ptr g_socket_accepted = sylar::MetricsMgr::GetInstance()->counter(
+    "sylar_socket_accepted_total", "accepted connections");
+static sylar::Counter::ptr g_socket_connected = sylar::MetricsMgr::GetInstance()->counter(
+    "sylar_socket_connected_total", "successful outgoing connects");
+static sylar::Counter::ptr g_socket_connect_errors = sylar::MetricsMgr::GetInstance()->counter(
+    "sylar_socket_connect_errors_total", "failed outgoing connects");
+static sylar::Counter::ptr g_socket_recv_bytes = sylar::MetricsMgr::GetInstance()->counter(
+    "sylar_socket_recv_bytes_total", "bytes received by Socket::recv");
+static sylar::Counter::ptr g_socket_send_bytes = sylar::MetricsMgr::GetInstance()->counter(
+    "sylar_socket_send_bytes_total", "bytes sent by Socket::send");
+
+static sylar::ConfigVar<bool>::ptr g_ssl_ktls =
+    sylar::Config::Lookup("ssl.ktls", false, "hand tls record crypto to the kernel when supported");
+
+static sylar::ConfigVar<bool>::ptr g_ssl_session_tickets =
+    sylar::Config::Lookup("ssl.session_tickets", true, "issue tls session tickets");
+
+static sylar::ConfigVar<uint32_t>::ptr g_ssl_session_cache_size =
+    sylar::Config::Lookup("ssl.session_cache_size", (uint32_t)20480, "tls session cache size");
+
+static sylar::ConfigVar<bool>::ptr g_ssl_verify_peer =
+    sylar::Config::Lookup("ssl.client.verify_peer", true, "verify server certificate");
+
+static sylar::ConfigVar<std::string>::ptr g_ssl_ca_file =
+    sylar::Config::Lookup("ssl.client.ca_file", std::string(""), "ca file used to verify server certificate, system ca store when empty");
+
 Socket::ptr Socket::CreateTCP(sylar::Address::ptr address) {
     Socket::ptr sock(new Socket(address->getFamily(), TCP, 0));
     return sock;
@@ -62,10 +98,12 @@ Socket::Socket(int family, int type, int protocol)
     , m_type(type)
     , m_protocol(protocol)
     , m_isConnected(false) {
+    g_socket_count->inc();
 }
 
 Socket::~Socket() {
     close();
+    g_socket_count->dec();
 }
 
 int64_t Socket::getSendTimeout() {
@@ -128,6 +166,7 @@ Socket::ptr Socket::accept() {
         return nullptr;
     }
     if (sock->init(newsock)) {
+        g_socket_accepted->inc();
         return sock;
     }
     return nullptr;
@@ -211,6 +250,7 @@ bool Socket::connect(const Address::ptr addr, uint64_t timeout_ms) {
             SYLAR_LOG_ERROR(g_logger) << "sock=" << m_sock << " connect(" << addr->toString()
                                       << ") error errno=" << errno << " errstr=" << strerror(errno);
             close();
+            g_socket_connect_errors->inc();
             return false;
         }
     } else {
@@ -219,12 +259,14 @@ bool Socket::connect(const Address::ptr addr, uint64_t timeout_ms) {
                                       << ") timeout=" << timeout_ms << " error errno="
                                       << errno << " errstr=" << strerror(errno);
             close();
+            g_socket_connect_errors->inc();
             return false;
         }
     }
     m_isConnected = true;
     getRemoteAddress();
     getLocalAddress();
+    g_socket_connected->inc();
     return true;
 }
 
@@ -242,6 +284,12 @@ bool Socket::listen(int backlog) {
 }
 
 bool Socket::close() {
+    if (m_statsGroup) {
+        // 关闭前最后采样一次，短连接也能留下RTT和重传
+        SocketStatsGroup::ptr group = m_statsGroup;
+        m_statsGroup.reset();
+        group->remove(this);
+    }
     if (!m_isConnected && m_sock == -1) {
         return true;
     }
@@ -255,7 +303,12 @@ bool Socket::close() {
 
 int Socket::send(const void *buffer, size_t length, int flags) {
     if (isConnected()) {
-        return ::send(m_sock, buffer, length, flags);
+        int rt = ::send(m_sock, buffer, length, flags);
+        addSendStats(rt);
+        if (rt > 0) {
+            g_socket_send_bytes->inc(rt);
+        }
+        return rt;
     }
     return -1;
 }
@@ -266,14 +319,21 @@ int Socket::send(const iovec *buffers, size_t length, int flags) {
         memset(&msg, 0, sizeof(msg));
         msg.msg_iov    = (iovec *)buffers;
         msg.msg_iovlen = length;
-        return ::sendmsg(m_sock, &msg, flags);
+        int rt = ::sendmsg(m_sock, &msg, flags);
+        addSendStats(rt);
+        if (rt > 0) {
+            g_socket_send_bytes->inc(rt);
+        }
+        return rt;
     }
     return -1;
 }
 
 int Socket::sendTo(const void *buffer, size_t length, const Address::ptr to, int flags) {
     if (isConnected()) {
-        return ::sendto(m_sock, buffer, length, flags, to->getAddr(), to->getAddrLen());
+        int rt = ::sendto(m_sock, buffer, length, flags, to->getAddr(), to->getAddrLen());
+        addSendStats(rt);
+        return rt;
     }
     return -1;
 }
@@ -286,14 +346,21 @@ int Socket::sendTo(const iovec *buffers, size_t length, const Address::ptr to, i
         msg.msg_iovlen  = length;
         msg.msg_name    = to->getAddr();
         msg.msg_namelen = to->getAddrLen();
-        return ::sendmsg(m_sock, &msg, flags);
+        int rt = ::sendmsg(m_sock, &msg, flags);
+        addSendStats(rt);
+        return rt;
     }
     return -1;
 }
 
 int Socket::recv(void *buffer, size_t length, int flags) {
     if (isConnected()) {
-        return ::recv(m_sock, buffer, length, flags);
+        int rt = ::recv(m_sock, buffer, length, flags);
+        addRecvStats(rt);
+        if (rt > 0) {
+            g_socket_recv_bytes->inc(rt);
+        }
+        return rt;
     }
     return -1;
 }
@@ -304,7 +371,12 @@ int Socket::recv(iovec *buffers, size_t length, int flags) {
         memset(&msg, 0, sizeof(msg));
         msg.msg_iov    = (iovec *)buffers;
         msg.msg_iovlen = length;
-        return ::recvmsg(m_sock, &msg, flags);
+        int rt = ::recvmsg(m_sock, &msg, flags);
+        addRecvStats(rt);
+        if (rt > 0) {
+            g_socket_recv_bytes->inc(rt);
+        }
+        return rt;
     }
     return -1;
 }
@@ -312,7 +384,9 @@ int Socket::recv(iovec *buffers, size_t length, int flags) {
 int Socket::recvFrom(void *buffer, size_t length, Address::ptr from, int flags) {
     if (isConnected()) {
         socklen_t len = from->getAddrLen();
-        return ::recvfrom(m_sock, buffer, length, flags, from->getAddr(), &len);
+        int rt = ::recvfrom(m_sock, buffer, length, flags, from->getAddr(), &len);
+        addRecvStats(rt);
+        return rt;
     }
     return -1;
 }
@@ -325,7 +399,9 @@ int Socket::recvFrom(iovec *buffers, size_t length, Address::ptr from, int flags
         msg.msg_iovlen  = length;
         msg.msg_name    = from->getAddr();
         msg.msg_namelen = from->getAddrLen();
-        return ::recvmsg(m_sock, &msg, flags);
+        int rt = ::recvmsg(m_sock, &msg, flags);
+        addRecvStats(rt);
+        return rt;
     }
     return -1;
 }
@@ -449,6 +525,58 @@ bool Socket::cancelAll() {
     return IOManager::GetThis()->cancelAll(m_sock);
 }
 
+SocketStats Socket::getStats() const {
+    SocketStats stats;
+    {
+        Spinlock::Lock lock(m_infoMutex);
+        stats = m_tcpInfo;
+    }
+    stats.bytesIn   = m_bytesIn.load(std::memory_order_relaxed);
+    stats.bytesOut  = m_bytesOut.load(std::memory_order_relaxed);
+    stats.recvCalls = m_recvCalls.load(std::memory_order_relaxed);
+    stats.sendCalls = m_sendCalls.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool Socket::sampleTcpInfo() {
+    if (m_sock == -1 || m_type != TCP || m_family == UNIX) {
+        return false;
+    }
+    struct tcp_info info;
+    socklen_t len = sizeof(info);
+    memset(&info, 0, sizeof(info));
+    // 采样失败不需要打日志，直接调用getsockopt
+    if (getsockopt(m_sock, IPPROTO_TCP, TCP_INFO, &info, &len)) {
+        return false;
+    }
+    Spinlock::Lock lock(m_infoMutex);
+    m_tcpInfo.sampleTime  = sylar::GetCurrentMS();
+    m_tcpInfo.rtt         = info.tcpi_rtt;
+    m_tcpInfo.rttVar      = info.tcpi_rttvar;
+    m_tcpInfo.cwnd        = info.tcpi_snd_cwnd;
+    m_tcpInfo.retransmits = info.tcpi_total_retrans;
+    m_tcpInfo.lost        = info.tcpi_lost;
+    m_tcpInfo.unacked     = info.tcpi_unacked;
+    return true;
+}
+
+std::string SocketStats::toString() const {
+    std::stringstream ss;
+    ss << "bytes_in=" << bytesIn
+       << " bytes_out=" << bytesOut
+       << " recv_calls=" << recvCalls
+       << " send_calls=" << sendCalls;
+    if (sampleTime) {
+        ss << " rtt_us=" << rtt
+           << " rttvar_us=" << rttVar
+           << " cwnd=" << cwnd
+           << " retrans=" << retransmits
+           << " lost=" << lost
+           << " unacked=" << unacked;
+    }
+    return ss.str();
+}
+
 void Socket::initSock() {
     int val = 1;
     setOption(SOL_SOCKET, SO_REUSEADDR, val);
@@ -472,4 +600,526 @@ std::ostream &operator<<(std::ostream &os, const Socket &sock) {
     return sock.dump(os);
 }
 
+namespace {
+
+struct _SSLInit {
+    _SSLInit() {
+        OPENSSL_init_ssl(0, nullptr);
+        // 对端关闭后OpenSSL写close_notify或应用数据会触发SIGPIPE，TLS服务必须忽略它
+        signal(SIGPIPE, SIG_IGN);
+    }
+};
+
+static _SSLInit s_ssl_init;
+
+std::string SSLErrorString() {
+    std::string rt;
+    unsigned long e = 0;
+    while ((e = ERR_get_error()) != 0) {
+        char buf[256];
+        ERR_error_string_n(e, buf, sizeof(buf));
+        if (!rt.empty()) {
+            rt += "; ";
+        }
+        rt += buf;
+    }
+    return rt;
+}
+
+/**
+ * @brief 客户端共用的SSL_CTX及会话缓存
+ * @details TLS1.3的会话票据在握手之后才下发，所以通过new_session回调收集会话，
+ *          key是SSL对象上挂的"SNI主机名/远端地址"
+ */
+struct SSLClientContext {
+    typedef Mutex MutexType;
+
+    SSLClientContext() {
+        ctx.reset(SSL_CTX_new(TLS_client_method()), SSL_CTX_free);
+        SSL_CTX *c = ctx.get();
+        SSL_CTX_set_min_proto_version(c, TLS1_2_VERSION);
+        uint64_t opts = SSL_OP_IGNORE_UNEXPECTED_EOF;
+        if (g_ssl_ktls->getValue()) {
+            opts |= SSL_OP_ENABLE_KTLS;
+        }
+        SSL_CTX_set_options(c, opts);
+        SSL_CTX_set_session_cache_mode(c, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        SSL_CTX_sess_set_new_cb(c, &SSLClientContext::OnNewSession);
+        // 是否校验在每个连接上按当时的配置设置，CA总是加载好
+        LoadCA(c, g_ssl_ca_file->getValue());
+        std::weak_ptr<SSL_CTX> wctx(ctx);
+        g_ssl_ca_file->addListener([wctx](const std::string &old_value, const std::string &new_value) {
+            std::shared_ptr<SSL_CTX> c = wctx.lock();
+            if (c) {
+                LoadCA(c.get(), new_value);
+            }
+        });
+        exIndex = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    }
+
+    /**
+     * @brief 把CA加入证书库，ca为空时使用系统的CA
+     */
+    static void LoadCA(SSL_CTX *c, const std::string &ca) {
+        if (ca.empty() ? !SSL_CTX_set_default_verify_paths(c)
+                       : !SSL_CTX_load_verify_locations(c, ca.c_str(), nullptr)) {
+            SYLAR_LOG_ERROR(g_logger) << "load ca fail: " << ca << " " << SSLErrorString();
+        }
+    }
+
+    ~SSLClientContext() {
+        for (auto &i : sessions) {
+            SSL_SESSION_free(i.second);
+        }
+    }
+
+    /**
+     * @brief 取出缓存的会话设置到ssl上
+     */
+    void restore(SSL *ssl, const std::string &key) {
+        MutexType::Lock lock(mutex);
+        auto it = sessions.find(key);
+        if (it != sessions.end()) {
+            SSL_set_session(ssl, it->second);
+        }
+    }
+
+    static int OnNewSession(SSL *ssl, SSL_SESSION *sess) {
+        SSLClientContext *self = Singleton<SSLClientContext>::GetInstance();
+        std::string *key = (std::string *)SSL_get_ex_data(ssl, self->exIndex);
+        if (!key) {
+            return 0;
+        }
+        SSL_SESSION *old = nullptr;
+        {
+            MutexType::Lock lock(self->mutex);
+            auto it = self->sessions.find(*key);
+            if (it != self->sessions.end()) {
+                old = it->second;
+                it->second = sess;
+            } else {
+                if (self->sessions.size() >= g_ssl_session_cache_size->getValue()
+                        && !self->sessions.empty()) {
+                    old = self->sessions.begin()->second;
+                    self->sessions.erase(self->sessions.begin());
+                }
+                self->sessions[*key] = sess;
+            }
+        }
+        if (old) {
+            SSL_SESSION_free(old);
+        }
+        // 返回1表示接管了sess的引用
+        return 1;
+    }
+
+    std::shared_ptr<SSL_CTX> ctx;
+    int exIndex = -1;
+    MutexType mutex;
+    std::unordered_map<std::string, SSL_SESSION *> sessions;
+};
+
+typedef sylar::Singleton<SSLClientContext> SSLClientCtx;
+
+} // namespace
+
+SSLSocket::ptr SSLSocket::CreateTCP(sylar::Address::ptr address) {
+    SSLSocket::ptr sock(new SSLSocket(address->getFamily(), TCP, 0));
+    return sock;
+}
+
+SSLSocket::ptr SSLSocket::CreateTCPSocket() {
+    SSLSocket::ptr sock(new SSLSocket(IPv4, TCP, 0));
+    return sock;
+}
+
+SSLSocket::ptr SSLSocket::CreateTCPSocket6() {
+    SSLSocket::ptr sock(new SSLSocket(IPv6, TCP, 0));
+    return sock;
+}
+
+SSLSocket::SSLSocket(int family, int type, int protocol)
+    : Socket(family, type, protocol) {
+}
+
+SSLSocket::~SSLSocket() {
+    close();
+}
+
+Socket::ptr SSLSocket::accept() {
+    SSLSocket::ptr sock(new SSLSocket(m_family, m_type, m_protocol));
+    int newsock = ::accept(m_sock, nullptr, nullptr);
+    if (newsock == -1) {
+        SYLAR_LOG_ERROR(g_logger) << "accept(" << m_sock << ") errno="
+                                  << errno << " errstr=" << strerror(errno);
+        return nullptr;
+    }
+    sock->m_ctx = m_ctx;
+    if (sock->init(newsock)) {
+        return sock;
+    }
+    return nullptr;
+}
+
+bool SSLSocket::init(int sock) {
+    if (!Socket::init(sock)) {
+        return false;
+    }
+    if (!m_ctx) {
+        SYLAR_LOG_ERROR(g_logger) << "ssl accept without certificates, sock=" << sock;
+        return false;
+    }
+    m_ssl.reset(SSL_new(m_ctx.get()), SSL_free);
+    SSL_set_fd(m_ssl.get(), m_sock);
+    SSL_set_accept_state(m_ssl.get());
+    return true;
+}
+
+bool SSLSocket::bind(const Address::ptr addr) {
+    return Socket::bind(addr);
+}
+
+bool SSLSocket::connect(const Address::ptr addr, uint64_t timeout_ms) {
+    if (!Socket::connect(addr, timeout_ms)) {
+        return false;
+    }
+    SSLClientContext *cc = SSLClientCtx::GetInstance();
+    m_ctx = cc->ctx;
+    m_ssl.reset(SSL_new(m_ctx.get()), SSL_free);
+    SSL *ssl = m_ssl.get();
+    SSL_set_fd(ssl, m_sock);
+    if (!m_hostName.empty()) {
+        SSL_set_tlsext_host_name(ssl, m_hostName.c_str());
+    }
+    bool verify = g_ssl_verify_peer->getValue();
+    SSL_set_verify(ssl, verify ? SSL_VERIFY_PEER : SSL_VERIFY_NONE, nullptr);
+    if (verify) {
+        // 证书必须属于要连接的主机：主机名按DNS名校验，IP地址或没有主机名时按IP校验
+        X509_VERIFY_PARAM *param = SSL_get0_param(ssl);
+        if (m_hostName.empty()) {
+            const sockaddr *sa = addr->getAddr();
+            if (sa->sa_family == AF_INET) {
+                X509_VERIFY_PARAM_set1_ip(param, (const unsigned char *)&((const sockaddr_in *)sa)->sin_addr, 4);
+            } else if (sa->sa_family == AF_INET6) {
+                X509_VERIFY_PARAM_set1_ip(param, (const unsigned char *)&((const sockaddr_in6 *)sa)->sin6_addr, 16);
+            }
+        } else if (!X509_VERIFY_PARAM_set1_ip_asc(param, m_hostName.c_str())) {
+            SSL_set1_host(ssl, m_hostName.c_str());
+        }
+    }
+    // 没有校验证书的会话不能给校验证书的连接恢复
+    m_sessionKey = (verify ? "" : "noverify/") + m_hostName + "/" + addr->toString();
+    SSL_set_ex_data(ssl, cc->exIndex, &m_sessionKey);
+    cc->restore(ssl, m_sessionKey);
+    SSL_set_connect_state(ssl);
+    if (!handshake()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool SSLSocket::listen(int backlog) {
+    return Socket::listen(backlog);
+}
+
+bool SSLSocket::close() {
+    if (m_ssl) {
+        if (m_handshaked && m_isConnected) {
+            // 只发送close_notify，不等待对端的回应
+            ERR_clear_error();
+            SSL_shutdown(m_ssl.get());
+        }
+        if (!m_sessionKey.empty()) {
+            SSL_set_ex_data(m_ssl.get(), SSLClientCtx::GetInstance()->exIndex, nullptr);
+        }
+        m_ssl.reset();
+    }
+    m_handshaked = false;
+    return Socket::close();
+}
+
+bool SSLSocket::loadCertificates(const std::string &cert_file, const std::string &key_file) {
+    m_ctx.reset(SSL_CTX_new(TLS_server_method()), SSL_CTX_free);
+    SSL_CTX *ctx = m_ctx.get();
+    SSL_CTX_set_min_proto_version(ctx, TLS1_2_VERSION);
+    uint64_t opts = SSL_OP_IGNORE_UNEXPECTED_EOF;
+    if (g_ssl_ktls->getValue()) {
+        opts |= SSL_OP_ENABLE_KTLS;
+    }
+    if (!g_ssl_session_tickets->getValue()) {
+        opts |= SSL_OP_NO_TICKET;
+    }
+    SSL_CTX_set_options(ctx, opts);
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+    SSL_CTX_sess_set_cache_size(ctx, g_ssl_session_cache_size->getValue());
+    static const unsigned char s_sid_ctx[] = "sylar";
+    SSL_CTX_set_session_id_context(ctx, s_sid_ctx, sizeof(s_sid_ctx) - 1);
+
+    if (SSL_CTX_use_certificate_chain_file(ctx, cert_file.c_str()) != 1) {
+        SYLAR_LOG_ERROR(g_logger) << "SSL_CTX_use_certificate_chain_file("
+                                  << cert_file << ") error: " << SSLErrorString();
+        return false;
+    }
+    if (SSL_CTX_use_PrivateKey_file(ctx, key_file.c_str(), SSL_FILETYPE_PEM) != 1) {
+        SYLAR_LOG_ERROR(g_logger) << "SSL_CTX_use_PrivateKey_file("
+                                  << key_file << ") error: " << SSLErrorString();
+        return false;
+    }
+    if (SSL_CTX_check_private_key(ctx) != 1) {
+        SYLAR_LOG_ERROR(g_logger) << "SSL_CTX_check_private_key cert_file="
+                                  << cert_file << " key_file=" << key_file
+                                  << " error: " << SSLErrorString();
+        return false;
+    }
+    return true;
+}
+
+bool SSLSocket::waitRetry(int err) {
+    IOManager::Event event;
+    if (err == SSL_ERROR_WANT_READ) {
+        event = IOManager::READ;
+    } else if (err == SSL_ERROR_WANT_WRITE) {
+        event = IOManager::WRITE;
+    } else {
+        return false;
+    }
+    // 通常底层read/write已经被hook，不会走到这里；
+    // 只有sendfile这类没有hook的调用，或者hook未开启时才需要自己等待
+    IOManager *iom = IOManager::GetThis();
+    if (!iom) {
+        errno = EAGAIN;
+        return false;
+    }
+    FdCtx::ptr ctx = FdMgr::GetInstance()->get(m_sock);
+    uint64_t timeout = ctx ? ctx->getTimeout(event == IOManager::READ ? SO_RCVTIMEO : SO_SNDTIMEO)
+                           : (uint64_t)-1;
+    std::shared_ptr<int> cancelled(new int(0));
+    std::weak_ptr<int> winfo(cancelled);
+    Timer::ptr timer;
+    int fd = m_sock;
+    if (timeout != (uint64_t)-1) {
+        timer = iom->addConditionTimer(timeout, [winfo, fd, iom, event]() {
+            auto t = winfo.lock();
+            if (!t || *t) {
+                return;
+            }
+            *t = ETIMEDOUT;
+            iom->cancelEvent(fd, event);
+        }, winfo);
+    }
+    if (iom->addEvent(fd, event)) {
+        if (timer) {
+            timer->cancel();
+        }
+        return false;
+    }
+    Fiber::GetThis()->yield();
+    if (timer) {
+        timer->cancel();
+    }
+    if (*cancelled) {
+        errno = *cancelled;
+        return false;
+    }
+    return true;
+}
+
+bool SSLSocket::handshake() {
+    if (m_handshaked) {
+        return true;
+    }
+    if (!m_ssl) {
+        return false;
+    }
+    do {
+        ERR_clear_error();
+        int rt = SSL_do_handshake(m_ssl.get());
+        if (rt == 1) {
+            m_handshaked = true;
+            return true;
+        }
+        if (!waitRetry(SSL_get_error(m_ssl.get(), rt))) {
+            SYLAR_LOG_DEBUG(g_logger) << "ssl handshake fail sock=" << m_sock
+                                      << " errno=" << errno << " errstr=" << strerror(errno)
+                                      << " ssl_error=" << SSLErrorString();
+            return false;
+        }
+    } while (true);
+}
+
+bool SSLSocket::isSessionReused() const {
+    return m_ssl && SSL_session_reused(m_ssl.get());
+}
+
+bool SSLSocket::isKtlsSend() const {
+    return m_ssl && BIO_get_ktls_send(SSL_get_wbio(m_ssl.get()));
+}
+
+int SSLSocket::send(const void *buffer, size_t length, int flags) {
+    if (!isConnected() || !handshake()) {
+        return -1;
+    }
+    if (length == 0) {
+        return 0;
+    }
+    do {
+        ERR_clear_error();
+        int rt = SSL_write(m_ssl.get(), buffer, length);
+        if (rt > 0) {
+            addSendStats(rt);
+            return rt;
+        }
+        int err = SSL_get_error(m_ssl.get(), rt);
+        if (err == SSL_ERROR_ZERO_RETURN) {
+            return 0;
+        }
+        if (!waitRetry(err)) {
+            return -1;
+        }
+    } while (true);
+}
+
+int SSLSocket::send(const iovec *buffers, size_t length, int flags) {
+    int total = 0;
+    for (size_t i = 0; i < length; ++i) {
+        if (buffers[i].iov_len == 0) {
+            continue;
+        }
+        int rt = send(buffers[i].iov_base, buffers[i].iov_len, flags);
+        if (rt <= 0) {
+            return total > 0 ? total : rt;
+        }
+        total += rt;
+        if ((size_t)rt < buffers[i].iov_len) {
+            break;
+        }
+    }
+    return total;
+}
+
+int SSLSocket::sendTo(const void *buffer, size_t length, const Address::ptr to, int flags) {
+    return send(buffer, length, flags);
+}
+
+int SSLSocket::sendTo(const iovec *buffers, size_t length, const Address::ptr to, int flags) {
+    return send(buffers, length, flags);
+}
+
+int SSLSocket::recv(void *buffer, size_t length, int flags) {
+    if (!isConnected() || !handshake()) {
+        return -1;
+    }
+    do {
+        ERR_clear_error();
+        int rt = (flags & MSG_PEEK) ? SSL_peek(m_ssl.get(), buffer, length)
+                                    : SSL_read(m_ssl.get(), buffer, length);
+        if (rt > 0) {
+            addRecvStats(rt);
+            return rt;
+        }
+        int err = SSL_get_error(m_ssl.get(), rt);
+        if (err == SSL_ERROR_ZERO_RETURN) {
+            return 0;
+        }
+        if (!waitRetry(err)) {
+            return -1;
+        }
+    } while (true);
+}
+
+int SSLSocket::recv(iovec *buffers, size_t length, int flags) {
+    int total = 0;
+    for (size_t i = 0; i < length; ++i) {
+        if (buffers[i].iov_len == 0) {
+            continue;
+        }
+        // 只有第一次读可以等待，之后只取已经解密好的数据
+        if (total > 0 && SSL_pending(m_ssl.get()) <= 0) {
+            break;
+        }
+        int rt = recv(buffers[i].iov_base, buffers[i].iov_len, flags);
+        if (rt <= 0) {
+            return total > 0 ? total : rt;
+        }
+        total += rt;
+        if ((size_t)rt < buffers[i].iov_len) {
+            break;
+        }
+    }
+    return total;
+}
+
+int SSLSocket::recvFrom(void *buffer, size_t length, Address::ptr from, int flags) {
+    return recv(buffer, length, flags);
+}
+
+int SSLSocket::recvFrom(iovec *buffers, size_t length, Address::ptr from, int flags) {
+    return recv(buffers, length, flags);
+}
+
+int64_t SSLSocket::sendFile(int fd, off_t offset, size_t count) {
+    if (!isConnected() || !handshake()) {
+        return -1;
+    }
+    int64_t total = 0;
+    if (isKtlsSend()) {
+        while ((size_t)total < count) {
+            ERR_clear_error();
+            ossl_ssize_t rt = SSL_sendfile(m_ssl.get(), fd, offset + total, count - total, 0);
+            if (rt > 0) {
+                addSendStats(rt);
+                total += rt;
+                continue;
+            }
+            if (!waitRetry(SSL_get_error(m_ssl.get(), rt))) {
+                return total > 0 ? total : -1;
+            }
+        }
+        return total;
+    }
+
+    std::string buf;
+    buf.resize(std::min(count, (size_t)64 * 1024));
+    while ((size_t)total < count) {
+        ssize_t n = pread(fd, &buf[0], std::min(buf.size(), count - total), offset + total);
+        if (n <= 0) {
+            break;
+        }
+        ssize_t off = 0;
+        while (off < n) {
+            int rt = send(&buf[off], n - off);
+            if (rt <= 0) {
+                return total > 0 ? total : rt;
+            }
+            off += rt;
+        }
+        total += n;
+    }
+    return total;
+}
+
+std::ostream &SSLSocket::dump(std::ostream &os) const {
+    os << "[SSLSocket sock=" << m_sock
+       << " is_connected=" << m_isConnected
+       << " family=" << m_family
+       << " type=" << m_type
+       << " protocol=" << m_protocol
+       << " handshaked=" << m_handshaked;
+    if (m_ssl && m_handshaked) {
+        os << " version=" << SSL_get_version(m_ssl.get())
+           << " cipher=" << SSL_get_cipher_name(m_ssl.get())
+           << " reused=" << isSessionReused()
+           << " ktls=" << isKtlsSend();
+    }
+    if (m_localAddress) {
+        os << " local_address=" << m_localAddress->toString();
+    }
+    if (m_remoteAddress) {
+        os << " remote_address=" << m_remoteAddress->toString();
+    }
+    os << "]";
+    return os;
+}
+
 } // namespace sylar
@@ -9,15 +9,54 @@
 #ifndef __SYLAR_SOCKET_H__
 #define __SYLAR_SOCKET_H__
 
+#include <atomic>
 #include <memory>
 #include <netinet/tcp.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
 #include "address.h"
+#include "mutex.h"
 #include "noncopyable.h"
 
 namespace sylar {
 
+class SocketStatsGroup;
+
+/**
+ * @brief 连接的收发统计和TCP_INFO采样
+ */
+struct SocketStats {
+    /// 收到的字节数
+    uint64_t bytesIn = 0;
+    /// 发出的字节数
+    uint64_t bytesOut = 0;
+    /// recv调用次数
+    uint64_t recvCalls = 0;
+    /// send调用次数
+    uint64_t sendCalls = 0;
+    /// 最近一次TCP_INFO采样的时间(毫秒)，0表示没有采样过
+    uint64_t sampleTime = 0;
+    /// 平滑RTT(微秒)
+    uint32_t rtt = 0;
+    /// RTT偏差(微秒)
+    uint32_t rttVar = 0;
+    /// 拥塞窗口(报文段)
+    uint32_t cwnd = 0;
+    /// 累计重传的报文段数
+    uint32_t retransmits = 0;
+    /// 当前认为已丢失的报文段数
+    uint32_t lost = 0;
+    /// 已发送未确认的报文段数
+    uint32_t unacked = 0;
+
+    /**
+     * @brief 输出统计
+     */
+    std::string toString() const;
+};
+
 /**
  * @brief Socket封装类
  */
@@ -358,7 +397,45 @@ public:
      */
     bool cancelAll();
 
+    /**
+     * @brief 返回收发统计和最近一次TCP_INFO采样
+     * @details 计数由收发数据的协程更新，其他线程读到的是近似值
+     */
+    SocketStats getStats() const;
+
+    /**
+     * @brief 读取TCP_INFO，更新RTT、重传和拥塞窗口
+     * @return 不是TCP连接或者读取失败时返回false
+     */
+    bool sampleTcpInfo();
+
+    /**
+     * @brief 加入统计组，关闭时最后采样一次并把计数汇总到组里
+     */
+    void setStatsGroup(std::shared_ptr<SocketStatsGroup> v) { m_statsGroup = v;}
+
 protected:
+    /**
+     * @brief 累加接收统计
+     */
+    void addRecvStats(int rt) {
+        // 同一方向只有一个协程在收发，不需要原子加
+        m_recvCalls.store(m_recvCalls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (rt > 0) {
+            m_bytesIn.store(m_bytesIn.load(std::memory_order_relaxed) + rt, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief 累加发送统计
+     */
+    void addSendStats(int64_t rt) {
+        m_sendCalls.store(m_sendCalls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (rt > 0) {
+            m_bytesOut.store(m_bytesOut.load(std::memory_order_relaxed) + rt, std::memory_order_relaxed);
+        }
+    }
+
     /**
      * @brief 初始化socket
      */
@@ -389,6 +466,155 @@ protected:
     Address::ptr m_localAddress;
     /// 远端地址
     Address::ptr m_remoteAddress;
+    /// 收到的字节数
+    std::atomic<uint64_t> m_bytesIn = {0};
+    /// 发出的字节数
+    std::atomic<uint64_t> m_bytesOut = {0};
+    /// recv调用次数
+    std::atomic<uint64_t> m_recvCalls = {0};
+    /// send调用次数
+    std::atomic<uint64_t> m_sendCalls = {0};
+    /// 保护m_tcpInfo
+    mutable Spinlock m_infoMutex;
+    /// 最近一次TCP_INFO采样，只用到其中的采样字段
+    SocketStats m_tcpInfo;
+    /// 所属的统计组
+    std::shared_ptr<SocketStatsGroup> m_statsGroup;
+};
+
+/**
+ * @brief SSL/TLS Socket封装(OpenSSL)
+ * @details 底层读写仍然经过hook，握手和收发在IO未就绪时挂起当前协程而不是阻塞线程。
+ *          - 监听socket通过loadCertificates()加载证书，accept出的连接共享同一个SSL_CTX，
+ *            服务端会话缓存和会话票据(session ticket)都在这个SSL_CTX上，因此可以恢复会话
+ *          - accept()不做握手，调用方可以把handshake()放到单独的调度器上执行，
+ *            避免握手的非对称加密计算占用IO线程；未握手的连接在第一次收发时自动握手
+ *          - 客户端共用一个进程级的SSL_CTX，按"SNI主机名/远端地址"缓存服务端下发的会话，
+ *            重连同一服务端时自动尝试恢复会话
+ *          - 配置ssl.ktls开启后，若内核与OpenSSL支持kTLS，握手完成后对称加密交给内核，
+ *            sendFile()走SSL_sendfile零拷贝发送
+ */
+class SSLSocket : public Socket {
+public:
+    typedef std::shared_ptr<SSLSocket> ptr;
+
+    /**
+     * @brief 创建TCP SSLSocket(满足地址类型)
+     * @param[in] address 地址
+     */
+    static SSLSocket::ptr CreateTCP(sylar::Address::ptr address);
+
+    /**
+     * @brief 创建IPv4的TCP SSLSocket
+     */
+    static SSLSocket::ptr CreateTCPSocket();
+
+    /**
+     * @brief 创建IPv6的TCP SSLSocket
+     */
+    static SSLSocket::ptr CreateTCPSocket6();
+
+    /**
+     * @brief SSLSocket构造函数
+     * @param[in] family 协议簇
+     * @param[in] type 类型
+     * @param[in] protocol 协议
+     */
+    SSLSocket(int family, int type, int protocol = 0);
+
+    /**
+     * @brief 析构函数，向对端发送close_notify后关闭连接
+     */
+    virtual ~SSLSocket();
+
+    virtual Socket::ptr accept() override;
+    virtual bool bind(const Address::ptr addr) override;
+
+    /**
+     * @brief 连接地址并完成握手
+     * @param[in] addr 目标地址
+     * @param[in] timeout_ms 超时时间(毫秒)
+     */
+    virtual bool connect(const Address::ptr addr, uint64_t timeout_ms = -1) override;
+    virtual bool listen(int backlog = SOMAXCONN) override;
+    virtual bool close() override;
+    virtual int send(const void *buffer, size_t length, int flags = 0) override;
+    virtual int send(const iovec *buffers, size_t length, int flags = 0) override;
+    virtual int sendTo(const void *buffer, size_t length, const Address::ptr to, int flags = 0) override;
+    virtual int sendTo(const iovec *buffers, size_t length, const Address::ptr to, int flags = 0) override;
+    virtual int recv(void *buffer, size_t length, int flags = 0) override;
+    virtual int recv(iovec *buffers, size_t length, int flags = 0) override;
+    virtual int recvFrom(void *buffer, size_t length, Address::ptr from, int flags = 0) override;
+    virtual int recvFrom(iovec *buffers, size_t length, Address::ptr from, int flags = 0) override;
+
+    /**
+     * @brief 加载证书和私钥，用于监听socket
+     * @param[in] cert_file PEM格式的证书链文件
+     * @param[in] key_file PEM格式的私钥文件
+     * @return 是否加载成功
+     */
+    bool loadCertificates(const std::string &cert_file, const std::string &key_file);
+
+    /**
+     * @brief 完成TLS握手，已握手时直接返回true
+     * @return 握手失败时返回false，调用方应关闭连接
+     */
+    bool handshake();
+
+    /**
+     * @brief 是否已完成握手
+     */
+    bool isHandshaked() const { return m_handshaked; }
+
+    /**
+     * @brief 本次握手是否恢复了之前的会话
+     */
+    bool isSessionReused() const;
+
+    /**
+     * @brief 发送方向是否已交给内核TLS
+     */
+    bool isKtlsSend() const;
+
+    /**
+     * @brief 发送文件内容
+     * @details kTLS生效时由内核加密并零拷贝发送，否则读到用户态后SSL_write
+     * @param[in] fd 文件句柄
+     * @param[in] offset 文件偏移
+     * @param[in] count 发送字节数
+     * @return 发送的字节数，<0 出错
+     */
+    int64_t sendFile(int fd, off_t offset, size_t count);
+
+    /**
+     * @brief 设置SNI主机名，需在connect之前调用，同时作为客户端会话缓存的key
+     */
+    void setHostName(const std::string &host) { m_hostName = host; }
+
+    virtual std::ostream &dump(std::ostream &os) const override;
+
+protected:
+    virtual bool init(int sock) override;
+
+private:
+    /**
+     * @brief 处理SSL_ERROR_WANT_READ/WANT_WRITE，在IOManager上等待socket就绪
+     * @param[in] err SSL_get_error的返回值
+     * @return 可以重试时返回true
+     */
+    bool waitRetry(int err);
+
+private:
+    /// SSL上下文，监听socket与其accept出的连接共享
+    std::shared_ptr<SSL_CTX> m_ctx;
+    /// SSL连接
+    std::shared_ptr<SSL> m_ssl;
+    /// 是否已完成握手
+    bool m_handshaked = false;
+    /// SNI主机名
+    std::string m_hostName;
+    /// 客户端会话缓存的key
+    std::string m_sessionKey;
 };
 
 /**
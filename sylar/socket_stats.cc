@@ -0,0 +1,179 @@
+/**
+ * @file socket_stats.cc
+ * @brief 连接统计组实现
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "socket_stats.h"
+#include <sstream>
+#include "config.h"
+
+namespace sylar {
+
+static sylar::ConfigVar<uint64_t>::ptr g_info_sample_interval =
+    sylar::Config::Lookup("tcp.info_sample_interval", (uint64_t)5000
+            , "interval in ms to sample TCP_INFO of server and upstream connections, 0 disables");
+
+SocketStatsGroup::SocketStatsGroup(const std::string& kind, const std::string& name)
+    :m_kind(kind)
+    ,m_name(name)
+    ,m_interval(g_info_sample_interval->getValue()) {
+    auto mgr = sylar::MetricsMgr::GetInstance();
+    MetricsRegistry::Labels labels = {{"kind", kind}, {"name", name}};
+    m_connections = mgr->gauge("sylar_tcp_connections", "tracked tcp connections", labels);
+    m_bytesIn = mgr->counter("sylar_tcp_received_bytes_total", "bytes received", labels);
+    m_bytesOut = mgr->counter("sylar_tcp_sent_bytes_total", "bytes sent", labels);
+    m_recvCalls = mgr->counter("sylar_tcp_recv_calls_total", "recv calls", labels);
+    m_sendCalls = mgr->counter("sylar_tcp_send_calls_total", "send calls", labels);
+    m_retransmits = mgr->counter("sylar_tcp_retransmits_total"
+                        , "retransmitted segments from TCP_INFO", labels);
+    m_rtt = mgr->summary("sylar_tcp_rtt_seconds", "smoothed rtt from TCP_INFO", labels, 1e-6);
+    m_cwnd = mgr->summary("sylar_tcp_cwnd_segments", "congestion window from TCP_INFO", labels);
+}
+
+void SocketStatsGroup::add(Socket::ptr sock) {
+    {
+        MutexType::Lock lock(m_mutex);
+        Entry& entry = m_socks[sock.get()];
+        entry.sock = sock;
+        entry.last = SocketStats();
+    }
+    m_connections->inc();
+    sock->setStatsGroup(shared_from_this());
+}
+
+void SocketStatsGroup::remove(Socket* sock) {
+    sock->sampleTcpInfo();
+    SocketStats cur = sock->getStats();
+    MutexType::Lock lock(m_mutex);
+    auto it = m_socks.find(sock);
+    if(it == m_socks.end()) {
+        return;
+    }
+    fold(it->second, cur);
+    if(cur.sampleTime) {
+        m_rtt->observe(cur.rtt);
+        m_cwnd->observe(cur.cwnd);
+    }
+    m_socks.erase(it);
+    lock.unlock();
+    m_connections->dec();
+}
+
+void SocketStatsGroup::tick(uint64_t now_ms) {
+    uint64_t last = m_lastSample.load(std::memory_order_relaxed);
+    if(!m_interval || now_ms < last + m_interval) {
+        return;
+    }
+    // 同一时刻只让一个调用方采样
+    if(m_lastSample.compare_exchange_strong(last, now_ms)) {
+        sample();
+    }
+}
+
+void SocketStatsGroup::sample() {
+    std::vector<Socket::ptr> socks;
+    {
+        MutexType::Lock lock(m_mutex);
+        socks.reserve(m_socks.size());
+        for(auto& i : m_socks) {
+            Socket::ptr sock = i.second.sock.lock();
+            if(sock) {
+                socks.push_back(sock);
+            }
+        }
+    }
+    for(auto& sock : socks) {
+        bool sampled = sock->sampleTcpInfo();
+        SocketStats cur = sock->getStats();
+        MutexType::Lock lock(m_mutex);
+        auto it = m_socks.find(sock.get());
+        if(it == m_socks.end()) {
+            continue;
+        }
+        fold(it->second, cur);
+        if(sampled) {
+            m_rtt->observe(cur.rtt);
+            m_cwnd->observe(cur.cwnd);
+        }
+    }
+    // socks在锁外释放，最后一个引用析构时会回调remove
+}
+
+void SocketStatsGroup::fold(Entry& entry, const SocketStats& cur) {
+    SocketStats& last = entry.last;
+    m_bytesIn->inc(cur.bytesIn - last.bytesIn);
+    m_bytesOut->inc(cur.bytesOut - last.bytesOut);
+    m_recvCalls->inc(cur.recvCalls - last.recvCalls);
+    m_sendCalls->inc(cur.sendCalls - last.sendCalls);
+    if(cur.retransmits > last.retransmits) {
+        m_retransmits->inc(cur.retransmits - last.retransmits);
+    }
+    last = cur;
+}
+
+void SocketStatsGroup::start(IOManager* iom, uint64_t interval_ms) {
+    MutexType::Lock lock(m_mutex);
+    if(interval_ms) {
+        m_interval = interval_ms;
+    }
+    if(!iom || !m_interval || m_iom) {
+        return;
+    }
+    m_iom = iom;
+    lock.unlock();
+    arm();
+}
+
+void SocketStatsGroup::stop() {
+    MutexType::Lock lock(m_mutex);
+    m_iom = nullptr;
+    if(m_timer) {
+        m_timer->cancel();
+        m_timer.reset();
+    }
+}
+
+void SocketStatsGroup::arm() {
+    MutexType::Lock lock(m_mutex);
+    if(!m_iom) {
+        return;
+    }
+    // 单次定时器每次触发后重新添加，组析构后条件失效，定时器随之结束，不需要在析构时访问调度器
+    m_timer = m_iom->addConditionTimer(m_interval, [this]() {
+        sample();
+        arm();
+    }, shared_from_this());
+}
+
+SocketStats SocketStatsGroup::getTotal() const {
+    SocketStats stats;
+    stats.bytesIn = m_bytesIn->get();
+    stats.bytesOut = m_bytesOut->get();
+    stats.recvCalls = m_recvCalls->get();
+    stats.sendCalls = m_sendCalls->get();
+    stats.retransmits = m_retransmits->get();
+    return stats;
+}
+
+size_t SocketStatsGroup::getConnections() {
+    MutexType::Lock lock(m_mutex);
+    return m_socks.size();
+}
+
+std::string SocketStatsGroup::toString() {
+    SocketStats total = getTotal();
+    std::stringstream ss;
+    ss << "[" << m_kind << " " << m_name
+       << " connections=" << getConnections()
+       << " bytes_in=" << total.bytesIn
+       << " bytes_out=" << total.bytesOut
+       << " recv_calls=" << total.recvCalls
+       << " send_calls=" << total.sendCalls
+       << " retrans=" << total.retransmits
+       << " rtt_us[" << getRtt().toString() << "]"
+       << " cwnd[" << getCwnd().toString() << "]]";
+    return ss.str();
+}
+
+}
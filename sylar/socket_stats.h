@@ -0,0 +1,171 @@
+/**
+ * @file socket_stats.h
+ * @brief 按服务器或上游汇总的连接统计
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#ifndef __SYLAR_SOCKET_STATS_H__
+#define __SYLAR_SOCKET_STATS_H__
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "iomanager.h"
+#include "metrics.h"
+#include "mutex.h"
+#include "socket.h"
+
+namespace sylar {
+
+/**
+ * @brief 连接统计组
+ * @details 一个TcpServer或一个HttpConnectionPool上游对应一组。组里的连接按tcp.info_sample_interval
+ *          低频读取TCP_INFO(服务器用循环定时器，连接池在请求路径上检查间隔)，RTT和拥塞窗口记入分位数摘要；
+ *          收发字节、调用次数和重传数在采样和连接关闭时按增量汇总。
+ *          指标注册在MetricsMgr里，以kind和name标签区分，通过 /_/status 管理接口导出：
+ *          RTT高而服务端耗时正常时是网络的问题，反之是服务端的问题
+ */
+class SocketStatsGroup : public std::enable_shared_from_this<SocketStatsGroup> {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<SocketStatsGroup> ptr;
+    /// 互斥量类型定义
+    typedef Mutex MutexType;
+
+    /**
+     * @brief 构造函数
+     * @param[in] kind 组的类型，服务器为服务器类型(如http)，上游为upstream
+     * @param[in] name 组名，如服务器名或上游的host:port
+     */
+    SocketStatsGroup(const std::string& kind, const std::string& name);
+
+    /**
+     * @brief 加入连接，连接关闭时自动移出
+     */
+    void add(Socket::ptr sock);
+
+    /**
+     * @brief 移出连接，最后采样一次并汇总计数
+     * @details 由Socket::close调用
+     */
+    void remove(Socket* sock);
+
+    /**
+     * @brief 对组里所有连接采样一次TCP_INFO并汇总计数
+     */
+    void sample();
+
+    /**
+     * @brief 距上次采样超过采样间隔时采样一次
+     * @details 供没有定时器的使用方在请求路径上调用，没到间隔时只比较一次时间。
+     *          连接池用这种方式，空闲连接上没有定时器，不会阻止IOManager退出
+     * @param[in] now_ms 当前时间(毫秒)
+     */
+    void tick(uint64_t now_ms);
+
+    /**
+     * @brief 在iom上启动循环采样
+     * @param[in] interval_ms 采样间隔(毫秒)，0表示使用配置tcp.info_sample_interval，配置也为0时不采样
+     */
+    void start(IOManager* iom, uint64_t interval_ms = 0);
+
+    /**
+     * @brief 停止循环采样
+     * @details 组析构后采样自动停止，但调度器先于组结束时需要先调用stop
+     */
+    void stop();
+
+    /**
+     * @brief 返回汇总的收发计数和重传数，采样字段不使用
+     * @details 活跃连接的计数在下一次采样或关闭时才汇总进来
+     */
+    SocketStats getTotal() const;
+
+    /**
+     * @brief 返回RTT分布(微秒)
+     */
+    HdrSnapshot getRtt() const { return m_rtt->snapshot();}
+
+    /**
+     * @brief 返回拥塞窗口分布(报文段)
+     */
+    HdrSnapshot getCwnd() const { return m_cwnd->snapshot();}
+
+    /**
+     * @brief 返回当前连接数
+     */
+    size_t getConnections();
+
+    /**
+     * @brief 返回组的类型
+     */
+    const std::string& getKind() const { return m_kind;}
+
+    /**
+     * @brief 返回组名
+     */
+    const std::string& getName() const { return m_name;}
+
+    /**
+     * @brief 输出统计摘要
+     */
+    std::string toString();
+private:
+    /**
+     * @brief 组里的一个连接
+     */
+    struct Entry {
+        /// 连接
+        std::weak_ptr<Socket> sock;
+        /// 已经汇总过的计数
+        SocketStats last;
+    };
+
+    /**
+     * @brief 把连接相对上次汇总的增量记入指标
+     */
+    void fold(Entry& entry, const SocketStats& cur);
+
+    /**
+     * @brief 添加下一次采样的定时器
+     */
+    void arm();
+private:
+    /// 组的类型
+    std::string m_kind;
+    /// 组名
+    std::string m_name;
+    /// 互斥量
+    MutexType m_mutex;
+    /// 连接
+    std::unordered_map<Socket*, Entry> m_socks;
+    /// 采样所在的调度器，为空表示没有启动采样
+    IOManager* m_iom = nullptr;
+    /// 采样间隔(毫秒)，0表示不采样
+    uint64_t m_interval;
+    /// 上次采样的时间(毫秒)
+    std::atomic<uint64_t> m_lastSample = {0};
+    /// 采样定时器
+    Timer::ptr m_timer;
+    /// 当前连接数
+    Gauge::ptr m_connections;
+    /// 收到的字节数
+    Counter::ptr m_bytesIn;
+    /// 发出的字节数
+    Counter::ptr m_bytesOut;
+    /// recv调用次数
+    Counter::ptr m_recvCalls;
+    /// send调用次数
+    Counter::ptr m_sendCalls;
+    /// 重传的报文段数
+    Counter::ptr m_retransmits;
+    /// RTT(微秒)
+    Summary::ptr m_rtt;
+    /// 拥塞窗口(报文段)
+    Summary::ptr m_cwnd;
+};
+
+}
+
+#endif
@@ -0,0 +1,149 @@
+/**
+ * @file splice.cc
+ * @brief 基于splice的socket间零拷贝数据搬运实现
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "splice.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include "config.h"
+#include "fd_manager.h"
+#include "iomanager.h"
+#include "log.h"
+
+namespace sylar {
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_NAME("system");
+
+static sylar::ConfigVar<uint32_t>::ptr g_splice_pipe_size =
+    sylar::Config::Lookup("splice.pipe_size", (uint32_t)(256 * 1024),
+            "splice pipe buffer size");
+
+/**
+ * @brief 等待fd可读/可写
+ * @details splice没有被hook，EAGAIN时需要自己挂到IOManager上等待，超时时间取socket上设置的值
+ * @return 超时或无法等待时返回false
+ */
+static bool WaitFd(int fd, IOManager::Event event) {
+    IOManager* iom = IOManager::GetThis();
+    if(!iom) {
+        errno = EAGAIN;
+        return false;
+    }
+    FdCtx::ptr ctx = FdMgr::GetInstance()->get(fd);
+    uint64_t timeout = ctx ? ctx->getTimeout(event == IOManager::READ ? SO_RCVTIMEO : SO_SNDTIMEO)
+                           : (uint64_t)-1;
+    std::shared_ptr<int> cancelled(new int(0));
+    std::weak_ptr<int> winfo(cancelled);
+    Timer::ptr timer;
+    if(timeout != (uint64_t)-1) {
+        timer = iom->addConditionTimer(timeout, [winfo, fd, iom, event]() {
+            auto t = winfo.lock();
+            if(!t || *t) {
+                return;
+            }
+            *t = ETIMEDOUT;
+            iom->cancelEvent(fd, event);
+        }, winfo);
+    }
+    if(iom->addEvent(fd, event)) {
+        if(timer) {
+            timer->cancel();
+        }
+        return false;
+    }
+    Fiber::GetThis()->yield();
+    if(timer) {
+        timer->cancel();
+    }
+    if(*cancelled) {
+        errno = *cancelled;
+        return false;
+    }
+    return true;
+}
+
+SplicePipe::SplicePipe() {
+    if(pipe2(m_fds, O_NONBLOCK | O_CLOEXEC)) {
+        SYLAR_LOG_ERROR(g_logger) << "pipe2 errno=" << errno
+            << " errstr=" << strerror(errno);
+        m_fds[0] = m_fds[1] = -1;
+        return;
+    }
+    // 放大管道可以减少大块数据的搬运次数，超过系统上限时保持默认大小
+    fcntl(m_fds[1], F_SETPIPE_SZ, (int)g_splice_pipe_size->getValue());
+}
+
+SplicePipe::~SplicePipe() {
+    if(m_fds[0] >= 0) {
+        ::close(m_fds[0]);
+        ::close(m_fds[1]);
+    }
+}
+
+bool SplicePipe::IsSupported(Socket::ptr sock) {
+    return sock && sock->isValid() && !std::dynamic_pointer_cast<SSLSocket>(sock);
+}
+
+int64_t SplicePipe::transfer(Socket::ptr from, Socket::ptr to, uint64_t length
+                             ,bool partial, ProgressCallback cb) {
+    if(!isValid()) {
+        errno = EBADF;
+        return -1;
+    }
+    int rfd = from->getSocket();
+    int wfd = to->getSocket();
+    uint64_t moved = 0;
+    bool eof = false;
+    while(true) {
+        if(m_pending == 0) {
+            if(eof || moved >= length) {
+                break;
+            }
+            uint64_t want = length - moved;
+            ssize_t n = splice(rfd, nullptr, m_fds[1], nullptr
+                               ,want > (uint64_t)SSIZE_MAX ? (size_t)SSIZE_MAX : (size_t)want
+                               ,SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+            if(n > 0) {
+                m_pending = n;
+                moved += n;
+            } else if(n == 0) {
+                eof = true;
+            } else if(errno == EINTR) {
+                continue;
+            } else if(errno == EAGAIN) {
+                // 管道是空的，EAGAIN只可能来自源socket
+                if(partial && moved > 0) {
+                    break;
+                }
+                if(!WaitFd(rfd, IOManager::READ)) {
+                    return -1;
+                }
+            } else {
+                return -1;
+            }
+            continue;
+        }
+        ssize_t n = splice(m_fds[0], nullptr, wfd, nullptr, m_pending
+                           ,SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if(n > 0) {
+            m_pending -= n;
+            if(cb) {
+                cb(n);
+            }
+        } else if(n < 0 && errno == EINTR) {
+            continue;
+        } else if(n < 0 && errno == EAGAIN) {
+            // 管道里有数据，EAGAIN只可能来自目标socket
+            if(!WaitFd(wfd, IOManager::WRITE)) {
+                return -1;
+            }
+        } else {
+            return -1;
+        }
+    }
+    return moved;
+}
+
+}
@@ -0,0 +1,76 @@
+/**
+ * @file splice.h
+ * @brief 基于splice的socket间零拷贝数据搬运
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#ifndef __SYLAR_SPLICE_H__
+#define __SYLAR_SPLICE_H__
+
+#include <functional>
+#include <memory>
+#include "socket.h"
+#include "noncopyable.h"
+
+namespace sylar {
+
+/**
+ * @brief splice用的内核管道
+ * @details 数据从源socket经管道直接进入目标socket，不经过用户态内存。
+ *          socket和管道都是非阻塞的，EAGAIN时当前协程挂到IOManager上等待可读/可写，
+ *          等待时间受socket的SO_RCVTIMEO/SO_SNDTIMEO限制。
+ *          TLS socket的数据需要用户态加解密，不能使用splice
+ */
+class SplicePipe : Noncopyable {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<SplicePipe> ptr;
+
+    /**
+     * @brief 构造函数，创建管道
+     */
+    SplicePipe();
+
+    /**
+     * @brief 析构函数，关闭管道
+     */
+    ~SplicePipe();
+
+    /**
+     * @brief 管道是否创建成功
+     */
+    bool isValid() const { return m_fds[0] >= 0;}
+
+    /// 每次有数据写入目标socket时的回调，参数为本次写入的字节数
+    typedef std::function<void(size_t)> ProgressCallback;
+
+    /**
+     * @brief 把from上的数据搬运到to
+     * @param[in] from 源socket
+     * @param[in] to 目标socket
+     * @param[in] length 最多搬运的字节数，-1表示直到from读到EOF
+     * @param[in] partial 为true时，已经搬运过数据而from暂时没有数据可读就立即返回，不再等待凑满length。
+     *                    双向转发时用它避免已经搬运的数据因为等待超时而丢失
+     * @param[in] cb 进度回调，可以为空
+     * @return >=0 已经写入to的字节数，from提前读到EOF时小于length；
+     *             partial为true时返回0表示from读到EOF
+     *         <0 读写失败或超时，errno为具体错误，已经进入管道的数据会在下次调用时继续写出
+     */
+    int64_t transfer(Socket::ptr from, Socket::ptr to, uint64_t length = -1
+                     ,bool partial = false, ProgressCallback cb = nullptr);
+
+    /**
+     * @brief socket能否用splice搬运数据
+     */
+    static bool IsSupported(Socket::ptr sock);
+
+private:
+    /// 管道的读端和写端
+    int m_fds[2];
+    /// 已经进入管道、尚未写入目标socket的字节数
+    size_t m_pending = 0;
+};
+
+}
+
+#endif
@@ -38,14 +38,43 @@
 #include "endian.h"
 #include "address.h"
 #include "socket.h"
+#include "socket_stats.h"
 #include "bytearray.h"
+#include "serialize.h"
+#include "json.h"
 #include "tcp_server.h"
+#include "udp_server.h"
+#include "splice.h"
+#include "tcp_proxy_server.h"
+#include "rate_limiter.h"
+#include "concurrency_limiter.h"
+#include "circuit_breaker.h"
+#include "resource_pool.h"
+#include "metrics.h"
+#include "trace.h"
+#include "flight_recorder.h"
+#include "hdr_histogram.h"
 #include "uri.h"
 #include "http/http.h"
 #include "http/http_parser.h"
 #include "http/http_session.h"
+#include "http/multipart.h"
+#include "http/route_stats.h"
 #include "http/servlet.h"
 #include "http/http_server.h"
 #include "http/http_connection.h"
+#include "http/http_load_balance.h"
+#include "http/sse.h"
+#include "http/servlets/proxy_servlet.h"
+#include "http/servlets/rate_limit_filter.h"
+#include "http/servlets/status_servlet.h"
+#include "http/servlets/flight_recorder_servlet.h"
 #include "daemon.h"
+#include "rpc/rpc.h"
+#include "rpc/rpc_session.h"
+#include "rpc/rpc_server.h"
+#include "rpc/rpc_client.h"
+#include "redis/resp.h"
+#include "redis/redis_store.h"
+#include "redis/redis_server.h"
 #endif
\ No newline at end of file
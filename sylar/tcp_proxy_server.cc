@@ -0,0 +1,213 @@
+/**
+ * @file tcp_proxy_server.cc
+ * @brief 四层TCP代理服务器实现
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "tcp_proxy_server.h"
+#include <sys/socket.h>
+#include "config.h"
+#include "iomanager.h"
+#include "log.h"
+#include "splice.h"
+#include "util.h"
+
+namespace sylar {
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_NAME("system");
+
+static sylar::ConfigVar<bool>::ptr g_tcp_proxy_splice =
+    sylar::Config::Lookup("tcp_proxy.splice", true,
+            "tcp proxy relays data with splice");
+
+static sylar::ConfigVar<uint64_t>::ptr g_tcp_proxy_connect_timeout =
+    sylar::Config::Lookup("tcp_proxy.connect_timeout", (uint64_t)3000,
+            "tcp proxy upstream connect timeout");
+
+static sylar::ConfigVar<uint32_t>::ptr g_tcp_proxy_buffer_size =
+    sylar::Config::Lookup("tcp_proxy.buffer_size", (uint32_t)(64 * 1024),
+            "tcp proxy user space copy buffer size");
+
+/// splice每次最多搬运的字节数，每搬完一段更新一次活跃时间
+static const uint64_t s_splice_chunk = 1024 * 1024;
+
+/**
+ * @brief 一对代理连接的共享状态
+ * @details 两个方向的协程各持有一份，都结束后析构时关闭两端
+ */
+struct TcpProxyServer::Relay {
+    Relay(Socket::ptr c, Socket::ptr u, bool s)
+        :client(c)
+        ,upstream(u)
+        ,splice(s)
+        ,lastActive(GetCurrentMS()) {
+    }
+
+    ~Relay() {
+        client->close();
+        upstream->close();
+    }
+
+    /**
+     * @brief 出错时立即断开两端，另一个方向上等待中的协程会被唤醒并退出
+     * @details 另一个方向可能正拿着fd在splice，这里只shutdown，
+     *          fd留到两个方向都结束后由析构关闭，不会被别的连接复用
+     */
+    void abort() {
+        if(!closed.exchange(true)) {
+            Shutdown(client);
+            Shutdown(upstream);
+        }
+    }
+
+    /**
+     * @brief shutdown之后读写立即返回，cancelEvent唤醒正在等待的协程，不必等到超时
+     */
+    static void Shutdown(Socket::ptr sock) {
+        int fd = sock->getSocket();
+        ::shutdown(fd, SHUT_RDWR);
+        IOManager* iom = IOManager::GetThis();
+        if(iom) {
+            iom->cancelEvent(fd, IOManager::READ);
+            iom->cancelEvent(fd, IOManager::WRITE);
+        }
+    }
+
+    /// 客户端连接
+    Socket::ptr client;
+    /// 上游连接
+    Socket::ptr upstream;
+    /// 是否使用splice
+    bool splice;
+    /// 两个方向最近一次转发数据的时间(毫秒)
+    std::atomic<uint64_t> lastActive;
+    /// 是否已经关闭
+    std::atomic<bool> closed = {false};
+    /// 还在转发的方向数
+    std::atomic<int> running = {2};
+};
+
+TcpProxyServer::TcpProxyServer(Address::ptr upstream
+                               ,IOManager* io_worker
+                               ,IOManager* accept_worker)
+    :TcpServer(io_worker, accept_worker)
+    ,m_upstream(upstream)
+    ,m_splice(g_tcp_proxy_splice->getValue()) {
+    m_type = "tcp_proxy";
+}
+
+void TcpProxyServer::handleClient(Socket::ptr client) {
+    Socket::ptr upstream = Socket::CreateTCP(m_upstream);
+    if(!upstream->connect(m_upstream, g_tcp_proxy_connect_timeout->getValue())) {
+        SYLAR_LOG_ERROR(g_logger) << "tcp proxy connect upstream fail errno=" << errno
+            << " errstr=" << strerror(errno) << " upstream=" << *m_upstream
+            << " client=" << *client;
+        client->close();
+        return;
+    }
+    client->setSendTimeout(m_recvTimeout);
+    upstream->setRecvTimeout(m_recvTimeout);
+    upstream->setSendTimeout(m_recvTimeout);
+
+    bool splice = m_splice && SplicePipe::IsSupported(client)
+                    && SplicePipe::IsSupported(upstream);
+    std::shared_ptr<Relay> ctx(new Relay(client, upstream, splice));
+    ++m_connections;
+    auto self = std::static_pointer_cast<TcpProxyServer>(shared_from_this());
+    m_ioWorker->schedule(std::bind(&TcpProxyServer::relay, self, ctx, true));
+    relay(ctx, false);
+}
+
+void TcpProxyServer::relay(std::shared_ptr<Relay> ctx, bool up) {
+    Socket::ptr from = up ? ctx->client : ctx->upstream;
+    Socket::ptr to = up ? ctx->upstream : ctx->client;
+    std::atomic<uint64_t>& bytes = up ? m_upBytes : m_downBytes;
+
+    SplicePipe::ptr pipe;
+    if(ctx->splice) {
+        pipe.reset(new SplicePipe);
+        if(!pipe->isValid()) {
+            pipe.reset();
+        }
+    }
+    std::string buffer;
+    if(!pipe) {
+        buffer.resize(g_tcp_proxy_buffer_size->getValue());
+    }
+    size_t offset = 0;
+    size_t length = 0;
+
+    // 超时只说明这个方向空闲，另一个方向还有数据时继续等
+    auto can_retry = [this, ctx]() {
+        return (errno == ETIMEDOUT || errno == EAGAIN) && !ctx->closed
+            && GetCurrentMS() - ctx->lastActive < m_recvTimeout;
+    };
+
+    // 每次写出数据都刷新活跃时间，慢而持续的转发不会被另一个方向当成空闲
+    auto progress = [&bytes, ctx](size_t n) {
+        bytes += n;
+        ctx->lastActive = GetCurrentMS();
+    };
+
+    bool eof = false;
+    while(!eof) {
+        int64_t n = 0;
+        if(pipe) {
+            n = pipe->transfer(from, to, s_splice_chunk, true, progress);
+            if(n > 0) {
+                continue;
+            }
+            if(n == 0) {
+                eof = true;
+            }
+        } else if(offset < length) {
+            n = to->send(&buffer[offset], length - offset);
+            if(n > 0) {
+                offset += n;
+                progress(n);
+                continue;
+            }
+        } else {
+            n = from->recv(&buffer[0], buffer.size());
+            if(n > 0) {
+                offset = 0;
+                length = n;
+                continue;
+            }
+            if(n == 0) {
+                eof = true;
+            }
+        }
+        if(n < 0) {
+            if(can_retry()) {
+                continue;
+            }
+            SYLAR_LOG_DEBUG(g_logger) << "tcp proxy relay " << (up ? "up" : "down")
+                << " fail errno=" << errno << " errstr=" << strerror(errno)
+                << " client=" << *ctx->client;
+            ctx->abort();
+            break;
+        }
+    }
+    if(eof && !ctx->closed) {
+        // 半关闭：对端读到EOF，另一个方向继续转发
+        ::shutdown(to->getSocket(), SHUT_WR);
+    }
+    if(--ctx->running == 0) {
+        --m_connections;
+    }
+}
+
+std::string TcpProxyServer::toString(const std::string& prefix) {
+    std::stringstream ss;
+    ss << TcpServer::toString(prefix);
+    std::string pfx = prefix.empty() ? "    " : prefix;
+    ss << pfx << "upstream=" << *m_upstream
+       << " splice=" << m_splice
+       << " connections=" << m_connections
+       << " up_bytes=" << m_upBytes
+       << " down_bytes=" << m_downBytes << std::endl;
+    return ss.str();
+}
+
+}
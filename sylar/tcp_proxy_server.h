@@ -0,0 +1,96 @@
+/**
+ * @file tcp_proxy_server.h
+ * @brief 四层TCP代理服务器
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#ifndef __SYLAR_TCP_PROXY_SERVER_H__
+#define __SYLAR_TCP_PROXY_SERVER_H__
+
+#include <atomic>
+#include "tcp_server.h"
+
+namespace sylar {
+
+/**
+ * @brief TCP代理服务器
+ * @details 每个接入的客户端连接都会新建一条到上游的连接，两个方向各由一个协程转发。
+ *          默认用splice经内核管道搬运，数据不进入用户态；两端有TLS socket时退回用户态拷贝。
+ *          一个方向读到EOF后对另一端shutdown(SHUT_WR)，另一个方向继续转发，两个方向都结束后才关闭连接；
+ *          任意方向读写出错时立即关闭两端。
+ *          读超时取recv_timeout，只有两个方向都没有数据时才算超时
+ */
+class TcpProxyServer : public TcpServer {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<TcpProxyServer> ptr;
+
+    /**
+     * @brief 构造函数
+     * @param[in] upstream 上游地址
+     * @param[in] io_worker 转发数据的调度器
+     * @param[in] accept_worker 接收连接的调度器
+     */
+    TcpProxyServer(Address::ptr upstream
+                   ,IOManager* io_worker = IOManager::GetThis()
+                   ,IOManager* accept_worker = IOManager::GetThis());
+
+    /**
+     * @brief 返回上游地址
+     */
+    Address::ptr getUpstream() const { return m_upstream;}
+
+    /**
+     * @brief 是否使用splice转发
+     */
+    bool isSplice() const { return m_splice;}
+
+    /**
+     * @brief 设置是否使用splice转发，默认取tcp_proxy.splice配置，只影响之后接入的连接
+     */
+    void setSplice(bool v) { m_splice = v;}
+
+    /**
+     * @brief 返回当前转发中的连接数
+     */
+    uint64_t getConnections() const { return m_connections;}
+
+    /**
+     * @brief 返回累计从客户端转发到上游的字节数
+     */
+    uint64_t getUpBytes() const { return m_upBytes;}
+
+    /**
+     * @brief 返回累计从上游转发到客户端的字节数
+     */
+    uint64_t getDownBytes() const { return m_downBytes;}
+
+    virtual std::string toString(const std::string& prefix = "") override;
+
+protected:
+    virtual void handleClient(Socket::ptr client) override;
+
+private:
+    struct Relay;
+
+    /**
+     * @brief 转发一个方向的数据，直到读到EOF或出错
+     */
+    void relay(std::shared_ptr<Relay> ctx, bool up);
+
+private:
+    /// 上游地址
+    Address::ptr m_upstream;
+    /// 是否使用splice
+    bool m_splice;
+    /// 当前连接数
+    std::atomic<uint64_t> m_connections = {0};
+    /// 客户端到上游的字节数
+    std::atomic<uint64_t> m_upBytes = {0};
+    /// 上游到客户端的字节数
+    std::atomic<uint64_t> m_downBytes = {0};
+};
+
+}
+
+#endif
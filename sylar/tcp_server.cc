@@ -27,17 +27,19 @@ TcpServer::~TcpServer() {
     m_socks.clear();
 }
 
-bool TcpServer::bind(sylar::Address::ptr addr) {
+bool TcpServer::bind(sylar::Address::ptr addr, bool ssl) {
     std::vector<Address::ptr> addrs;
     std::vector<Address::ptr> fails;
     addrs.push_back(addr);
-    return bind(addrs, fails);
+    return bind(addrs, fails, ssl);
 }
 
 bool TcpServer::bind(const std::vector<Address::ptr>& addrs
-                        ,std::vector<Address::ptr>& fails ) {
+                        ,std::vector<Address::ptr>& fails
+                        ,bool ssl) {
+    m_ssl = ssl;
     for(auto& addr : addrs) {
-        Socket::ptr sock = Socket::CreateTCP(addr);
+        Socket::ptr sock = ssl ? SSLSocket::CreateTCP(addr) : Socket::CreateTCP(addr);
         if(!sock->bind(addr)) {
             SYLAR_LOG_ERROR(g_logger) << "bind fail errno="
                 << errno << " errstr=" << strerror(errno)
@@ -72,10 +74,23 @@ void TcpServer::startAccept(Socket::ptr sock) {
     while(!m_isStop) {
         Socket::ptr client = sock->accept();
         if(client) {
+            // 在分配会话之前拒绝超出频率的连接
+            if(m_rateLimiter && !m_rateLimiter->allow(
+                        RateLimiter::AddressKey(client->getRemoteAddress()))) {
+                SYLAR_LOG_DEBUG(g_logger) << "accept rate limited: " << *client;
+                client->close();
+                continue;
+            }
             client->setRecvTimeout(m_recvTimeout);
-            //bind(&TcpServer::handleClient,shared_from_this(), client)即handleClient(client)
-            m_ioWorker->schedule(std::bind(&TcpServer::handleClient,
-                        shared_from_this(), client));
+            m_stats->add(client);
+            SSLSocket::ptr ssl_client = std::dynamic_pointer_cast<SSLSocket>(client);
+            if(ssl_client) {
+                IOManager* worker = m_handshakeWorker ? m_handshakeWorker : m_ioWorker;
+                worker->schedule(std::bind(&TcpServer::handshakeClient,
+                            shared_from_this(), ssl_client));
+                continue;
+            }
+            dispatchClient(client);
         } else {
             SYLAR_LOG_ERROR(g_logger) << "accept errno=" << errno
                 << " errstr=" << strerror(errno);
@@ -83,11 +98,40 @@ void TcpServer::startAccept(Socket::ptr sock) {
     }
 }
 
+void TcpServer::handshakeClient(SSLSocket::ptr client) {
+    if(!client->handshake()) {
+        SYLAR_LOG_DEBUG(g_logger) << "ssl handshake fail: " << *client;
+        client->close();
+        return;
+    }
+    dispatchClient(client);
+}
+
+void TcpServer::dispatchClient(Socket::ptr client) {
+    //bind(&TcpServer::handleClient,shared_from_this(), client)即handleClient(client)
+    m_ioWorker->schedule(std::bind(&TcpServer::handleClient,
+                shared_from_this(), client));
+}
+
+bool TcpServer::loadCertificates(const std::string& cert_file, const std::string& key_file) {
+    for(auto& i : m_socks) {
+        auto ssl_socket = std::dynamic_pointer_cast<SSLSocket>(i);
+        if(ssl_socket && !ssl_socket->loadCertificates(cert_file, key_file)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool TcpServer::start() {
     if(!m_isStop) {
         return true;
     }
     m_isStop = false;
+    if(!m_stats) {
+        m_stats = std::make_shared<SocketStatsGroup>(m_type, m_name);
+    }
+    m_stats->start(m_ioWorker);
     for(auto& sock : m_socks) {
         //bind(&TcpServer::startAccept,shared_from_this(), sock)即startAccept(sock)
         m_acceptWorker->schedule(std::bind(&TcpServer::startAccept,
@@ -98,6 +142,9 @@ bool TcpServer::start() {
 
 void TcpServer::stop() {
     m_isStop = true;
+    if(m_stats) {
+        m_stats->stop();
+    }
     auto self = shared_from_this();
     m_acceptWorker->schedule([this, self]() {
         for(auto& sock : m_socks) {
@@ -118,8 +165,15 @@ std::string TcpServer::toString(const std::string& prefix) {
        << " name=" << m_name
        << " io_worker=" << (m_ioWorker ? m_ioWorker->getName() : "")
        << " accept=" << (m_acceptWorker ? m_acceptWorker->getName() : "")
+       << " ssl=" << m_ssl
        << " recv_timeout=" << m_recvTimeout << "]" << std::endl;
     std::string pfx = prefix.empty() ? "    " : prefix;
+    if(m_rateLimiter) {
+        ss << pfx << "rate_limiter=" << m_rateLimiter->toString() << std::endl;
+    }
+    if(m_stats) {
+        ss << pfx << "socket_stats=" << m_stats->toString() << std::endl;
+    }
     for(auto& i : m_socks) {
         ss << pfx << pfx << *i << std::endl;
     }
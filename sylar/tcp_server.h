@@ -14,8 +14,10 @@
 #include "address.h"
 #include "iomanager.h"
 #include "socket.h"
+#include "socket_stats.h"
 #include "noncopyable.h"
 #include "config.h"
+#include "rate_limiter.h"
 
 namespace sylar {
 /**
@@ -42,18 +44,53 @@ public:
 
     /**
      * @brief 绑定地址
+     * @param[in] ssl 是否使用TLS，需要再调用loadCertificates加载证书
      * @return 返回是否绑定成功
      */
-    virtual bool bind(sylar::Address::ptr addr);
+    virtual bool bind(sylar::Address::ptr addr, bool ssl = false);
 
     /**
      * @brief 绑定地址数组
      * @param[in] addrs 需要绑定的地址数组
      * @param[out] fails 绑定失败的地址
+     * @param[in] ssl 是否使用TLS，需要再调用loadCertificates加载证书
      * @return 是否绑定成功
      */
     virtual bool bind(const std::vector<Address::ptr>& addrs
-                        ,std::vector<Address::ptr>& fails);
+                        ,std::vector<Address::ptr>& fails
+                        ,bool ssl = false);
+
+    /**
+     * @brief 为所有TLS监听socket加载证书和私钥
+     * @param[in] cert_file PEM格式的证书链文件
+     * @param[in] key_file PEM格式的私钥文件
+     * @return 是否全部加载成功
+     */
+    bool loadCertificates(const std::string& cert_file, const std::string& key_file);
+
+    /**
+     * @brief 设置执行TLS握手的调度器
+     * @details 握手的非对称加密比较耗CPU，可以交给单独的调度器，握手完成后连接再回到io_worker；
+     *          不设置时在io_worker上握手
+     */
+    void setHandshakeWorker(IOManager* v) { m_handshakeWorker = v;}
+
+    /**
+     * @brief 设置接入限流器
+     * @details 每个新连接以客户端IP为key取一个令牌，取不到时直接关闭连接，不再交给io_worker
+     */
+    void setRateLimiter(RateLimiter::ptr v) { m_rateLimiter = v;}
+
+    /**
+     * @brief 返回接入限流器
+     */
+    RateLimiter::ptr getRateLimiter() const { return m_rateLimiter;}
+
+    /**
+     * @brief 返回客户端连接的统计组
+     * @details start()时按服务器名称创建，之前为空
+     */
+    SocketStatsGroup::ptr getSocketStats() const { return m_stats;}
 
     /**
      * @brief 启动服务
@@ -106,7 +143,18 @@ protected:
      * @brief 开始接受连接
      */
     virtual void startAccept(Socket::ptr sock);
-    
+
+    /**
+     * @brief 完成TLS握手后交给dispatchClient
+     */
+    void handshakeClient(SSLSocket::ptr client);
+
+    /**
+     * @brief 把通过限流(SSL连接还要完成握手)的新连接分配给IO调度器
+     * @details 默认调度到m_ioWorker上执行handleClient，子类可以重载以选择其他调度器
+     */
+    virtual void dispatchClient(Socket::ptr client);
+
 protected:
     /// 监听Socket数组
     std::vector<Socket::ptr> m_socks;
@@ -114,6 +162,8 @@ protected:
     IOManager* m_ioWorker;
     /// 服务器Socket接收连接的调度器
     IOManager* m_acceptWorker;
+    /// 执行TLS握手的调度器
+    IOManager* m_handshakeWorker = nullptr;
     /// 接收超时时间(毫秒)
     uint64_t m_recvTimeout;
     /// 服务器名称
@@ -122,6 +172,12 @@ protected:
     std::string m_type;
     /// 服务是否停止
     bool m_isStop;
+    /// 是否使用TLS
+    bool m_ssl = false;
+    /// 接入限流器
+    RateLimiter::ptr m_rateLimiter;
+    /// 客户端连接的统计组
+    SocketStatsGroup::ptr m_stats;
 };
 
 }
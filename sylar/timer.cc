@@ -1,6 +1,8 @@
 #include "timer.h"
 #include "util.h"
 #include "macro.h"
+#include "probe.h"
+#include "flight_recorder.h"
 
 namespace sylar {
 
@@ -170,6 +172,9 @@ void TimerManager::listExpiredCb(std::vector<std::function<void()> >& cbs) {
     cbs.reserve(expired.size());
 
     for(auto& timer : expired) {
+        // 最后一个参数是实际触发比预定时间晚了多少毫秒
+        SYLAR_PROBE3(timer_fire, timer.get(), timer->m_ms, (int64_t)(now_ms - timer->m_next));
+        FlightRecorder::Record(FlightRecorder::TIMER_FIRE, (int32_t)(now_ms - timer->m_next), timer->m_ms);
         cbs.push_back(timer->m_cb);
         if(timer->m_recurring) {
             timer->m_next = now_ms + timer->m_ms;
@@ -209,4 +214,9 @@ bool TimerManager::hasTimer() {
     return !m_timers.empty();
 }
 
+size_t TimerManager::getTimerCount() {
+    RWMutexType::ReadLock lock(m_mutex);
+    return m_timers.size();
+}
+
 }
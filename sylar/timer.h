@@ -136,6 +136,11 @@ public:
      * @brief 是否有定时器
      */
     bool hasTimer();
+
+    /**
+     * @brief 返回定时器个数
+     */
+    size_t getTimerCount();
 protected:
 
     /**
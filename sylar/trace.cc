@@ -0,0 +1,453 @@
+/**
+ * @file trace.cc
+ * @brief 分布式链路追踪实现
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "trace.h"
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include "config.h"
+#include "fiber.h"
+#include "json.h"
+#include "log.h"
+#include "util.h"
+
+namespace sylar {
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_NAME("system");
+
+static sylar::ConfigVar<double>::ptr g_trace_sample_rate =
+    sylar::Config::Lookup("trace.sample_rate", 0.0, "trace head sampling rate [0, 1]");
+
+static sylar::ConfigVar<std::string>::ptr g_trace_exporter =
+    sylar::Config::Lookup("trace.exporter", std::string(""), "trace exporter, file:<path> or udp:<host:port>");
+
+static sylar::ConfigVar<uint32_t>::ptr g_trace_ring_size =
+    sylar::Config::Lookup("trace.ring_size", (uint32_t)4096, "spans buffered per thread");
+
+static sylar::ConfigVar<uint32_t>::ptr g_trace_flush_interval =
+    sylar::Config::Lookup("trace.flush_interval", (uint32_t)100, "trace exporter flush interval ms");
+
+static sylar::ConfigVar<std::string>::ptr g_trace_service =
+    sylar::Config::Lookup("trace.service", std::string("sylar"), "service name in exported spans");
+
+/// UDP导出时单个报文的最大长度
+static const size_t s_udp_payload = 1400;
+
+/**
+ * @brief 线程局部的xorshift64*随机数，用于生成id和采样
+ */
+static uint64_t Rand() {
+    static thread_local uint64_t t_state = 0;
+    if(!t_state) {
+        t_state = (GetCurrentUS() << 16) ^ ((uint64_t)GetThreadId() << 40)
+                    ^ (uint64_t)(uintptr_t)&t_state;
+        t_state |= 1;
+    }
+    t_state ^= t_state >> 12;
+    t_state ^= t_state << 25;
+    t_state ^= t_state >> 27;
+    return t_state * 0x2545F4914F6CDD1DULL;
+}
+
+static uint64_t RandId() {
+    uint64_t v;
+    while(!(v = Rand()));
+    return v;
+}
+
+static void ToHex(std::string& str, uint64_t v) {
+    static const char* s_hex = "0123456789abcdef";
+    for(int i = 60; i >= 0; i -= 4) {
+        str += s_hex[(v >> i) & 0xf];
+    }
+}
+
+/**
+ * @brief 解析定长的十六进制串
+ */
+static bool FromHex(const char* p, size_t len, uint64_t& v) {
+    v = 0;
+    for(size_t i = 0; i < len; ++i) {
+        char c = p[i];
+        int d;
+        if(c >= '0' && c <= '9') {
+            d = c - '0';
+        } else if(c >= 'a' && c <= 'f') {
+            d = c - 'a' + 10;
+        } else if(c >= 'A' && c <= 'F') {
+            d = c - 'A' + 10;
+        } else {
+            return false;
+        }
+        v = (v << 4) | d;
+    }
+    return true;
+}
+
+std::string SpanContext::getTraceId() const {
+    std::string str;
+    str.reserve(32);
+    ToHex(str, traceIdHigh);
+    ToHex(str, traceIdLow);
+    return str;
+}
+
+std::string SpanContext::toTraceparent() const {
+    std::string str;
+    str.reserve(55);
+    str += "00-";
+    ToHex(str, traceIdHigh);
+    ToHex(str, traceIdLow);
+    str += '-';
+    ToHex(str, spanId);
+    str += sampled ? "-01" : "-00";
+    return str;
+}
+
+bool SpanContext::FromTraceparent(const std::string& str, SpanContext& ctx) {
+    // version-traceid-parentid-flags，更高版本可能在后面追加字段
+    if(str.size() < 55 || str[2] != '-' || str[35] != '-' || str[52] != '-'
+            || (str.size() > 55 && str[55] != '-')) {
+        return false;
+    }
+    uint64_t version, flags;
+    SpanContext tmp;
+    if(!FromHex(&str[0], 2, version) || version == 0xff
+            || (version == 0 && str.size() != 55)
+            || !FromHex(&str[3], 16, tmp.traceIdHigh)
+            || !FromHex(&str[19], 16, tmp.traceIdLow)
+            || !FromHex(&str[36], 16, tmp.spanId)
+            || !FromHex(&str[53], 2, flags)
+            || !tmp.isValid()) {
+        return false;
+    }
+    tmp.sampled = flags & 0x01;
+    ctx = tmp;
+    return true;
+}
+
+Span::Span(const std::string& name, Kind kind) {
+    init(name, nullptr, kind);
+}
+
+Span::Span(const std::string& name, const SpanContext& parent, Kind kind) {
+    init(name, &parent, kind);
+}
+
+Span::~Span() {
+    end();
+}
+
+void Span::init(const std::string& name, const SpanContext* parent, Kind kind) {
+    m_kind = kind;
+    Fiber::ptr fiber = Fiber::GetThis();
+    m_prev = fiber->getSpan();
+    if(!parent && m_prev) {
+        parent = &m_prev->m_ctx;
+    }
+    if(parent && parent->isValid()) {
+        m_ctx.traceIdHigh = parent->traceIdHigh;
+        m_ctx.traceIdLow = parent->traceIdLow;
+        m_ctx.sampled = parent->sampled;
+        m_parentId = parent->spanId;
+    } else {
+        m_ctx.traceIdHigh = Rand();
+        m_ctx.traceIdLow = RandId();
+        m_ctx.sampled = TracerMgr::GetInstance()->shouldSample();
+    }
+    m_ctx.spanId = RandId();
+    if(m_ctx.sampled) {
+        m_name = name;
+        m_start = GetCurrentUS();
+    }
+    fiber->setSpan(this);
+}
+
+void Span::end() {
+    if(m_ended) {
+        return;
+    }
+    m_ended = true;
+    Fiber::ptr fiber = Fiber::GetThis();
+    if(fiber->getSpan() == this) {
+        fiber->setSpan(m_prev);
+    }
+    if(!m_ctx.sampled) {
+        return;
+    }
+    SpanRecord rec;
+    rec.traceIdHigh = m_ctx.traceIdHigh;
+    rec.traceIdLow = m_ctx.traceIdLow;
+    rec.spanId = m_ctx.spanId;
+    rec.parentId = m_parentId;
+    rec.startUs = m_start;
+    rec.durationUs = GetCurrentUS() - m_start;
+    rec.status = m_status;
+    rec.threadId = GetThreadId();
+    rec.kind = m_kind;
+    size_t len = std::min(m_name.size(), sizeof(rec.name) - 1);
+    memcpy(rec.name, m_name.c_str(), len);
+    rec.name[len] = '\0';
+    TracerMgr::GetInstance()->submit(rec);
+}
+
+Span* Span::GetCurrent() {
+    return Fiber::GetThis()->getSpan();
+}
+
+SpanRing::SpanRing(size_t capacity) {
+    size_t size = 1;
+    while(size < capacity) {
+        size <<= 1;
+    }
+    m_buf.resize(size);
+    m_mask = size - 1;
+}
+
+bool SpanRing::push(const SpanRecord& rec) {
+    uint64_t head = m_head.load(std::memory_order_relaxed);
+    if(head - m_tail.load(std::memory_order_acquire) > m_mask) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    m_buf[head & m_mask] = rec;
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+size_t SpanRing::drain(std::vector<SpanRecord>& out) {
+    uint64_t tail = m_tail.load(std::memory_order_relaxed);
+    uint64_t head = m_head.load(std::memory_order_acquire);
+    for(uint64_t i = tail; i < head; ++i) {
+        out.push_back(m_buf[i & m_mask]);
+    }
+    m_tail.store(head, std::memory_order_release);
+    return head - tail;
+}
+
+bool SpanRing::empty() const {
+    return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief 线程退出时标记缓冲，由导出线程取完后回收
+ */
+struct SpanRingHolder {
+    ~SpanRingHolder() {
+        if(ring) {
+            ring->setDead();
+        }
+    }
+    SpanRing::ptr ring;
+};
+
+static thread_local SpanRingHolder t_ring;
+
+Tracer::Tracer() {
+}
+
+Tracer::~Tracer() {
+    stop();
+}
+
+bool Tracer::shouldSample() {
+    if(!m_enabled.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    double rate = m_sampleRate.load(std::memory_order_relaxed);
+    if(rate >= 1) {
+        return true;
+    }
+    if(rate <= 0) {
+        return false;
+    }
+    return (Rand() >> 11) * (1.0 / 9007199254740992.0) < rate;
+}
+
+SpanRing* Tracer::getRing() {
+    if(!t_ring.ring) {
+        t_ring.ring = std::make_shared<SpanRing>(g_trace_ring_size->getValue());
+        MutexType::Lock lock(m_mutex);
+        m_rings.push_back(t_ring.ring);
+    }
+    return t_ring.ring.get();
+}
+
+void Tracer::submit(const SpanRecord& rec) {
+    // 上游要求采样但本进程没有导出目标时不记录，采样标记照常向下游传播
+    if(!m_enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    getRing()->push(rec);
+}
+
+bool Tracer::setExporter(const std::string& target) {
+    stop();
+    if(target.empty()) {
+        return true;
+    }
+    MutexType::Lock lock(m_exportMutex);
+    if(target.compare(0, 5, "file:") == 0) {
+        m_file = fopen(target.c_str() + 5, "a");
+        if(!m_file) {
+            SYLAR_LOG_ERROR(g_logger) << "trace exporter open " << target
+                << " fail errno=" << errno << " errstr=" << strerror(errno);
+            return false;
+        }
+    } else if(target.compare(0, 4, "udp:") == 0) {
+        m_addr = Address::LookupAny(target.substr(4));
+        if(m_addr) {
+            m_sock = Socket::CreateUDP(m_addr);
+        }
+        if(!m_sock) {
+            SYLAR_LOG_ERROR(g_logger) << "trace exporter invalid udp address " << target;
+            m_addr.reset();
+            return false;
+        }
+    } else {
+        SYLAR_LOG_ERROR(g_logger) << "trace exporter invalid target " << target;
+        return false;
+    }
+    m_enabled = true;
+    m_running = true;
+    m_thread.reset(new Thread(std::bind(&Tracer::run, this), "trace_export"));
+    SYLAR_LOG_INFO(g_logger) << "trace exporter " << target
+        << " sample_rate=" << m_sampleRate;
+    return true;
+}
+
+void Tracer::stop() {
+    m_enabled = false;
+    if(m_running) {
+        m_running = false;
+        m_thread->join();
+        m_thread.reset();
+    }
+    flush();
+    MutexType::Lock lock(m_exportMutex);
+    if(m_file) {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+    m_sock.reset();
+    m_addr.reset();
+}
+
+void Tracer::run() {
+    while(m_running) {
+        flush();
+        usleep(g_trace_flush_interval->getValue() * 1000);
+    }
+}
+
+size_t Tracer::flush() {
+    MutexType::Lock elock(m_exportMutex);
+    std::vector<SpanRing::ptr> rings;
+    {
+        MutexType::Lock lock(m_mutex);
+        rings = m_rings;
+    }
+    std::vector<SpanRecord> recs;
+    for(auto& i : rings) {
+        i->drain(recs);
+    }
+    {
+        // 线程已退出且取空的缓冲不会再有写入，可以回收
+        MutexType::Lock lock(m_mutex);
+        for(auto it = m_rings.begin(); it != m_rings.end();) {
+            if(!(*it)->isAlive() && (*it)->empty()) {
+                m_deadDropped += (*it)->getDropped();
+                it = m_rings.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    if(!recs.empty()) {
+        write(recs);
+        m_exported += recs.size();
+    }
+    return recs.size();
+}
+
+uint64_t Tracer::getDropped() {
+    MutexType::Lock lock(m_mutex);
+    uint64_t v = m_deadDropped;
+    for(auto& i : m_rings) {
+        v += i->getDropped();
+    }
+    return v;
+}
+
+static const char* KindToString(uint8_t kind) {
+    switch(kind) {
+        case Span::SERVER:
+            return "server";
+        case Span::CLIENT:
+            return "client";
+        default:
+            return "internal";
+    }
+}
+
+void Tracer::write(const std::vector<SpanRecord>& recs) {
+    std::string service;
+    const std::string& name = g_trace_service->getValue();
+    JsonWriter::AppendString(service, name.c_str(), name.size());
+    std::string buf;
+    std::string line;
+    for(auto& r : recs) {
+        line = "{\"service\":" + service + ",\"trace_id\":\"";
+        ToHex(line, r.traceIdHigh);
+        ToHex(line, r.traceIdLow);
+        line += "\",\"span_id\":\"";
+        ToHex(line, r.spanId);
+        line += "\",\"parent_id\":\"";
+        if(r.parentId) {
+            ToHex(line, r.parentId);
+        }
+        line += "\",\"name\":";
+        JsonWriter::AppendString(line, r.name, strlen(r.name));
+        line += ",\"kind\":\"";
+        line += KindToString(r.kind);
+        line += "\",\"start_us\":" + std::to_string(r.startUs)
+                + ",\"duration_us\":" + std::to_string(r.durationUs)
+                + ",\"status\":" + std::to_string(r.status)
+                + ",\"thread\":" + std::to_string(r.threadId) + "}\n";
+        if(m_file) {
+            fwrite(line.c_str(), 1, line.size(), m_file);
+        } else if(m_sock) {
+            // 多个span拼进一个报文，单行不拆分
+            if(!buf.empty() && buf.size() + line.size() > s_udp_payload) {
+                m_sock->sendTo(buf.c_str(), buf.size(), m_addr);
+                buf.clear();
+            }
+            buf += line;
+        }
+    }
+    if(m_file) {
+        fflush(m_file);
+    } else if(m_sock && !buf.empty()) {
+        m_sock->sendTo(buf.c_str(), buf.size(), m_addr);
+    }
+}
+
+struct TraceIniter {
+    TraceIniter() {
+        TracerMgr::GetInstance()->setSampleRate(g_trace_sample_rate->getValue());
+        TracerMgr::GetInstance()->setExporter(g_trace_exporter->getValue());
+        g_trace_sample_rate->addListener([](const double& old_value, const double& new_value) {
+            TracerMgr::GetInstance()->setSampleRate(new_value);
+        });
+        g_trace_exporter->addListener([](const std::string& old_value, const std::string& new_value) {
+            TracerMgr::GetInstance()->setExporter(new_value);
+        });
+    }
+};
+
+static TraceIniter __trace_init;
+
+}
@@ -0,0 +1,346 @@
+/**
+ * @file trace.h
+ * @brief 分布式链路追踪
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#ifndef __SYLAR_TRACE_H__
+#define __SYLAR_TRACE_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include "mutex.h"
+#include "noncopyable.h"
+#include "singleton.h"
+#include "socket.h"
+#include "thread.h"
+
+namespace sylar {
+
+/**
+ * @brief 跨进程传递的调用链上下文，对应W3C traceparent
+ */
+struct SpanContext {
+    /// trace id高64位
+    uint64_t traceIdHigh = 0;
+    /// trace id低64位
+    uint64_t traceIdLow = 0;
+    /// span id
+    uint64_t spanId = 0;
+    /// 是否采样
+    bool sampled = false;
+
+    /**
+     * @brief 是否有效，全0的trace id和span id无效
+     */
+    bool isValid() const { return (traceIdHigh || traceIdLow) && spanId;}
+
+    /**
+     * @brief 输出traceparent头部的值，如 00-<32位trace id>-<16位span id>-01
+     */
+    std::string toTraceparent() const;
+
+    /**
+     * @brief 返回32位十六进制的trace id
+     */
+    std::string getTraceId() const;
+
+    /**
+     * @brief 解析traceparent头部
+     * @param[out] ctx 解析结果
+     * @return 格式不合法返回false
+     */
+    static bool FromTraceparent(const std::string& str, SpanContext& ctx);
+};
+
+/**
+ * @brief 已结束的span，定长结构，直接写入线程的环形缓冲
+ */
+struct SpanRecord {
+    uint64_t traceIdHigh;
+    uint64_t traceIdLow;
+    uint64_t spanId;
+    /// 父span id，根span为0
+    uint64_t parentId;
+    /// 开始时间(微秒)
+    uint64_t startUs;
+    /// 耗时(微秒)
+    uint32_t durationUs;
+    /// 状态，HTTP span为状态码
+    int32_t status;
+    /// 线程id
+    int32_t threadId;
+    /// Span::Kind
+    uint8_t kind;
+    /// span名称，超长截断
+    char name[75];
+};
+
+/**
+ * @brief 一段被追踪的调用
+ * @details 在栈上创建，构造时成为当前协程的活动span，析构(或end)时恢复之前的span。
+ *          未指定父span时以当前协程的活动span为父，没有活动span时开始新的调用链并决定是否采样，
+ *          子span沿用父span的采样结果。未采样的span只生成id用于传播，不记录
+ */
+class Span : Noncopyable {
+public:
+    /**
+     * @brief span类型
+     */
+    enum Kind {
+        /// 进程内调用
+        INTERNAL = 0,
+        /// 处理远端发来的请求
+        SERVER = 1,
+        /// 向远端发出的请求
+        CLIENT = 2
+    };
+
+    /**
+     * @brief 以当前协程的活动span为父创建span
+     * @param[in] name span名称
+     * @param[in] kind span类型
+     */
+    Span(const std::string& name, Kind kind = INTERNAL);
+
+    /**
+     * @brief 以远端传来的上下文为父创建span
+     * @param[in] parent 远端上下文，无效时开始新的调用链
+     */
+    Span(const std::string& name, const SpanContext& parent, Kind kind = SERVER);
+
+    /**
+     * @brief 析构函数，未结束时结束span
+     */
+    ~Span();
+
+    /**
+     * @brief 结束span，写入当前线程的缓冲
+     */
+    void end();
+
+    /**
+     * @brief 设置状态
+     */
+    void setStatus(int32_t v) { m_status = v;}
+
+    /**
+     * @brief 返回上下文，用于向下游传播
+     */
+    const SpanContext& getContext() const { return m_ctx;}
+
+    /**
+     * @brief 返回父span id
+     */
+    uint64_t getParentId() const { return m_parentId;}
+
+    /**
+     * @brief 是否被采样记录
+     */
+    bool isRecording() const { return m_ctx.sampled;}
+
+    /**
+     * @brief 返回当前协程的活动span，没有时返回nullptr
+     */
+    static Span* GetCurrent();
+private:
+    /**
+     * @brief 初始化并设为当前协程的活动span
+     */
+    void init(const std::string& name, const SpanContext* parent, Kind kind);
+private:
+    /// 上下文
+    SpanContext m_ctx;
+    /// 父span id
+    uint64_t m_parentId = 0;
+    /// 开始时间(微秒)
+    uint64_t m_start = 0;
+    /// 状态
+    int32_t m_status = 0;
+    /// 类型
+    Kind m_kind;
+    /// 是否已结束
+    bool m_ended = false;
+    /// 之前的活动span
+    Span* m_prev = nullptr;
+    /// 名称，只有采样时保存
+    std::string m_name;
+};
+
+/**
+ * @brief 单个线程的span环形缓冲
+ * @details 单生产者单消费者：所属线程写入，导出线程读取，满了直接丢弃
+ */
+class SpanRing {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<SpanRing> ptr;
+
+    /**
+     * @brief 构造函数
+     * @param[in] capacity 容量，向上取整为2的幂
+     */
+    SpanRing(size_t capacity);
+
+    /**
+     * @brief 写入一条记录，只能由所属线程调用
+     * @return 缓冲已满返回false
+     */
+    bool push(const SpanRecord& rec);
+
+    /**
+     * @brief 取出全部记录，只能由一个消费者调用
+     * @return 取出的条数
+     */
+    size_t drain(std::vector<SpanRecord>& out);
+
+    /**
+     * @brief 是否没有待取出的记录
+     */
+    bool empty() const;
+
+    /**
+     * @brief 返回丢弃的记录数
+     */
+    uint64_t getDropped() const { return m_dropped;}
+
+    /**
+     * @brief 所属线程是否还在运行
+     */
+    bool isAlive() const { return m_alive;}
+
+    /**
+     * @brief 所属线程退出时调用
+     */
+    void setDead() { m_alive = false;}
+private:
+    /// 缓冲区
+    std::vector<SpanRecord> m_buf;
+    /// 容量减一
+    size_t m_mask;
+    /// 写位置，只有所属线程修改
+    std::atomic<uint64_t> m_head = {0};
+    /// 避免读写位置共享缓存行
+    char m_pad[64];
+    /// 读位置，只有消费者修改
+    std::atomic<uint64_t> m_tail = {0};
+    /// 丢弃的记录数
+    std::atomic<uint64_t> m_dropped = {0};
+    /// 所属线程是否还在运行
+    std::atomic<bool> m_alive = {true};
+};
+
+/**
+ * @brief 链路追踪器，负责采样决策和后台导出
+ * @details 导出目标由配置trace.exporter指定：
+ *          file:/path/spans.log 追加写入文件，udp:127.0.0.1:6831 发送到本地收集器，
+ *          为空时不导出，也不采样。每个span导出为一行JSON
+ */
+class Tracer : Noncopyable {
+public:
+    /// 互斥锁类型定义
+    typedef Mutex MutexType;
+
+    Tracer();
+
+    ~Tracer();
+
+    /**
+     * @brief 新的调用链是否采样
+     */
+    bool shouldSample();
+
+    /**
+     * @brief 提交已结束的span，写入当前线程的缓冲
+     */
+    void submit(const SpanRecord& rec);
+
+    /**
+     * @brief 设置导出目标，会重启导出线程
+     * @param[in] target 导出目标，为空时停止导出
+     * @return 目标格式不合法或无法打开时返回false
+     */
+    bool setExporter(const std::string& target);
+
+    /**
+     * @brief 设置采样率，[0, 1]
+     */
+    void setSampleRate(double v) { m_sampleRate = v;}
+
+    /**
+     * @brief 返回采样率
+     */
+    double getSampleRate() const { return m_sampleRate;}
+
+    /**
+     * @brief 立即把各线程缓冲中的span写到导出目标
+     * @return 导出的span数
+     */
+    size_t flush();
+
+    /**
+     * @brief 停止导出线程，停止前导出剩余的span
+     */
+    void stop();
+
+    /**
+     * @brief 返回已导出的span数
+     */
+    uint64_t getExported() const { return m_exported;}
+
+    /**
+     * @brief 返回因缓冲满丢弃的span数
+     */
+    uint64_t getDropped();
+private:
+    /**
+     * @brief 返回当前线程的缓冲，第一次调用时创建并登记
+     */
+    SpanRing* getRing();
+
+    /**
+     * @brief 导出线程
+     */
+    void run();
+
+    /**
+     * @brief 把一批记录写到导出目标
+     */
+    void write(const std::vector<SpanRecord>& recs);
+private:
+    /// 保护缓冲列表
+    MutexType m_mutex;
+    /// 保护导出目标，同一时间只有一个消费者
+    MutexType m_exportMutex;
+    /// 各线程的缓冲
+    std::vector<SpanRing::ptr> m_rings;
+    /// 采样率，没有导出目标时不采样
+    std::atomic<double> m_sampleRate = {0};
+    /// 是否有导出目标
+    std::atomic<bool> m_enabled = {false};
+    /// 导出线程是否运行
+    std::atomic<bool> m_running = {false};
+    /// 导出线程
+    Thread::ptr m_thread;
+    /// 文件导出目标
+    FILE* m_file = nullptr;
+    /// UDP导出目标
+    Socket::ptr m_sock;
+    /// UDP收集器地址
+    Address::ptr m_addr;
+    /// 已导出的span数
+    std::atomic<uint64_t> m_exported = {0};
+    /// 已退出线程的缓冲丢弃的span数
+    uint64_t m_deadDropped = 0;
+};
+
+/// 链路追踪器单例
+typedef sylar::Singleton<Tracer> TracerMgr;
+
+}
+
+#endif
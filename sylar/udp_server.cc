@@ -0,0 +1,327 @@
+/**
+ * @file udp_server.cc
+ * @brief UDP服务器的封装实现
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "udp_server.h"
+#include <limits.h>
+#include <sys/socket.h>
+#include <string.h>
+#include "config.h"
+#include "fiber.h"
+#include "log.h"
+
+namespace sylar {
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_NAME("system");
+
+static sylar::ConfigVar<uint32_t>::ptr g_udp_server_batch_size =
+    sylar::Config::Lookup("udp_server.batch_size", (uint32_t)32,
+            "udp server max datagrams per recvmmsg");
+
+static sylar::ConfigVar<uint32_t>::ptr g_udp_server_max_packet_size =
+    sylar::Config::Lookup("udp_server.max_packet_size", (uint32_t)8192,
+            "udp server max datagram size, larger datagrams are dropped");
+
+/**
+ * @brief 等待fd上的事件
+ * @details recvmmsg/sendmmsg没有被hook，EAGAIN时需要自己挂到IOManager上等待；
+ *          接收协程在服务器停止前一直等下去，stop时cancelAll唤醒，所以不设超时
+ */
+static bool WaitEvent(int fd, IOManager::Event event) {
+    IOManager* iom = IOManager::GetThis();
+    if(!iom || iom->addEvent(fd, event)) {
+        return false;
+    }
+    Fiber::GetThis()->yield();
+    return true;
+}
+
+/**
+ * @brief 返回socket实际绑定的地址，绑定端口0时各worker需要复用第一个socket拿到的端口
+ */
+static Address::ptr BoundAddress(Socket::ptr sock) {
+    sockaddr_storage addr;
+    socklen_t len = sizeof(addr);
+    if(getsockname(sock->getSocket(), (sockaddr*)&addr, &len)) {
+        return nullptr;
+    }
+    return Address::Create((const sockaddr*)&addr, len);
+}
+
+UdpChannel::UdpChannel(Socket::ptr sock, IOManager* worker)
+    :m_sock(sock)
+    ,m_worker(worker) {
+}
+
+bool UdpChannel::sendTo(const std::string& data, Address::ptr to) {
+    {
+        MutexType::Lock lock(m_mutex);
+        if(!m_sock->isValid()) {
+            return false;
+        }
+        m_queue.push_back(OutPacket{data, to});
+        if(m_sending || m_holding) {
+            return true;
+        }
+        m_sending = true;
+    }
+    flush();
+    return true;
+}
+
+void UdpChannel::hold() {
+    MutexType::Lock lock(m_mutex);
+    m_holding = true;
+}
+
+void UdpChannel::release() {
+    {
+        MutexType::Lock lock(m_mutex);
+        m_holding = false;
+        if(m_sending || m_queue.empty()) {
+            return;
+        }
+        m_sending = true;
+    }
+    flush();
+}
+
+void UdpChannel::flush() {
+    int fd = m_sock->getSocket();
+    std::vector<OutPacket> out;
+    std::vector<mmsghdr> msgs;
+    std::vector<iovec> iovs;
+    while(true) {
+        {
+            MutexType::Lock lock(m_mutex);
+            if(m_queue.empty()) {
+                m_sending = false;
+                return;
+            }
+            out.swap(m_queue);
+        }
+        msgs.resize(out.size());
+        iovs.resize(out.size());
+        for(size_t i = 0; i < out.size(); ++i) {
+            iovs[i].iov_base = (void*)out[i].data.c_str();
+            iovs[i].iov_len = out[i].data.size();
+            memset(&msgs[i], 0, sizeof(msgs[i]));
+            msgs[i].msg_hdr.msg_name = out[i].to->getAddr();
+            msgs[i].msg_hdr.msg_namelen = out[i].to->getAddrLen();
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        size_t sent = 0;
+        while(sent < out.size()) {
+            int n = sendmmsg(fd, &msgs[sent], std::min(out.size() - sent, (size_t)IOV_MAX)
+                             , MSG_DONTWAIT);
+            if(n > 0) {
+                sent += n;
+                continue;
+            }
+            if(errno == EINTR) {
+                continue;
+            }
+            if(errno == EAGAIN && WaitEvent(fd, IOManager::WRITE)) {
+                continue;
+            }
+            if(errno == EBADF || errno == EAGAIN) {
+                // socket已关闭，或不在IOManager中无法等待，丢弃本批剩余的数据报
+                SYLAR_LOG_DEBUG(g_logger) << "sendmmsg drop " << (out.size() - sent)
+                    << " datagrams errno=" << errno << " errstr=" << strerror(errno);
+                break;
+            }
+            // 单个数据报出错(例如目标地址不可用)时跳过它，不影响后面的数据报
+            SYLAR_LOG_DEBUG(g_logger) << "sendmmsg to " << *out[sent].to
+                << " errno=" << errno << " errstr=" << strerror(errno);
+            ++sent;
+        }
+        out.clear();
+    }
+}
+
+UdpServer::UdpServer(const std::vector<sylar::IOManager*>& io_workers)
+    :m_ioWorkers(io_workers)
+    ,m_batchSize(g_udp_server_batch_size->getValue())
+    ,m_maxPacketSize(g_udp_server_max_packet_size->getValue())
+    ,m_name("sylar/1.0.0")
+    ,m_type("udp")
+    ,m_isStop(true) {
+    if(m_batchSize == 0) {
+        m_batchSize = 1;
+    }
+}
+
+UdpServer::UdpServer(sylar::IOManager* io_worker)
+    :UdpServer(std::vector<sylar::IOManager*>{io_worker}) {
+}
+
+UdpServer::~UdpServer() {
+    for(auto& i : m_channels) {
+        i->getSocket()->close();
+    }
+    m_channels.clear();
+}
+
+bool UdpServer::bind(sylar::Address::ptr addr) {
+    std::vector<Address::ptr> addrs;
+    std::vector<Address::ptr> fails;
+    addrs.push_back(addr);
+    return bind(addrs, fails);
+}
+
+bool UdpServer::bind(const std::vector<Address::ptr>& addrs
+                        ,std::vector<Address::ptr>& fails) {
+    for(auto& addr : addrs) {
+        Address::ptr bind_addr = addr;
+        std::vector<UdpChannel::ptr> channels;
+        for(auto& worker : m_ioWorkers) {
+            Socket::ptr sock = Socket::CreateUDP(bind_addr);
+            int val = 1;
+            sock->setOption(SOL_SOCKET, SO_REUSEPORT, val);
+            if(!sock->bind(bind_addr)) {
+                SYLAR_LOG_ERROR(g_logger) << "bind fail errno="
+                    << errno << " errstr=" << strerror(errno)
+                    << " addr=[" << bind_addr->toString() << "]";
+                fails.push_back(addr);
+                channels.clear();
+                break;
+            }
+            if(channels.empty()) {
+                Address::ptr bound = BoundAddress(sock);
+                if(bound) {
+                    bind_addr = bound;
+                }
+            }
+            channels.push_back(std::make_shared<UdpChannel>(sock, worker));
+        }
+        m_channels.insert(m_channels.end(), channels.begin(), channels.end());
+    }
+
+    if(!fails.empty()) {
+        m_channels.clear();
+        return false;
+    }
+
+    for(auto& i : m_channels) {
+        SYLAR_LOG_INFO(g_logger) << "type=" << m_type
+            << " name=" << m_name
+            << " server bind success: " << *i->getSocket();
+    }
+    return true;
+}
+
+void UdpServer::startReceive(UdpChannel::ptr channel) {
+    int fd = channel->getSocket()->getSocket();
+    size_t batch = m_batchSize;
+    size_t psize = m_maxPacketSize;
+    std::string buffer(batch * psize, '\0');
+    std::vector<mmsghdr> msgs(batch);
+    std::vector<iovec> iovs(batch);
+    std::vector<sockaddr_storage> addrs(batch);
+    while(!m_isStop) {
+        for(size_t i = 0; i < batch; ++i) {
+            iovs[i].iov_base = &buffer[i * psize];
+            iovs[i].iov_len = psize;
+            memset(&msgs[i], 0, sizeof(msgs[i]));
+            msgs[i].msg_hdr.msg_name = &addrs[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        int n = recvmmsg(fd, &msgs[0], batch, MSG_DONTWAIT, nullptr);
+        if(n < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            if(errno == EAGAIN && WaitEvent(fd, IOManager::READ)) {
+                continue;
+            }
+            if(!m_isStop) {
+                SYLAR_LOG_ERROR(g_logger) << "recvmmsg errno=" << errno
+                    << " errstr=" << strerror(errno) << " " << *channel->getSocket();
+            }
+            break;
+        }
+
+        // 同一批数据报的回复攒到一起，处理完再用一次sendmmsg发出
+        if(m_inline) {
+            channel->hold();
+        }
+        for(int i = 0; i < n; ++i) {
+            if(msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+                SYLAR_LOG_DEBUG(g_logger) << "drop truncated datagram, max_packet_size="
+                    << psize;
+                continue;
+            }
+            UdpPacket::ptr packet(new UdpPacket);
+            packet->data.assign(&buffer[i * psize], msgs[i].msg_len);
+            packet->from = Address::Create((const sockaddr*)&addrs[i]
+                                           ,msgs[i].msg_hdr.msg_namelen);
+            packet->channel = channel;
+            if(m_inline) {
+                handlePacket(packet);
+            } else {
+                channel->getWorker()->schedule(std::bind(&UdpServer::handlePacket,
+                            shared_from_this(), packet));
+            }
+        }
+        if(m_inline) {
+            channel->release();
+        }
+    }
+}
+
+bool UdpServer::start() {
+    if(!m_isStop) {
+        return true;
+    }
+    m_isStop = false;
+    for(auto& channel : m_channels) {
+        channel->getWorker()->schedule(std::bind(&UdpServer::startReceive,
+                    shared_from_this(), channel));
+    }
+    return true;
+}
+
+void UdpServer::stop() {
+    m_isStop = true;
+    auto self = shared_from_this();
+    std::vector<UdpChannel::ptr> channels;
+    channels.swap(m_channels);
+    for(auto& channel : channels) {
+        // 在socket所属的worker上取消事件，唤醒阻塞中的接收协程
+        channel->getWorker()->schedule([self, channel]() {
+            channel->getSocket()->cancelAll();
+            channel->getSocket()->close();
+        });
+    }
+}
+
+void UdpServer::handlePacket(UdpPacket::ptr packet) {
+    SYLAR_LOG_INFO(g_logger) << "handlePacket: " << packet->data.size()
+        << " bytes from " << *packet->from;
+}
+
+std::string UdpServer::toString(const std::string& prefix) {
+    std::stringstream ss;
+    ss << prefix << "[type=" << m_type
+       << " name=" << m_name
+       << " io_workers=";
+    for(size_t i = 0; i < m_ioWorkers.size(); ++i) {
+        ss << (i ? "," : "") << (m_ioWorkers[i] ? m_ioWorkers[i]->getName() : "");
+    }
+    ss << " inline=" << m_inline
+       << " batch_size=" << m_batchSize
+       << " max_packet_size=" << m_maxPacketSize << "]" << std::endl;
+    std::string pfx = prefix.empty() ? "    " : prefix;
+    for(auto& i : m_channels) {
+        ss << pfx << pfx << *i->getSocket() << std::endl;
+    }
+    return ss.str();
+}
+
+}
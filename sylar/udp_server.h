@@ -0,0 +1,238 @@
+/**
+ * @file udp_server.h
+ * @brief UDP服务器的封装
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#ifndef __SYLAR_UDP_SERVER_H__
+#define __SYLAR_UDP_SERVER_H__
+
+#include <memory>
+#include <functional>
+#include <vector>
+#include "address.h"
+#include "iomanager.h"
+#include "socket.h"
+#include "noncopyable.h"
+#include "mutex.h"
+
+namespace sylar {
+
+/**
+ * @brief 一个IO worker上的UDP socket
+ * @details 同一个地址在每个IO worker上各绑定一个SO_REUSEPORT socket，由内核按四元组把数据报分散到各socket。
+ *          回复先进入发送队列，由第一个发现队列空闲的协程用sendmmsg批量发出
+ */
+class UdpChannel : public std::enable_shared_from_this<UdpChannel>, Noncopyable {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<UdpChannel> ptr;
+    /// 锁类型
+    typedef Mutex MutexType;
+
+    /**
+     * @brief 构造函数
+     * @param[in] sock 已绑定的UDP socket
+     * @param[in] worker socket所属的IO worker
+     */
+    UdpChannel(Socket::ptr sock, IOManager* worker);
+
+    /**
+     * @brief 向to发送一个数据报
+     * @details 只是放入发送队列，hold期间不会立即发送
+     * @return 通道已关闭时返回false
+     */
+    bool sendTo(const std::string& data, Address::ptr to);
+
+    /**
+     * @brief 暂缓发送，之后的sendTo只入队
+     */
+    void hold();
+
+    /**
+     * @brief 取消暂缓，并把队列中积攒的数据报一次发出
+     */
+    void release();
+
+    /**
+     * @brief 返回socket
+     */
+    Socket::ptr getSocket() const { return m_sock;}
+
+    /**
+     * @brief 返回所属的IO worker
+     */
+    IOManager* getWorker() const { return m_worker;}
+
+private:
+    /**
+     * @brief 发送队列中的数据报，直到队列为空
+     */
+    void flush();
+
+private:
+    /**
+     * @brief 待发送的数据报
+     */
+    struct OutPacket {
+        std::string data;
+        Address::ptr to;
+    };
+
+    /// socket
+    Socket::ptr m_sock;
+    /// 所属的IO worker
+    IOManager* m_worker;
+    /// 锁
+    MutexType m_mutex;
+    /// 发送队列
+    std::vector<OutPacket> m_queue;
+    /// 是否有协程正在发送
+    bool m_sending = false;
+    /// 是否暂缓发送
+    bool m_holding = false;
+};
+
+/**
+ * @brief 收到的数据报
+ */
+struct UdpPacket {
+    /// 智能指针类型定义
+    typedef std::shared_ptr<UdpPacket> ptr;
+    /// 数据
+    std::string data;
+    /// 对端地址
+    Address::ptr from;
+    /// 收到数据报的通道
+    UdpChannel::ptr channel;
+
+    /**
+     * @brief 从收到数据报的socket回复对端
+     */
+    bool reply(const std::string& rsp) { return channel->sendTo(rsp, from);}
+};
+
+/**
+ * @brief UDP服务器封装
+ * @details 每个IO worker上的接收协程用recvmmsg批量收包。默认每个数据报在IO worker上新起一个协程调用handlePacket，
+ *          处理中可以做阻塞IO；setInline(true)后在接收协程中直接处理，同一批数据报的回复合并成一次sendmmsg，
+ *          适合指标上报、DNS这类处理简单且不会阻塞的服务。
+ *          要做到按核分片，每个IO worker应当只有一个调度线程
+ */
+class UdpServer : public std::enable_shared_from_this<UdpServer>
+                    , Noncopyable {
+public:
+    /// 智能指针类型定义
+    typedef std::shared_ptr<UdpServer> ptr;
+
+    /**
+     * @brief 构造函数
+     * @param[in] io_workers IO worker列表，每个worker上为每个地址绑定一个socket
+     */
+    UdpServer(const std::vector<sylar::IOManager*>& io_workers);
+
+    /**
+     * @brief 构造函数
+     * @param[in] io_worker 唯一的IO worker
+     */
+    UdpServer(sylar::IOManager* io_worker = sylar::IOManager::GetThis());
+
+    /**
+     * @brief 析构函数
+     */
+    virtual ~UdpServer();
+
+    /**
+     * @brief 绑定地址
+     * @return 返回是否绑定成功
+     */
+    virtual bool bind(sylar::Address::ptr addr);
+
+    /**
+     * @brief 绑定地址数组
+     * @param[in] addrs 需要绑定的地址数组
+     * @param[out] fails 绑定失败的地址
+     * @return 是否绑定成功
+     */
+    virtual bool bind(const std::vector<Address::ptr>& addrs
+                        ,std::vector<Address::ptr>& fails);
+
+    /**
+     * @brief 启动服务
+     * @pre 需要bind成功后执行
+     */
+    virtual bool start();
+
+    /**
+     * @brief 停止服务
+     */
+    virtual void stop();
+
+    /**
+     * @brief 返回服务器名称
+     */
+    std::string getName() const { return m_name;}
+
+    /**
+     * @brief 设置服务器名称
+     */
+    virtual void setName(const std::string& v) { m_name = v;}
+
+    /**
+     * @brief 是否在接收协程中直接处理数据报
+     */
+    bool isInline() const { return m_inline;}
+
+    /**
+     * @brief 设置是否在接收协程中直接处理数据报
+     */
+    void setInline(bool v) { m_inline = v;}
+
+    /**
+     * @brief 是否停止
+     */
+    bool isStop() const { return m_isStop;}
+
+    /**
+     * @brief 返回所有绑定的通道
+     */
+    const std::vector<UdpChannel::ptr>& getChannels() const { return m_channels;}
+
+    /**
+     * @brief 以字符串形式dump server信息
+     */
+    virtual std::string toString(const std::string& prefix = "");
+
+protected:
+    /**
+     * @brief 处理一个数据报
+     */
+    virtual void handlePacket(UdpPacket::ptr packet);
+
+    /**
+     * @brief 在通道上循环收包
+     */
+    virtual void startReceive(UdpChannel::ptr channel);
+
+protected:
+    /// 每个地址在每个IO worker上的通道
+    std::vector<UdpChannel::ptr> m_channels;
+    /// IO worker列表
+    std::vector<IOManager*> m_ioWorkers;
+    /// 单次recvmmsg最多接收的数据报个数
+    uint32_t m_batchSize;
+    /// 单个数据报的最大字节数
+    uint32_t m_maxPacketSize;
+    /// 服务器名称
+    std::string m_name;
+    /// 服务器类型
+    std::string m_type;
+    /// 服务是否停止
+    bool m_isStop;
+    /// 是否在接收协程中直接处理
+    bool m_inline = false;
+};
+
+}
+
+#endif
@@ -0,0 +1,146 @@
+/**
+ * @file test_circuit_breaker.cc
+ * @brief 熔断器测试：连续失败和慢请求熔断、半开探测、并发上限，以及连接池上的熔断
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "sylar/sylar.h"
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_ROOT();
+
+void test_eject() {
+    sylar::CircuitBreaker breaker("eject");
+    uint64_t now = 1000000;
+    for(int i = 0; i < 4; ++i) {
+        SYLAR_ASSERT(breaker.allow(now));
+        breaker.record(false, 100, now);
+    }
+    // 成功的请求清零连续失败次数
+    SYLAR_ASSERT(breaker.allow(now));
+    breaker.record(true, 100, now);
+    for(int i = 0; i < 5; ++i) {
+        SYLAR_ASSERT(breaker.allow(now));
+        breaker.record(false, 100, now);
+    }
+    SYLAR_ASSERT(breaker.getState() == sylar::CircuitBreaker::OPEN);
+    SYLAR_ASSERT(!breaker.allow(now + 29999));
+    SYLAR_ASSERT(breaker.getRejected() == 1);
+
+    // 到期后只放行一个探测请求，探测失败后熔断时长加倍
+    now += 30000;
+    SYLAR_ASSERT(breaker.allow(now));
+    SYLAR_ASSERT(breaker.getState() == sylar::CircuitBreaker::HALF_OPEN);
+    SYLAR_ASSERT(!breaker.allow(now));
+    breaker.record(false, 100, now);
+    SYLAR_ASSERT(breaker.getState() == sylar::CircuitBreaker::OPEN);
+    SYLAR_ASSERT(!breaker.allow(now + 59999));
+
+    // 探测成功后恢复
+    now += 60000;
+    SYLAR_ASSERT(breaker.allow(now));
+    breaker.record(true, 100, now);
+    SYLAR_ASSERT(breaker.getState() == sylar::CircuitBreaker::CLOSED);
+    SYLAR_ASSERT(breaker.getEjections() == 2);
+    SYLAR_ASSERT(breaker.getInflight() == 0);
+
+    // 恢复后稳定运行超过最大熔断时长，熔断时长重新从基础时长开始
+    now += 300001;
+    for(int i = 0; i < 5; ++i) {
+        SYLAR_ASSERT(breaker.allow(now));
+        breaker.record(false, 100, now);
+    }
+    SYLAR_ASSERT(!breaker.allow(now + 29999));
+    SYLAR_ASSERT(breaker.allow(now + 30000));
+    breaker.record(true, 100, now + 30000);
+    SYLAR_LOG_INFO(g_logger) << "eject test ok " << breaker.toString();
+}
+
+void test_slow_and_max() {
+    sylar::Config::Lookup<uint64_t>("circuit_breaker.slow_request_ms")->setValue(100);
+    sylar::Config::Lookup<uint32_t>("circuit_breaker.max_requests")->setValue(2);
+    sylar::CircuitBreaker breaker("slow");
+    sylar::Config::Lookup<uint64_t>("circuit_breaker.slow_request_ms")->setValue(0);
+    sylar::Config::Lookup<uint32_t>("circuit_breaker.max_requests")->setValue(0);
+
+    uint64_t now = 1000000;
+    SYLAR_ASSERT(breaker.allow(now));
+    SYLAR_ASSERT(breaker.allow(now));
+    SYLAR_ASSERT(!breaker.allow(now));
+    breaker.record(true, 1000, now);
+    breaker.record(true, 1000, now);
+    // 成功但超过slow_request_ms的请求也计为失败
+    for(int i = 0; i < 5; ++i) {
+        SYLAR_ASSERT(breaker.allow(now));
+        breaker.record(true, 200 * 1000, now);
+    }
+    SYLAR_ASSERT(breaker.getState() == sylar::CircuitBreaker::OPEN);
+    SYLAR_LOG_INFO(g_logger) << "slow and max test ok " << breaker.toString();
+}
+
+void test_pool() {
+    sylar::http::HttpServer::ptr server(new sylar::http::HttpServer(true));
+    server->addAdminServlets();
+    auto addr = sylar::Address::LookupAnyIPAddress("127.0.0.1:8108");
+    while(!server->bind(addr)) {
+        sleep(2);
+    }
+    auto sd = server->getServletDispatch();
+    sd->addServlet("/fail", [](sylar::http::HttpRequest::ptr req
+                , sylar::http::HttpResponse::ptr rsp
+                , sylar::http::HttpSession::ptr session) {
+        rsp->setStatus(sylar::http::HttpStatus::INTERNAL_SERVER_ERROR);
+        return 0;
+    });
+    sd->addServlet("/ok", [](sylar::http::HttpRequest::ptr req
+                , sylar::http::HttpResponse::ptr rsp
+                , sylar::http::HttpSession::ptr session) {
+        rsp->setBody("ok");
+        return 0;
+    });
+    server->start();
+
+    sylar::Config::Lookup<uint64_t>("circuit_breaker.base_ejection_ms")->setValue(200);
+    auto pool = sylar::http::HttpConnectionPool::Create("http://127.0.0.1:8108", "", 10, 1000 * 60, 100);
+    auto breaker = pool->getCircuitBreaker();
+    for(int i = 0; i < 5; ++i) {
+        auto rt = pool->doGet("/fail", 1000);
+        SYLAR_ASSERT2(rt->result == 0, rt->toString());
+        SYLAR_ASSERT(rt->response->getStatus() == sylar::http::HttpStatus::INTERNAL_SERVER_ERROR);
+    }
+    // 熔断期间请求立即失败，不再访问上游
+    auto rt = pool->doGet("/ok", 1000);
+    SYLAR_ASSERT2(rt->result == (int)sylar::http::HttpResult::Error::CIRCUIT_OPEN, rt->toString());
+    SYLAR_ASSERT(breaker->getState() == sylar::CircuitBreaker::OPEN);
+
+    usleep(250 * 1000);
+    rt = pool->doGet("/ok", 1000);
+    SYLAR_ASSERT(rt->result == 0 && rt->response->getBody() == "ok");
+    SYLAR_ASSERT(breaker->getState() == sylar::CircuitBreaker::CLOSED);
+
+    rt = sylar::http::HttpConnection::DoGet("http://127.0.0.1:8108/_/status", 1000);
+    SYLAR_ASSERT(rt->result == 0);
+    const std::string& status = rt->response->getBody();
+    for(auto& i : {"sylar_circuit_breaker_state{name=\"127.0.0.1:8108\"} 0"
+                   ,"sylar_circuit_breaker_ejections_total{name=\"127.0.0.1:8108\"} 1"
+                   ,"sylar_circuit_breaker_rejected_total{name=\"127.0.0.1:8108\"} 1"}) {
+        if(status.find(i) == std::string::npos) {
+            SYLAR_LOG_ERROR(g_logger) << "missing " << i;
+            SYLAR_ASSERT(false);
+        }
+    }
+    server->stop();
+    SYLAR_LOG_INFO(g_logger) << "pool test ok " << breaker->toString();
+}
+
+void run() {
+    g_logger->setLevel(sylar::LogLevel::INFO);
+    test_pool();
+}
+
+int main(int argc, char *argv[]) {
+    test_eject();
+    test_slow_and_max();
+    sylar::IOManager iom(2);
+    iom.schedule(&run);
+    return 0;
+}
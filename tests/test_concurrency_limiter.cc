@@ -0,0 +1,160 @@
+/**
+ * @file test_concurrency_limiter.cc
+ * @brief 自适应并发限制测试：上限随耗时增长和收缩，以及servlet路由上的503拒绝
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "sylar/sylar.h"
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_ROOT();
+
+/**
+ * @brief 按窗口模拟请求：每个窗口占满当前上限(或指定的并发数)，以固定耗时归还
+ */
+static uint64_t run_windows(sylar::ConcurrencyLimiter& limiter, uint64_t now
+                            ,int windows, uint64_t latency_us, uint32_t concurrency = 0) {
+    for(int w = 0; w < windows; ++w) {
+        uint32_t n = concurrency ? concurrency : limiter.getLimit();
+        for(uint32_t round = 0; round < 10;) {
+            // 窗口结束时上限可能收缩，能占多少占多少
+            uint32_t held = 0;
+            while(held < n && limiter.acquire()) {
+                ++held;
+            }
+            SYLAR_ASSERT(held > 0);
+            for(uint32_t i = 0; i < held; ++i) {
+                limiter.release(latency_us, true, now);
+            }
+            round += held;
+        }
+        now += 100;
+    }
+    return now;
+}
+
+void test_adapt() {
+    sylar::ConcurrencyLimiter limiter("adapt", 10, 4, 100);
+    uint64_t now = 1000000;
+    // 耗时稳定时上限缓慢增长
+    now = run_windows(limiter, now, 50, 1000);
+    uint32_t grown = limiter.getLimit();
+    SYLAR_LOG_INFO(g_logger) << "grown " << limiter.toString();
+    SYLAR_ASSERT(grown > 20);
+    SYLAR_ASSERT(limiter.getInflight() == 0);
+
+    // 上限没有被用到时不再增长，第一个窗口还包含上一阶段的并发
+    now = run_windows(limiter, now, 1, 1000, 1);
+    grown = limiter.getLimit();
+    now = run_windows(limiter, now, 50, 1000, 1);
+    SYLAR_ASSERT(limiter.getLimit() == grown);
+
+    // 耗时明显超过基线时上限收缩到最小值附近
+    now = run_windows(limiter, now, 50, 5000);
+    SYLAR_LOG_INFO(g_logger) << "shrunk " << limiter.toString();
+    SYLAR_ASSERT(limiter.getLimit() <= 8);
+
+    // 不计入统计的归还只减少并发数
+    SYLAR_ASSERT(limiter.acquire());
+    limiter.release(1000000, false, now + 1000);
+    SYLAR_ASSERT(limiter.getInflight() == 0);
+    SYLAR_LOG_INFO(g_logger) << "adapt test ok";
+}
+
+void test_reject() {
+    sylar::ConcurrencyLimiter limiter("reject", 2, 2, 2);
+    SYLAR_ASSERT(limiter.acquire());
+    SYLAR_ASSERT(limiter.acquire());
+    SYLAR_ASSERT(!limiter.acquire());
+    SYLAR_ASSERT(limiter.getRejected() == 1);
+    limiter.release(100);
+    SYLAR_ASSERT(limiter.acquire());
+    limiter.release(100);
+    limiter.release(100);
+    SYLAR_ASSERT(limiter.getInflight() == 0);
+    SYLAR_LOG_INFO(g_logger) << "reject test ok";
+}
+
+/**
+ * @brief 同时发出n个请求，返回成功和被拒绝的个数
+ */
+static void burst(int n, int& ok, int& rejected) {
+    std::atomic<int> done(0), succ(0), fail(0);
+    for(int i = 0; i < n; ++i) {
+        sylar::IOManager::GetThis()->schedule([&done, &succ, &fail]() {
+            auto rt = sylar::http::HttpConnection::DoGet("http://127.0.0.1:8107/slow", 3000);
+            SYLAR_ASSERT2(rt->result == 0, rt->toString());
+            if(rt->response->getStatus() == sylar::http::HttpStatus::OK) {
+                ++succ;
+            } else if(rt->response->getStatus() == sylar::http::HttpStatus::SERVICE_UNAVAILABLE) {
+                ++fail;
+            }
+            ++done;
+        });
+    }
+    while(done < n) {
+        usleep(10 * 1000);
+    }
+    ok = succ;
+    rejected = fail;
+}
+
+void test_servlet() {
+    sylar::http::HttpServer::ptr server(new sylar::http::HttpServer(true));
+    server->addAdminServlets();
+    auto addr = sylar::Address::LookupAnyIPAddress("127.0.0.1:8107");
+    while(!server->bind(addr)) {
+        sleep(2);
+    }
+    auto sd = server->getServletDispatch();
+    sd->addServlet("/slow", [](sylar::http::HttpRequest::ptr req
+                , sylar::http::HttpResponse::ptr rsp
+                , sylar::http::HttpSession::ptr session) {
+        usleep(200 * 1000);
+        rsp->setBody("slow");
+        return 0;
+    });
+    auto limiter = std::make_shared<sylar::ConcurrencyLimiter>("slow", 2, 2, 2);
+    sd->setConcurrencyLimiter("/slow", limiter);
+    SYLAR_ASSERT(sd->getConcurrencyLimiter("/slow") == limiter);
+    server->start();
+
+    int ok = 0, rejected = 0;
+    burst(5, ok, rejected);
+    SYLAR_LOG_INFO(g_logger) << "ok=" << ok << " rejected=" << rejected
+        << " " << limiter->toString();
+    SYLAR_ASSERT(ok == 2 && rejected == 3);
+    SYLAR_ASSERT(limiter->getRejected() == 3);
+    SYLAR_ASSERT(limiter->getInflight() == 0);
+
+    auto rt = sylar::http::HttpConnection::DoGet("http://127.0.0.1:8107/_/status", 1000);
+    SYLAR_ASSERT(rt->result == 0);
+    const std::string& status = rt->response->getBody();
+    for(auto& i : {"sylar_concurrency_limit{name=\"slow\"} 2"
+                   ,"sylar_concurrency_rejected_total{name=\"slow\"} 3"
+                   ,"sylar_concurrency_inflight{name=\"slow\"} 0"}) {
+        if(status.find(i) == std::string::npos) {
+            SYLAR_LOG_ERROR(g_logger) << "missing " << i;
+            SYLAR_ASSERT(false);
+        }
+    }
+
+    // 取消限制后全部通过
+    sd->setConcurrencyLimiter("/slow", nullptr);
+    burst(5, ok, rejected);
+    SYLAR_ASSERT(ok == 5 && rejected == 0);
+    server->stop();
+    SYLAR_LOG_INFO(g_logger) << "servlet test ok";
+}
+
+void run() {
+    g_logger->setLevel(sylar::LogLevel::INFO);
+    test_servlet();
+}
+
+int main(int argc, char *argv[]) {
+    test_adapt();
+    test_reject();
+    sylar::IOManager iom(2);
+    iom.schedule(&run);
+    return 0;
+}
@@ -62,6 +62,9 @@ void test_fiber() {
     SYLAR_LOG_INFO(g_logger) << "test_fiber end";
 }
 
+/// 静态对象持有的协程在线程局部的栈缓存析构之后才释放栈
+static sylar::Fiber::ptr s_static_fiber;
+
 int main(int argc, char *argv[]) {
     sylar::EnvMgr::GetInstance()->init(argc, argv);
     sylar::Config::LoadFromConfDir(sylar::EnvMgr::GetInstance()->getConfigPath());
@@ -79,6 +82,10 @@ int main(int argc, char *argv[]) {
         i->join();
     }
 
+    sylar::Fiber::GetThis();
+    s_static_fiber.reset(new sylar::Fiber(run_in_fiber2, 0, false));
+    s_static_fiber->resume();
+
     SYLAR_LOG_INFO(g_logger) << "main end";
     return 0;
 }
\ No newline at end of file
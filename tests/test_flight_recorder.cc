@@ -0,0 +1,114 @@
+/**
+ * @file test_flight_recorder.cc
+ * @brief 飞行记录器测试：事件记录、覆盖、信号和HTTP导出，以及单次记录的开销
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "sylar/sylar.h"
+#include <signal.h>
+#include <fstream>
+#include <sstream>
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_ROOT();
+
+static const std::string s_dump_file = "/tmp/test_flight_recorder.log";
+
+static size_t Count(const std::string& str, const std::string& sub) {
+    size_t n = 0;
+    for(size_t pos = str.find(sub); pos != std::string::npos; pos = str.find(sub, pos + 1)) {
+        ++n;
+    }
+    return n;
+}
+
+static std::string ReadFile(const std::string& path) {
+    std::ifstream ifs(path);
+    std::stringstream ss;
+    ss << ifs.rdbuf();
+    return ss.str();
+}
+
+void test_wrap() {
+    // 线程退出后事件仍可导出，只保留最近的size个
+    sylar::Thread::ptr thr(new sylar::Thread([]() {
+        for(int i = 0; i < 10000; ++i) {
+            sylar::FlightRecorder::Record(sylar::FlightRecorder::TIMER_FIRE, i, 77);
+        }
+    }, "fr_wrap"));
+    thr->join();
+    std::string dump = sylar::FlightRecorder::Dump();
+    size_t pos = dump.find("fr_wrap (exited) events=4096 ---");
+    SYLAR_ASSERT(pos != std::string::npos);
+    size_t end = dump.find("---", pos + 40);
+    std::string section = dump.substr(pos, end == std::string::npos ? end : end - pos);
+    SYLAR_ASSERT(Count(section, "timer_fire") == 4096);
+    SYLAR_ASSERT(section.find("value=5903 ") == std::string::npos);
+    SYLAR_ASSERT(section.find("value=5904 ") != std::string::npos);
+    SYLAR_ASSERT(section.find("value=9999 ") != std::string::npos);
+
+    std::string last = sylar::FlightRecorder::Dump(10);
+    SYLAR_ASSERT(last.find("fr_wrap (exited) events=10 ---") != std::string::npos);
+    SYLAR_LOG_INFO(g_logger) << "wrap test ok";
+}
+
+void bench(int loops) {
+    uint64_t start = sylar::GetCurrentUS();
+    for(int i = 0; i < loops; ++i) {
+        sylar::FlightRecorder::Record(sylar::FlightRecorder::IO_ADD, i, 1);
+    }
+    uint64_t used = sylar::GetCurrentUS() - start;
+    SYLAR_LOG_INFO(g_logger) << "record bench per_event=" << used * 1000.0 / loops << "ns";
+}
+
+void test_signal() {
+    unlink(s_dump_file.c_str());
+    sylar::Config::Lookup<std::string>("flight_recorder.dump_path")->setValue(s_dump_file);
+    sylar::Config::Lookup<int>("flight_recorder.signal")->setValue(SIGUSR2);
+    raise(SIGUSR2);
+    std::string dump = ReadFile(s_dump_file);
+    SYLAR_ASSERT(dump.find("=== flight recorder pid=") == 0);
+    SYLAR_ASSERT(dump.find("io_add") != std::string::npos);
+
+    // 断言失败时的导出只做一次
+    sylar::FlightRecorder::OnAssert();
+    sylar::FlightRecorder::OnAssert();
+    SYLAR_ASSERT(Count(ReadFile(s_dump_file), "=== flight recorder") == 2);
+    sylar::Config::Lookup<int>("flight_recorder.signal")->setValue(0);
+    SYLAR_LOG_INFO(g_logger) << "signal test ok";
+}
+
+void test_iomanager() {
+    sylar::http::HttpServer::ptr server(new sylar::http::HttpServer(true));
+    server->addAdminServlets();
+    auto addr = sylar::Address::LookupAnyIPAddress("127.0.0.1:8104");
+    while(!server->bind(addr)) {
+        sleep(2);
+    }
+    server->start();
+    // 让调度线程走一遍定时器和epoll_wait
+    usleep(20 * 1000);
+
+    auto rt = sylar::http::HttpConnection::DoGet("http://127.0.0.1:8104/_/flight?last=200", 1000);
+    SYLAR_ASSERT(rt->result == 0);
+    const std::string& body = rt->response->getBody();
+    for(auto& i : {"fiber_resume", "fiber_yield", "sched_enqueue", "sched_dequeue"
+                   , "io_add", "io_trigger", "idle_wait", "idle_wake", "timer_fire"
+                   , "http_start"}) {
+        if(body.find(i) == std::string::npos) {
+            SYLAR_LOG_ERROR(g_logger) << "missing " << i;
+            SYLAR_ASSERT(false);
+        }
+    }
+    SYLAR_ASSERT(body.find("IOManager_0") != std::string::npos);
+    server->stop();
+    SYLAR_LOG_INFO(g_logger) << "iomanager test ok";
+}
+
+int main(int argc, char *argv[]) {
+    test_wrap();
+    bench(argc > 1 ? atoi(argv[1]) : 1000000);
+    test_signal();
+    sylar::IOManager iom(2);
+    iom.schedule(&test_iomanager);
+    return 0;
+}
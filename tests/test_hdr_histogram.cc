@@ -0,0 +1,150 @@
+/**
+ * @file test_hdr_histogram.cc
+ * @brief HDR直方图测试：分桶、分位数误差、多线程合并，以及按路由的HTTP统计
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "sylar/sylar.h"
+#include <algorithm>
+#include <random>
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_ROOT();
+
+void test_buckets() {
+    // 桶首尾相接，覆盖所有值
+    for(uint32_t p : {2u, 5u, 8u}) {
+        uint64_t expect = 0;
+        size_t count = sylar::HdrHistogram::BucketIndex(1ull << 40, p);
+        for(size_t i = 0; i < count; ++i) {
+            SYLAR_ASSERT(sylar::HdrHistogram::BucketLow(i, p) == expect);
+            uint64_t high = sylar::HdrHistogram::BucketHigh(i, p);
+            SYLAR_ASSERT(sylar::HdrHistogram::BucketIndex(expect, p) == i);
+            SYLAR_ASSERT(sylar::HdrHistogram::BucketIndex(high, p) == i);
+            expect = high + 1;
+        }
+    }
+    SYLAR_LOG_INFO(g_logger) << "bucket test ok";
+}
+
+void test_percentile() {
+    sylar::HdrHistogram hist(1ull << 36, 5);
+    std::mt19937_64 rng(12345);
+    std::lognormal_distribution<double> dist(8, 1.5);
+    std::vector<uint64_t> values;
+    for(int i = 0; i < 100000; ++i) {
+        uint64_t v = (uint64_t)dist(rng);
+        values.push_back(v);
+        hist.record(v);
+    }
+    std::sort(values.begin(), values.end());
+    auto snap = hist.snapshot();
+    SYLAR_ASSERT(snap.getCount() == values.size());
+    SYLAR_ASSERT(snap.getMin() == values.front());
+    SYLAR_ASSERT(snap.getMax() == values.back());
+    for(double q : {50.0, 90.0, 99.0, 99.9, 100.0}) {
+        uint64_t exact = values[(size_t)ceil(q / 100 * values.size()) - 1];
+        uint64_t got = snap.percentile(q);
+        // 精度5位时同一桶内的相对误差不超过1/16
+        SYLAR_ASSERT(got >= exact);
+        SYLAR_ASSERT(got - exact <= exact / 16 + 1);
+    }
+    SYLAR_LOG_INFO(g_logger) << "percentile test ok " << snap.toString();
+}
+
+void test_threads() {
+    sylar::HdrHistogram hist;
+    std::vector<sylar::Thread::ptr> thrs;
+    for(int i = 0; i < 8; ++i) {
+        thrs.push_back(std::make_shared<sylar::Thread>([&hist, i]() {
+            for(uint64_t v = 1; v <= 10000; ++v) {
+                hist.record(v * (i + 1));
+            }
+        }, "hdr_" + std::to_string(i)));
+    }
+    for(auto& i : thrs) {
+        i->join();
+    }
+    auto snap = hist.snapshot();
+    SYLAR_ASSERT(snap.getCount() == 80000);
+    SYLAR_ASSERT(snap.getSum() == 50005000ull * 36);
+    SYLAR_ASSERT(snap.getMin() == 1);
+    SYLAR_ASSERT(snap.getMax() == 80000);
+    SYLAR_LOG_INFO(g_logger) << "threads test ok";
+}
+
+void bench(int loops) {
+    sylar::HdrHistogram hist;
+    uint64_t start = sylar::GetCurrentUS();
+    for(int i = 0; i < loops; ++i) {
+        hist.record(i & 0xffff);
+    }
+    uint64_t used = sylar::GetCurrentUS() - start;
+    SYLAR_LOG_INFO(g_logger) << "record bench per_value=" << used * 1000.0 / loops << "ns";
+}
+
+void test_server() {
+    sylar::http::HttpServer::ptr server(new sylar::http::HttpServer(true));
+    server->addAdminServlets();
+    auto addr = sylar::Address::LookupAnyIPAddress("127.0.0.1:8105");
+    while(!server->bind(addr)) {
+        sleep(2);
+    }
+    auto sd = server->getServletDispatch();
+    sd->addServlet("/fast", [](sylar::http::HttpRequest::ptr req
+                    ,sylar::http::HttpResponse::ptr rsp
+                    ,sylar::http::HttpSession::ptr session) {
+        rsp->setBody("fast");
+        return 0;
+    });
+    sd->addServlet("/slow", [](sylar::http::HttpRequest::ptr req
+                    ,sylar::http::HttpResponse::ptr rsp
+                    ,sylar::http::HttpSession::ptr session) {
+        usleep(5 * 1000);
+        rsp->setBody(std::string(1000, 's'));
+        return 0;
+    });
+    server->start();
+
+    for(int i = 0; i < 20; ++i) {
+        SYLAR_ASSERT(sylar::http::HttpConnection::DoGet("http://127.0.0.1:8105/fast", 1000)->result == 0);
+        SYLAR_ASSERT(sylar::http::HttpConnection::DoRequest(sylar::http::HttpMethod::POST
+                    , "http://127.0.0.1:8105/slow", 1000, {}, std::string(100, 'b'))->result == 0);
+    }
+    SYLAR_ASSERT(sylar::http::HttpConnection::DoGet("http://127.0.0.1:8105/nothing", 1000)->result == 0);
+
+    std::map<std::string, sylar::http::RouteStats::ptr> stats;
+    sd->listRouteStats(stats);
+    for(auto& i : stats) {
+        SYLAR_LOG_INFO(g_logger) << i.second->toString();
+    }
+    auto slow = stats["/slow"];
+    auto fast = stats["/fast"];
+    SYLAR_ASSERT(slow && fast && stats["default"]);
+    SYLAR_ASSERT(slow->getLatency().getCount() == 20);
+    SYLAR_ASSERT(slow->getLatency().percentile(50) >= 5000);
+    SYLAR_ASSERT(fast->getLatency().percentile(50) < slow->getLatency().percentile(50));
+    SYLAR_ASSERT(slow->getRequestBytes().getMax() == 100);
+    SYLAR_ASSERT(slow->getResponseBytes().getMin() == 1000);
+    SYLAR_ASSERT(fast->getStatusCount(2) == 20);
+    SYLAR_ASSERT(stats["default"]->getStatusCount(4) == 1);
+
+    auto rt = sylar::http::HttpConnection::DoGet("http://127.0.0.1:8105/_/status", 1000);
+    SYLAR_ASSERT(rt->result == 0);
+    const std::string& body = rt->response->getBody();
+    SYLAR_ASSERT(body.find("# TYPE sylar_http_route_latency_seconds summary") != std::string::npos);
+    SYLAR_ASSERT(body.find("sylar_http_route_latency_seconds{route=\"/slow\",quantile=\"0.99\"}") != std::string::npos);
+    SYLAR_ASSERT(body.find("sylar_http_route_latency_seconds_count{route=\"/slow\"} 20") != std::string::npos);
+    SYLAR_ASSERT(body.find("sylar_http_route_requests_total{code=\"4xx\",route=\"default\"} 1") != std::string::npos);
+    server->stop();
+    SYLAR_LOG_INFO(g_logger) << "server test ok";
+}
+
+int main(int argc, char *argv[]) {
+    test_buckets();
+    test_percentile();
+    test_threads();
+    bench(argc > 1 ? atoi(argv[1]) : 1000000);
+    sylar::IOManager iom(2);
+    iom.schedule(&test_server);
+    return 0;
+}
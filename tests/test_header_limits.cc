@@ -0,0 +1,163 @@
+/**
+ * @file test_header_limits.cc
+ * @brief 请求头限制测试：慢速发送的连接被截止时间关闭、低速率返回408、头部过多或过大返回431
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "sylar/sylar.h"
+#include <signal.h>
+#include <poll.h>
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_ROOT();
+
+static sylar::Socket::ptr connect() {
+    auto addr = sylar::Address::LookupAnyIPAddress("127.0.0.1:8115");
+    auto sock = sylar::Socket::CreateTCP(addr);
+    SYLAR_ASSERT(sock->connect(addr));
+    sock->setRecvTimeout(3000);
+    return sock;
+}
+
+static double rejected(const std::string& reason) {
+    return sylar::MetricsMgr::GetInstance()->counter("sylar_http_header_rejected_total"
+            , "", {{"reason", reason}})->get();
+}
+
+/// 读到连接关闭为止，返回收到的全部数据
+static std::string read_all(sylar::Socket::ptr sock) {
+    std::string data;
+    char buf[1024];
+    int rt = 0;
+    while((rt = sock->recv(buf, sizeof(buf))) > 0) {
+        data.append(buf, rt);
+    }
+    return data;
+}
+
+static bool drip(sylar::Socket::ptr sock, const std::string& data, uint64_t interval_ms) {
+    for(auto& c : data) {
+        // 服务端已经回复时停止发送，否则未读的数据会让服务端回RST，冲掉回复
+        pollfd pfd = {sock->getSocket(), POLLIN, 0};
+        if(::poll(&pfd, 1, 0) > 0 || sock->send(&c, 1) <= 0) {
+            return false;
+        }
+        usleep(interval_ms * 1000);
+    }
+    return true;
+}
+
+void test_normal() {
+    auto sock = connect();
+    std::string req = "GET /hit HTTP/1.1\r\nHost: 127.0.0.1\r\nConnection: close\r\n";
+    for(int i = 0; i < 20; ++i) {
+        req += "X-Field-" + std::to_string(i) + ": " + std::string(100, 'a') + "\r\n";
+    }
+    req += "\r\n";
+    SYLAR_ASSERT(sock->send(req.c_str(), req.size()) == (int)req.size());
+    std::string rsp = read_all(sock);
+    SYLAR_ASSERT(rsp.find("200 OK") != std::string::npos && rsp.find("hit") != std::string::npos);
+
+    // 逐字节到达的请求，url和头部被分成多次解析
+    sock = connect();
+    SYLAR_ASSERT(drip(sock, "GET /hit?a=1 HTTP/1.1\r\nHost: 127.0.0.1\r\nConnection: close\r\n\r\n", 1));
+    rsp = read_all(sock);
+    SYLAR_ASSERT(rsp.find("200 OK") != std::string::npos && rsp.find("hit") != std::string::npos);
+
+    // 单行头部超过4K的初始读缓冲区，没有超过max_header_size时缓冲区扩大后接收
+    sock = connect();
+    req = "GET /hit HTTP/1.1\r\nHost: 127.0.0.1\r\nConnection: close\r\nX-Big: "
+        + std::string(10 * 1024, 'a') + "\r\n\r\n";
+    SYLAR_ASSERT(sock->send(req.c_str(), req.size()) == (int)req.size());
+    rsp = read_all(sock);
+    SYLAR_ASSERT(rsp.find("200 OK") != std::string::npos && rsp.find("hit") != std::string::npos);
+    SYLAR_LOG_INFO(g_logger) << "normal test ok";
+}
+
+void test_deadline() {
+    // 每100ms发1字节，速率达标但总时间超过截止时间
+    sylar::Config::Lookup<uint64_t>("http.server.header_min_rate")->setValue(1);
+    double before = rejected("timeout");
+    auto sock = connect();
+    uint64_t start = sylar::GetCurrentMS();
+    bool sent = drip(sock, "GET /hit HTTP/1.1\r\nHost: 127.0.0.1\r\n", 100);
+    SYLAR_ASSERT(read_all(sock).empty());
+    uint64_t used = sylar::GetCurrentMS() - start;
+    SYLAR_LOG_INFO(g_logger) << "deadline used=" << used;
+    // 连接被关闭后发送失败，不会发完整个请求行
+    SYLAR_ASSERT(!sent && used >= 400 && used < 2500);
+    SYLAR_ASSERT(rejected("timeout") == before + 1);
+    sylar::Config::Lookup<uint64_t>("http.server.header_min_rate")->setValue(100);
+    SYLAR_LOG_INFO(g_logger) << "deadline test ok";
+}
+
+void test_slow() {
+    // 宽限期过后速率低于100字节/秒
+    double before = rejected("slow");
+    auto sock = connect();
+    drip(sock, "GET /hit HTTP/1.1\r\nHost: 127.0.0.1\r\nX-Slow: abcdefgh\r\n", 30);
+    std::string rsp = read_all(sock);
+    SYLAR_ASSERT(rsp.find("408 Request Timeout") != std::string::npos);
+    SYLAR_ASSERT(rejected("slow") == before + 1);
+    SYLAR_LOG_INFO(g_logger) << "slow test ok";
+}
+
+void test_too_many() {
+    double before = rejected("too_many");
+    auto sock = connect();
+    std::string req = "GET /hit HTTP/1.1\r\nHost: 127.0.0.1\r\n";
+    for(int i = 0; i < 200; ++i) {
+        req += "X-" + std::to_string(i) + ": 1\r\n";
+    }
+    req += "\r\n";
+    sock->send(req.c_str(), req.size());
+    std::string rsp = read_all(sock);
+    SYLAR_ASSERT(rsp.find("431 Request Header Fields Too Large") != std::string::npos);
+    SYLAR_ASSERT(rejected("too_many") == before + 1);
+    SYLAR_LOG_INFO(g_logger) << "too many test ok";
+}
+
+void test_too_large() {
+    double before = rejected("too_large");
+    auto sock = connect();
+    // 单个头部超过上限，头部还没有结束就拒绝
+    std::string req = "GET /hit HTTP/1.1\r\nHost: 127.0.0.1\r\nX-Big: " + std::string(32 * 1024, 'a');
+    sock->send(req.c_str(), req.size());
+    std::string rsp = read_all(sock);
+    SYLAR_ASSERT(rsp.find("431 Request Header Fields Too Large") != std::string::npos);
+    SYLAR_ASSERT(rejected("too_large") == before + 1);
+    SYLAR_LOG_INFO(g_logger) << "too large test ok";
+}
+
+void run() {
+    g_logger->setLevel(sylar::LogLevel::INFO);
+    sylar::Config::Lookup<uint64_t>("http.server.header_timeout_ms")->setValue(500);
+    sylar::Config::Lookup<uint64_t>("http.server.header_rate_grace_ms")->setValue(300);
+    sylar::http::HttpServer::ptr server(new sylar::http::HttpServer(true));
+    auto addr = sylar::Address::LookupAnyIPAddress("127.0.0.1:8115");
+    while(!server->bind(addr)) {
+        sleep(2);
+    }
+    server->setRecvTimeout(3000);
+    server->getServletDispatch()->addServlet("/hit", [](sylar::http::HttpRequest::ptr req
+                , sylar::http::HttpResponse::ptr rsp
+                , sylar::http::HttpSession::ptr session) {
+        rsp->setBody(req->getPath() == "/hit" ? "hit" : "bad");
+        return 0;
+    });
+    server->start();
+
+    test_normal();
+    test_deadline();
+    test_slow();
+    test_too_many();
+    test_too_large();
+    server->stop();
+}
+
+int main(int argc, char *argv[]) {
+    // 服务端关闭连接后客户端继续发送
+    signal(SIGPIPE, SIG_IGN);
+    sylar::IOManager iom(2);
+    iom.schedule(&run);
+    return 0;
+}
@@ -0,0 +1,164 @@
+/**
+ * @file test_hedge.cc
+ * @brief 对冲请求测试：慢请求被对冲、落败请求立即取消、额度和分位数延迟
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "sylar/sylar.h"
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_ROOT();
+
+static std::atomic<int> s_calls(0);
+
+static sylar::http::HttpConnectionPool::ptr create_pool(uint64_t delay, double budget) {
+    sylar::Config::Lookup<uint64_t>("http.client.hedge_delay_ms")->setValue(delay);
+    sylar::Config::Lookup<double>("http.client.hedge_budget")->setValue(budget);
+    return sylar::http::HttpConnectionPool::Create("http://127.0.0.1:8109", "", 10, 1000 * 60, 100);
+}
+
+void test_hedge() {
+    auto pool = create_pool(50, 1);
+    auto breaker = pool->getCircuitBreaker();
+    // 第一个请求很慢，对冲请求先返回
+    s_calls = 0;
+    uint64_t start = sylar::GetCurrentMS();
+    auto rt = pool->doHedgedGet("/slow_once", 3000);
+    uint64_t used = sylar::GetCurrentMS() - start;
+    SYLAR_ASSERT2(rt->result == 0, rt->toString());
+    SYLAR_ASSERT(rt->response->getBody() == "fast");
+    SYLAR_LOG_INFO(g_logger) << "hedged request used " << used << "ms";
+    SYLAR_ASSERT(used >= 50 && used < 500);
+    SYLAR_ASSERT(s_calls == 2);
+
+    // 落败的请求被立即唤醒，不等慢响应，也不计入熔断
+    usleep(100 * 1000);
+    SYLAR_ASSERT(breaker->getInflight() == 0);
+    SYLAR_ASSERT(breaker->getState() == sylar::CircuitBreaker::CLOSED);
+
+    // 在延迟内返回的请求不对冲
+    rt = pool->doHedgedGet("/fast", 3000);
+    SYLAR_ASSERT(rt->result == 0 && rt->response->getBody() == "fast");
+
+    // 非幂等请求不对冲
+    s_calls = 0;
+    auto req = std::make_shared<sylar::http::HttpRequest>();
+    req->setMethod(sylar::http::HttpMethod::POST);
+    req->setPath("/slow_once");
+    req->setHeader("Host", "127.0.0.1");
+    rt = pool->doHedgedRequest(req, 3000);
+    SYLAR_ASSERT(rt->result == 0 && rt->response->getBody() == "slow");
+    SYLAR_ASSERT(s_calls == 1);
+
+    rt = sylar::http::HttpConnection::DoGet("http://127.0.0.1:8109/_/status", 1000);
+    SYLAR_ASSERT(rt->result == 0);
+    const std::string& status = rt->response->getBody();
+    for(auto& i : {"sylar_http_client_hedges_total{name=\"127.0.0.1:8109\"} 1"
+                   ,"sylar_http_client_hedge_wins_total{name=\"127.0.0.1:8109\"} 1"}) {
+        if(status.find(i) == std::string::npos) {
+            SYLAR_LOG_ERROR(g_logger) << "missing " << i;
+            SYLAR_ASSERT(false);
+        }
+    }
+    SYLAR_LOG_INFO(g_logger) << "hedge test ok";
+}
+
+void test_budget() {
+    // 没有额度时不对冲
+    auto pool = create_pool(50, 0);
+    s_calls = 0;
+    auto rt = pool->doHedgedGet("/slow_once", 3000);
+    SYLAR_ASSERT(rt->result == 0 && rt->response->getBody() == "slow");
+    SYLAR_ASSERT(s_calls == 1);
+
+    // 额度按比例积累：0.5表示每两个请求最多对冲一次
+    pool = create_pool(50, 0.5);
+    int hedged = 0;
+    for(int i = 0; i < 4; ++i) {
+        s_calls = 0;
+        rt = pool->doHedgedGet("/slow_once", 3000);
+        SYLAR_ASSERT(rt->result == 0);
+        hedged += rt->response->getBody() == "fast";
+    }
+    SYLAR_ASSERT(hedged == 2);
+    SYLAR_LOG_INFO(g_logger) << "budget test ok";
+}
+
+void test_deadline() {
+    // 主请求300ms后失败，立即重试；重试只能用剩下的时间，整个调用不超过timeout
+    auto pool = create_pool(500, 1);
+    s_calls = 0;
+    uint64_t start = sylar::GetCurrentMS();
+    auto rt = pool->doHedgedGet("/fail_once", 800);
+    uint64_t used = sylar::GetCurrentMS() - start;
+    SYLAR_LOG_INFO(g_logger) << "retried request used " << used << "ms " << rt->toString();
+    SYLAR_ASSERT(rt->result != 0);
+    SYLAR_ASSERT(s_calls == 2);
+    SYLAR_ASSERT(used >= 700 && used < 1000);
+    SYLAR_LOG_INFO(g_logger) << "deadline test ok";
+}
+
+void test_percentile() {
+    auto pool = create_pool(0, 1);
+    for(int i = 0; i < 20; ++i) {
+        SYLAR_ASSERT(pool->doGet("/fast", 1000)->result == 0);
+    }
+    uint64_t delay = pool->getHedgeDelay();
+    SYLAR_LOG_INFO(g_logger) << "p95 hedge delay " << delay << "ms";
+    SYLAR_ASSERT(delay >= 1 && delay < 100);
+    s_calls = 0;
+    auto rt = pool->doHedgedGet("/slow_once", 3000);
+    SYLAR_ASSERT(rt->result == 0 && rt->response->getBody() == "fast");
+    SYLAR_LOG_INFO(g_logger) << "percentile test ok";
+}
+
+void run() {
+    g_logger->setLevel(sylar::LogLevel::INFO);
+    sylar::http::HttpServer::ptr server(new sylar::http::HttpServer(true));
+    server->addAdminServlets();
+    auto addr = sylar::Address::LookupAnyIPAddress("127.0.0.1:8109");
+    while(!server->bind(addr)) {
+        sleep(2);
+    }
+    auto sd = server->getServletDispatch();
+    sd->addServlet("/slow_once", [](sylar::http::HttpRequest::ptr req
+                , sylar::http::HttpResponse::ptr rsp
+                , sylar::http::HttpSession::ptr session) {
+        if(++s_calls == 1) {
+            usleep(1000 * 1000);
+            rsp->setBody("slow");
+        } else {
+            rsp->setBody("fast");
+        }
+        return 0;
+    });
+    sd->addServlet("/fail_once", [](sylar::http::HttpRequest::ptr req
+                , sylar::http::HttpResponse::ptr rsp
+                , sylar::http::HttpSession::ptr session) {
+        if(++s_calls == 1) {
+            usleep(300 * 1000);
+            ::shutdown(session->getSocket()->getSocket(), SHUT_RDWR);
+        } else {
+            usleep(2000 * 1000);
+        }
+        return 0;
+    });
+    sd->addServlet("/fast", [](sylar::http::HttpRequest::ptr req
+                , sylar::http::HttpResponse::ptr rsp
+                , sylar::http::HttpSession::ptr session) {
+        rsp->setBody("fast");
+        return 0;
+    });
+    server->start();
+
+    test_hedge();
+    test_budget();
+    test_deadline();
+    test_percentile();
+    server->stop();
+}
+
+int main(int argc, char *argv[]) {
+    sylar::IOManager iom(2);
+    iom.schedule(&run);
+    return 0;
+}
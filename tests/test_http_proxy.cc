@@ -0,0 +1,230 @@
+/**
+ * @file test_http_proxy.cc
+ * @brief 反向代理Servlet测试，以及splice与用户态拷贝转发大消息体的耗时对比
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "sylar/sylar.h"
+#include "sylar/http/servlets/proxy_servlet.h"
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_ROOT();
+
+static const char* s_upstream = "127.0.0.1:8094";
+static const char* s_proxy    = "127.0.0.1:8095";
+static std::string s_big;
+
+static sylar::http::HttpServer::ptr StartUpstream() {
+    sylar::http::HttpServer::ptr server(new sylar::http::HttpServer(true));
+    auto addr = sylar::Address::LookupAnyIPAddress(s_upstream);
+    while(!server->bind(addr)) {
+        sleep(2);
+    }
+    auto sd = server->getServletDispatch();
+    sd->addServlet("/echo", [](sylar::http::HttpRequest::ptr req
+                , sylar::http::HttpResponse::ptr rsp
+                , sylar::http::HttpSession::ptr session) {
+        rsp->setBody(req->getBody());
+        rsp->setHeader("X-Method", sylar::http::HttpMethodToString(req->getMethod()));
+        return 0;
+    });
+    sd->addServlet("/big", [](sylar::http::HttpRequest::ptr req
+                , sylar::http::HttpResponse::ptr rsp
+                , sylar::http::HttpSession::ptr session) {
+        rsp->setBody(s_big);
+        return 0;
+    });
+    sd->addServlet("/chunked", [](sylar::http::HttpRequest::ptr req
+                , sylar::http::HttpResponse::ptr rsp
+                , sylar::http::HttpSession::ptr session) {
+        // 直接在连接上写chunked响应
+        rsp->setHeader("Transfer-Encoding", "chunked");
+        session->sendResponse(rsp);
+        std::string body = "5\r\nhello\r\n6\r\n world\r\n0\r\n\r\n";
+        session->writeFixSize(body.c_str(), body.size());
+        return 0;
+    });
+    sd->addServlet("/eof", [](sylar::http::HttpRequest::ptr req
+                , sylar::http::HttpResponse::ptr rsp
+                , sylar::http::HttpSession::ptr session) {
+        // 没有Content-Length，以关闭连接结束消息体
+        rsp->setClose(true);
+        rsp->setStreamBody(true);
+        session->sendResponse(rsp);
+        if(req->getMethod() != sylar::http::HttpMethod::HEAD) {
+            std::string body = "until eof";
+            session->writeFixSize(body.c_str(), body.size());
+        }
+        return 0;
+    });
+    sd->addServlet("/hop", [](sylar::http::HttpRequest::ptr req
+                , sylar::http::HttpResponse::ptr rsp
+                , sylar::http::HttpSession::ptr session) {
+        rsp->setBody(req->getHeader("Keep-Alive") + "|" + req->getHeader("X-Private")
+                + "|" + req->getHeader("X-Forwarded-For") + "|" + req->getHeader("X-Public"));
+        rsp->setHeader("Keep-Alive", "timeout=60");
+        return 0;
+    });
+    sd->addServlet("/slow", [](sylar::http::HttpRequest::ptr req
+                , sylar::http::HttpResponse::ptr rsp
+                , sylar::http::HttpSession::ptr session) {
+        sleep(2);
+        rsp->setBody("slow");
+        return 0;
+    });
+    server->start();
+    return server;
+}
+
+static sylar::http::HttpServer::ptr StartProxy(sylar::http::ProxyServlet::ptr& proxy) {
+    sylar::http::HttpServer::ptr server(new sylar::http::HttpServer(true));
+    auto addr = sylar::Address::LookupAnyIPAddress(s_proxy);
+    while(!server->bind(addr)) {
+        sleep(2);
+    }
+    auto pool = sylar::http::HttpConnectionPool::Create(std::string("http://") + s_upstream
+                , "", 16, 60 * 1000, 1000);
+    proxy.reset(new sylar::http::ProxyServlet(pool, 1000));
+    server->getServletDispatch()->addGlobServlet("/*", proxy);
+    server->start();
+    return server;
+}
+
+/**
+ * @brief 在新连接上发送原始请求，读到连接关闭或出现until为止，返回收到的原始数据
+ */
+static std::string RawExchange(const std::string& data, const std::string& until = "") {
+    auto addr = sylar::Address::LookupAnyIPAddress(s_proxy);
+    auto sock = sylar::Socket::CreateTCP(addr);
+    SYLAR_ASSERT(sock->connect(addr));
+    sock->setRecvTimeout(3000);
+    SYLAR_ASSERT(sock->send(data.c_str(), data.size()) == (int)data.size());
+    std::string rt;
+    char buf[1024];
+    int len = 0;
+    while((until.empty() || rt.find(until) == std::string::npos)
+            && (len = sock->recv(buf, sizeof(buf))) > 0) {
+        rt.append(buf, len);
+    }
+    return rt;
+}
+
+/**
+ * @brief 在新连接上发送原始请求并读取响应
+ */
+static sylar::http::HttpResponse::ptr RawRequest(const std::string& data) {
+    auto addr = sylar::Address::LookupAnyIPAddress(s_proxy);
+    auto sock = sylar::Socket::CreateTCP(addr);
+    SYLAR_ASSERT(sock->connect(addr));
+    sock->setRecvTimeout(3000);
+    sylar::http::HttpConnection conn(sock);
+    SYLAR_ASSERT(conn.writeFixSize(data.c_str(), data.size()) > 0);
+    return conn.recvResponse();
+}
+
+void test_functional() {
+    std::string base = std::string("http://") + s_proxy;
+
+    auto rt = sylar::http::HttpConnection::DoGet(base + "/echo", 3000);
+    SYLAR_ASSERT(rt->result == 0 && rt->response->getStatus() == sylar::http::HttpStatus::OK);
+    SYLAR_ASSERT(rt->response->getHeader("X-Method") == "GET");
+
+    std::string body(1024 * 1024, 'x');
+    for(size_t i = 0; i < body.size(); i += 7) {
+        body[i] = 'a' + i % 26;
+    }
+    rt = sylar::http::HttpConnection::DoPost(base + "/echo", 3000, {}, body);
+    SYLAR_ASSERT(rt->result == 0 && rt->response->getBody() == body);
+
+    rt = sylar::http::HttpConnection::DoGet(base + "/chunked", 3000);
+    SYLAR_ASSERT(rt->result == 0 && rt->response->getBody() == "hello world");
+    SYLAR_ASSERT(rt->response->getHeader("Transfer-Encoding") == "chunked");
+
+    // chunked请求体按段转发
+    auto rsp = RawRequest("POST /echo HTTP/1.1\r\nHost: test\r\nTransfer-Encoding: chunked\r\n\r\n"
+                          "5\r\nhello\r\n1\r\n!\r\n0\r\n\r\n");
+    SYLAR_ASSERT(rsp && rsp->getBody() == "hello!");
+
+    // HTTP/1.0客户端，上游以关闭连接结束消息体：同样以关闭连接结束，不能声明长度为0
+    std::string raw = RawExchange("GET /eof HTTP/1.0\r\nHost: test\r\n\r\n");
+    SYLAR_ASSERT2(raw.find("200 OK") != std::string::npos
+            && strcasestr(raw.c_str(), "content-length") == nullptr
+            && raw.size() > 9 && raw.compare(raw.size() - 9, 9, "until eof") == 0, raw);
+    // HTTP/1.1客户端改用chunked
+    rt = sylar::http::HttpConnection::DoGet(base + "/eof", 3000);
+    SYLAR_ASSERT(rt->result == 0 && rt->response->getBody() == "until eof");
+    // 上游HEAD响应没有长度时不补content-length: 0
+    raw = RawExchange("HEAD /eof HTTP/1.1\r\nHost: test\r\n\r\n", "\r\n\r\n");
+    SYLAR_ASSERT2(raw.find("200 OK") != std::string::npos
+            && strcasestr(raw.c_str(), "content-length") == nullptr, raw);
+
+    // 逐跳头部不转发，Connection中列出的头部也不转发
+    rsp = RawRequest("GET /hop HTTP/1.1\r\nHost: test\r\nConnection: keep-alive, X-Private\r\n"
+                     "Keep-Alive: timeout=5\r\nX-Private: secret\r\nX-Public: ok\r\n\r\n");
+    SYLAR_ASSERT(rsp && rsp->getBody() == "||127.0.0.1|ok");
+    SYLAR_ASSERT(rsp->getHeader("Keep-Alive").empty());
+
+    // 一条客户端连接上连续转发多个请求
+    auto addr = sylar::Address::LookupAnyIPAddress(s_proxy);
+    auto sock = sylar::Socket::CreateTCP(addr);
+    SYLAR_ASSERT(sock->connect(addr));
+    sylar::http::HttpConnection conn(sock);
+    for(int i = 0; i < 100; ++i) {
+        sylar::http::HttpRequest::ptr req(new sylar::http::HttpRequest(0x11, false));
+        req->setMethod(sylar::http::HttpMethod::POST);
+        req->setPath("/echo");
+        req->setHeader("Host", "test");
+        req->setBody("keepalive " + std::to_string(i));
+        SYLAR_ASSERT(conn.sendRequest(req) > 0);
+        auto r = conn.recvResponse();
+        SYLAR_ASSERT(r && r->getBody() == req->getBody());
+    }
+    conn.close();
+
+    rt = sylar::http::HttpConnection::DoGet(base + "/slow", 5000);
+    SYLAR_ASSERT(rt->result == 0
+            && rt->response->getStatus() == sylar::http::HttpStatus::GATEWAY_TIMEOUT);
+    SYLAR_LOG_INFO(g_logger) << "functional test ok";
+}
+
+void bench(sylar::http::ProxyServlet::ptr proxy, int loops) {
+    std::string url = std::string("http://") + s_proxy + "/big";
+    for(int k = 0; k < 2; ++k) {
+        proxy->setSplice(k == 0);
+        uint64_t start = sylar::GetCurrentUS();
+        for(int i = 0; i < loops; ++i) {
+            auto rt = sylar::http::HttpConnection::DoGet(url, 10000);
+            SYLAR_ASSERT(rt->result == 0 && rt->response->getBody().size() == s_big.size());
+        }
+        uint64_t used = sylar::GetCurrentUS() - start;
+        SYLAR_LOG_INFO(g_logger) << "proxy bench " << (k == 0 ? "splice" : "copy")
+            << " body=" << s_big.size() / 1024 / 1024 << "MB"
+            << " loops=" << loops
+            << " used=" << used / 1000 << "ms"
+            << " per_request=" << used / loops / 1000 << "ms";
+    }
+}
+
+static int s_loops = 10;
+
+void run() {
+    g_logger->setLevel(sylar::LogLevel::INFO);
+    s_big.assign(32 * 1024 * 1024, 'b');
+    auto upstream = StartUpstream();
+    sylar::http::ProxyServlet::ptr proxy;
+    auto server = StartProxy(proxy);
+
+    test_functional();
+    bench(proxy, s_loops);
+
+    server->stop();
+    upstream->stop();
+}
+
+int main(int argc, char *argv[]) {
+    if(argc > 1) {
+        s_loops = atoi(argv[1]);
+    }
+    sylar::IOManager iom(2);
+    iom.schedule(&run);
+    return 0;
+}
@@ -0,0 +1,328 @@
+/**
+ * @file test_json.cc
+ * @brief JSON测试：写入器的格式和转义、数字格式化、写进ByteArray、按需读取、跳过字段、错误输入
+ * @version 0.1
+ * @date 2026-10-19
+ */
+#include "sylar/sylar.h"
+#include <locale.h>
+#include <math.h>
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_ROOT();
+
+void test_writer() {
+    std::string out;
+    sylar::JsonWriter w(out);
+    w.startObject()
+        .key("id").value(42)
+        .key("name").value("a\"b\\c\n")
+        .key("ok").value(true)
+        .key("none").null()
+        .key("list").startArray().value(1).value(-2).startObject().endObject().startArray().endArray().endArray()
+        .key("raw").raw("{\"x\":1}")
+     .endObject();
+    SYLAR_ASSERT(w.getDepth() == 0);
+    SYLAR_LOG_INFO(g_logger) << out;
+    SYLAR_ASSERT(out == "{\"id\":42,\"name\":\"a\\\"b\\\\c\\n\",\"ok\":true,\"none\":null"
+                        ",\"list\":[1,-2,{},[]],\"raw\":{\"x\":1}}");
+
+    // 需要转义的字节出现在8字节和16字节块的每个位置
+    for(size_t i = 0; i < 40; ++i) {
+        std::string s(40, 'a');
+        s[i] = "\"\\\x01\x1f"[i % 4];
+        std::string expect = "\"";
+        for(auto c : s) {
+            if(c == '"') {
+                expect += "\\\"";
+            } else if(c == '\\') {
+                expect += "\\\\";
+            } else if(c == '\x01') {
+                expect += "\\u0001";
+            } else if(c == '\x1f') {
+                expect += "\\u001f";
+            } else {
+                expect += c;
+            }
+        }
+        expect += "\"";
+        std::string rt;
+        sylar::JsonWriter::AppendString(rt, s.c_str(), s.size());
+        SYLAR_ASSERT(rt == expect);
+    }
+    // UTF-8和0x7f以上的字节原样写出
+    std::string rt;
+    sylar::JsonWriter::AppendString(rt, "\xE4\xBD\xA0\x7f\xff", 5);
+    SYLAR_ASSERT(rt == "\"\xE4\xBD\xA0\x7f\xff\"");
+    std::string high(32, '\x80');
+    high[7] = ' ';
+    high[20] = '\xff';
+    rt.clear();
+    sylar::JsonWriter::AppendString(rt, high.c_str(), high.size());
+    SYLAR_ASSERT(rt == "\"" + high + "\"");
+    SYLAR_LOG_INFO(g_logger) << "writer test ok";
+}
+
+void test_numbers() {
+    std::string out;
+    sylar::JsonWriter w(out);
+    w.startArray()
+        .value((int64_t)0).value(INT64_MIN).value(INT64_MAX).value(UINT64_MAX)
+        .value(100).value((uint32_t)4000000000u)
+        .value(0.1).value(1.5).value(-3.0).value(1e300).value(NAN).value(INFINITY)
+     .endArray();
+    SYLAR_LOG_INFO(g_logger) << out;
+    SYLAR_ASSERT(out == "[0,-9223372036854775808,9223372036854775807,18446744073709551615"
+                        ",100,4000000000,0.1,1.5,-3,1e+300,null,null]");
+
+    // 浮点数写出后能原样读回
+    for(double v : {M_PI, 1.0 / 3, 123456.789e-20, -2.2250738585072014e-308, 5e-324}) {
+        std::string s;
+        sylar::JsonWriter::AppendDouble(s, v);
+        double back = 0;
+        sylar::JsonReader reader(s);
+        SYLAR_ASSERT(reader.readDouble(back) && back == v && reader.isEnd());
+    }
+    // 随机位模式：总能原样读回，有效数字不超过17位
+    uint64_t x = 0x9E3779B97F4A7C15ull;
+    for(int n = 0; n < 200000; ++n) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        double v;
+        memcpy(&v, &x, sizeof(v));
+        if(!isfinite(v)) {
+            continue;
+        }
+        std::string s;
+        sylar::JsonWriter::AppendDouble(s, v);
+        SYLAR_ASSERT(strtod(s.c_str(), nullptr) == v);
+        size_t end = s.find('e');
+        std::string digits = s.substr(0, end);
+        digits.erase(std::remove_if(digits.begin(), digits.end(), [](char c) {
+            return c < '0' || c > '9';
+        }), digits.end());
+        digits.erase(0, digits.find_first_not_of('0'));
+        digits.erase(digits.find_last_not_of('0') + 1);
+        SYLAR_ASSERT2(digits.size() <= 17, s);
+    }
+    // 最短表示
+    for(auto& i : std::vector<std::pair<double, std::string> >{{0.1 + 0.2, "0.30000000000000004"}
+                , {1e-7, "1e-7"}, {1e21, "1e+21"}, {1e20, "100000000000000000000"}
+                , {0.000001, "0.000001"}, {-2.5e-10, "-2.5e-10"}, {5e-324, "5e-324"}
+                , {1.7976931348623157e308, "1.7976931348623157e+308"}}) {
+        std::string s;
+        sylar::JsonWriter::AppendDouble(s, i.first);
+        SYLAR_ASSERT2(s == i.second, s);
+    }
+    // 小数点是','的locale下读写不变，系统没有这些locale时跳过
+    for(auto& name : {"de_DE.UTF-8", "de_DE.utf8", "fr_FR.UTF-8", "ru_RU.UTF-8"}) {
+        if(!setlocale(LC_NUMERIC, name)) {
+            continue;
+        }
+        std::string s;
+        sylar::JsonWriter::AppendDouble(s, 1.5);
+        double back = 0;
+        sylar::JsonReader reader(s);
+        SYLAR_ASSERT(s == "1.5" && reader.readDouble(back) && back == 1.5);
+        setlocale(LC_NUMERIC, "C");
+        SYLAR_LOG_INFO(g_logger) << "locale " << name << " ok";
+        break;
+    }
+    // 整数读取的边界
+    int64_t i = 0;
+    uint64_t u = 0;
+    std::string ints = "[-9223372036854775808,9223372036854775808,18446744073709551615"
+                       ",18446744073709551616,1.5,-1]";
+    sylar::JsonReader r1(ints);
+    SYLAR_ASSERT(r1.enterArray());
+    SYLAR_ASSERT(r1.nextElement() && r1.readInt64(i) && i == INT64_MIN);
+    SYLAR_ASSERT(r1.nextElement() && !r1.readInt64(i) && r1.readUint64(u) && u == 9223372036854775808ull);
+    SYLAR_ASSERT(r1.nextElement() && r1.readUint64(u) && u == UINT64_MAX);
+    double d = 0;
+    SYLAR_ASSERT(r1.nextElement() && !r1.readUint64(u) && r1.readDouble(d) && d == 18446744073709551616.0);
+    SYLAR_ASSERT(r1.nextElement() && !r1.readInt64(i) && r1.readDouble(d) && d == 1.5);
+    SYLAR_ASSERT(r1.nextElement() && !r1.readUint64(u) && r1.readInt64(i) && i == -1);
+    SYLAR_ASSERT(!r1.nextElement() && r1.isEnd());
+    SYLAR_LOG_INFO(g_logger) << "numbers test ok";
+}
+
+void test_bench() {
+    // 1M文本，每1K字节一个需要转义的字节
+    std::string text(1024 * 1024, 'x');
+    for(size_t i = 512; i < text.size(); i += 1024) {
+        text[i] = '"';
+    }
+    const int loops = 20;
+    std::string out;
+    uint64_t start = sylar::GetCurrentUS();
+    for(int i = 0; i < loops; ++i) {
+        out.clear();
+        sylar::JsonWriter::AppendString(out, text.c_str(), text.size());
+    }
+    uint64_t used = sylar::GetCurrentUS() - start;
+    SYLAR_ASSERT(out.size() == text.size() + 1024 + 2);
+    // 对比：逐字节检查
+    std::string naive;
+    uint64_t naive_start = sylar::GetCurrentUS();
+    for(int i = 0; i < loops; ++i) {
+        naive.clear();
+        naive += '"';
+        for(char c : text) {
+            if(c == '"' || c == '\\' || (unsigned char)c < 0x20) {
+                naive += '\\';
+            }
+            naive += c;
+        }
+        naive += '"';
+    }
+    uint64_t naive_used = sylar::GetCurrentUS() - naive_start;
+    SYLAR_ASSERT(naive == out);
+
+    // 浮点数：对比snprintf("%.17g")
+    const int count = 1000000;
+    std::string num;
+    start = sylar::GetCurrentUS();
+    for(int i = 0; i < count; ++i) {
+        num.clear();
+        sylar::JsonWriter::AppendDouble(num, i * 1.2345678901e-3);
+    }
+    uint64_t double_used = sylar::GetCurrentUS() - start;
+    char buf[32];
+    start = sylar::GetCurrentUS();
+    for(int i = 0; i < count; ++i) {
+        snprintf(buf, sizeof(buf), "%.17g", i * 1.2345678901e-3);
+    }
+    uint64_t printf_used = sylar::GetCurrentUS() - start;
+    SYLAR_LOG_INFO(g_logger) << "escape " << text.size() * loops / used << "MB/s"
+        << " naive " << text.size() * loops / naive_used << "MB/s"
+        << " double " << double_used * 1000 / count << "ns"
+        << " snprintf " << printf_used * 1000 / count << "ns";
+}
+
+void test_bytearray() {
+    sylar::ByteArray::ptr ba(new sylar::ByteArray);
+    std::string expect;
+    {
+        sylar::JsonWriter w(ba);
+        sylar::JsonWriter e(expect);
+        w.startArray();
+        e.startArray();
+        for(int i = 0; i < 2000; ++i) {
+            w.startObject().key("i").value(i).key("s").value("value " + std::to_string(i)).endObject();
+            e.startObject().key("i").value(i).key("s").value("value " + std::to_string(i)).endObject();
+        }
+        w.endArray();
+        e.endArray();
+    }
+    ba->setPosition(0);
+    SYLAR_ASSERT(expect.size() > 8192 && ba->toString() == expect);
+    SYLAR_LOG_INFO(g_logger) << "bytearray test ok";
+}
+
+void test_reader() {
+    std::string json = " { \"id\" : 7, \"name\":\"a\\\"b\\u00e9\\ud83d\\ude00\\n\", \"tags\":[\"x\",\"y\"],"
+                       " \"skip\":{\"deep\":[[{\"a\":[1,2,{\"b\":null}]}],true,false,-1.5e3,\"}\"]},"
+                       " \"ok\":true, \"none\":null, \"empty\":{}, \"list\":[] } ";
+    sylar::JsonReader reader(json);
+    std::string key;
+    int64_t id = 0;
+    std::string name;
+    std::vector<std::string> tags;
+    bool ok = false;
+    int keys = 0;
+    SYLAR_ASSERT(reader.peek() == sylar::JsonReader::OBJECT);
+    SYLAR_ASSERT(reader.enterObject());
+    while(reader.nextKey(key)) {
+        ++keys;
+        if(key == "id") {
+            SYLAR_ASSERT(!reader.readString(name));
+            SYLAR_ASSERT(reader.readInt64(id));
+        } else if(key == "name") {
+            SYLAR_ASSERT(reader.readString(name));
+        } else if(key == "tags") {
+            SYLAR_ASSERT(reader.enterArray());
+            std::string tag;
+            while(reader.nextElement()) {
+                SYLAR_ASSERT(reader.readString(tag));
+                tags.push_back(tag);
+            }
+        } else if(key == "ok") {
+            SYLAR_ASSERT(reader.readBool(ok));
+        } else if(key == "none") {
+            SYLAR_ASSERT(reader.readNull());
+        } else {
+            SYLAR_ASSERT(reader.skip());
+        }
+    }
+    SYLAR_ASSERT(!reader.hasError() && reader.isEnd());
+    SYLAR_ASSERT(keys == 8 && id == 7 && ok);
+    SYLAR_ASSERT(name == "a\"b\xC3\xA9\xF0\x9F\x98\x80\n");
+    SYLAR_ASSERT(tags.size() == 2 && tags[1] == "y");
+
+    // 写入器的输出可以读回
+    std::string out;
+    sylar::JsonWriter w(out);
+    w.startObject().key("k\t").value(name).endObject();
+    sylar::JsonReader back(out);
+    std::string v;
+    SYLAR_ASSERT(back.enterObject() && back.nextKey(key) && key == "k\t");
+    SYLAR_ASSERT(back.readString(v) && v == name && !back.nextKey(key) && back.isEnd());
+    SYLAR_LOG_INFO(g_logger) << "reader test ok";
+}
+
+static bool valid(const std::string& json) {
+    sylar::JsonReader reader(json, 16);
+    return reader.skip() && reader.isEnd();
+}
+
+void test_errors() {
+    SYLAR_ASSERT(valid("[1,{\"a\":\"b\"},[],{}]"));
+    SYLAR_ASSERT(valid("  0  "));
+    for(auto& i : {"", "[1,]", "[1 2]", "{\"a\" 1}", "{\"a\":1,}", "{1:2}", "[01]", "[1.]", "[-]"
+                  ,"[1e]", "\"abc", "\"a\x01\"", "\"\\x\"", "\"\\ud800\"", "\"\\udc00\"", "\"\\u12\""
+                  ,"[tru]", "nul", "[1]]", "{}{}", "[", "{\"a\":1"}) {
+        if(valid(i)) {
+            SYLAR_LOG_ERROR(g_logger) << "should be invalid: " << i;
+            SYLAR_ASSERT(false);
+        }
+    }
+    // 嵌套层数超过上限
+    SYLAR_ASSERT(valid(std::string(16, '[') + std::string(16, ']')));
+    SYLAR_ASSERT(!valid(std::string(17, '[') + std::string(17, ']')));
+    std::string nested(100000, '[');
+    sylar::JsonReader deep(nested);
+    SYLAR_ASSERT(!deep.skip() && deep.hasError() && deep.getOffset() == 128);
+
+    // 出错后所有读取都失败
+    std::string bad = "[1,,2]";
+    sylar::JsonReader reader(bad);
+    int64_t v = 0;
+    SYLAR_ASSERT(reader.enterArray() && reader.nextElement() && reader.readInt64(v));
+    SYLAR_ASSERT(!reader.nextElement() && reader.hasError() && reader.getOffset() == 3);
+    SYLAR_ASSERT(!reader.readInt64(v) && reader.peek() == sylar::JsonReader::NONE);
+    SYLAR_LOG_INFO(g_logger) << "errors test ok";
+}
+
+void test_http() {
+    // 写好的JSON直接move进响应，不再复制
+    std::string body;
+    sylar::JsonWriter w(body);
+    w.startObject().key("code").value(0).key("message").value(std::string(64, 'x')).endObject();
+    const char* data = body.data();
+    sylar::http::HttpResponse::ptr rsp(new sylar::http::HttpResponse);
+    rsp->setBody(std::move(body));
+    SYLAR_ASSERT(rsp->getBody().size() == 87 && rsp->getBody().data() == data);
+    SYLAR_LOG_INFO(g_logger) << "http test ok";
+}
+
+int main(int argc, char *argv[]) {
+    g_logger->setLevel(sylar::LogLevel::INFO);
+    test_writer();
+    test_numbers();
+    test_bench();
+    test_bytearray();
+    test_reader();
+    test_errors();
+    test_http();
+    return 0;
+}
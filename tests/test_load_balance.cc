@@ -0,0 +1,204 @@
+/**
+ * @file test_load_balance.cc
+ * @brief 负载均衡连接池测试：power-of-two-choices避开慢上游和排队的上游、熔断摘除、上游列表更新
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "sylar/sylar.h"
+#include <fstream>
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_ROOT();
+
+static std::atomic<int> s_hits[3];
+static std::vector<sylar::http::HttpServer::ptr> s_servers;
+
+static const std::map<std::string, std::string> s_keepalive = {{"Connection", "keep-alive"}};
+
+static void start_servers() {
+    for(int i = 0; i < 3; ++i) {
+        sylar::http::HttpServer::ptr server(new sylar::http::HttpServer(true));
+        server->addAdminServlets();
+        auto addr = sylar::Address::LookupAnyIPAddress("127.0.0.1:" + std::to_string(8110 + i));
+        while(!server->bind(addr)) {
+            sleep(2);
+        }
+        // 连接池里的连接一直空闲，服务端尽快超时关闭，IOManager才能退出
+        server->setRecvTimeout(500);
+        server->getServletDispatch()->addServlet("/hit", [i](sylar::http::HttpRequest::ptr req
+                    ,sylar::http::HttpResponse::ptr rsp
+                    ,sylar::http::HttpSession::ptr session) {
+            ++s_hits[i];
+            // 第一个上游明显更慢
+            if(i == 0) {
+                usleep(50 * 1000);
+            }
+            rsp->setBody(std::to_string(i));
+            return 0;
+        });
+        server->start();
+        s_servers.push_back(server);
+    }
+}
+
+void test_p2c() {
+    auto pool = sylar::http::HttpLoadBalancePool::Create("lb", {"http://127.0.0.1:8110"
+                , "http://127.0.0.1:8111", "http://127.0.0.1:8112"}, "", 10, 1000 * 60, 100);
+    for(auto& i : s_hits) {
+        i = 0;
+    }
+    for(int i = 0; i < 60; ++i) {
+        auto rt = pool->doGet("/hit", 1000, s_keepalive);
+        SYLAR_ASSERT2(rt->result == 0, rt->toString());
+    }
+    SYLAR_LOG_INFO(g_logger) << "hits " << s_hits[0] << " " << s_hits[1] << " " << s_hits[2]
+        << " " << pool->toString();
+    // 均匀分配时约20个
+    SYLAR_ASSERT(s_hits[0] <= 10);
+    SYLAR_ASSERT(s_hits[1] + s_hits[2] >= 50);
+
+    auto rt = sylar::http::HttpConnection::DoGet("http://127.0.0.1:8111/_/status", 1000);
+    SYLAR_ASSERT(rt->result == 0);
+    const std::string& status = rt->response->getBody();
+    for(auto& i : {"sylar_http_lb_requests_total{endpoint=\"http://127.0.0.1:8110\",name=\"lb\"}"
+                   ,"sylar_http_lb_latency_seconds{endpoint=\"http://127.0.0.1:8111\",name=\"lb\"}"
+                   ,"sylar_http_lb_inflight{endpoint=\"http://127.0.0.1:8112\",name=\"lb\"} 0"}) {
+        if(status.find(i) == std::string::npos) {
+            SYLAR_LOG_ERROR(g_logger) << "missing " << i;
+            SYLAR_ASSERT(false);
+        }
+    }
+    SYLAR_LOG_INFO(g_logger) << "p2c test ok";
+}
+
+void test_inflight() {
+    // 只有两个上游时两个候选总是它们，耗时相同时选并发少的
+    auto pool = sylar::http::HttpLoadBalancePool::Create("inflight", {"http://127.0.0.1:8111"
+                , "http://127.0.0.1:8112"}, "", 10, 1000 * 60, 100);
+    auto eps = pool->getEndpoints();
+    SYLAR_ASSERT(eps.size() == 2);
+    uint64_t now = sylar::GetCurrentUS();
+    eps[0]->observe(1000, now, 1e7);
+    eps[1]->observe(1000, now, 1e7);
+    eps[0]->inflight = 5;
+    for(int i = 0; i < 10; ++i) {
+        SYLAR_ASSERT(pool->select() == eps[1]);
+    }
+    // 并发相同时选耗时低的，耗时下降按时间衰减
+    eps[0]->inflight = 0;
+    eps[1]->observe(4000, now, 1e7);
+    SYLAR_ASSERT(pool->select() == eps[0]);
+    eps[1]->observe(100, now + 100 * 1000 * 1000, 1e7);
+    SYLAR_ASSERT(eps[1]->getLatency() < 200);
+    SYLAR_ASSERT(pool->select() == eps[1]);
+    SYLAR_LOG_INFO(g_logger) << "inflight test ok";
+}
+
+void test_decay() {
+    // 慢上游不再被选中、没有新样本时，挑选时按时间衰减，过一段时间后重新得到请求
+    auto pool = sylar::http::HttpLoadBalancePool::Create("decay", {"http://127.0.0.1:8111"
+                , "http://127.0.0.1:8112"}, "", 10, 1000 * 60, 100);
+    auto eps = pool->getEndpoints();
+    uint64_t now = sylar::GetCurrentUS();
+    eps[0]->observe(1000, now, 1e7);
+    eps[1]->observe(4000, now - 30 * 1000 * 1000, 1e7);
+    SYLAR_ASSERT(eps[1]->getLatency() == 4000);
+    SYLAR_ASSERT(pool->select() == eps[1]);
+    SYLAR_ASSERT(eps[1]->getLatency() < 250);
+    SYLAR_LOG_INFO(g_logger) << "decay test ok";
+}
+
+void test_eject() {
+    // 8113上没有服务：失败按两倍耗时计入后很少被选中，连续失败后被熔断，请求全部发往正常的上游
+    auto errors = sylar::Config::Lookup<uint32_t>("circuit_breaker.consecutive_errors");
+    errors->setValue(2);
+    auto pool = sylar::http::HttpLoadBalancePool::Create("eject", {"http://127.0.0.1:8113"
+                , "http://127.0.0.1:8111"}, "", 10, 1000 * 60, 100);
+    int ok = 0;
+    for(int i = 0; i < 30; ++i) {
+        ok += pool->doGet("/hit", 1000, s_keepalive)->result == 0;
+    }
+    auto dead = pool->getEndpoints()[0];
+    SYLAR_LOG_INFO(g_logger) << "ok=" << ok << " " << pool->toString();
+    SYLAR_ASSERT(ok >= 25 && dead->requests->get() <= 5);
+    // 熔断中的上游不参与挑选
+    while(dead->pool->getCircuitBreaker()->getState() != sylar::CircuitBreaker::OPEN) {
+        SYLAR_ASSERT(dead->pool->doGet("/hit", 1000)->result != 0);
+    }
+    uint64_t dead_requests = dead->requests->get();
+    for(int i = 0; i < 10; ++i) {
+        SYLAR_ASSERT(pool->doGet("/hit", 1000, s_keepalive)->result == 0);
+    }
+    SYLAR_ASSERT(dead->requests->get() == dead_requests);
+
+    // 连续失败计入的耗时有上限，不会逐次翻倍
+    errors->setValue(1000);
+    auto single = sylar::http::HttpLoadBalancePool::Create("penalty", {"http://127.0.0.1:8113"}
+                , "", 10, 1000 * 60, 100);
+    for(int i = 0; i < 30; ++i) {
+        SYLAR_ASSERT(single->doGet("/hit", 1000)->result != 0);
+    }
+    double penalty = single->getEndpoints()[0]->getLatency();
+    SYLAR_LOG_INFO(g_logger) << "failure penalty " << penalty << "us";
+    SYLAR_ASSERT(penalty > 0 && penalty <= 1000 * 1000);
+    errors->setValue(5);
+    SYLAR_LOG_INFO(g_logger) << "eject test ok";
+}
+
+void test_update() {
+    auto pool = sylar::http::HttpLoadBalancePool::Create("update", {"http://127.0.0.1:8111"
+                , "http://127.0.0.1:8112"}, "", 10, 1000 * 60, 100);
+    auto first = pool->getEndpoints()[0];
+    // 保留已有上游的连接池和统计，非法地址被忽略
+    SYLAR_ASSERT(pool->setEndpoints({"http://127.0.0.1:8111", "http://127.0.0.1:8111"
+                , "http://[bad"}) == 1);
+    SYLAR_ASSERT(pool->getEndpoints()[0] == first);
+
+    std::string path = "/tmp/test_load_balance_endpoints";
+    {
+        std::ofstream ofs(path);
+        ofs << "# upstreams\n"
+            << "  http://127.0.0.1:8111  \n"
+            << "\n"
+            << "http://127.0.0.1:8112\n";
+    }
+    auto file_pool = sylar::http::HttpLoadBalancePool::CreateFromFile("file", path, "", 10, 1000 * 60, 100);
+    SYLAR_ASSERT(file_pool && file_pool->getEndpoints().size() == 2);
+    SYLAR_ASSERT(file_pool->doGet("/hit", 1000)->result == 0);
+    SYLAR_ASSERT(!sylar::http::HttpLoadBalancePool::CreateFromFile("file", path + ".none"
+                , "", 10, 1000 * 60, 100));
+
+    // 配置变化时更新上游
+    typedef std::map<std::string, std::vector<std::string> > Upstreams;
+    auto var = sylar::Config::Lookup<Upstreams>("http.upstreams");
+    var->setValue({{"conf", {"http://127.0.0.1:8111"}}});
+    auto conf_pool = sylar::http::HttpLoadBalancePool::CreateFromConfig("conf", "", 10, 1000 * 60, 100);
+    SYLAR_ASSERT(conf_pool->getEndpoints().size() == 1);
+    var->setValue({{"conf", {"http://127.0.0.1:8111", "http://127.0.0.1:8112"}}});
+    SYLAR_ASSERT(conf_pool->getEndpoints().size() == 2);
+    conf_pool.reset();
+    var->setValue({{"conf", {"http://127.0.0.1:8112"}}});
+
+    auto empty = sylar::http::HttpLoadBalancePool::Create("empty", {}, "", 10, 1000 * 60, 100);
+    SYLAR_ASSERT(empty->doGet("/hit", 1000)->result
+            == (int)sylar::http::HttpResult::Error::POOL_GET_CONNECTION);
+    SYLAR_LOG_INFO(g_logger) << "update test ok";
+}
+
+void run() {
+    g_logger->setLevel(sylar::LogLevel::INFO);
+    start_servers();
+    test_p2c();
+    test_inflight();
+    test_decay();
+    test_eject();
+    test_update();
+    for(auto& i : s_servers) {
+        i->stop();
+    }
+}
+
+int main(int argc, char *argv[]) {
+    sylar::IOManager iom(2);
+    iom.schedule(&run);
+    return 0;
+}
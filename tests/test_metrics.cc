@@ -0,0 +1,144 @@
+/**
+ * @file test_metrics.cc
+ * @brief 指标注册表和/_/status测试
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "sylar/sylar.h"
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_ROOT();
+
+void test_counter() {
+    auto counter = sylar::MetricsMgr::GetInstance()->counter("test_counter_total", "test counter");
+    const int threads = 4;
+    const int loops = 1000000;
+    std::vector<sylar::Thread::ptr> thrs;
+    uint64_t start = sylar::GetCurrentUS();
+    for(int i = 0; i < threads; ++i) {
+        thrs.push_back(std::make_shared<sylar::Thread>([counter]() {
+            for(int j = 0; j < loops; ++j) {
+                counter->inc();
+            }
+        }, "counter_" + std::to_string(i)));
+    }
+    for(auto& i : thrs) {
+        i->join();
+    }
+    uint64_t used = sylar::GetCurrentUS() - start;
+    SYLAR_ASSERT(counter->get() == (uint64_t)threads * loops);
+    SYLAR_LOG_INFO(g_logger) << "counter inc threads=" << threads
+        << " per_inc=" << used * 1000 / loops << "ns";
+}
+
+void test_histogram() {
+    auto h = sylar::MetricsMgr::GetInstance()->histogram("test_latency_seconds", "test histogram"
+                , {{"route", "/a"}}, {0.1, 1});
+    h->observe(0.05);
+    h->observe(0.5);
+    h->observe(0.5);
+    h->observe(3);
+    SYLAR_ASSERT(h->getCount() == 4);
+    SYLAR_ASSERT(h->getSum() == 4.05);
+    std::string text = sylar::MetricsMgr::GetInstance()->toPrometheus();
+    SYLAR_ASSERT(text.find("# TYPE test_latency_seconds histogram\n") != std::string::npos);
+    SYLAR_ASSERT(text.find("test_latency_seconds_bucket{route=\"/a\",le=\"0.1\"} 1\n") != std::string::npos);
+    SYLAR_ASSERT(text.find("test_latency_seconds_bucket{route=\"/a\",le=\"1\"} 3\n") != std::string::npos);
+    SYLAR_ASSERT(text.find("test_latency_seconds_bucket{route=\"/a\",le=\"+Inf\"} 4\n") != std::string::npos);
+    SYLAR_ASSERT(text.find("test_latency_seconds_count{route=\"/a\"} 4\n") != std::string::npos);
+}
+
+void test_registry() {
+    auto metrics = sylar::MetricsMgr::GetInstance();
+    auto c1 = metrics->counter("test_requests_total", "", {{"code", "200"}});
+    auto c2 = metrics->counter("test_requests_total", "", {{"code", "200"}});
+    SYLAR_ASSERT(c1 == c2);
+    // 同名不同类型
+    SYLAR_ASSERT(!metrics->gauge("test_requests_total", "", {{"code", "500"}}));
+    metrics->gauge("test_queue", "queue length", {{"name", "a\"b"}}, []() { return 7.5; });
+    std::string text = metrics->toPrometheus();
+    SYLAR_ASSERT(text.find("test_queue{name=\"a\\\"b\"} 7.5\n") != std::string::npos);
+    metrics->remove("test_queue", {{"name", "a\"b"}});
+    SYLAR_ASSERT(metrics->toPrometheus().find("test_queue") == std::string::npos);
+}
+
+void test_status() {
+    sylar::http::HttpServer::ptr server(new sylar::http::HttpServer(true));
+    server->addAdminServlets();
+    auto addr = sylar::Address::LookupAnyIPAddress("127.0.0.1:8102");
+    while(!server->bind(addr)) {
+        sleep(2);
+    }
+    server->getServletDispatch()->addServlet("/hello", [](sylar::http::HttpRequest::ptr req
+                , sylar::http::HttpResponse::ptr rsp
+                , sylar::http::HttpSession::ptr session) {
+        rsp->setBody("hello");
+        return 0;
+    });
+    server->start();
+
+    for(int i = 0; i < 3; ++i) {
+        auto rt = sylar::http::HttpConnection::DoGet("http://127.0.0.1:8102/hello", 1000);
+        SYLAR_ASSERT(rt->result == 0);
+    }
+    sylar::http::HttpConnection::DoGet("http://127.0.0.1:8102/missing", 1000);
+    auto rt = sylar::http::HttpConnection::DoGet("http://127.0.0.1:8102/_/status", 1000);
+    SYLAR_ASSERT(rt->result == 0);
+    const std::string& body = rt->response->getBody();
+    SYLAR_LOG_INFO(g_logger) << "\n" << body;
+    SYLAR_ASSERT(rt->response->getHeader("Content-Type").find("text/plain") == 0);
+    for(auto& i : {"sylar_http_requests_total{code=\"2xx\"} 3\n"
+                   ,"sylar_http_requests_total{code=\"4xx\"} 1\n"
+                   ,"sylar_http_request_duration_seconds_count 4\n"
+                   ,"sylar_http_connections "
+                   ,"# TYPE sylar_fibers gauge\n"
+                   ,"sylar_scheduler_threads{id=\"1\",scheduler=\"main\"} 2\n"
+                   ,"sylar_iomanager_pending_events{id=\"1\",scheduler=\"main\"}"
+                   ,"sylar_iomanager_timers{id=\"1\",scheduler=\"main\"}"
+                   ,"sylar_socket_accepted_total"
+                   ,"sylar_socket_recv_bytes_total"}) {
+        if(body.find(i) == std::string::npos) {
+            SYLAR_LOG_ERROR(g_logger) << "missing " << i;
+            SYLAR_ASSERT(false);
+        }
+    }
+    server->stop();
+    SYLAR_LOG_INFO(g_logger) << "status test ok";
+}
+
+void test_admin_off() {
+    // 默认不挂管理接口；打开后也不覆盖用户自己注册的同名路径
+    sylar::http::HttpServer::ptr server(new sylar::http::HttpServer(true));
+    auto addr = sylar::Address::LookupAnyIPAddress("127.0.0.1:8118");
+    while(!server->bind(addr)) {
+        sleep(2);
+    }
+    server->start();
+    auto rt = sylar::http::HttpConnection::DoGet("http://127.0.0.1:8118/_/status", 1000);
+    SYLAR_ASSERT(rt->result == 0);
+    SYLAR_ASSERT(rt->response->getStatus() == sylar::http::HttpStatus::NOT_FOUND);
+
+    server->getServletDispatch()->addServlet("/_/flight", [](sylar::http::HttpRequest::ptr req
+                , sylar::http::HttpResponse::ptr rsp
+                , sylar::http::HttpSession::ptr session) {
+        rsp->setBody("user flight");
+        return 0;
+    });
+    server->addAdminServlets();
+    rt = sylar::http::HttpConnection::DoGet("http://127.0.0.1:8118/_/flight", 1000);
+    SYLAR_ASSERT(rt->result == 0);
+    SYLAR_ASSERT(rt->response->getBody() == "user flight");
+    server->stop();
+    SYLAR_LOG_INFO(g_logger) << "admin off test ok";
+}
+
+int main(int argc, char *argv[]) {
+    test_counter();
+    test_histogram();
+    test_registry();
+    sylar::IOManager iom(2, true, "main");
+    iom.schedule([]() {
+        test_status();
+        test_admin_off();
+    });
+    return 0;
+}
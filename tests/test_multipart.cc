@@ -0,0 +1,290 @@
+/**
+ * @file test_multipart.cc
+ * @brief 消息体解析测试：multipart任意切分、分隔符前缀出现在内容中、头部过大和中止、
+ *        urlencoded流式解析、initBodyParam取multipart字段、流式servlet边收边写盘
+ * @version 0.1
+ * @date 2026-10-19
+ */
+#include "sylar/sylar.h"
+#include <fstream>
+#include <sstream>
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_ROOT();
+
+static const std::string s_boundary = "----sylarBoundary7MA4YWxk";
+
+struct Collected {
+    std::vector<sylar::http::MultipartParser::Part> parts;
+    std::vector<std::string> bodies;
+    int ends = 0;
+};
+
+static void collect(sylar::http::MultipartParser& parser, Collected& c) {
+    parser.setOnPartBegin([&c](const sylar::http::MultipartParser::Part& part) {
+        c.parts.push_back(part);
+        c.bodies.push_back("");
+        return true;
+    });
+    parser.setOnPartData([&c](const char* data, size_t len) {
+        c.bodies.back().append(data, len);
+        return true;
+    });
+    parser.setOnPartEnd([&c]() {
+        ++c.ends;
+        return true;
+    });
+}
+
+static std::string make_body(const std::string& binary) {
+    std::string body = "preamble is ignored\r\n";
+    body += "--" + s_boundary + "\r\n";
+    body += "Content-Disposition: form-data; name=\"title\"\r\n\r\n";
+    body += "hello; world";
+    body += "\r\n--" + s_boundary + "  \r\n";
+    body += "Content-Disposition: form-data; name=\"file\"; filename=\"a \\\"b\\\".bin\"\r\n";
+    body += "Content-Type: application/octet-stream\r\n\r\n";
+    body += binary;
+    body += "\r\n--" + s_boundary + "\r\n";
+    body += "Content-Disposition: form-data; name=\"utf8\"; filename*=UTF-8''%E2%82%AC.txt\r\n\r\n";
+    body += "\r\n--" + s_boundary + "--\r\nepilogue";
+    return body;
+}
+
+void test_split() {
+    SYLAR_ASSERT(sylar::http::MultipartParser::GetBoundary("multipart/form-data; boundary=" + s_boundary) == s_boundary);
+    SYLAR_ASSERT(sylar::http::MultipartParser::GetBoundary("Multipart/Form-Data; charset=utf-8; Boundary=\"a;b c\"") == "a;b c");
+    SYLAR_ASSERT(sylar::http::MultipartParser::GetBoundary("application/json; boundary=abc").empty());
+    SYLAR_ASSERT(sylar::http::MultipartParser::GetBoundary("multipart/form-data").empty());
+
+    // 内容里有分隔符的前缀、单独的'\r'和'\0'
+    std::string binary = "\r\n--" + s_boundary.substr(0, 10) + "\r\r\n-";
+    binary.append(1, '\0');
+    binary += "\r\n--" + s_boundary.substr(0, s_boundary.size() - 1) + "x\r";
+    std::string body = make_body(binary);
+    // 按各种大小切分，结果都相同
+    for(size_t step = 1; step <= body.size(); step = step < 64 ? step + 1 : step * 2) {
+        sylar::http::MultipartParser parser(s_boundary);
+        Collected c;
+        collect(parser, c);
+        for(size_t pos = 0; pos < body.size(); pos += step) {
+            SYLAR_ASSERT(parser.execute(body.c_str() + pos, std::min(step, body.size() - pos)));
+        }
+        SYLAR_ASSERT(parser.isFinished() && parser.getPartCount() == 3 && c.ends == 3);
+        SYLAR_ASSERT(c.parts[0].name == "title" && !c.parts[0].isFile());
+        SYLAR_ASSERT(c.bodies[0] == "hello; world");
+        SYLAR_ASSERT(c.parts[1].name == "file" && c.parts[1].filename == "a \"b\".bin");
+        SYLAR_ASSERT(c.parts[1].contentType == "application/octet-stream");
+        SYLAR_ASSERT(c.bodies[1] == binary);
+        SYLAR_ASSERT(c.parts[2].filename == "\xE2\x82\xAC.txt" && c.bodies[2].empty());
+    }
+    SYLAR_LOG_INFO(g_logger) << "split test ok";
+}
+
+void test_errors() {
+    // part头部过大
+    sylar::http::MultipartParser parser(s_boundary, 64);
+    std::string body = "--" + s_boundary + "\r\nX-Big: " + std::string(100, 'a');
+    SYLAR_ASSERT(!parser.execute(body.c_str(), body.size()));
+    SYLAR_ASSERT(parser.getError() == sylar::http::MultipartParser::TOO_LARGE);
+
+    // 分隔符后面既不是CRLF也不是"--"
+    sylar::http::MultipartParser bad(s_boundary);
+    body = "--" + s_boundary + "xx\r\n\r\n";
+    SYLAR_ASSERT(!bad.execute(body.c_str(), body.size()));
+    SYLAR_ASSERT(bad.getError() == sylar::http::MultipartParser::INVALID);
+
+    // 回调返回false中止
+    sylar::http::MultipartParser abort(s_boundary);
+    abort.setOnPartData([](const char* data, size_t len) {
+        return false;
+    });
+    body = make_body("data");
+    SYLAR_ASSERT(!abort.execute(body.c_str(), body.size()));
+    SYLAR_ASSERT(abort.getError() == sylar::http::MultipartParser::ABORTED);
+
+    // 没有结束分隔符
+    sylar::http::MultipartParser unfinished(s_boundary);
+    body = "--" + s_boundary + "\r\n\r\ndata";
+    SYLAR_ASSERT(unfinished.execute(body.c_str(), body.size()) && !unfinished.isFinished());
+    SYLAR_LOG_INFO(g_logger) << "errors test ok";
+}
+
+void test_urlencoded() {
+    std::map<std::string, std::string> params;
+    sylar::http::FormUrlencodedParser parser([&params](const std::string& k, const std::string& v) {
+        params[k] = v;
+        return true;
+    }, 32);
+    std::string body = "a=1&b=hello+world&&noeq&c=%E4%BD%A0%3D";
+    for(size_t i = 0; i < body.size(); i += 3) {
+        SYLAR_ASSERT(parser.execute(body.c_str() + i, std::min((size_t)3, body.size() - i)));
+    }
+    SYLAR_ASSERT(parser.finish());
+    SYLAR_ASSERT(params.size() == 3 && params["a"] == "1" && params["b"] == "hello world");
+    SYLAR_ASSERT(params["c"] == "\xE4\xBD\xA0=");
+
+    // 单个参数超过上限
+    sylar::http::FormUrlencodedParser limited([](const std::string& k, const std::string& v) {
+        return true;
+    }, 32);
+    std::string big = "k=" + std::string(40, 'v');
+    SYLAR_ASSERT(!limited.execute(big.c_str(), big.size()));
+
+    // 缓存的请求体也能取到multipart中的普通字段
+    auto req = std::make_shared<sylar::http::HttpRequest>();
+    req->setHeader("Content-Type", "multipart/form-data; boundary=" + s_boundary);
+    req->setBody(make_body("file content"));
+    SYLAR_ASSERT(req->getParam("title") == "hello; world");
+    SYLAR_ASSERT(!req->hasParam("file"));
+    SYLAR_LOG_INFO(g_logger) << "urlencoded test ok";
+}
+
+/**
+ * @brief 边收边把文件写盘，返回每个part的名字和大小
+ */
+class UploadServlet : public sylar::http::Servlet {
+public:
+    UploadServlet()
+        :Servlet("UploadServlet") {}
+
+    bool isStreaming() const override { return true;}
+
+    int32_t handle(sylar::http::HttpRequest::ptr request
+                   , sylar::http::HttpResponse::ptr response
+                   , sylar::http::HttpSession::ptr session) override {
+        sylar::http::MultipartParser parser(sylar::http::MultipartParser::GetBoundary(
+                    request->getHeader("Content-Type")));
+        std::ofstream ofs;
+        std::stringstream ss;
+        std::string name;
+        size_t size = 0;
+        parser.setOnPartBegin([&](const sylar::http::MultipartParser::Part& part) {
+            name = part.name;
+            size = 0;
+            if(part.isFile()) {
+                ofs.open("/tmp/test_multipart_" + part.name, std::ios::binary | std::ios::trunc);
+            }
+            return true;
+        });
+        parser.setOnPartData([&](const char* data, size_t len) {
+            size += len;
+            if(ofs.is_open()) {
+                ofs.write(data, len);
+            }
+            return (bool)ofs || !ofs.is_open();
+        });
+        parser.setOnPartEnd([&]() {
+            ss << name << ":" << size << ";";
+            ofs.close();
+            return true;
+        });
+        if(!parser.readFrom(session)) {
+            response->setStatus(sylar::http::HttpStatus::BAD_REQUEST);
+            return 0;
+        }
+        response->setBody(ss.str());
+        return 0;
+    }
+};
+
+void test_upload() {
+    sylar::http::HttpServer::ptr server(new sylar::http::HttpServer(true));
+    auto addr = sylar::Address::LookupAnyIPAddress("127.0.0.1:8116");
+    while(!server->bind(addr)) {
+        sleep(2);
+    }
+    server->getServletDispatch()->addServlet("/upload", std::make_shared<UploadServlet>());
+    server->start();
+
+    std::string file;
+    for(int i = 0; i < 4 * 1024 * 1024; ++i) {
+        file.append(1, (char)(i * 131 + (i >> 12)));
+    }
+    std::string body = make_body(file);
+    std::map<std::string, std::string> headers = {
+        {"Content-Type", "multipart/form-data; boundary=" + s_boundary}};
+    auto rt = sylar::http::HttpConnection::DoPost("http://127.0.0.1:8116/upload", 5000, headers, body);
+    SYLAR_ASSERT2(rt->result == 0, rt->toString());
+    SYLAR_LOG_INFO(g_logger) << "upload: " << rt->response->getBody();
+    SYLAR_ASSERT(rt->response->getBody() == "title:12;file:" + std::to_string(file.size()) + ";utf8:0;");
+    std::ifstream ifs("/tmp/test_multipart_file", std::ios::binary);
+    std::string saved((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    SYLAR_ASSERT(saved == file);
+
+    // 消息体在结束分隔符之前结束
+    body = "--" + s_boundary + "\r\nContent-Disposition: form-data; name=\"x\"\r\n\r\ndata";
+    rt = sylar::http::HttpConnection::DoPost("http://127.0.0.1:8116/upload", 5000, headers, body);
+    SYLAR_ASSERT(rt->result == 0 && rt->response->getStatus() == sylar::http::HttpStatus::BAD_REQUEST);
+    server->stop();
+    SYLAR_LOG_INFO(g_logger) << "upload test ok";
+}
+
+void test_bench() {
+    // 8M随机二进制内容，平均每256字节一个'\r'
+    std::string binary(8 * 1024 * 1024, '\0');
+    uint64_t x = 0x9E3779B97F4A7C15ull;
+    for(size_t i = 0; i < binary.size(); i += 8) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        memcpy(&binary[i], &x, 8);
+    }
+    std::string body = make_body(binary);
+    const size_t chunk = 64 * 1024;
+    const int loops = 5;
+    uint64_t start = sylar::GetCurrentUS();
+    for(int n = 0; n < loops; ++n) {
+        sylar::http::MultipartParser parser(s_boundary);
+        size_t size = 0;
+        parser.setOnPartData([&size](const char* data, size_t len) {
+            size += len;
+            return true;
+        });
+        for(size_t pos = 0; pos < body.size(); pos += chunk) {
+            SYLAR_ASSERT(parser.execute(body.c_str() + pos, std::min(chunk, body.size() - pos)));
+        }
+        SYLAR_ASSERT(parser.isFinished() && size == binary.size() + 12);
+    }
+    uint64_t used = sylar::GetCurrentUS() - start;
+
+    // 随机内容按64K切分后原样还原
+    sylar::http::MultipartParser parser(s_boundary);
+    Collected c;
+    collect(parser, c);
+    for(size_t pos = 0; pos < body.size(); pos += chunk) {
+        SYLAR_ASSERT(parser.execute(body.c_str() + pos, std::min(chunk, body.size() - pos)));
+    }
+    SYLAR_ASSERT(parser.isFinished() && c.bodies[1] == binary);
+
+    // 对比：memchr找'\r'再比较
+    std::string delim = "\r\n--" + s_boundary;
+    size_t found = 0;
+    uint64_t memchr_start = sylar::GetCurrentUS();
+    for(int n = 0; n < loops; ++n) {
+        const char* p = body.c_str();
+        const char* end = p + body.size();
+        while((p = (const char*)memchr(p, '\r', end - p))) {
+            found += (size_t)(end - p) >= delim.size() && memcmp(p, delim.c_str(), delim.size()) == 0;
+            ++p;
+        }
+    }
+    uint64_t memchr_used = sylar::GetCurrentUS() - memchr_start;
+    SYLAR_ASSERT(found == 4 * (size_t)loops);
+    SYLAR_LOG_INFO(g_logger) << "parse " << body.size() * loops / used << "MB/s"
+        << " memchr scan " << body.size() * loops / std::max(memchr_used, (uint64_t)1) << "MB/s";
+}
+
+void run() {
+    g_logger->setLevel(sylar::LogLevel::INFO);
+    test_split();
+    test_bench();
+    test_errors();
+    test_urlencoded();
+    test_upload();
+}
+
+int main(int argc, char *argv[]) {
+    sylar::IOManager iom(2);
+    iom.schedule(&run);
+    return 0;
+}
@@ -0,0 +1,120 @@
+/**
+ * @file test_park_idle.cc
+ * @brief 停放空闲长连接测试：空闲连接不占协程、收到数据后处理、流水线请求、空闲超时关闭
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "sylar/sylar.h"
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_ROOT();
+
+static const int s_conns = 200;
+
+static double gauge(const std::string& name) {
+    return sylar::MetricsMgr::GetInstance()->gauge(name, "")->get();
+}
+
+static sylar::http::HttpConnection::ptr connect() {
+    auto addr = sylar::Address::LookupAnyIPAddress("127.0.0.1:8114");
+    auto sock = sylar::Socket::CreateTCP(addr);
+    SYLAR_ASSERT(sock->connect(addr));
+    sock->setRecvTimeout(1000);
+    return std::make_shared<sylar::http::HttpConnection>(sock);
+}
+
+static sylar::http::HttpRequest::ptr make_request(const std::string& path) {
+    auto req = std::make_shared<sylar::http::HttpRequest>();
+    req->setPath(path);
+    req->setHeader("Host", "127.0.0.1");
+    req->setClose(false);
+    return req;
+}
+
+void test_park(sylar::http::HttpServer::ptr server) {
+    uint64_t fibers = sylar::Fiber::TotalFibers();
+    std::vector<sylar::http::HttpConnection::ptr> conns;
+    for(int i = 0; i < s_conns; ++i) {
+        conns.push_back(connect());
+    }
+    usleep(100 * 1000);
+    // 空闲连接只注册了读事件，不占用协程
+    SYLAR_LOG_INFO(g_logger) << "fibers before=" << fibers << " idle=" << sylar::Fiber::TotalFibers()
+        << " parked=" << gauge("sylar_http_parked_connections");
+    SYLAR_ASSERT(gauge("sylar_http_parked_connections") == s_conns);
+    SYLAR_ASSERT(sylar::Fiber::TotalFibers() < fibers + 10);
+
+    // 每个连接上连续发两个请求，处理完后重新停放
+    for(int n = 0; n < 2; ++n) {
+        for(auto& i : conns) {
+            SYLAR_ASSERT(i->sendRequest(make_request("/hit")) > 0);
+            auto rsp = i->recvResponse();
+            SYLAR_ASSERT(rsp && rsp->getBody() == "hit");
+        }
+    }
+    usleep(50 * 1000);
+    SYLAR_ASSERT(gauge("sylar_http_parked_connections") == s_conns);
+
+    // 流水线上的第二个请求已在读取器中，不停放直接处理
+    auto conn = conns[0];
+    std::string pipelined = make_request("/hit")->toString() + make_request("/hit")->toString();
+    SYLAR_ASSERT(conn->writeFixSize(pipelined.c_str(), pipelined.size()) > 0);
+    for(int i = 0; i < 2; ++i) {
+        auto rsp = conn->recvResponse();
+        SYLAR_ASSERT(rsp && rsp->getBody() == "hit");
+    }
+
+    // 空闲超过接收超时时间的连接被关闭
+    usleep(500 * 1000);
+    SYLAR_ASSERT(gauge("sylar_http_parked_connections") == 0);
+    char buf[16];
+    for(auto& i : conns) {
+        SYLAR_ASSERT(i->read(buf, sizeof(buf)) == 0);
+    }
+    SYLAR_LOG_INFO(g_logger) << "park test ok";
+}
+
+void test_unparked(sylar::http::HttpServer::ptr server) {
+    // 关闭停放时每个空闲连接占一个协程
+    server->setParkIdle(false);
+    uint64_t fibers = sylar::Fiber::TotalFibers();
+    std::vector<sylar::http::HttpConnection::ptr> conns;
+    for(int i = 0; i < 20; ++i) {
+        conns.push_back(connect());
+    }
+    usleep(100 * 1000);
+    SYLAR_ASSERT(sylar::Fiber::TotalFibers() >= fibers + 20);
+    for(auto& i : conns) {
+        SYLAR_ASSERT(i->sendRequest(make_request("/hit")) > 0);
+        auto rsp = i->recvResponse();
+        SYLAR_ASSERT(rsp && rsp->getBody() == "hit");
+    }
+    SYLAR_LOG_INFO(g_logger) << "unparked test ok";
+}
+
+void run() {
+    g_logger->setLevel(sylar::LogLevel::INFO);
+    sylar::http::HttpServer::ptr server(new sylar::http::HttpServer(true));
+    auto addr = sylar::Address::LookupAnyIPAddress("127.0.0.1:8114");
+    while(!server->bind(addr)) {
+        sleep(2);
+    }
+    server->setParkIdle(true);
+    server->setRecvTimeout(300);
+    server->getServletDispatch()->addServlet("/hit", [](sylar::http::HttpRequest::ptr req
+                , sylar::http::HttpResponse::ptr rsp
+                , sylar::http::HttpSession::ptr session) {
+        rsp->setBody("hit");
+        return 0;
+    });
+    server->start();
+
+    test_park(server);
+    test_unparked(server);
+    server->stop();
+}
+
+int main(int argc, char *argv[]) {
+    sylar::IOManager iom(2);
+    iom.schedule(&run);
+    return 0;
+}
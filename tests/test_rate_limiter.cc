@@ -0,0 +1,176 @@
+/**
+ * @file test_rate_limiter.cc
+ * @brief 令牌桶限流器测试，包括TcpServer接入限流和HTTP限流过滤器
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "sylar/sylar.h"
+#include "sylar/rate_limiter.h"
+#include "sylar/http/servlets/rate_limit_filter.h"
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_ROOT();
+
+void test_bucket() {
+    sylar::RateLimiter limiter(10, 5, 8000, 4);
+    uint64_t now = 1000000;
+    for(int i = 0; i < 5; ++i) {
+        SYLAR_ASSERT(limiter.allow("a", 1, now));
+    }
+    SYLAR_ASSERT(!limiter.allow("a", 1, now));
+    // 其他key不受影响
+    SYLAR_ASSERT(limiter.allow("b", 1, now));
+    // 100ms补充一个令牌
+    SYLAR_ASSERT(limiter.allow("a", 1, now + 100));
+    SYLAR_ASSERT(!limiter.allow("a", 1, now + 100));
+    // 最多攒burst个
+    SYLAR_ASSERT(limiter.allow("a", 5, now + 10000));
+    SYLAR_ASSERT(!limiter.allow("a", 1, now + 10000));
+    SYLAR_ASSERT(!limiter.allow("a", 6, now + 20000));
+    SYLAR_LOG_INFO(g_logger) << "bucket test ok";
+}
+
+void test_evict() {
+    sylar::RateLimiter limiter(10, 5, 8000, 4);
+    uint64_t now = 1000000;
+    for(int i = 0; i < 1000; ++i) {
+        limiter.allow("key" + std::to_string(i), 1, now);
+    }
+    SYLAR_ASSERT(limiter.size() == 1000);
+    // 活跃的key一直保留
+    for(uint64_t t = now; t <= now + 20000; t += 500) {
+        for(int i = 0; i < 10; ++i) {
+            limiter.allow("key" + std::to_string(i), 1, t);
+        }
+    }
+    SYLAR_ASSERT(limiter.size() == 10);
+    // 长时间没有请求后，下一次访问时各分片淘汰全部空闲桶
+    for(int i = 0; i < 100; ++i) {
+        limiter.allow("new" + std::to_string(i), 1, now + 100000);
+    }
+    SYLAR_ASSERT(limiter.size() == 100);
+    SYLAR_LOG_INFO(g_logger) << "evict test ok " << limiter.toString();
+}
+
+void bench_allow() {
+    sylar::RateLimiter::ptr limiter(new sylar::RateLimiter(1000000, 1000000));
+    const int threads = 4;
+    const int loops = 250000;
+    std::vector<sylar::Thread::ptr> thrs;
+    std::atomic<uint64_t> allowed(0);
+    uint64_t start = sylar::GetCurrentUS();
+    for(int i = 0; i < threads; ++i) {
+        thrs.push_back(std::make_shared<sylar::Thread>([limiter, i, &allowed]() {
+            std::vector<std::string> keys;
+            for(int k = 0; k < 1024; ++k) {
+                keys.push_back("10.0." + std::to_string(i) + "." + std::to_string(k));
+            }
+            uint64_t n = 0;
+            for(int j = 0; j < loops; ++j) {
+                n += limiter->allow(keys[j & 1023]);
+            }
+            allowed += n;
+        }, "bench_" + std::to_string(i)));
+    }
+    for(auto& i : thrs) {
+        i->join();
+    }
+    uint64_t used = sylar::GetCurrentUS() - start;
+    SYLAR_LOG_INFO(g_logger) << "allow bench threads=" << threads
+        << " calls=" << threads * loops
+        << " allowed=" << allowed
+        << " used=" << used / 1000 << "ms"
+        << " ops=" << (uint64_t)threads * loops * 1000000 / used << "/s";
+}
+
+class EchoServer : public sylar::TcpServer {
+protected:
+    void handleClient(sylar::Socket::ptr client) override {
+        char buf[64];
+        int n = client->recv(buf, sizeof(buf));
+        if(n > 0) {
+            client->send(buf, n);
+        }
+        client->close();
+    }
+};
+
+void test_accept() {
+    sylar::TcpServer::ptr server(new EchoServer);
+    auto addr = sylar::Address::LookupAnyIPAddress("127.0.0.1:8100");
+    while(!server->bind(addr)) {
+        sleep(2);
+    }
+    server->setRateLimiter(std::make_shared<sylar::RateLimiter>(0.01, 3));
+    server->start();
+
+    int served = 0;
+    for(int i = 0; i < 6; ++i) {
+        auto sock = sylar::Socket::CreateTCP(addr);
+        SYLAR_ASSERT(sock->connect(addr));
+        sock->setRecvTimeout(1000);
+        sock->send("ping", 4);
+        char buf[64];
+        if(sock->recv(buf, sizeof(buf)) == 4) {
+            ++served;
+        }
+        sock->close();
+    }
+    SYLAR_ASSERT(served == 3);
+    server->stop();
+    SYLAR_LOG_INFO(g_logger) << "accept limit test ok";
+}
+
+void test_filter() {
+    sylar::http::HttpServer::ptr server(new sylar::http::HttpServer(true));
+    auto addr = sylar::Address::LookupAnyIPAddress("127.0.0.1:8101");
+    while(!server->bind(addr)) {
+        sleep(2);
+    }
+    auto filter = std::make_shared<sylar::http::RateLimitFilter>(
+            std::make_shared<sylar::RateLimiter>(0.5, 2), "X-Api-Key");
+    auto sd = server->getServletDispatch();
+    sd->addFilter(filter);
+    sd->addServlet("/hello", [](sylar::http::HttpRequest::ptr req
+                , sylar::http::HttpResponse::ptr rsp
+                , sylar::http::HttpSession::ptr session) {
+        rsp->setBody("hello");
+        return 0;
+    });
+    server->start();
+
+    std::string url = "http://127.0.0.1:8101/hello";
+    for(int i = 0; i < 2; ++i) {
+        auto rt = sylar::http::HttpConnection::DoGet(url, 1000);
+        SYLAR_ASSERT(rt->result == 0 && rt->response->getBody() == "hello");
+    }
+    auto rt = sylar::http::HttpConnection::DoGet(url, 1000);
+    SYLAR_ASSERT(rt->result == 0
+            && rt->response->getStatus() == sylar::http::HttpStatus::TOO_MANY_REQUESTS);
+    SYLAR_ASSERT(rt->response->getHeader("Retry-After") == "2");
+    // 不同的API key各自限流
+    rt = sylar::http::HttpConnection::DoGet(url, 1000, {{"X-Api-Key", "k1"}});
+    SYLAR_ASSERT(rt->result == 0 && rt->response->getBody() == "hello");
+    // 被拦截的POST请求不读取消息体，响应后关闭连接
+    rt = sylar::http::HttpConnection::DoPost(url, 1000, {}, std::string(100, 'x'));
+    SYLAR_ASSERT(rt->result == 0
+            && rt->response->getStatus() == sylar::http::HttpStatus::TOO_MANY_REQUESTS);
+    SYLAR_ASSERT(rt->response->getHeader("connection") == "close");
+    SYLAR_ASSERT(filter->getRejected() == 2);
+    server->stop();
+    SYLAR_LOG_INFO(g_logger) << "filter test ok";
+}
+
+void run() {
+    g_logger->setLevel(sylar::LogLevel::INFO);
+    test_accept();
+    test_filter();
+}
+
+int main(int argc, char *argv[]) {
+    test_bucket();
+    test_evict();
+    bench_allow();
+    sylar::IOManager iom(2);
+    iom.schedule(&run);
+    return 0;
+}
@@ -0,0 +1,251 @@
+/**
+ * @file test_redis_server.cc
+ * @brief RESP服务器功能测试，以及流水线小请求压测
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "sylar/sylar.h"
+#include "sylar/redis/redis_server.h"
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_ROOT();
+
+static int s_requests    = 200000;
+static int s_connections = 16;
+static int s_pipeline    = 32;
+
+/**
+ * @brief 极简的RESP客户端，只负责收发原始数据
+ */
+class Client {
+public:
+    Client(sylar::Address::ptr addr) {
+        m_sock = sylar::Socket::CreateTCP(addr);
+        SYLAR_ASSERT(m_sock->connect(addr));
+        m_buf.resize(64 * 1024);
+    }
+
+    void send(const std::string& data) {
+        size_t off = 0;
+        while(off < data.size()) {
+            int rt = m_sock->send(data.c_str() + off, data.size() - off);
+            SYLAR_ASSERT(rt > 0);
+            off += rt;
+        }
+    }
+
+    /**
+     * @brief 读取n个回复，返回回复的原始数据
+     */
+    std::string recv(int n) {
+        std::string rt;
+        while(n > 0) {
+            int len = RespSkipReplyAt(m_data);
+            if(len > 0) {
+                rt.append(m_data, 0, len);
+                m_data.erase(0, len);
+                --n;
+                continue;
+            }
+            SYLAR_ASSERT(len == 0);
+            int r = m_sock->recv(&m_buf[0], m_buf.size());
+            SYLAR_ASSERT(r > 0);
+            m_data.append(&m_buf[0], r);
+        }
+        return rt;
+    }
+
+    std::string call(const sylar::redis::RespCommand& cmd) {
+        std::string req;
+        sylar::redis::RespAppendCommand(req, cmd);
+        send(req);
+        return recv(1);
+    }
+
+private:
+    static int RespSkipReplyAt(const std::string& data) {
+        return sylar::redis::RespSkipReply(data.c_str(), data.size());
+    }
+
+private:
+    sylar::Socket::ptr m_sock;
+    std::string m_buf;
+    std::string m_data;
+};
+
+void test_parser() {
+    // 解析器保存进度，数据逐字节补齐也能解析出完整命令
+    std::string data;
+    sylar::redis::RespAppendCommand(data, {"SET", "key", "value"});
+    sylar::redis::RespParser parser;
+    sylar::redis::RespCommand cmd;
+    for(size_t i = 1; i < data.size(); ++i) {
+        SYLAR_ASSERT(parser.parse(data.c_str(), i, cmd) == 0);
+    }
+    SYLAR_ASSERT(parser.parse(data.c_str(), data.size(), cmd) == (int)data.size());
+    SYLAR_ASSERT(cmd.size() == 3 && cmd[0] == "SET" && cmd[2] == "value");
+
+    // 声称的参数个数很大但数据很少时不会按参数个数预分配
+    parser.reset();
+    SYLAR_ASSERT(parser.parse("*1000000\r\n$3\r\nGET\r\n", 19, cmd) == 0);
+    parser.reset();
+    SYLAR_ASSERT(parser.parse("*1048577\r\n", 11, cmd) < 0);
+    SYLAR_LOG_INFO(g_logger) << "parser test ok";
+}
+
+void test_functional(sylar::Address::ptr addr) {
+    Client c(addr);
+    SYLAR_ASSERT(c.call({"PING"}) == "+PONG\r\n");
+    SYLAR_ASSERT(c.call({"SET", "name", "sylar"}) == "+OK\r\n");
+    SYLAR_ASSERT(c.call({"GET", "name"}) == "$5\r\nsylar\r\n");
+    SYLAR_ASSERT(c.call({"GET", "none"}) == "$-1\r\n");
+    SYLAR_ASSERT(c.call({"get"}) == "-ERR wrong number of arguments for 'get' command\r\n");
+    SYLAR_ASSERT(c.call({"FOO"}) == "-ERR unknown command 'FOO'\r\n");
+
+    // 多个key大概率落在不同分片上
+    std::string req;
+    sylar::redis::RespCommand mget = {"MGET"};
+    sylar::redis::RespCommand del = {"DEL"};
+    for(int i = 0; i < 8; ++i) {
+        std::string k = "key_" + std::to_string(i);
+        sylar::redis::RespAppendCommand(req, {"SET", k, std::to_string(i)});
+        mget.push_back(k);
+        del.push_back(k);
+    }
+    mget.push_back("none");
+    sylar::redis::RespAppendCommand(req, mget);
+    sylar::redis::RespAppendCommand(req, del);
+    sylar::redis::RespAppendCommand(req, mget);
+    c.send(req);
+    std::string expect;
+    for(int i = 0; i < 8; ++i) {
+        expect += "+OK\r\n";
+    }
+    expect += "*9\r\n";
+    for(int i = 0; i < 8; ++i) {
+        expect += "$1\r\n" + std::to_string(i) + "\r\n";
+    }
+    expect += "$-1\r\n:8\r\n*9\r\n";
+    for(int i = 0; i < 9; ++i) {
+        expect += "$-1\r\n";
+    }
+    SYLAR_ASSERT(c.recv(11) == expect);
+
+    // 命令被拆成单字节分多次到达
+    std::string split;
+    sylar::redis::RespAppendCommand(split, {"SET", "split", "value"});
+    for(auto ch : split) {
+        c.send(std::string(1, ch));
+        usleep(1000);
+    }
+    SYLAR_ASSERT(c.recv(1) == "+OK\r\n");
+
+    // 内联命令
+    c.send("SET inline 1\r\nGET inline\r\n");
+    SYLAR_ASSERT(c.recv(2) == "+OK\r\n$1\r\n1\r\n");
+
+    // 过期
+    SYLAR_ASSERT(c.call({"SET", "ttl", "v", "PX", "100"}) == "+OK\r\n");
+    SYLAR_ASSERT(c.call({"SET", "ttl2", "v"}) == "+OK\r\n");
+    SYLAR_ASSERT(c.call({"EXPIRE", "ttl2", "1"}) == ":1\r\n");
+    SYLAR_ASSERT(c.call({"EXPIRE", "none", "1"}) == ":0\r\n");
+    SYLAR_ASSERT(c.call({"GET", "ttl"}) == "$1\r\nv\r\n");
+    usleep(200 * 1000);
+    SYLAR_ASSERT(c.call({"GET", "ttl"}) == "$-1\r\n");
+    SYLAR_ASSERT(c.call({"GET", "ttl2"}) == "$1\r\nv\r\n");
+    usleep(1000 * 1000);
+    SYLAR_ASSERT(c.call({"DEL", "ttl2"}) == ":0\r\n");
+
+    // 换算成毫秒会溢出的过期时间是非法的，EXPIRE不大于0时删除key
+    SYLAR_ASSERT(c.call({"SET", "big", "v", "EX", "9223372036854775"}).find("-ERR invalid expire time") == 0);
+    SYLAR_ASSERT(c.call({"SET", "big", "v", "PX", "9223372036854775807"}).find("-ERR invalid expire time") == 0);
+    SYLAR_ASSERT(c.call({"SET", "big", "v", "EX", "100000"}) == "+OK\r\n");
+    SYLAR_ASSERT(c.call({"EXPIRE", "big", "9223372036854775807"}).find("-ERR invalid expire time") == 0);
+    SYLAR_ASSERT(c.call({"GET", "big"}) == "$1\r\nv\r\n");
+    SYLAR_ASSERT(c.call({"EXPIRE", "big", "-9223372036854775807"}) == ":1\r\n");
+    SYLAR_ASSERT(c.call({"GET", "big"}) == "$-1\r\n");
+    SYLAR_ASSERT(c.call({"SET", "big", "v"}) == "+OK\r\n");
+    SYLAR_ASSERT(c.call({"EXPIRE", "big", "0"}) == ":1\r\n");
+    SYLAR_ASSERT(c.call({"GET", "big"}) == "$-1\r\n");
+
+    SYLAR_ASSERT(c.call({"QUIT"}) == "+OK\r\n");
+    SYLAR_LOG_INFO(g_logger) << "functional test ok";
+}
+
+void bench(sylar::Address::ptr addr) {
+    std::shared_ptr<std::atomic<int> > done(new std::atomic<int>(0));
+    auto self = sylar::Fiber::GetThis();
+    auto iom = sylar::IOManager::GetThis();
+    int rounds = s_requests / s_connections / s_pipeline;
+    uint64_t start = sylar::GetCurrentUS();
+    for(int i = 0; i < s_connections; ++i) {
+        iom->schedule([addr, done, self, iom, rounds, i]() {
+            Client c(addr);
+            std::string value(32, 'x');
+            for(int r = 0; r < rounds; ++r) {
+                // 一半SET一半GET，一次写出整批请求
+                std::string req;
+                for(int j = 0; j < s_pipeline; ++j) {
+                    std::string key = "bench_" + std::to_string(i) + "_" + std::to_string(j);
+                    if(j & 1) {
+                        sylar::redis::RespAppendCommand(req, {"GET", key});
+                    } else {
+                        sylar::redis::RespAppendCommand(req, {"SET", key, value});
+                    }
+                }
+                c.send(req);
+                c.recv(s_pipeline);
+            }
+            if(++*done == s_connections) {
+                iom->schedule(self);
+            }
+        });
+    }
+    sylar::Fiber::GetThis()->yield();
+    uint64_t used = sylar::GetCurrentUS() - start;
+    int total = rounds * s_pipeline * s_connections;
+    SYLAR_LOG_INFO(g_logger) << "redis bench: requests=" << total
+        << " connections=" << s_connections
+        << " pipeline=" << s_pipeline
+        << " used=" << used / 1000 << "ms"
+        << " qps=" << (uint64_t)(total * 1000000.0 / used);
+}
+
+static std::vector<sylar::IOManager*> s_workers;
+
+void run() {
+    g_logger->setLevel(sylar::LogLevel::INFO);
+    sylar::redis::RedisServer::ptr server(new sylar::redis::RedisServer(s_workers));
+    auto addr = sylar::Address::LookupAnyIPAddress("127.0.0.1:6390");
+    SYLAR_ASSERT(addr);
+    while(!server->bind(addr)) {
+        sleep(2);
+    }
+    server->start();
+    SYLAR_LOG_INFO(g_logger) << "shards=" << server->getStore()->getShardCount();
+
+    test_parser();
+    test_functional(addr);
+    bench(addr);
+    server->stop();
+}
+
+int main(int argc, char *argv[]) {
+    if(argc > 1) {
+        s_requests = atoi(argv[1]);
+    }
+    if(argc > 2) {
+        s_connections = atoi(argv[2]);
+    }
+    if(argc > 3) {
+        s_pipeline = atoi(argv[3]);
+    }
+    // 每个IO worker一个线程、一个分片
+    std::vector<std::shared_ptr<sylar::IOManager> > workers;
+    for(int i = 0; i < 2; ++i) {
+        workers.emplace_back(new sylar::IOManager(1, false, "redis_" + std::to_string(i)));
+        s_workers.push_back(workers.back().get());
+    }
+    sylar::IOManager iom(1);
+    iom.schedule(&run);
+    return 0;
+}
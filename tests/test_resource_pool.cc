@@ -0,0 +1,184 @@
+/**
+ * @file test_resource_pool.cc
+ * @brief 资源池测试：后进先出复用、挂起等待和超时、校验、空闲和生命周期淘汰、并发上限
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "sylar/sylar.h"
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_ROOT();
+
+struct Conn {
+    Conn(int v) :id(v) { ++s_alive;}
+    ~Conn() { --s_alive;}
+
+    int id;
+    bool broken = false;
+    static std::atomic<int> s_alive;
+};
+
+std::atomic<int> Conn::s_alive(0);
+
+static std::atomic<int> s_next(0);
+
+typedef sylar::ResourcePool<Conn> ConnPool;
+
+static ConnPool::ptr create_pool(const std::string& name, uint32_t max_size
+                                 ,uint64_t max_idle_ms = 60 * 1000
+                                 ,uint64_t max_lifetime_ms = 0) {
+    return ConnPool::Create(name, []() {
+        return new Conn(++s_next);
+    }, [](Conn* conn) {
+        return !conn->broken;
+    }, max_size, max_idle_ms, max_lifetime_ms);
+}
+
+void test_reuse() {
+    auto pool = create_pool("reuse", 4);
+    auto a = pool->acquire();
+    auto b = pool->acquire();
+    int a_id = a->id;
+    int b_id = b->id;
+    SYLAR_ASSERT(a_id != b_id && pool->getTotal() == 2);
+    a.reset();
+    b.reset();
+    // 后进先出，最近归还的先被复用
+    SYLAR_ASSERT(pool->acquire()->id == b_id);
+    SYLAR_ASSERT(pool->getIdle() == 2);
+
+    // 校验失败的资源归还时被销毁
+    a = pool->acquire();
+    a->broken = true;
+    a.reset();
+    SYLAR_ASSERT(pool->getTotal() == 1 && pool->getIdle() == 1);
+
+    auto created = sylar::MetricsMgr::GetInstance()->counter("sylar_resource_pool_created_total"
+                    , "", {{"name", "reuse"}});
+    SYLAR_ASSERT(created->get() == 2);
+    pool.reset();
+    SYLAR_ASSERT(Conn::s_alive == 0);
+    SYLAR_LOG_INFO(g_logger) << "reuse test ok";
+}
+
+void test_wait() {
+    auto pool = create_pool("wait", 1);
+    auto held = pool->acquire();
+    int id = held->id;
+    // 不等待时立即失败
+    SYLAR_ASSERT(!pool->acquire(0));
+
+    // 池满时挂起，超时返回nullptr
+    uint64_t start = sylar::GetCurrentMS();
+    SYLAR_ASSERT(!pool->acquire(50));
+    uint64_t used = sylar::GetCurrentMS() - start;
+    SYLAR_ASSERT(used >= 40 && used < 500);
+    SYLAR_ASSERT(pool->getWaiting() == 0);
+
+    // 归还的资源直接交给等待者
+    sylar::IOManager::GetThis()->schedule([&held]() {
+        usleep(50 * 1000);
+        held.reset();
+    });
+    start = sylar::GetCurrentMS();
+    auto conn = pool->acquire(1000);
+    used = sylar::GetCurrentMS() - start;
+    SYLAR_ASSERT(conn && conn->id == id);
+    SYLAR_ASSERT(used >= 40 && used < 500);
+
+    // 资源被销毁时等待者拿到创建名额
+    sylar::IOManager::GetThis()->schedule([&conn]() {
+        usleep(50 * 1000);
+        conn->broken = true;
+        conn.reset();
+    });
+    auto fresh = pool->acquire(1000);
+    SYLAR_ASSERT(fresh && fresh->id != id);
+    SYLAR_LOG_INFO(g_logger) << "wait test ok";
+}
+
+void test_evict() {
+    auto pool = create_pool("evict", 4, 50);
+    pool->acquire();
+    SYLAR_ASSERT(pool->getIdle() == 1);
+    usleep(200 * 1000);
+    SYLAR_ASSERT(pool->getIdle() == 0 && pool->getTotal() == 0);
+    SYLAR_ASSERT(Conn::s_alive == 0);
+
+    // 超过生命周期的资源不再复用，即使一直在使用
+    pool = create_pool("lifetime", 4, 0, 100);
+    int id = pool->acquire()->id;
+    SYLAR_ASSERT(pool->acquire()->id == id);
+    usleep(150 * 1000);
+    SYLAR_ASSERT(pool->acquire()->id != id);
+    pool.reset();
+    SYLAR_ASSERT(Conn::s_alive == 0);
+    SYLAR_LOG_INFO(g_logger) << "evict test ok";
+}
+
+void test_factory_fail() {
+    bool fail = true;
+    auto pool = ConnPool::Create("fail", [&fail]() {
+        return fail ? nullptr : new Conn(++s_next);
+    }, nullptr, 1);
+    SYLAR_ASSERT(!pool->acquire(0));
+    // 创建失败归还名额
+    SYLAR_ASSERT(pool->getTotal() == 0);
+    fail = false;
+    SYLAR_ASSERT(pool->acquire(0));
+    SYLAR_LOG_INFO(g_logger) << "factory fail test ok";
+}
+
+void test_concurrent() {
+    const uint32_t max_size = 4;
+    auto pool = create_pool("concurrent", max_size);
+    std::atomic<int> inuse(0);
+    std::atomic<int> peak(0);
+    std::atomic<int> done(0);
+    std::atomic<int> fails(0);
+    const int fibers = 64;
+    for(int i = 0; i < fibers; ++i) {
+        sylar::IOManager::GetThis()->schedule([&, i]() {
+            for(int n = 0; n < 200; ++n) {
+                auto conn = pool->acquire(5000);
+                if(!conn) {
+                    ++fails;
+                    continue;
+                }
+                int v = ++inuse;
+                int p = peak;
+                while(v > p && !peak.compare_exchange_weak(p, v));
+                if(n % 16 == i % 16) {
+                    usleep(100);
+                }
+                --inuse;
+            }
+            ++done;
+        });
+    }
+    while(done != fibers) {
+        usleep(10 * 1000);
+    }
+    SYLAR_LOG_INFO(g_logger) << "peak=" << peak << " total=" << pool->getTotal()
+        << " idle=" << pool->getIdle() << " fails=" << fails;
+    SYLAR_ASSERT(fails == 0);
+    SYLAR_ASSERT(peak <= (int)max_size && pool->getTotal() <= max_size);
+    SYLAR_ASSERT(pool->getIdle() == pool->getTotal() && pool->getWaiting() == 0);
+    pool.reset();
+    SYLAR_ASSERT(Conn::s_alive == 0);
+    SYLAR_LOG_INFO(g_logger) << "concurrent test ok";
+}
+
+void run() {
+    g_logger->setLevel(sylar::LogLevel::INFO);
+    test_reuse();
+    test_wait();
+    test_evict();
+    test_factory_fail();
+    test_concurrent();
+}
+
+int main(int argc, char *argv[]) {
+    sylar::IOManager iom(4);
+    iom.schedule(&run);
+    return 0;
+}
@@ -0,0 +1,108 @@
+/**
+ * @file test_rpc.cc
+ * @brief RPC服务器/客户端测试，以及回环地址上的调用吞吐量测试
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "sylar/sylar.h"
+#include "sylar/rpc/rpc_server.h"
+#include "sylar/rpc/rpc_client.h"
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_ROOT();
+
+static int s_concurrency = 64;
+static int s_calls       = 100000;
+
+void run() {
+    g_logger->setLevel(sylar::LogLevel::INFO);
+    sylar::rpc::RpcServer::ptr server(new sylar::rpc::RpcServer);
+    auto addr = sylar::Address::LookupAnyIPAddress("127.0.0.1:8090");
+    SYLAR_ASSERT(addr);
+    while(!server->bind(addr)) {
+        sleep(2);
+    }
+    server->registerMethod("echo", [](const std::string& req, std::string& rsp) {
+        rsp = req;
+        return 0;
+    });
+    server->registerMethod("add", [](const std::string& req, std::string& rsp) {
+        sylar::ByteArray ba;
+        ba.write(req.c_str(), req.size());
+        ba.setPosition(0);
+        int64_t a = ba.readInt64();
+        int64_t b = ba.readInt64();
+        return (int32_t)(a + b);
+    });
+    server->start();
+
+    sylar::rpc::RpcClient::ptr client(new sylar::rpc::RpcClient(addr, 2));
+
+    // 功能测试
+    auto rt = client->call("echo", "hello rpc", 1000);
+    SYLAR_ASSERT(rt->result == 0 && rt->response == "hello rpc");
+    sylar::ByteArray ba;
+    ba.writeInt64(20);
+    ba.writeInt64(22);
+    ba.setPosition(0);
+    rt = client->call("add", ba.toString(), 1000);
+    SYLAR_ASSERT(rt->result == 0 && rt->status == 42);
+    rt = client->call("not_exists", "", 1000);
+    SYLAR_ASSERT(rt->result == (int)sylar::rpc::RpcResult::Error::METHOD_NOT_FOUND);
+
+    // 字符串长度前缀超出帧内剩余数据时解码失败，而不是按伪造的长度分配内存
+    sylar::ByteArray::ptr bad(new sylar::ByteArray);
+    bad->writeFuint8(sylar::rpc::RpcMessage::MAGIC);
+    bad->writeFuint8(sylar::rpc::RpcMessage::REQUEST);
+    bad->writeUint64(1);
+    bad->writeInt32(0);
+    bad->writeInt32(0);
+    bad->writeUint64(1ull << 62);
+    bad->setPosition(0);
+    sylar::rpc::RpcMessage msg;
+    SYLAR_ASSERT(!msg.decode(bad));
+    SYLAR_LOG_INFO(g_logger) << "functional test ok";
+
+    // 吞吐量测试：s_concurrency个协程共享同一个客户端，并发发起调用
+    std::shared_ptr<std::atomic<int> > done(new std::atomic<int>(0));
+    std::shared_ptr<std::atomic<int> > fails(new std::atomic<int>(0));
+    uint64_t start = sylar::GetCurrentUS();
+    auto self = sylar::Fiber::GetThis();
+    auto iom = sylar::IOManager::GetThis();
+    for(int i = 0; i < s_concurrency; ++i) {
+        iom->schedule([client, done, fails, self, iom, start]() {
+            std::string payload(64, 'x');
+            for(int j = 0; j < s_calls / s_concurrency; ++j) {
+                auto rt = client->call("echo", payload, 3000);
+                if(rt->result != 0) {
+                    ++*fails;
+                }
+            }
+            if(++*done == s_concurrency) {
+                iom->schedule(self);
+            }
+        });
+    }
+    sylar::Fiber::GetThis()->yield();
+    uint64_t used = sylar::GetCurrentUS() - start;
+    int total = s_calls / s_concurrency * s_concurrency;
+    SYLAR_LOG_INFO(g_logger) << "rpc bench: calls=" << total
+        << " concurrency=" << s_concurrency
+        << " fails=" << *fails
+        << " used=" << used / 1000 << "ms"
+        << " qps=" << (uint64_t)(total * 1000000.0 / used);
+
+    client->close();
+    server->stop();
+}
+
+int main(int argc, char *argv[]) {
+    if(argc > 1) {
+        s_calls = atoi(argv[1]);
+    }
+    if(argc > 2) {
+        s_concurrency = atoi(argv[2]);
+    }
+    sylar::IOManager iom(2);
+    iom.schedule(&run);
+    return 0;
+}
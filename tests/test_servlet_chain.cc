@@ -0,0 +1,215 @@
+/**
+ * @file test_servlet_chain.cc
+ * @brief ServletDispatch过滤器链测试，以及与逐层包装servlet的单次调用耗时对比
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "sylar/sylar.h"
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_ROOT();
+
+/**
+ * @brief 把前后置调用记录到响应头部的过滤器
+ */
+class TraceFilter : public sylar::http::ServletFilter {
+public:
+    TraceFilter(const std::string& name, bool pass = true)
+        :ServletFilter(name)
+        ,m_pass(pass) {
+    }
+
+    bool doFilter(const sylar::http::HttpRequest::ptr& request
+                  , const sylar::http::HttpResponse::ptr& response
+                  , const sylar::http::HttpSession::ptr& session) override {
+        response->setHeader("X-Trace", response->getHeader("X-Trace") + ">" + m_name);
+        if(!m_pass) {
+            response->setStatus(sylar::http::HttpStatus::FORBIDDEN);
+        }
+        return m_pass;
+    }
+
+    void afterHandle(const sylar::http::HttpRequest::ptr& request
+                     , const sylar::http::HttpResponse::ptr& response
+                     , const sylar::http::HttpSession::ptr& session) override {
+        response->setHeader("X-Trace", response->getHeader("X-Trace") + "<" + m_name);
+    }
+private:
+    bool m_pass;
+};
+
+static std::string Run(sylar::http::ServletDispatch::ptr sd, const std::string& path) {
+    sylar::http::HttpRequest::ptr req(new sylar::http::HttpRequest);
+    req->setPath(path);
+    sylar::http::HttpResponse::ptr rsp(new sylar::http::HttpResponse);
+    sd->handle(req, rsp, nullptr);
+    return rsp->getHeader("X-Trace") + "|" + rsp->getBody();
+}
+
+void test_chain() {
+    sylar::http::ServletDispatch::ptr sd(new sylar::http::ServletDispatch);
+    auto hello = [](sylar::http::HttpRequest::ptr req
+                , sylar::http::HttpResponse::ptr rsp
+                , sylar::http::HttpSession::ptr session) {
+        rsp->setHeader("X-Trace", rsp->getHeader("X-Trace") + "=servlet");
+        rsp->setBody("hello");
+        return 0;
+    };
+    sd->addServlet("/hello", hello);
+    sd->addGlobServlet("/api/*", hello);
+    sd->addFilter(std::make_shared<TraceFilter>("a"));
+    sd->addFilter(std::make_shared<TraceFilter>("b"));
+    sd->addFilter(std::make_shared<TraceFilter>("api"), "/api/*");
+
+    SYLAR_ASSERT(Run(sd, "/hello") == ">a>b=servlet<b<a|hello");
+    SYLAR_ASSERT(Run(sd, "/api/x") == ">a>b>api=servlet<api<b<a|hello");
+    // 默认servlet只经过"*"过滤器
+    SYLAR_ASSERT(Run(sd, "/missing").find(">a>b<b<a|") == 0);
+
+    // 拦截后servlet和后面的过滤器都不执行，前面通过的过滤器仍执行后置处理
+    sd->addFilter(std::make_shared<TraceFilter>("deny", false), "/api/*");
+    SYLAR_ASSERT(Run(sd, "/api/x") == ">a>b>api>deny<api<b<a|");
+    SYLAR_ASSERT(Run(sd, "/hello") == ">a>b=servlet<b<a|hello");
+
+    // 过滤器先注册、servlet后注册时也会组合进去
+    sd->addServlet("/late", hello);
+    SYLAR_ASSERT(Run(sd, "/late") == ">a>b=servlet<b<a|hello");
+
+    sd->delFilter("deny");
+    sd->delFilter("a");
+    SYLAR_ASSERT(Run(sd, "/api/x") == ">b>api=servlet<api<b|hello");
+    SYLAR_LOG_INFO(g_logger) << "chain test ok";
+}
+
+/**
+ * @brief 空过滤器，只统计调用次数
+ */
+class NopFilter : public sylar::http::ServletFilter {
+public:
+    NopFilter()
+        :ServletFilter("nop") {
+    }
+    bool doFilter(const sylar::http::HttpRequest::ptr& request
+                  , const sylar::http::HttpResponse::ptr& response
+                  , const sylar::http::HttpSession::ptr& session) override {
+        ++count;
+        return true;
+    }
+    void afterHandle(const sylar::http::HttpRequest::ptr& request
+                     , const sylar::http::HttpResponse::ptr& response
+                     , const sylar::http::HttpSession::ptr& session) override {
+        ++count;
+    }
+    uint64_t count = 0;
+};
+
+/**
+ * @brief 请求体没有读完连接就断开，已经通过的过滤器仍要调用afterHandle
+ */
+void test_body_fail() {
+    sylar::http::HttpServer::ptr server(new sylar::http::HttpServer);
+    auto addr = sylar::Address::LookupAnyIPAddress("127.0.0.1:8120");
+    while(!server->bind(addr)) {
+        sleep(2);
+    }
+    auto filter = std::make_shared<NopFilter>();
+    auto sd = server->getServletDispatch();
+    sd->addFilter(filter);
+    sd->addServlet("/upload", [](sylar::http::HttpRequest::ptr req
+                , sylar::http::HttpResponse::ptr rsp
+                , sylar::http::HttpSession::ptr session) {
+        SYLAR_ASSERT(false);
+        return 0;
+    });
+    server->start();
+
+    auto sock = sylar::Socket::CreateTCP(addr);
+    SYLAR_ASSERT(sock->connect(addr));
+    std::string req = "POST /upload HTTP/1.1\r\nHost: test\r\nContent-Length: 100\r\n\r\n0123456789";
+    SYLAR_ASSERT(sock->send(req.c_str(), req.size()) == (int)req.size());
+    sock->close();
+    for(int i = 0; i < 100 && filter->count < 2; ++i) {
+        usleep(10 * 1000);
+    }
+    SYLAR_ASSERT(filter->count == 2);
+    server->stop();
+    SYLAR_LOG_INFO(g_logger) << "body fail test ok";
+}
+
+/**
+ * @brief 以前的写法：每个横切逻辑包一层servlet
+ */
+class WrapperServlet : public sylar::http::Servlet {
+public:
+    WrapperServlet(sylar::http::Servlet::ptr inner)
+        :Servlet("wrapper")
+        ,m_inner(inner) {
+    }
+    int32_t handle(sylar::http::HttpRequest::ptr request
+                   , sylar::http::HttpResponse::ptr response
+                   , sylar::http::HttpSession::ptr session) override {
+        ++count;
+        int32_t rt = m_inner->handle(request, response, session);
+        ++count;
+        return rt;
+    }
+    uint64_t count = 0;
+private:
+    sylar::http::Servlet::ptr m_inner;
+};
+
+void bench(int filters, int loops) {
+    auto servlet = std::make_shared<sylar::http::FunctionServlet>(
+        [](sylar::http::HttpRequest::ptr req
+           , sylar::http::HttpResponse::ptr rsp
+           , sylar::http::HttpSession::ptr session) {
+        return 0;
+    });
+    sylar::http::HttpRequest::ptr req(new sylar::http::HttpRequest);
+    req->setPath("/bench");
+    sylar::http::HttpResponse::ptr rsp(new sylar::http::HttpResponse);
+    sylar::http::HttpSession::ptr session;
+
+    sylar::http::ServletDispatch::ptr chain_sd(new sylar::http::ServletDispatch);
+    chain_sd->addServlet("/bench", servlet);
+    for(int i = 0; i < filters; ++i) {
+        chain_sd->addFilter(std::make_shared<NopFilter>());
+    }
+    sylar::http::ServletDispatch::ptr wrap_sd(new sylar::http::ServletDispatch);
+    sylar::http::Servlet::ptr wrapped = servlet;
+    for(int i = 0; i < filters; ++i) {
+        wrapped = std::make_shared<WrapperServlet>(wrapped);
+    }
+    wrap_sd->addServlet("/bench", wrapped);
+
+    // 只计算匹配路径之后的调用链耗时
+    auto chain = chain_sd->getMatchedChain("/bench");
+    uint64_t start = sylar::GetCurrentUS();
+    for(int i = 0; i < loops; ++i) {
+        chain->handle(req, rsp, session);
+    }
+    uint64_t chain_used = sylar::GetCurrentUS() - start;
+
+    auto slt = wrap_sd->getMatchedServlet("/bench");
+    start = sylar::GetCurrentUS();
+    for(int i = 0; i < loops; ++i) {
+        slt->handle(req, rsp, session);
+    }
+    uint64_t wrap_used = sylar::GetCurrentUS() - start;
+
+    SYLAR_LOG_INFO(g_logger) << "filters=" << filters
+        << " chain=" << chain_used * 1000 / loops << "ns"
+        << " wrapper=" << wrap_used * 1000 / loops << "ns";
+}
+
+int main(int argc, char *argv[]) {
+    test_chain();
+    {
+        sylar::IOManager iom(1);
+        iom.schedule(test_body_fail);
+    }
+    int loops = argc > 1 ? atoi(argv[1]) : 1000000;
+    for(int i : {0, 1, 4, 8}) {
+        bench(i, loops);
+    }
+    return 0;
+}
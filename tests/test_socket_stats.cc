@@ -0,0 +1,83 @@
+/**
+ * @file test_socket_stats.cc
+ * @brief 连接统计测试：收发计数、TCP_INFO定时采样，以及服务器和上游连接池的汇总
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "sylar/sylar.h"
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_ROOT();
+
+void test_stats() {
+    sylar::Config::Lookup<uint64_t>("tcp.info_sample_interval")->setValue(50);
+    sylar::http::HttpServer::ptr server(new sylar::http::HttpServer(true));
+    server->addAdminServlets();
+    auto addr = sylar::Address::LookupAnyIPAddress("127.0.0.1:8106");
+    while(!server->bind(addr)) {
+        sleep(2);
+    }
+    server->setName("stats");
+    // 连接池里的连接一直空闲，服务端尽快超时关闭，IOManager才能退出
+    server->setRecvTimeout(500);
+    server->getServletDispatch()->addServlet("/echo", [](sylar::http::HttpRequest::ptr req
+                    ,sylar::http::HttpResponse::ptr rsp
+                    ,sylar::http::HttpSession::ptr session) {
+        rsp->setBody(req->getBody());
+        return 0;
+    });
+    server->start();
+
+    auto pool = sylar::http::HttpConnectionPool::Create("http://127.0.0.1:8106", "", 10, 1000 * 60, 100);
+    std::string body(10000, 'x');
+    for(int i = 0; i < 10; ++i) {
+        auto rt = pool->doPost("/echo", 1000, {{"Connection", "keep-alive"}}, body);
+        SYLAR_ASSERT2(rt->result == 0, rt->toString());
+        SYLAR_ASSERT(rt->response->getBody() == body);
+    }
+    // 服务端的连接等定时器采样，连接池在归还连接时采样
+    usleep(200 * 1000);
+    SYLAR_ASSERT(pool->doGet("/echo", 1000, {{"Connection", "keep-alive"}})->result == 0);
+
+    auto server_stats = server->getSocketStats();
+    auto pool_stats = pool->getSocketStats();
+    SYLAR_LOG_INFO(g_logger) << server_stats->toString();
+    SYLAR_LOG_INFO(g_logger) << pool_stats->toString();
+    SYLAR_ASSERT(server_stats->getConnections() == 1);
+    SYLAR_ASSERT(pool_stats->getConnections() == 1);
+    SYLAR_ASSERT(server_stats->getRtt().getCount() > 0);
+    SYLAR_ASSERT(pool_stats->getRtt().getCount() > 0);
+    SYLAR_ASSERT(pool_stats->getCwnd().getMin() > 0);
+
+    auto total = server_stats->getTotal();
+    SYLAR_ASSERT(total.bytesIn >= body.size() * 10);
+    SYLAR_ASSERT(total.bytesOut >= body.size() * 10);
+    SYLAR_ASSERT(total.recvCalls >= 10 && total.sendCalls >= 10);
+    total = pool_stats->getTotal();
+    SYLAR_ASSERT(total.bytesOut >= body.size() * 10);
+    SYLAR_ASSERT(total.bytesIn >= body.size() * 10);
+
+    // 短连接在关闭时汇总
+    auto rt = sylar::http::HttpConnection::DoGet("http://127.0.0.1:8106/_/status", 1000);
+    SYLAR_ASSERT(rt->result == 0);
+    const std::string& status = rt->response->getBody();
+    for(auto& i : {"sylar_tcp_rtt_seconds{kind=\"upstream\",name=\"127.0.0.1:8106\",quantile=\"0.99\"}"
+                   ,"sylar_tcp_rtt_seconds_count{kind=\"http\",name=\"stats\"}"
+                   ,"sylar_tcp_received_bytes_total{kind=\"http\",name=\"stats\"}"
+                   ,"sylar_tcp_connections{kind=\"upstream\",name=\"127.0.0.1:8106\"} 1"}) {
+        if(status.find(i) == std::string::npos) {
+            SYLAR_LOG_ERROR(g_logger) << "missing " << i;
+            SYLAR_ASSERT(false);
+        }
+    }
+    usleep(10 * 1000);
+    SYLAR_ASSERT(server_stats->getConnections() == 1);
+    SYLAR_LOG_INFO(g_logger) << server->toString();
+    server->stop();
+    SYLAR_LOG_INFO(g_logger) << "stats test ok";
+}
+
+int main(int argc, char *argv[]) {
+    sylar::IOManager iom(2);
+    iom.schedule(&test_stats);
+    return 0;
+}
@@ -0,0 +1,304 @@
+/**
+ * @file test_sse.cc
+ * @brief SSE测试：事件编码、共享缓冲区和队列溢出策略、多连接广播、按Last-Event-ID补发、
+ *        心跳、慢连接被断开、停止后连接正常结束
+ * @version 0.1
+ * @date 2026-10-19
+ */
+#include "sylar/sylar.h"
+#include <signal.h>
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_ROOT();
+
+void test_encode() {
+    auto buf = sylar::http::SseHub::Encode("hello");
+    SYLAR_ASSERT(*buf == "data: hello\n\n");
+    buf = sylar::http::SseHub::Encode("a\nb\r\nc\rd\n", "update", "42", 3000);
+    SYLAR_LOG_INFO(g_logger) << *buf;
+    SYLAR_ASSERT(*buf == "event: update\nid: 42\nretry: 3000\ndata: a\ndata: b\ndata: c\ndata: d\ndata: \n\n");
+    // 单行字段中的换行会破坏事件边界，在换行处截断
+    buf = sylar::http::SseHub::Encode("", "x\ny", "1\r2");
+    SYLAR_ASSERT(*buf == "event: x\nid: 1\ndata: \n\n");
+    SYLAR_LOG_INFO(g_logger) << "encode test ok";
+}
+
+static std::vector<sylar::http::SseSubscriber::ptr> make_subscribers(sylar::http::SseHub::ptr hub, size_t n) {
+    std::vector<sylar::http::SseSubscriber::ptr> subs;
+    for(size_t i = 0; i < n; ++i) {
+        sylar::http::HttpSession::ptr session(new sylar::http::HttpSession(sylar::Socket::CreateTCPSocket()));
+        auto sub = hub->createSubscriber(session, true);
+        SYLAR_ASSERT(hub->subscribe(sub));
+        subs.push_back(sub);
+    }
+    return subs;
+}
+
+void test_queue() {
+    // 不运行写协程，事件都留在队列里
+    sylar::http::SseHub::ptr hub(new sylar::http::SseHub("unit", sylar::http::SseSubscriber::DROP_OLDEST, 4));
+    auto subs = make_subscribers(hub, 3);
+    SYLAR_ASSERT(hub->getSubscriberCount() == 3);
+    auto buf = sylar::http::SseHub::Encode("shared");
+    SYLAR_ASSERT(hub->publish(buf) == 3);
+    // 所有队列存的是同一个缓冲区
+    SYLAR_ASSERT(buf.use_count() == 4);
+    for(int i = 0; i < 9; ++i) {
+        SYLAR_ASSERT(hub->publish("x") == 3);
+    }
+    // 最旧的共享缓冲区已被挤出
+    SYLAR_ASSERT(buf.use_count() == 1);
+    for(auto& i : subs) {
+        SYLAR_ASSERT(i->getQueueSize() == 4 && i->getDropped() == 6);
+    }
+
+    sylar::http::SseHub::ptr newest(new sylar::http::SseHub("unit_newest", sylar::http::SseSubscriber::DROP_NEWEST, 4));
+    subs = make_subscribers(newest, 2);
+    SYLAR_ASSERT(newest->publish(buf) == 2 && buf.use_count() == 3);
+    for(int i = 0; i < 9; ++i) {
+        SYLAR_ASSERT(newest->publish("x") == (i < 3 ? 2u : 0u));
+    }
+    // 最早的事件保留
+    SYLAR_ASSERT(buf.use_count() == 3 && subs[0]->getDropped() == 6);
+
+    sylar::http::SseHub::ptr disconnect(new sylar::http::SseHub("unit_disconnect", sylar::http::SseSubscriber::DISCONNECT, 4));
+    subs = make_subscribers(disconnect, 2);
+    for(int i = 0; i < 4; ++i) {
+        SYLAR_ASSERT(disconnect->publish("x") == 2);
+    }
+    SYLAR_ASSERT(disconnect->publish("x") == 0);
+    SYLAR_ASSERT(subs[0]->isClosed() && subs[0]->getQueueSize() == 0);
+
+    // run返回后连接归调用方所有，abort不能再shutdown它
+    auto listener = sylar::Socket::CreateTCPSocket();
+    auto addr = sylar::Address::LookupAnyIPAddress("127.0.0.1:8119");
+    SYLAR_ASSERT(listener->bind(addr) && listener->listen());
+    auto client = sylar::Socket::CreateTCPSocket();
+    SYLAR_ASSERT(client->connect(addr));
+    auto accepted = listener->accept();
+    SYLAR_ASSERT(accepted);
+    auto sub = disconnect->createSubscriber(sylar::http::HttpSession::ptr(
+                new sylar::http::HttpSession(accepted, false)), true);
+    sub->close();
+    sub->run(0);
+    sub->abort();
+    SYLAR_ASSERT(accepted->send("x", 1) == 1);
+    char end[6] = {0};
+    SYLAR_ASSERT(client->recv(end, 6, MSG_WAITALL) == 6 && memcmp(end, "0\r\n\r\nx", 6) == 0);
+
+    // 停止后不能再订阅
+    hub->stop();
+    SYLAR_ASSERT(hub->getSubscriberCount() == 0 && hub->publish("x") == 0);
+    sub = hub->createSubscriber(subs[0]->getSession(), true);
+    SYLAR_ASSERT(!hub->subscribe(sub));
+    newest->stop();
+    disconnect->stop();
+    SYLAR_LOG_INFO(g_logger) << "queue test ok";
+}
+
+/**
+ * @brief 读取SSE响应的客户端，解开chunked编码
+ */
+struct Client {
+    sylar::Socket::ptr sock;
+    /// 尚未解码的数据
+    std::string raw;
+    /// 解码后的消息体
+    std::string body;
+    /// 响应头
+    std::string header;
+    /// 是否收到结束块
+    bool ended = false;
+
+    bool connect(const std::string& path, const std::string& extra = "") {
+        sock = sylar::Socket::CreateTCPSocket();
+        sock->setRecvTimeout(3000);
+        if(!sock->connect(sylar::Address::LookupAnyIPAddress("127.0.0.1:8117"))) {
+            return false;
+        }
+        std::string req = "GET " + path + " HTTP/1.1\r\nHost: 127.0.0.1\r\n" + extra + "\r\n";
+        return sock->send(req.c_str(), req.size()) == (int)req.size();
+    }
+
+    bool recv() {
+        char buf[4096];
+        int rt = sock->recv(buf, sizeof(buf));
+        if(rt <= 0) {
+            return false;
+        }
+        raw.append(buf, rt);
+        return true;
+    }
+
+    bool readHeader() {
+        while(raw.find("\r\n\r\n") == std::string::npos) {
+            if(!recv()) {
+                return false;
+            }
+        }
+        size_t pos = raw.find("\r\n\r\n") + 4;
+        header = raw.substr(0, pos);
+        raw.erase(0, pos);
+        return true;
+    }
+
+    void decode() {
+        while(!ended) {
+            size_t pos = raw.find("\r\n");
+            if(pos == std::string::npos) {
+                return;
+            }
+            size_t len = strtoul(raw.c_str(), nullptr, 16);
+            if(raw.size() < pos + 2 + len + 2) {
+                return;
+            }
+            body.append(raw, pos + 2, len);
+            raw.erase(0, pos + 2 + len + 2);
+            ended = len == 0;
+        }
+    }
+
+    /**
+     * @brief 读到消息体中出现s为止
+     */
+    bool readUntil(const std::string& s) {
+        while(true) {
+            decode();
+            if(body.find(s) != std::string::npos) {
+                return true;
+            }
+            if(ended || !recv()) {
+                return false;
+            }
+        }
+    }
+
+    /**
+     * @brief 读到连接关闭
+     */
+    void readAll() {
+        while(recv()) {
+        }
+        decode();
+    }
+};
+
+static void wait_subscribers(sylar::http::SseHub::ptr hub, size_t n) {
+    for(int i = 0; i < 300 && hub->getSubscriberCount() != n; ++i) {
+        usleep(10 * 1000);
+    }
+    SYLAR_ASSERT(hub->getSubscriberCount() == n);
+}
+
+void test_server() {
+    sylar::http::HttpServer::ptr server(new sylar::http::HttpServer(true));
+    auto addr = sylar::Address::LookupAnyIPAddress("127.0.0.1:8117");
+    while(!server->bind(addr)) {
+        sleep(2);
+    }
+    sylar::http::SseHub::ptr hub(new sylar::http::SseHub("test", sylar::http::SseSubscriber::DROP_OLDEST, 1024));
+    server->getServletDispatch()->addServlet("/events", std::make_shared<sylar::http::SseServlet>(hub
+        , [](sylar::http::HttpRequest::ptr req, sylar::http::HttpResponse::ptr rsp
+             , sylar::http::SseSubscriber::ptr sub) {
+            if(req->getHeader("Authorization") == "deny") {
+                rsp->setStatus(sylar::http::HttpStatus::FORBIDDEN);
+                return false;
+            }
+            // 按Last-Event-ID补发断线期间的事件
+            std::string last = req->getHeader("Last-Event-ID");
+            if(!last.empty()) {
+                sub->push(sylar::http::SseHub::Encode("replay after " + last, "", "r"));
+            }
+            return true;
+        }));
+    sylar::http::SseHub::ptr slow(new sylar::http::SseHub("test_slow", sylar::http::SseSubscriber::DISCONNECT, 8));
+    server->getServletDispatch()->addServlet("/slow", std::make_shared<sylar::http::SseServlet>(slow));
+    server->start();
+
+    // 被回调拒绝的连接收到普通响应
+    auto rt = sylar::http::HttpConnection::DoGet("http://127.0.0.1:8117/events", 3000, {{"Authorization", "deny"}});
+    SYLAR_ASSERT(rt->result == 0 && rt->response->getStatus() == sylar::http::HttpStatus::FORBIDDEN);
+
+    // 多个连接收到同样的事件
+    const size_t N = 20;
+    std::vector<Client> clients(N);
+    for(size_t i = 0; i < N; ++i) {
+        SYLAR_ASSERT(clients[i].connect("/events", i == 0 ? "Last-Event-ID: 7\r\n" : ""));
+        SYLAR_ASSERT(clients[i].readHeader());
+        SYLAR_ASSERT(clients[i].header.find("text/event-stream") != std::string::npos);
+        SYLAR_ASSERT(clients[i].header.find("chunked") != std::string::npos);
+    }
+    wait_subscribers(hub, N);
+    std::string expect;
+    for(int i = 0; i < 100; ++i) {
+        std::string data = "event " + std::to_string(i);
+        SYLAR_ASSERT(hub->publish(data, "tick", std::to_string(i)) == N);
+        expect += *sylar::http::SseHub::Encode(data, "tick", std::to_string(i));
+    }
+    for(size_t i = 0; i < N; ++i) {
+        SYLAR_ASSERT(clients[i].readUntil("data: event 99\n\n"));
+        std::string replay = i == 0 ? *sylar::http::SseHub::Encode("replay after 7", "", "r") : "";
+        SYLAR_ASSERT(clients[i].body == replay + expect);
+    }
+    SYLAR_LOG_INFO(g_logger) << "fan-out ok";
+
+    // 空闲时写心跳
+    sylar::Config::Lookup<uint64_t>("http.sse.heartbeat_ms")->setValue(100);
+    Client idle;
+    SYLAR_ASSERT(idle.connect("/events") && idle.readHeader());
+    uint64_t start = sylar::GetCurrentMS();
+    SYLAR_ASSERT(idle.readUntil(":\n\n") && idle.body == ":\n\n");
+    SYLAR_ASSERT(sylar::GetCurrentMS() - start < 1000);
+    SYLAR_LOG_INFO(g_logger) << "heartbeat ok";
+
+    // 不读数据的慢连接，队列满后被断开，不影响其他连接
+    Client lazy;
+    SYLAR_ASSERT(lazy.connect("/slow") && lazy.readHeader());
+    Client fast;
+    SYLAR_ASSERT(fast.connect("/slow") && fast.readHeader());
+    wait_subscribers(slow, 2);
+    std::string big(64 * 1024, 'x');
+    auto buf = sylar::http::SseHub::Encode(big);
+    for(int i = 0; i < 100000 && slow->getSubscriberCount() == 2; ++i) {
+        slow->publish(buf);
+        // 每发几个事件就读完fast的数据，fast的队列不会满
+        if(i % 4 == 3) {
+            while(fast.body.size() < 4 * buf->size()) {
+                SYLAR_ASSERT(fast.recv());
+                fast.decode();
+            }
+            SYLAR_ASSERT(fast.body.size() == 4 * buf->size());
+            fast.body.clear();
+        }
+    }
+    wait_subscribers(slow, 1);
+    lazy.readAll();
+    SYLAR_ASSERT(!lazy.ended);
+    SYLAR_LOG_INFO(g_logger) << "slow subscriber disconnected ok";
+
+    // 停止广播后连接以结束块正常结束
+    hub->stop();
+    slow->stop();
+    for(size_t i = 0; i < N; ++i) {
+        clients[i].readAll();
+        SYLAR_ASSERT(clients[i].ended);
+    }
+    idle.readAll();
+    fast.readAll();
+    SYLAR_ASSERT(idle.ended && fast.ended);
+    server->stop();
+    SYLAR_LOG_INFO(g_logger) << "stop test ok";
+}
+
+void run() {
+    g_logger->setLevel(sylar::LogLevel::INFO);
+    signal(SIGPIPE, SIG_IGN);
+    test_encode();
+    test_queue();
+    test_server();
+}
+
+int main(int argc, char *argv[]) {
+    sylar::IOManager iom(2);
+    iom.schedule(&run);
+    return 0;
+}
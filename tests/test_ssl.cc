@@ -0,0 +1,234 @@
+/**
+ * @file test_ssl.cc
+ * @brief SSLSocket测试：HTTPS收发、会话恢复、握手卸载、sendFile，以及完整握手与恢复握手的耗时对比
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "sylar/sylar.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_ROOT();
+
+static const char* s_cert_file = "/tmp/sylar_test_cert.pem";
+static const char* s_key_file  = "/tmp/sylar_test_key.pem";
+static const char* s_data_file = "/tmp/sylar_test_sendfile.dat";
+
+static sylar::IOManager* s_handshake_worker = nullptr;
+static int s_handshakes = 200;
+
+/**
+ * @brief 生成自签名证书
+ */
+static bool GenerateCert() {
+    EVP_PKEY* pkey = EVP_EC_gen("P-256");
+    if(!pkey) {
+        return false;
+    }
+    X509* x = X509_new();
+    ASN1_INTEGER_set(X509_get_serialNumber(x), 1);
+    X509_gmtime_adj(X509_getm_notBefore(x), 0);
+    X509_gmtime_adj(X509_getm_notAfter(x), 24 * 3600L);
+    X509_set_pubkey(x, pkey);
+    X509_NAME* name = X509_get_subject_name(x);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char*)"localhost", -1, -1, 0);
+    X509_set_issuer_name(x, name);
+    X509_sign(x, pkey, EVP_sha256());
+
+    bool ok = false;
+    FILE* kf = fopen(s_key_file, "w");
+    FILE* cf = fopen(s_cert_file, "w");
+    if(kf && cf) {
+        ok = PEM_write_PrivateKey(kf, pkey, nullptr, nullptr, 0, nullptr, nullptr)
+            && PEM_write_X509(cf, x);
+    }
+    if(kf) {
+        fclose(kf);
+    }
+    if(cf) {
+        fclose(cf);
+    }
+    X509_free(x);
+    EVP_PKEY_free(pkey);
+    return ok;
+}
+
+/**
+ * @brief 用sendFile把文件发给每个连接的TLS服务器
+ */
+class FileServer : public sylar::TcpServer {
+public:
+    typedef std::shared_ptr<FileServer> ptr;
+protected:
+    virtual void handleClient(sylar::Socket::ptr client) override {
+        auto sock = std::dynamic_pointer_cast<sylar::SSLSocket>(client);
+        SYLAR_ASSERT(sock && sock->isHandshaked());
+        int fd = open(s_data_file, O_RDONLY);
+        SYLAR_ASSERT(fd >= 0);
+        struct stat st;
+        fstat(fd, &st);
+        int64_t rt = sock->sendFile(fd, 0, st.st_size);
+        SYLAR_LOG_INFO(g_logger) << "sendFile rt=" << rt << " " << *sock;
+        ::close(fd);
+        sock->close();
+    }
+};
+
+static std::string RecvAll(sylar::Socket::ptr sock) {
+    std::string rt;
+    char buf[8192];
+    int n = 0;
+    while((n = sock->recv(buf, sizeof(buf))) > 0) {
+        rt.append(buf, n);
+    }
+    return rt;
+}
+
+static bool Connect(sylar::Address::ptr addr, const std::string& host) {
+    sylar::SSLSocket::ptr sock = sylar::SSLSocket::CreateTCP(addr);
+    sock->setHostName(host);
+    sock->setRecvTimeout(3000);
+    return sock->connect(addr);
+}
+
+/**
+ * @brief 默认校验服务器证书，自签名证书配置成CA之后才能通过，主机名也必须匹配
+ */
+void test_verify(sylar::Address::ptr addr) {
+    auto verify = sylar::Config::Lookup<bool>("ssl.client.verify_peer");
+    SYLAR_ASSERT(verify->getValue());
+    SYLAR_ASSERT(!Connect(addr, "localhost"));
+    sylar::Config::Lookup<std::string>("ssl.client.ca_file")->setValue(s_cert_file);
+    SYLAR_ASSERT(Connect(addr, "localhost"));
+    SYLAR_ASSERT(!Connect(addr, "other.test"));
+    // 没有主机名时按IP校验，证书里没有127.0.0.1
+    SYLAR_ASSERT(!Connect(addr, ""));
+
+    // 其余的测试用IP和任意主机名连接自签名证书的服务器，不校验
+    verify->setValue(false);
+    SYLAR_ASSERT(Connect(addr, "other.test"));
+    SYLAR_LOG_INFO(g_logger) << "verify ok";
+}
+
+void test_https(sylar::Address::ptr addr) {
+    auto r = sylar::http::HttpConnection::DoGet("https://127.0.0.1:"
+            + std::to_string(std::dynamic_pointer_cast<sylar::IPAddress>(addr)->getPort())
+            + "/hello", 3000);
+    SYLAR_LOG_INFO(g_logger) << "DoGet result=" << r->result << " error=" << r->error;
+    SYLAR_ASSERT(r->result == 0 && r->response->getBody() == "hello https");
+
+    auto pool = sylar::http::HttpConnectionPool::Create("https://127.0.0.1:8443", "localhost"
+            , 10, 30 * 1000, 5);
+    SYLAR_ASSERT(pool);
+    r = pool->doGet("/hello", 3000);
+    SYLAR_ASSERT(r->result == 0 && r->response->getBody() == "hello https");
+    SYLAR_LOG_INFO(g_logger) << "https ok";
+}
+
+/**
+ * @brief 建立连接并发一个请求，返回是否恢复了会话
+ * @details TLS1.3的会话票据在握手之后下发，读一次响应才能把票据收进缓存
+ */
+static bool Request(sylar::Address::ptr addr, const std::string& host) {
+    sylar::SSLSocket::ptr sock = sylar::SSLSocket::CreateTCP(addr);
+    sock->setHostName(host);
+    sock->setRecvTimeout(3000);
+    SYLAR_ASSERT(sock->connect(addr));
+    sylar::http::HttpConnection::ptr conn(new sylar::http::HttpConnection(sock));
+    sylar::http::HttpRequest::ptr req(new sylar::http::HttpRequest);
+    req->setPath("/hello");
+    req->setHeader("Host", host);
+    SYLAR_ASSERT(conn->sendRequest(req) > 0);
+    auto rsp = conn->recvResponse();
+    SYLAR_ASSERT(rsp && rsp->getBody() == "hello https");
+    return sock->isSessionReused();
+}
+
+void test_resumption(sylar::Address::ptr addr) {
+    SYLAR_ASSERT(!Request(addr, "resume.test"));
+    SYLAR_ASSERT(Request(addr, "resume.test"));
+    SYLAR_LOG_INFO(g_logger) << "session resumption ok";
+
+    // 每次换一个SNI主机名就拿不到缓存的会话，只能完整握手
+    uint64_t full = 0;
+    uint64_t resumed = 0;
+    for(int k = 0; k < 2; ++k) {
+        uint64_t start = sylar::GetCurrentUS();
+        for(int i = 0; i < s_handshakes; ++i) {
+            bool reused = Request(addr, k == 0 ? "full" + std::to_string(i) : "resume.test");
+            SYLAR_ASSERT(reused == (k == 1));
+        }
+        (k == 0 ? full : resumed) = sylar::GetCurrentUS() - start;
+    }
+    SYLAR_LOG_INFO(g_logger) << "handshake+request bench: n=" << s_handshakes
+        << " full=" << full / s_handshakes << "us/conn"
+        << " resumed=" << resumed / s_handshakes << "us/conn";
+}
+
+void test_sendfile() {
+    std::string data;
+    for(int i = 0; i < 300000; ++i) {
+        data.append(1, 'a' + i % 26);
+    }
+    FILE* f = fopen(s_data_file, "w");
+    SYLAR_ASSERT(f);
+    fwrite(data.c_str(), 1, data.size(), f);
+    fclose(f);
+
+    FileServer::ptr server(new FileServer);
+    auto addr = sylar::Address::LookupAnyIPAddress("127.0.0.1:8444");
+    SYLAR_ASSERT(server->bind(addr, true));
+    SYLAR_ASSERT(server->loadCertificates(s_cert_file, s_key_file));
+    server->setHandshakeWorker(s_handshake_worker);
+    server->start();
+
+    sylar::SSLSocket::ptr sock = sylar::SSLSocket::CreateTCP(addr);
+    sock->setRecvTimeout(3000);
+    SYLAR_ASSERT(sock->connect(addr));
+    SYLAR_ASSERT(RecvAll(sock) == data);
+    server->stop();
+    SYLAR_LOG_INFO(g_logger) << "sendfile ok";
+}
+
+void run() {
+    g_logger->setLevel(sylar::LogLevel::INFO);
+    SYLAR_ASSERT(GenerateCert());
+
+    sylar::http::HttpServer::ptr server(new sylar::http::HttpServer(true));
+    auto addr = sylar::Address::LookupAnyIPAddress("127.0.0.1:8443");
+    SYLAR_ASSERT(addr);
+    while(!server->bind(addr, true)) {
+        sleep(2);
+    }
+    SYLAR_ASSERT(server->loadCertificates(s_cert_file, s_key_file));
+    server->setHandshakeWorker(s_handshake_worker);
+    server->getServletDispatch()->addServlet("/hello", [](sylar::http::HttpRequest::ptr req
+                , sylar::http::HttpResponse::ptr rsp
+                , sylar::http::HttpSession::ptr session) {
+        rsp->setBody("hello https");
+        return 0;
+    });
+    server->start();
+
+    test_verify(addr);
+    test_https(addr);
+    test_resumption(addr);
+    test_sendfile();
+    server->stop();
+}
+
+int main(int argc, char** argv) {
+    if(argc > 1) {
+        s_handshakes = atoi(argv[1]);
+    }
+    if(argc > 2 && !strcmp(argv[2], "ktls")) {
+        sylar::Config::Lookup<bool>("ssl.ktls")->setValue(true);
+    }
+    sylar::IOManager handshake(1, false, "handshake");
+    s_handshake_worker = &handshake;
+    sylar::IOManager iom(2);
+    iom.schedule(&run);
+    return 0;
+}
@@ -0,0 +1,228 @@
+/**
+ * @file test_tcp_proxy.cc
+ * @brief TCP代理服务器测试，以及splice与用户态拷贝转发的吞吐量对比
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "sylar/sylar.h"
+#include "sylar/tcp_proxy_server.h"
+#include <sys/socket.h>
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_ROOT();
+
+static const char* s_upstream = "127.0.0.1:8096";
+static const char* s_proxy    = "127.0.0.1:8097";
+static const char* s_refused  = "127.0.0.1:8099";
+
+static int s_clients = 4;
+static uint64_t s_bytes = 256 * 1024 * 1024;
+
+/**
+ * @brief 上游服务器
+ * @details 第一个字节是'E'时回显收到的数据，读到EOF后回显完再半关闭；
+ *          是'D'时后面跟十进制字节数和换行，发送这么多数据后关闭；
+ *          是'S'时后面跟十进制字节数和换行，每100毫秒发送一个字节，发完后关闭
+ */
+class UpstreamServer : public sylar::TcpServer {
+protected:
+    void handleClient(sylar::Socket::ptr client) override {
+        char mode = 0;
+        if(client->recv(&mode, 1) != 1) {
+            client->close();
+            return;
+        }
+        std::string buf(64 * 1024, 'd');
+        if(mode == 'E') {
+            int n;
+            while((n = client->recv(&buf[0], buf.size())) > 0) {
+                SYLAR_ASSERT(client->send(&buf[0], n) == n);
+            }
+            ::shutdown(client->getSocket(), SHUT_WR);
+            // 等客户端也关闭
+            client->recv(&buf[0], buf.size());
+        } else if(mode == 'D' || mode == 'S') {
+            std::string line;
+            char c;
+            while(client->recv(&c, 1) == 1 && c != '\n') {
+                line.push_back(c);
+            }
+            uint64_t left = std::stoull(line);
+            while(mode == 'S' && left) {
+                if(client->send(&buf[0], 1) != 1) {
+                    break;
+                }
+                --left;
+                usleep(100 * 1000);
+            }
+            while(left) {
+                int n = client->send(&buf[0], std::min((uint64_t)buf.size(), left));
+                if(n <= 0) {
+                    break;
+                }
+                left -= n;
+            }
+        }
+        client->close();
+    }
+};
+
+static sylar::Socket::ptr Connect() {
+    auto addr = sylar::Address::LookupAnyIPAddress(s_proxy);
+    auto sock = sylar::Socket::CreateTCP(addr);
+    SYLAR_ASSERT(sock->connect(addr));
+    sock->setRecvTimeout(5000);
+    return sock;
+}
+
+static std::string RecvAll(sylar::Socket::ptr sock) {
+    std::string data;
+    char buf[4096];
+    int n;
+    while((n = sock->recv(buf, sizeof(buf))) > 0) {
+        data.append(buf, n);
+    }
+    SYLAR_ASSERT(n == 0);
+    return data;
+}
+
+void test_functional(sylar::TcpProxyServer::ptr proxy) {
+    // 客户端半关闭后仍能收到上游的全部回显和EOF
+    auto sock = Connect();
+    std::string msg = "E";
+    for(int i = 0; i < 10000; ++i) {
+        msg += "hello proxy " + std::to_string(i) + "\n";
+    }
+    SYLAR_ASSERT(sock->send(msg.c_str(), msg.size()) == (int)msg.size());
+    ::shutdown(sock->getSocket(), SHUT_WR);
+    SYLAR_ASSERT(RecvAll(sock) == msg.substr(1));
+    sock->close();
+
+    // 上游主动关闭
+    sock = Connect();
+    std::string req = "D1000000\n";
+    SYLAR_ASSERT(sock->send(req.c_str(), req.size()) == (int)req.size());
+    SYLAR_ASSERT(RecvAll(sock).size() == 1000000);
+    sock->close();
+
+    // 上行空闲、下行缓慢但持续地转发，总时长超过读超时也不会被断开
+    uint64_t timeout = proxy->getRecvTimeout();
+    proxy->setRecvTimeout(300);
+    for(int k = 0; k < 2; ++k) {
+        proxy->setSplice(k == 0);
+        sock = Connect();
+        req = "S10\n";
+        SYLAR_ASSERT(sock->send(req.c_str(), req.size()) == (int)req.size());
+        SYLAR_ASSERT(RecvAll(sock).size() == 10);
+        sock->close();
+    }
+    proxy->setRecvTimeout(timeout);
+
+    // 客户端在转发途中重置连接，出错的方向断开两端，另一个方向立即退出而不是等到读超时
+    for(int k = 0; k < 2; ++k) {
+        proxy->setSplice(k == 0);
+        sock = Connect();
+        req = "D100000000\n";
+        SYLAR_ASSERT(sock->send(req.c_str(), req.size()) == (int)req.size());
+        char buf[4096];
+        SYLAR_ASSERT(sock->recv(buf, sizeof(buf)) > 0);
+        struct linger lg = {1, 0};
+        sock->setOption(SOL_SOCKET, SO_LINGER, lg);
+        sock->close();
+        for(int i = 0; i < 100 && proxy->getConnections(); ++i) {
+            usleep(10 * 1000);
+        }
+        SYLAR_ASSERT(proxy->getConnections() == 0);
+    }
+    proxy->setSplice(true);
+
+    // 上游连接不上时直接断开客户端
+    sylar::TcpProxyServer::ptr refused(new sylar::TcpProxyServer(
+                sylar::Address::LookupAnyIPAddress(s_refused)));
+    auto addr = sylar::Address::LookupAnyIPAddress("127.0.0.1:8098");
+    while(!refused->bind(addr)) {
+        sleep(2);
+    }
+    refused->start();
+    sock = sylar::Socket::CreateTCP(addr);
+    SYLAR_ASSERT(sock->connect(addr));
+    sock->setRecvTimeout(5000);
+    SYLAR_ASSERT(RecvAll(sock).empty());
+    sock->close();
+    refused->stop();
+
+    // 等连接计数归零
+    for(int i = 0; i < 100 && proxy->getConnections(); ++i) {
+        usleep(10 * 1000);
+    }
+    SYLAR_ASSERT(proxy->getConnections() == 0);
+    SYLAR_LOG_INFO(g_logger) << "functional test ok " << proxy->toString();
+}
+
+void bench(sylar::TcpProxyServer::ptr proxy) {
+    for(int k = 0; k < 2; ++k) {
+        proxy->setSplice(k == 0);
+        std::shared_ptr<std::atomic<int> > done(new std::atomic<int>(0));
+        uint64_t start = sylar::GetCurrentUS();
+        for(int i = 0; i < s_clients; ++i) {
+            sylar::IOManager::GetThis()->schedule([done]() {
+                auto sock = Connect();
+                std::string req = "D" + std::to_string(s_bytes) + "\n";
+                SYLAR_ASSERT(sock->send(req.c_str(), req.size()) == (int)req.size());
+                std::string buf(256 * 1024, 0);
+                uint64_t total = 0;
+                int n;
+                while((n = sock->recv(&buf[0], buf.size())) > 0) {
+                    total += n;
+                }
+                SYLAR_ASSERT(n == 0 && total == s_bytes);
+                sock->close();
+                ++*done;
+            });
+        }
+        while(*done < s_clients) {
+            usleep(10 * 1000);
+        }
+        uint64_t used = sylar::GetCurrentUS() - start;
+        uint64_t total = s_bytes * s_clients;
+        SYLAR_LOG_INFO(g_logger) << "tcp proxy bench " << (k == 0 ? "splice" : "copy")
+            << " clients=" << s_clients
+            << " bytes=" << total / 1024 / 1024 << "MB"
+            << " used=" << used / 1000 << "ms"
+            << " throughput=" << (total * 1000000 / used / 1024 / 1024) << "MB/s";
+    }
+}
+
+void run() {
+    g_logger->setLevel(sylar::LogLevel::INFO);
+    sylar::TcpServer::ptr upstream(new UpstreamServer);
+    auto addr = sylar::Address::LookupAnyIPAddress(s_upstream);
+    while(!upstream->bind(addr)) {
+        sleep(2);
+    }
+    upstream->start();
+
+    sylar::TcpProxyServer::ptr proxy(new sylar::TcpProxyServer(addr));
+    auto paddr = sylar::Address::LookupAnyIPAddress(s_proxy);
+    while(!proxy->bind(paddr)) {
+        sleep(2);
+    }
+    proxy->start();
+
+    test_functional(proxy);
+    bench(proxy);
+
+    proxy->stop();
+    upstream->stop();
+}
+
+int main(int argc, char *argv[]) {
+    if(argc > 1) {
+        s_clients = atoi(argv[1]);
+    }
+    if(argc > 2) {
+        s_bytes = std::stoull(argv[2]) * 1024 * 1024;
+    }
+    sylar::IOManager iom(2);
+    iom.schedule(&run);
+    return 0;
+}
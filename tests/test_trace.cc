@@ -0,0 +1,212 @@
+/**
+ * @file test_trace.cc
+ * @brief 链路追踪测试：traceparent解析、协程局部上下文、HTTP上下游传播和单个span的开销
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "sylar/sylar.h"
+#include <fstream>
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_ROOT();
+
+static const std::string s_span_file = "/tmp/test_trace_spans.log";
+
+void test_traceparent() {
+    sylar::SpanContext ctx;
+    SYLAR_ASSERT(sylar::SpanContext::FromTraceparent(
+            "00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01", ctx));
+    SYLAR_ASSERT(ctx.getTraceId() == "0af7651916cd43dd8448eb211c80319c");
+    SYLAR_ASSERT(ctx.spanId == 0xb7ad6b7169203331ULL);
+    SYLAR_ASSERT(ctx.sampled);
+    SYLAR_ASSERT(ctx.toTraceparent() == "00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01");
+    // 更高版本允许追加字段
+    SYLAR_ASSERT(sylar::SpanContext::FromTraceparent(
+            "01-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-00-extra", ctx));
+    SYLAR_ASSERT(!ctx.sampled);
+    for(auto& i : {""
+                   ,"00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01-x"
+                   ,"ff-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01"
+                   ,"00-00000000000000000000000000000000-b7ad6b7169203331-01"
+                   ,"00-0af7651916cd43dd8448eb211c80319c-0000000000000000-01"
+                   ,"00-0af7651916cd43dd8448eb211c80319g-b7ad6b7169203331-01"
+                   ,"00_0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01"}) {
+        SYLAR_ASSERT(!sylar::SpanContext::FromTraceparent(i, ctx));
+    }
+    SYLAR_LOG_INFO(g_logger) << "traceparent test ok";
+}
+
+void test_fiber_local() {
+    sylar::Span* a_span = nullptr;
+    sylar::IOManager::GetThis()->schedule([&a_span]() {
+        sylar::Span span("a");
+        a_span = &span;
+        usleep(50 * 1000);
+        // 其他协程的span不影响本协程
+        SYLAR_ASSERT(sylar::Span::GetCurrent() == &span);
+        {
+            sylar::Span child("a.child");
+            SYLAR_ASSERT(child.getParentId() == span.getContext().spanId);
+            SYLAR_ASSERT(child.getContext().traceIdLow == span.getContext().traceIdLow);
+        }
+        SYLAR_ASSERT(sylar::Span::GetCurrent() == &span);
+    });
+    usleep(10 * 1000);
+    SYLAR_ASSERT(a_span && sylar::Span::GetCurrent() == nullptr);
+    {
+        sylar::Span span("b");
+        SYLAR_ASSERT(span.getParentId() == 0);
+        SYLAR_ASSERT(span.getContext().traceIdLow != a_span->getContext().traceIdLow);
+        usleep(80 * 1000);
+    }
+    SYLAR_ASSERT(sylar::Span::GetCurrent() == nullptr);
+    SYLAR_LOG_INFO(g_logger) << "fiber local test ok";
+}
+
+/**
+ * @brief 取出JSON行里字符串或数字字段的值
+ */
+static std::string Field(const std::string& line, const std::string& name) {
+    std::string key = "\"" + name + "\":";
+    size_t pos = line.find(key);
+    if(pos == std::string::npos) {
+        return "";
+    }
+    pos += key.size();
+    if(line[pos] == '"') {
+        return line.substr(pos + 1, line.find('"', pos + 1) - pos - 1);
+    }
+    return line.substr(pos, line.find_first_of(",}", pos) - pos);
+}
+
+static std::vector<std::string> ReadSpans() {
+    sylar::TracerMgr::GetInstance()->flush();
+    std::vector<std::string> lines;
+    std::ifstream ifs(s_span_file);
+    std::string line;
+    while(std::getline(ifs, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+static std::string Find(const std::vector<std::string>& spans, const std::string& name) {
+    for(auto& i : spans) {
+        if(Field(i, "name") == name) {
+            return i;
+        }
+    }
+    SYLAR_LOG_ERROR(g_logger) << "span not found: " << name;
+    SYLAR_ASSERT(false);
+    return "";
+}
+
+void test_http() {
+    unlink(s_span_file.c_str());
+    sylar::Config::Lookup<double>("trace.sample_rate")->setValue(1);
+    sylar::Config::Lookup<std::string>("trace.exporter")->setValue("file:" + s_span_file);
+
+    sylar::http::HttpServer::ptr server(new sylar::http::HttpServer(true));
+    auto addr = sylar::Address::LookupAnyIPAddress("127.0.0.1:8103");
+    while(!server->bind(addr)) {
+        sleep(2);
+    }
+    auto sd = server->getServletDispatch();
+    sd->addServlet("/front", [](sylar::http::HttpRequest::ptr req
+                , sylar::http::HttpResponse::ptr rsp
+                , sylar::http::HttpSession::ptr session) {
+        auto rt = sylar::http::HttpConnection::DoGet("http://127.0.0.1:8103/back", 1000);
+        rsp->setBody(rt->response ? "front:" + rt->response->getBody() : "fail");
+        return 0;
+    });
+    sd->addServlet("/back", [](sylar::http::HttpRequest::ptr req
+                , sylar::http::HttpResponse::ptr rsp
+                , sylar::http::HttpSession::ptr session) {
+        rsp->setBody("back");
+        return 0;
+    });
+    server->start();
+
+    std::string trace_id;
+    {
+        sylar::Span root("root");
+        trace_id = root.getContext().getTraceId();
+        auto rt = sylar::http::HttpConnection::DoGet("http://127.0.0.1:8103/front", 1000);
+        SYLAR_ASSERT(rt->result == 0 && rt->response->getBody() == "front:back");
+    }
+    // 服务端的span在发送响应之后结束
+    usleep(50 * 1000);
+    auto spans = ReadSpans();
+    SYLAR_ASSERT(spans.size() == 5);
+    for(auto& i : spans) {
+        SYLAR_ASSERT(Field(i, "trace_id") == trace_id);
+    }
+    auto root = Find(spans, "root");
+    auto c1 = Find(spans, "GET 127.0.0.1/front");
+    auto s1 = Find(spans, "GET /front");
+    auto c2 = Find(spans, "GET 127.0.0.1/back");
+    auto s2 = Find(spans, "GET /back");
+    SYLAR_ASSERT(Field(root, "parent_id") == "");
+    SYLAR_ASSERT(Field(c1, "parent_id") == Field(root, "span_id"));
+    SYLAR_ASSERT(Field(s1, "parent_id") == Field(c1, "span_id"));
+    SYLAR_ASSERT(Field(c2, "parent_id") == Field(s1, "span_id"));
+    SYLAR_ASSERT(Field(s2, "parent_id") == Field(c2, "span_id"));
+    SYLAR_ASSERT(Field(s1, "kind") == "server" && Field(c1, "kind") == "client");
+    SYLAR_ASSERT(Field(s2, "status") == "200");
+
+    // 本地不采样时仍然遵从上游的采样标记
+    sylar::Config::Lookup<double>("trace.sample_rate")->setValue(0);
+    auto sock = sylar::Socket::CreateTCP(addr);
+    SYLAR_ASSERT(sock->connect(addr));
+    std::string raw = "GET /back HTTP/1.1\r\nHost: 127.0.0.1\r\nConnection: close\r\n"
+        "traceparent: 00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01\r\n\r\n";
+    sock->send(raw.c_str(), raw.size());
+    char buf[1024];
+    while(sock->recv(buf, sizeof(buf)) > 0);
+    sock->close();
+    // 新的调用链按采样率0不记录
+    sylar::http::HttpConnection::DoGet("http://127.0.0.1:8103/back", 1000);
+    usleep(50 * 1000);
+    spans = ReadSpans();
+    SYLAR_ASSERT(spans.size() == 6);
+    SYLAR_ASSERT(Field(spans[5], "trace_id") == "0af7651916cd43dd8448eb211c80319c");
+    SYLAR_ASSERT(Field(spans[5], "parent_id") == "b7ad6b7169203331");
+
+    server->stop();
+    SYLAR_LOG_INFO(g_logger) << "http test ok exported="
+        << sylar::TracerMgr::GetInstance()->getExported();
+}
+
+void bench(double rate, int loops) {
+    sylar::TracerMgr::GetInstance()->setSampleRate(rate);
+    sylar::TracerMgr::GetInstance()->flush();
+    uint64_t dropped = sylar::TracerMgr::GetInstance()->getDropped();
+    std::string name = "bench";
+    sylar::Span root("bench_root");
+    uint64_t start = sylar::GetCurrentUS();
+    for(int i = 0; i < loops; ++i) {
+        sylar::Span span(name);
+        span.setStatus(i);
+    }
+    uint64_t used = sylar::GetCurrentUS() - start;
+    SYLAR_LOG_INFO(g_logger) << "span bench sample_rate=" << rate
+        << " recording=" << root.isRecording()
+        << " per_span=" << used * 1000 / loops << "ns"
+        << " dropped=" << sylar::TracerMgr::GetInstance()->getDropped() - dropped;
+}
+
+void run() {
+    g_logger->setLevel(sylar::LogLevel::INFO);
+    test_traceparent();
+    test_fiber_local();
+    test_http();
+    // 每轮只占满一次缓冲，不计入导出线程取走后的溢出
+    bench(0, 1000000);
+    bench(1, 4000);
+    sylar::Config::Lookup<std::string>("trace.exporter")->setValue("");
+}
+
+int main(int argc, char *argv[]) {
+    sylar::IOManager iom(2);
+    iom.schedule(&run);
+    return 0;
+}
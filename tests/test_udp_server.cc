@@ -0,0 +1,142 @@
+/**
+ * @file test_udp_server.cc
+ * @brief UDP服务器测试，以及内联处理与协程处理两种模式的回显吞吐量对比
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#include "sylar/sylar.h"
+#include "sylar/udp_server.h"
+
+static sylar::Logger::ptr g_logger = SYLAR_LOG_ROOT();
+
+static int s_clients = 8;
+static int s_packets = 100000;
+static int s_window  = 32;
+
+class EchoServer : public sylar::UdpServer {
+public:
+    typedef std::shared_ptr<EchoServer> ptr;
+    EchoServer(const std::vector<sylar::IOManager*>& workers)
+        :UdpServer(workers) {
+        m_type = "udp_echo";
+    }
+
+    std::atomic<uint64_t> count = {0};
+protected:
+    void handlePacket(sylar::UdpPacket::ptr packet) override {
+        ++count;
+        packet->reply(packet->data);
+    }
+};
+
+static sylar::Socket::ptr NewClient(sylar::Address::ptr addr) {
+    auto sock = sylar::Socket::CreateUDP(addr);
+    sock->setRecvTimeout(1000);
+    return sock;
+}
+
+void test_echo(sylar::Address::ptr addr) {
+    auto sock = NewClient(addr);
+    for(int i = 0; i < 10; ++i) {
+        std::string msg = "hello udp " + std::to_string(i);
+        SYLAR_ASSERT(sock->sendTo(msg.c_str(), msg.size(), addr) == (int)msg.size());
+        char buf[256];
+        sylar::Address::ptr from(new sylar::IPv4Address);
+        int rt = sock->recvFrom(buf, sizeof(buf), from);
+        SYLAR_ASSERT(rt == (int)msg.size());
+        SYLAR_ASSERT(std::string(buf, rt) == msg);
+        SYLAR_ASSERT(from->toString() == addr->toString());
+    }
+    // 空数据报也是合法的
+    SYLAR_ASSERT(sock->sendTo("", 0, addr) == 0);
+    char buf[16];
+    sylar::Address::ptr from(new sylar::IPv4Address);
+    SYLAR_ASSERT(sock->recvFrom(buf, sizeof(buf), from) == 0);
+    sock->close();
+}
+
+void bench(sylar::Address::ptr addr, const std::string& mode) {
+    std::shared_ptr<std::atomic<int> > done(new std::atomic<int>(0));
+    std::shared_ptr<std::atomic<uint64_t> > recved(new std::atomic<uint64_t>(0));
+    auto self = sylar::Fiber::GetThis();
+    auto iom = sylar::IOManager::GetThis();
+    uint64_t start = sylar::GetCurrentUS();
+    for(int i = 0; i < s_clients; ++i) {
+        iom->schedule([addr, done, recved, self, iom]() {
+            auto sock = NewClient(addr);
+            std::string payload(64, 'x');
+            char buf[256];
+            sylar::Address::ptr from(new sylar::IPv4Address);
+            int rounds = s_packets / s_clients / s_window;
+            for(int r = 0; r < rounds; ++r) {
+                for(int j = 0; j < s_window; ++j) {
+                    sock->sendTo(payload.c_str(), payload.size(), addr);
+                }
+                for(int j = 0; j < s_window; ++j) {
+                    if(sock->recvFrom(buf, sizeof(buf), from) <= 0) {
+                        // 丢包，放弃这一轮
+                        break;
+                    }
+                    ++*recved;
+                }
+            }
+            sock->close();
+            if(++*done == s_clients) {
+                iom->schedule(self);
+            }
+        });
+    }
+    sylar::Fiber::GetThis()->yield();
+    uint64_t used = sylar::GetCurrentUS() - start;
+    uint64_t total = (uint64_t)s_packets / s_clients / s_window * s_window * s_clients;
+    SYLAR_LOG_INFO(g_logger) << "udp bench mode=" << mode
+        << " clients=" << s_clients
+        << " window=" << s_window
+        << " sent=" << total
+        << " recved=" << *recved
+        << " used=" << used / 1000 << "ms"
+        << " pps=" << (uint64_t)(*recved * 1000000.0 / used);
+}
+
+void run() {
+    g_logger->setLevel(sylar::LogLevel::INFO);
+    // 每个IO worker一个调度线程，各自持有一个SO_REUSEPORT socket
+    static sylar::IOManager w1(1, false, "udp_w1");
+    static sylar::IOManager w2(1, false, "udp_w2");
+    std::vector<sylar::IOManager*> workers = {&w1, &w2};
+
+    auto addr = sylar::Address::LookupAnyIPAddress("127.0.0.1:8093");
+    SYLAR_ASSERT(addr);
+
+    for(int inl = 1; inl >= 0; --inl) {
+        EchoServer::ptr server(new EchoServer(workers));
+        server->setInline(inl);
+        while(!server->bind(addr)) {
+            sleep(2);
+        }
+        SYLAR_ASSERT(server->getChannels().size() == workers.size());
+        server->start();
+        SYLAR_LOG_INFO(g_logger) << server->toString();
+
+        test_echo(addr);
+        SYLAR_LOG_INFO(g_logger) << "echo test ok inline=" << inl;
+        bench(addr, inl ? "inline" : "fiber");
+        server->stop();
+        // 等待各worker关闭socket，端口释放后再绑定下一个服务器
+        sleep(1);
+    }
+    w1.stop();
+    w2.stop();
+}
+
+int main(int argc, char *argv[]) {
+    if(argc > 1) {
+        s_packets = atoi(argv[1]);
+    }
+    if(argc > 2) {
+        s_clients = atoi(argv[2]);
+    }
+    sylar::IOManager iom(2);
+    iom.schedule(&run);
+    return 0;
+}